@@ -0,0 +1,772 @@
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_csv.h"
+#include "ticksio/ticksio_chunks.h"
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Reproducible micro and macro benchmarks for ticksio.
+// Usage: ticksio_bench [--quick] [--hugepages] [--filter <substring>] [--json <path>] [--dir <path>]
+
+#define BENCH_MAX_RESULTS 256
+#define BENCH_SEED 0x7469636B73ull
+#define BENCH_BASE_MS 1600000000000ull // 2020-09-13, keeps iterator ranges in the past
+
+typedef struct {
+    char name[64];
+    char params[160];     // JSON object describing the benchmark parameters
+    uint32_t warmup;
+    uint32_t samples;
+    double median_ns;
+    double p99_ns;
+    double p999_ns;
+    double throughput;    // Work units per second at the median
+    const char* unit;
+} bench_result_t;
+
+typedef struct {
+    int quick;
+    const char* filter;
+    const char* json_path;
+    const char* dir;
+    bench_result_t results[BENCH_MAX_RESULTS];
+    uint32_t num_results;
+} bench_state_t;
+
+typedef void (*bench_fn)(void* context);
+
+static void bench_fail(const char* what, ticks_status_e status) {
+    fprintf(stderr, "BENCH FAILED in %s: %s\n", what, ticks_status_to_string(status));
+    exit(EXIT_FAILURE);
+}
+
+// --- Deterministic data generation ---
+static uint64_t bench_rand(uint64_t* state) {
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+static void generate_trades(trade_data_t* out, uint64_t count, uint64_t seed) {
+    uint64_t state = seed;
+    uint64_t ms = BENCH_BASE_MS;
+    uint64_t price = 10000;
+    for (uint64_t i = 0; i < count; i++) {
+        ms += 1 + bench_rand(&state) % 100;
+        uint64_t step = bench_rand(&state) % 21;
+        price = (price + step > 10) ? price + step - 10 : price;
+        out[i].ms_since_epoch = ms;
+        out[i].price = price;
+        out[i].volume = 1 + bench_rand(&state) % 1000;
+    }
+}
+
+static uint64_t max_value_for_size(size_e size) {
+    // determine_min_size_uint64 picks the smallest width whose max value is strictly greater
+    switch (size) {
+        case SIZE_8BIT: return UINT8_MAX - 1;
+        case SIZE_16BIT: return UINT16_MAX - 1;
+        case SIZE_32BIT: return UINT32_MAX - 1;
+        default: return UINT64_MAX / 2;
+    }
+}
+
+// Generates records whose chunk encoding uses exactly the requested widths
+static void generate_trades_with_sizes(trade_data_t* out, uint64_t count, size_e ts_size, size_e price_size, size_e volume_size, uint64_t seed) {
+    uint64_t state = seed;
+    const uint64_t ts_max = max_value_for_size(ts_size);
+    const uint64_t price_max = max_value_for_size(price_size);
+    const uint64_t volume_max = max_value_for_size(volume_size);
+    for (uint64_t i = 0; i < count; i++) {
+        // Spread deltas evenly so the last record needs the full timestamp width
+        out[i].ms_since_epoch = BENCH_BASE_MS + (uint64_t)((double)ts_max * (double)i / (double)(count - 1));
+        out[i].price = bench_rand(&state) % price_max;
+        out[i].volume = bench_rand(&state) % volume_max;
+    }
+    // Columns are stored relative to their chunk minimum, so pin both ends of the range
+    out[0].price = price_max;
+    out[0].volume = volume_max;
+    out[1].price = 0;
+    out[1].volume = 0;
+}
+
+static void bench_path(const bench_state_t* state, const char* name, char* out_path, size_t out_size) {
+    snprintf(out_path, out_size, "%s/%s", state->dir, name);
+}
+
+static void write_ticks_file(const char* path, const trade_data_t* records, uint64_t count, uint64_t batch) {
+    ticks_header_t header;
+    memset(&header, 0, sizeof(header));
+    strcpy(header.ticker, "BENCH");
+    strcpy(header.currency, "USD");
+    strcpy(header.country, "US");
+
+    ticks_file_t* handle = NULL;
+    ticks_status_e status = ticks_new_file(path, &header, &handle);
+    if (status != TICKS_OK)
+        bench_fail("ticks_new_file", status);
+
+    for (uint64_t i = 0; i < count; i += batch) {
+        uint64_t n = (count - i < batch) ? count - i : batch;
+        status = ticks_add_data(handle, (trade_data_t*)records + i, n);
+        if (status != TICKS_OK)
+            bench_fail("ticks_add_data", status);
+    }
+
+    status = ticks_close(handle);
+    if (status != TICKS_OK)
+        bench_fail("ticks_close", status);
+}
+
+// --- Harness ---
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int bench_selected(const bench_state_t* state, const char* name) {
+    return state->filter == NULL || strstr(name, state->filter) != NULL;
+}
+
+// Runs fn warmup + samples times and records median/p99/p99.9. work_per_run is the amount of work
+// (bytes, rows, operations) one run performs, throughput is reported per second at the median.
+static void bench_run(bench_state_t* state, const char* name, const char* params, bench_fn fn, void* context,
+                      uint32_t warmup, uint32_t samples, double work_per_run, const char* unit) {
+    if (state->num_results >= BENCH_MAX_RESULTS)
+        return;
+
+    for (uint32_t i = 0; i < warmup; i++)
+        fn(context);
+
+    uint64_t* timings = malloc(samples * sizeof(uint64_t));
+    if (timings == NULL)
+        bench_fail("bench_run", TICKS_ERROR_MEMORY_ALLOCATION);
+
+    for (uint32_t i = 0; i < samples; i++) {
+        uint64_t start = monotonic_ns_portable();
+        fn(context);
+        timings[i] = monotonic_ns_portable() - start;
+    }
+    qsort(timings, samples, sizeof(uint64_t), compare_u64);
+
+    bench_result_t* result = &state->results[state->num_results++];
+    memset(result, 0, sizeof(*result));
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    snprintf(result->params, sizeof(result->params), "%s", params);
+    result->warmup = warmup;
+    result->samples = samples;
+    result->median_ns = (samples % 2) ? (double)timings[samples / 2] : ((double)timings[samples / 2 - 1] + (double)timings[samples / 2]) / 2.0;
+    result->p99_ns = (double)timings[(uint32_t)((samples - 1) * 0.99)];
+    result->p999_ns = (double)timings[(uint32_t)((samples - 1) * 0.999)];
+    result->throughput = result->median_ns > 0 ? work_per_run * 1e9 / result->median_ns : 0;
+    result->unit = unit;
+    free(timings);
+
+    printf("%-28s %-44s median %12.0f ns  p99 %12.0f ns  p99.9 %12.0f ns  %12.2f %s\n",
+           result->name, result->params, result->median_ns, result->p99_ns, result->p999_ns, result->throughput, result->unit);
+    fflush(stdout);
+}
+
+// --- CSV parse ---
+typedef struct {
+    const char* path;
+} csv_context_t;
+
+static void run_csv_parse(void* context) {
+    csv_context_t* ctx = context;
+    csv_read_result_t reader;
+    memset(&reader, 0, sizeof(reader));
+    ticks_status_e status = read_csv(ctx->path, &reader);
+    if (status != TICKS_OK)
+        bench_fail("read_csv", status);
+    csv_reader_cleanup(&reader);
+}
+
+static void bench_csv_parse(bench_state_t* state) {
+    if (!bench_selected(state, "csv_parse"))
+        return;
+
+    const uint64_t rows = state->quick ? 100000 : 1000000;
+    trade_data_t* records = malloc(rows * sizeof(trade_data_t));
+    if (records == NULL)
+        bench_fail("csv_parse", TICKS_ERROR_MEMORY_ALLOCATION);
+    generate_trades(records, rows, BENCH_SEED);
+
+    char path[512];
+    bench_path(state, "bench_input.csv", path, sizeof(path));
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+        bench_fail("fopen (csv)", TICKS_ERROR_FILE_IO);
+    fprintf(file, "timestamp,price,volume\n");
+    for (uint64_t i = 0; i < rows; i++) {
+        time_t seconds = (time_t)(records[i].ms_since_epoch / 1000);
+        struct tm* tm_time = gmtime(&seconds);
+        char timestamp[CSV_MAX_TIMESTAMP_LEN];
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", tm_time);
+        fprintf(file, "%s.%03u,%.2f,%llu\n", timestamp, (unsigned)(records[i].ms_since_epoch % 1000),
+                (double)records[i].price / 100.0, (unsigned long long)records[i].volume);
+    }
+    long file_size = ftell(file);
+    fclose(file);
+    free(records);
+
+    csv_context_t ctx = { .path = path };
+    char params[160];
+    snprintf(params, sizeof(params), "{\"rows\":%llu,\"bytes\":%ld}", (unsigned long long)rows, file_size);
+    bench_run(state, "csv_parse", params, run_csv_parse, &ctx, 1, state->quick ? 3 : 7, (double)file_size / 1e6, "MB/s");
+
+    remove(path);
+}
+
+// --- Encode ---
+typedef struct {
+    ticks_file_t* handle;
+    const trade_data_t* records;
+    uint64_t rows;
+    uint64_t rows_per_call; // Rows per ticks_add_data call, 0 to hand all rows to create_chunks at once
+} encode_context_t;
+
+static void run_encode(void* context) {
+    encode_context_t* ctx = context;
+    if (ctx->rows_per_call == 0) {
+        ticks_status_e status = create_chunks(ctx->handle, (const uint64_t*)ctx->records, ctx->rows);
+        if (status != TICKS_OK)
+            bench_fail("create_chunks", status);
+        return;
+    }
+
+    // A live recorder's batches, checkpoints run between and during these calls
+    for (uint64_t first = 0; first < ctx->rows; first += ctx->rows_per_call) {
+        const uint64_t num_rows = ctx->rows - first < ctx->rows_per_call ? ctx->rows - first : ctx->rows_per_call;
+        ticks_status_e status = ticks_add_data(ctx->handle, (trade_data_t*)&ctx->records[first], num_rows);
+        if (status != TICKS_OK)
+            bench_fail("ticks_add_data", status);
+    }
+}
+
+// Encodes and writes through a handle with the given I/O mode, direct writes bypass the page cache.
+// With durability on, rows arrive in add calls of 10000 as they would from a recorder.
+static void bench_encode_mode(bench_state_t* state, const char* name, ticks_write_io_e io_mode, ticks_durability_e durability) {
+    if (!bench_selected(state, name))
+        return;
+
+    const uint64_t rows = state->quick ? 200000 : 2000000;
+    trade_data_t* records = malloc(rows * sizeof(trade_data_t));
+    if (records == NULL)
+        bench_fail("encode", TICKS_ERROR_MEMORY_ALLOCATION);
+    generate_trades(records, rows, BENCH_SEED);
+
+    char path[512];
+    bench_path(state, "bench_encode.ticks", path, sizeof(path));
+    ticks_header_t header;
+    memset(&header, 0, sizeof(header));
+    strcpy(header.ticker, "BENCH");
+
+    encode_context_t ctx = { .records = records, .rows = rows, .rows_per_call = durability != TICKS_DURABILITY_NONE ? 10000 : 0 };
+    ticks_status_e status = ticks_new_file(path, &header, &ctx.handle);
+    if (status != TICKS_OK)
+        bench_fail("ticks_new_file", status);
+
+    ticks_write_options_t write_options;
+    memset(&write_options, 0, sizeof(write_options));
+    write_options.io_mode = io_mode;
+    write_options.durability = durability;
+    status = ticks_set_write_options(ctx.handle, &write_options);
+    if (status != TICKS_OK)
+        bench_fail("ticks_set_write_options", status);
+
+    char params[160];
+    snprintf(params, sizeof(params), "{\"rows\":%llu}", (unsigned long long)rows);
+    bench_run(state, name, params, run_encode, &ctx, 1, state->quick ? 3 : 9, (double)rows, "rows/s");
+
+    status = ticks_close(ctx.handle);
+    if (status != TICKS_OK)
+        bench_fail("ticks_close", status);
+    remove(path);
+    free(records);
+}
+
+static void bench_encode(bench_state_t* state) {
+    bench_encode_mode(state, "encode", TICKS_WRITE_BUFFERED, TICKS_DURABILITY_NONE);
+    bench_encode_mode(state, "encode_direct", TICKS_WRITE_DIRECT, TICKS_DURABILITY_NONE);
+    bench_encode_mode(state, "encode_group_commit", TICKS_WRITE_BUFFERED, TICKS_DURABILITY_GROUP);
+    bench_encode_mode(state, "encode_strict", TICKS_WRITE_BUFFERED, TICKS_DURABILITY_STRICT);
+}
+
+// --- Ingest latency per tick, inline versus through an async writer ---
+typedef struct {
+    ticks_file_t* handle;
+    ticks_async_writer_t* writer;
+    const trade_data_t* records;
+    uint64_t next;
+} ingest_context_t;
+
+static void run_ingest_inline(void* context) {
+    ingest_context_t* ctx = context;
+    ticks_status_e status = ticks_add_data(ctx->handle, (trade_data_t*)&ctx->records[ctx->next++], 1);
+    if (status != TICKS_OK)
+        bench_fail("ticks_add_data", status);
+}
+
+static void run_ingest_async(void* context) {
+    ingest_context_t* ctx = context;
+    ticks_status_e status = ticks_async_push(ctx->writer, (const uint64_t*)&ctx->records[ctx->next++], 1);
+    if (status != TICKS_OK)
+        bench_fail("ticks_async_push", status);
+}
+
+// Times each tick a feed thread hands over, one sample per tick, so p99.9 shows the chunks encoded and written inline.
+// Both run with group commit as a live recorder would.
+static void bench_ingest_mode(bench_state_t* state, const char* name, int async) {
+    if (!bench_selected(state, name))
+        return;
+
+    const uint64_t rows = state->quick ? 200000 : 2000000;
+    trade_data_t* records = malloc(rows * sizeof(trade_data_t));
+    if (records == NULL)
+        bench_fail("ingest", TICKS_ERROR_MEMORY_ALLOCATION);
+    generate_trades(records, rows, BENCH_SEED);
+
+    char path[512];
+    bench_path(state, "bench_ingest.ticks", path, sizeof(path));
+    ticks_header_t header;
+    memset(&header, 0, sizeof(header));
+    strcpy(header.ticker, "BENCH");
+
+    ingest_context_t ctx = { .records = records };
+    ticks_status_e status = ticks_new_file(path, &header, &ctx.handle);
+    if (status != TICKS_OK)
+        bench_fail("ticks_new_file", status);
+
+    ticks_write_options_t write_options;
+    memset(&write_options, 0, sizeof(write_options));
+    write_options.durability = TICKS_DURABILITY_GROUP;
+    status = ticks_set_write_options(ctx.handle, &write_options);
+    if (status != TICKS_OK)
+        bench_fail("ticks_set_write_options", status);
+
+    if (async) {
+        status = ticks_async_writer_create(ctx.handle, NULL, &ctx.writer);
+        if (status != TICKS_OK)
+            bench_fail("ticks_async_writer_create", status);
+    }
+
+    char params[160];
+    snprintf(params, sizeof(params), "{\"rows\":%llu}", (unsigned long long)rows);
+    bench_run(state, name, params, async ? run_ingest_async : run_ingest_inline, &ctx, 0, (uint32_t)rows, 1.0, "ticks/s");
+
+    if (async) {
+        status = ticks_async_writer_destroy(ctx.writer);
+        if (status != TICKS_OK)
+            bench_fail("ticks_async_writer_destroy", status);
+    }
+    status = ticks_close(ctx.handle);
+    if (status != TICKS_OK)
+        bench_fail("ticks_close", status);
+    remove(path);
+    free(records);
+}
+
+static void bench_ingest(bench_state_t* state) {
+    bench_ingest_mode(state, "ingest_inline", 0);
+    bench_ingest_mode(state, "ingest_async", 1);
+}
+
+// --- Decode per width combination ---
+typedef struct {
+    const ticks_index_entry_t* entry;
+    const uint8_t* data;
+    trade_data_t* out;
+} decode_context_t;
+
+static void run_decode(void* context) {
+    decode_context_t* ctx = context;
+    uint32_t num_records = 0;
+    ticks_status_e status = decode_chunk(ctx->entry, 3, 0x7, ctx->data, (uint64_t*)ctx->out, &num_records, NULL);
+    if (status != TICKS_OK)
+        bench_fail("decode_chunk", status);
+}
+
+static void bench_decode(bench_state_t* state) {
+    if (!bench_selected(state, "decode"))
+        return;
+
+    static const size_e sizes[] = { SIZE_8BIT, SIZE_16BIT, SIZE_32BIT, SIZE_64BIT };
+    const uint64_t rows = 65536;
+    trade_data_t* records = malloc(rows * sizeof(trade_data_t));
+    trade_data_t* decoded = malloc(rows * sizeof(trade_data_t));
+    if (records == NULL || decoded == NULL)
+        bench_fail("decode", TICKS_ERROR_MEMORY_ALLOCATION);
+
+    char path[512];
+    bench_path(state, "bench_decode.ticks", path, sizeof(path));
+
+    for (int t = 0; t < 4; t++) {
+        for (int p = 0; p < 4; p++) {
+            for (int v = 0; v < 4; v++) {
+                generate_trades_with_sizes(records, rows, sizes[t], sizes[p], sizes[v], BENCH_SEED);
+                write_ticks_file(path, records, rows, rows);
+
+                ticks_file_t* handle = NULL;
+                ticks_status_e status = ticks_open_read(path, &handle);
+                if (status != TICKS_OK)
+                    bench_fail("ticks_open_read", status);
+
+                uint8_t* buffer = NULL;
+                size_t capacity = 0;
+                status = read_chunk(handle, 0, 0x7, &buffer, &capacity);
+                if (status != TICKS_OK)
+                    bench_fail("read_chunk", status);
+
+                const ticks_index_entry_t* entry = &handle->index.entries[0];
+                decode_context_t ctx = { .entry = entry, .data = buffer, .out = decoded };
+                char params[160];
+                snprintf(params, sizeof(params), "{\"widths\":\"%u/%u/%u\",\"rows\":%u,\"encoded_bytes\":%u}",
+                         entry->columns[0].width, entry->columns[1].width, entry->columns[2].width,
+                         entry->num_records, entry->chunk_size);
+
+                // Throughput is reported in decoded bytes so combinations are comparable
+                double decoded_gb = (double)entry->num_records * sizeof(trade_data_t) / 1e9;
+                bench_run(state, "decode", params, run_decode, &ctx, 3, state->quick ? 5 : 21, decoded_gb, "GB/s");
+
+                free(buffer);
+                ticks_close(handle);
+            }
+        }
+    }
+
+    remove(path);
+    free(records);
+    free(decoded);
+}
+
+// --- Iterator scan and seek ---
+typedef struct {
+    ticks_file_t* handle;
+    trade_data_t batch[4096];
+    uint64_t projected_batch[4096 * 2];
+    uint64_t rows_seen;
+    uint64_t notional;    // Sum of price * volume, so the kernel benchmarks touch every value
+    time_t from;
+    time_t to;
+    uint64_t rng;
+    ticks_iterator_options_t options;
+    uint64_t* asof_queries;   // One timestamp per second of the file, for mark-to-market lookups
+    uint64_t num_asof_queries;
+    trade_data_t* asof_records;
+    uint8_t* asof_found;
+} scan_context_t;
+
+static void run_scan(void* context) {
+    scan_context_t* ctx = context;
+    ticks_iterator_t* iterator = NULL;
+    ticks_status_e status = ticks_iterator_create_ex(ctx->handle, ctx->from, ctx->to, &ctx->options, &iterator);
+    if (status != TICKS_OK)
+        bench_fail("ticks_iterator_create_ex", status);
+
+    uint32_t count = 0;
+    ctx->rows_seen = 0;
+    while ((status = ticks_iterator_next_batch(iterator, ctx->batch, 4096, &count)) == TICKS_OK)
+        ctx->rows_seen += count;
+    if (status != TICKS_EOF)
+        bench_fail("ticks_iterator_next_batch", status);
+
+    ticks_iterator_destroy(iterator);
+}
+
+static void run_scan_projected(void* context) {
+    scan_context_t* ctx = context;
+    ticks_iterator_t* iterator = NULL;
+    ticks_status_e status = ticks_iterator_create_ex(ctx->handle, ctx->from, ctx->to, &ctx->options, &iterator);
+    if (status != TICKS_OK)
+        bench_fail("ticks_iterator_create_ex", status);
+
+    uint32_t count = 0;
+    ctx->rows_seen = 0;
+    while ((status = ticks_iterator_next_records(iterator, ctx->projected_batch, 4096, &count)) == TICKS_OK)
+        ctx->rows_seen += count;
+    if (status != TICKS_EOF)
+        bench_fail("ticks_iterator_next_records", status);
+
+    ticks_iterator_destroy(iterator);
+}
+
+// Pull-based kernel: decode a chunk into the iterator's rows, copy batches out, then loop over them
+static void run_scan_kernel(void* context) {
+    scan_context_t* ctx = context;
+    ticks_iterator_t* iterator = NULL;
+    ticks_status_e status = ticks_iterator_create(ctx->handle, ctx->from, ctx->to, &iterator);
+    if (status != TICKS_OK)
+        bench_fail("ticks_iterator_create", status);
+
+    uint32_t count = 0;
+    ctx->rows_seen = 0;
+    ctx->notional = 0;
+    while ((status = ticks_iterator_next_batch(iterator, ctx->batch, 4096, &count)) == TICKS_OK) {
+        for (uint32_t i = 0; i < count; i++)
+            ctx->notional += ctx->batch[i].price * ctx->batch[i].volume;
+        ctx->rows_seen += count;
+    }
+    if (status != TICKS_EOF)
+        bench_fail("ticks_iterator_next_batch", status);
+
+    ticks_iterator_destroy(iterator);
+}
+
+static ticks_status_e notional_callback(const uint64_t* rows, uint32_t num_rows, void* user) {
+    scan_context_t* ctx = user;
+    const trade_data_t* records = (const trade_data_t*)rows;
+    for (uint32_t i = 0; i < num_rows; i++)
+        ctx->notional += records[i].price * records[i].volume;
+    ctx->rows_seen += num_rows;
+    return TICKS_OK;
+}
+
+// Push-based kernel: the same loop runs on each batch while it is still in cache
+static void run_scan_callback(void* context) {
+    scan_context_t* ctx = context;
+    ctx->rows_seen = 0;
+    ctx->notional = 0;
+    ticks_status_e status = ticks_scan(ctx->handle, ctx->from, ctx->to, notional_callback, ctx);
+    if (status != TICKS_OK)
+        bench_fail("ticks_scan", status);
+}
+
+static ticks_status_e count_callback(const uint64_t* rows, uint32_t num_rows, void* user) {
+    (void)rows;
+    scan_context_t* ctx = user;
+    ctx->rows_seen += num_rows;
+    return TICKS_OK;
+}
+
+// Block trades: the volume predicate is evaluated on the stored column and most batches are never decoded
+static void run_scan_filtered(void* context) {
+    scan_context_t* ctx = context;
+    const ticks_predicate_t block_trades = {2, 990, UINT64_MAX};
+    ticks_iterator_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.predicates = &block_trades;
+    options.num_predicates = 1;
+
+    ctx->rows_seen = 0;
+    ticks_status_e status = ticks_scan_ex(ctx->handle, ctx->from, ctx->to, &options, count_callback, ctx);
+    if (status != TICKS_OK)
+        bench_fail("ticks_scan_ex", status);
+}
+
+static void run_aggregate(void* context) {
+    scan_context_t* ctx = context;
+    ticks_aggregate_t aggregate;
+    ticks_status_e status = ticks_aggregate(ctx->handle, ctx->from, ctx->to, 2, &aggregate);
+    if (status != TICKS_OK)
+        bench_fail("ticks_aggregate", status);
+    ctx->rows_seen = aggregate.count;
+}
+
+static void run_seek(void* context) {
+    scan_context_t* ctx = context;
+    time_t target = ctx->from + (time_t)(bench_rand(&ctx->rng) % (uint64_t)(ctx->to - ctx->from - 1));
+
+    ticks_iterator_t* iterator = NULL;
+    ticks_status_e status = ticks_iterator_create(ctx->handle, target, target + 1, &iterator);
+    if (status != TICKS_OK)
+        bench_fail("ticks_iterator_create", status);
+
+    status = ticks_iterator_next(iterator, &ctx->batch[0]);
+    if (status != TICKS_OK && status != TICKS_EOF)
+        bench_fail("ticks_iterator_next", status);
+
+    ticks_iterator_destroy(iterator);
+}
+
+// Last trade at or before every second of the file in one batched call
+static void run_asof(void* context) {
+    scan_context_t* ctx = context;
+    ticks_status_e status = ticks_asof(ctx->handle, ctx->asof_queries, ctx->num_asof_queries, ctx->asof_records, ctx->asof_found);
+    if (status != TICKS_OK)
+        bench_fail("ticks_asof", status);
+}
+
+static void bench_scan_and_seek(bench_state_t* state) {
+    if (!bench_selected(state, "scan") && !bench_selected(state, "seek") && !bench_selected(state, "aggregate") &&
+        !bench_selected(state, "asof"))
+        return;
+
+    const uint64_t rows = state->quick ? 500000 : 5000000;
+    trade_data_t* records = malloc(rows * sizeof(trade_data_t));
+    if (records == NULL)
+        bench_fail("scan", TICKS_ERROR_MEMORY_ALLOCATION);
+    generate_trades(records, rows, BENCH_SEED);
+
+    char path[512];
+    bench_path(state, "bench_scan.ticks", path, sizeof(path));
+    write_ticks_file(path, records, rows, 100000);
+
+    scan_context_t* ctx = malloc(sizeof(scan_context_t));
+    if (ctx == NULL)
+        bench_fail("scan", TICKS_ERROR_MEMORY_ALLOCATION);
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->from = (time_t)(records[0].ms_since_epoch / 1000);
+    ctx->to = (time_t)(records[rows - 1].ms_since_epoch / 1000) + 1;
+    ctx->rng = BENCH_SEED;
+
+    ticks_status_e status = ticks_open_read(path, &ctx->handle);
+    if (status != TICKS_OK)
+        bench_fail("ticks_open_read", status);
+
+    char params[160];
+    snprintf(params, sizeof(params), "{\"rows\":%llu,\"chunks\":%u}", (unsigned long long)rows, ctx->handle->index.num_entries);
+    if (bench_selected(state, "scan")) {
+        bench_run(state, "scan", params, run_scan, ctx, 1, state->quick ? 3 : 9, (double)rows, "rows/s");
+
+        // Timestamps and prices only, the volume column is never read
+        ctx->options.column_mask = 0x3;
+        bench_run(state, "scan_projected", params, run_scan_projected, ctx, 1, state->quick ? 3 : 9, (double)rows, "rows/s");
+        ctx->options.column_mask = 0;
+
+        bench_run(state, "scan_kernel", params, run_scan_kernel, ctx, 1, state->quick ? 3 : 9, (double)rows, "rows/s");
+        bench_run(state, "scan_callback", params, run_scan_callback, ctx, 1, state->quick ? 3 : 9, (double)rows, "rows/s");
+        bench_run(state, "scan_filtered", params, run_scan_filtered, ctx, 1, state->quick ? 3 : 9, (double)rows, "rows/s");
+    }
+    if (bench_selected(state, "aggregate"))
+        bench_run(state, "aggregate", params, run_aggregate, ctx, 1, state->quick ? 3 : 9, (double)rows, "rows/s");
+    if (bench_selected(state, "seek"))
+        bench_run(state, "seek", params, run_seek, ctx, 10, state->quick ? 101 : 1001, 1.0, "seeks/s");
+    if (bench_selected(state, "asof")) {
+        ctx->num_asof_queries = (uint64_t)(ctx->to - ctx->from);
+        ctx->asof_queries = malloc(ctx->num_asof_queries * sizeof(uint64_t));
+        ctx->asof_records = malloc(ctx->num_asof_queries * sizeof(trade_data_t));
+        ctx->asof_found = malloc(ctx->num_asof_queries);
+        if (ctx->asof_queries == NULL || ctx->asof_records == NULL || ctx->asof_found == NULL)
+            bench_fail("asof", TICKS_ERROR_MEMORY_ALLOCATION);
+        for (uint64_t i = 0; i < ctx->num_asof_queries; i++)
+            ctx->asof_queries[i] = ((uint64_t)ctx->from + i) * 1000 + 999;
+
+        char asof_params[160];
+        snprintf(asof_params, sizeof(asof_params), "{\"rows\":%llu,\"chunks\":%u,\"queries\":%llu}", (unsigned long long)rows,
+                 ctx->handle->index.num_entries, (unsigned long long)ctx->num_asof_queries);
+        bench_run(state, "asof", asof_params, run_asof, ctx, 1, state->quick ? 3 : 9, (double)ctx->num_asof_queries, "queries/s");
+        free(ctx->asof_queries);
+        free(ctx->asof_records);
+        free(ctx->asof_found);
+    }
+
+    ticks_close(ctx->handle);
+    free(ctx);
+    remove(path);
+    free(records);
+}
+
+// --- Open latency vs chunk count ---
+typedef struct {
+    const char* path;
+    ticks_open_options_t options;
+} open_context_t;
+
+static void run_open(void* context) {
+    open_context_t* ctx = context;
+    ticks_file_t* handle = NULL;
+    ticks_status_e status = ticks_open_read_ex(ctx->path, &ctx->options, &handle);
+    if (status != TICKS_OK)
+        bench_fail("ticks_open_read_ex", status);
+    ticks_close(handle);
+}
+
+static void bench_open(bench_state_t* state) {
+    if (!bench_selected(state, "open"))
+        return;
+
+    static const uint64_t chunk_counts[] = { 1000, 10000, 100000 };
+    const int num_counts = state->quick ? 2 : 3;
+    const uint64_t rows_per_chunk = 4;
+
+    char path[512];
+    bench_path(state, "bench_open.ticks", path, sizeof(path));
+
+    for (int c = 0; c < num_counts; c++) {
+        const uint64_t rows = chunk_counts[c] * rows_per_chunk;
+        trade_data_t* records = malloc(rows * sizeof(trade_data_t));
+        if (records == NULL)
+            bench_fail("open", TICKS_ERROR_MEMORY_ALLOCATION);
+        generate_trades(records, rows, BENCH_SEED);
+        write_ticks_file(path, records, rows, rows_per_chunk);
+        free(records);
+
+        for (int mode = 0; mode < 2; mode++) {
+            open_context_t ctx = { .path = path };
+            ctx.options.index_mode = mode == 0 ? TICKS_INDEX_LOAD : TICKS_INDEX_MMAP;
+
+            char params[160];
+            snprintf(params, sizeof(params), "{\"chunks\":%llu,\"index_mode\":\"%s\"}",
+                     (unsigned long long)chunk_counts[c], mode == 0 ? "load" : "mmap");
+            bench_run(state, "open", params, run_open, &ctx, 3, state->quick ? 11 : 51, 1.0, "opens/s");
+        }
+    }
+
+    remove(path);
+}
+
+// --- Output ---
+static void write_json(const bench_state_t* state) {
+    FILE* file = fopen(state->json_path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Failed to open %s for writing\n", state->json_path);
+        return;
+    }
+
+    fprintf(file, "{\n  \"suite\": \"ticksio_bench\",\n  \"format_version\": %d,\n  \"quick\": %s,\n  \"results\": [\n",
+            TICKS_FORMAT_VERSION, state->quick ? "true" : "false");
+    for (uint32_t i = 0; i < state->num_results; i++) {
+        const bench_result_t* r = &state->results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"params\": %s, \"warmup\": %u, \"samples\": %u, "
+                      "\"median_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f, \"throughput\": %.3f, \"unit\": \"%s\"}%s\n",
+                r->name, r->params, r->warmup, r->samples, r->median_ns, r->p99_ns, r->p999_ns, r->throughput, r->unit,
+                i + 1 < state->num_results ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+}
+
+int main(int argc, char** argv) {
+    static bench_state_t state;
+    state.dir = ".";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            state.quick = 1;
+        } else if (strcmp(argv[i], "--hugepages") == 0) {
+            ticks_allocator_t allocator;
+            ticks_allocator_hugepage(&allocator);
+            ticks_set_allocator(NULL, &allocator);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            state.filter = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            state.json_path = argv[++i];
+        } else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            state.dir = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--quick] [--hugepages] [--filter <substring>] [--json <path>] [--dir <path>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    bench_csv_parse(&state);
+    bench_encode(&state);
+    bench_ingest(&state);
+    bench_decode(&state);
+    bench_scan_and_seek(&state);
+    bench_open(&state);
+
+    if (state.json_path != NULL)
+        write_json(&state);
+
+    return EXIT_SUCCESS;
+}
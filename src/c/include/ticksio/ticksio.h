@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <time.h>
 
 #include "ticksio/ticksio_types.h"
 
@@ -17,8 +18,26 @@ extern "C" {
  * @return Status code indicating success or failure (0 = OK).
  */
 ticks_status_e ticks_open_read(const char* filename, ticks_file_t** out_handle);
+/**
+ * @brief Opens an existing ticks file in read mode with explicit options.
+ * With TICKS_INDEX_MMAP the index is mapped instead of being read and only the sparse index is decoded on open,
+ * so opening costs the same regardless of how many chunks the file holds. Each block of entries is decoded the
+ * first time a lookup reaches it. Falls back to reading the index if mapping fails.
+ * verify_mode selects when chunk checksums are checked, a mapped index is only verified with TICKS_VERIFY_ALWAYS.
+ * A file whose end holds no valid footer, e.g. after a crash while writing, is opened at its last complete footer.
+ * With follow set, a file holding no complete footer yet opens without chunks instead of failing, see ticks_refresh.
+ * This includes a file whose header is not complete yet, its header reads as zeroed until a refresh finds it.
+ * @param filename The name of the file to open.
+ * @param options Open options, NULL for the defaults.
+ * @param out_handle Pointer to store the resulting handle.
+ * @return Status code indicating success or failure (0 = OK).
+ */
+ticks_status_e ticks_open_read_ex(const char* filename, const ticks_open_options_t* options, ticks_file_t** out_handle);
 /**
  * @brief Opens an existing ticks file in write mode, validates the magic, and returns the handle.
+ * New chunks are appended after the existing footer, which stays valid until the index written on close replaces it,
+ * and the file is flagged as checkpointed so readers can fall back to it if the writer dies first. Every reopen leaves
+ * the previous index behind as unreferenced bytes, ticks_compact drops them.
  * @param filename The name of the file to open.
  * @param out_handle Pointer to store the resulting handle.
  * @return Status code indicating success or failure (0 = OK).
@@ -26,6 +45,9 @@ ticks_status_e ticks_open_read(const char* filename, ticks_file_t** out_handle);
 ticks_status_e ticks_open_write(const char* filename, ticks_file_t** out_handle);
 /**
  * @brief Creates a new ticks file, writes the header, and returns the handle.
+ * header->chunk_policy decides where chunks end and is recorded in the file, so later appends use it too.
+ * A zero-initialised policy selects chunks of up to TICKS_DEFAULT_CHUNK_BYTES with no row or time limit.
+ * header->schema describes the record columns; with num_columns == 0 the file stores trades.
  * @param filename The name of the file to create.
  * @param header The header structure containing initial settings.
  * @param out_handle Pointer to store the resulting handle.
@@ -35,6 +57,7 @@ ticks_status_e ticks_new_file(const char* filename, ticks_header_t* header, tick
 
 /**
  * @brief Closes the file stream and frees the opaque handle's memory.
+ * For handles in write mode the index and footer are written before closing.
  * @param handle The file stream handle to close.
  * @return Status code indicating success or failure (0 = OK).
  */
@@ -63,8 +86,18 @@ ticks_status_e ticks_get_index_offset(ticks_file_t* handle, uint64_t* out_offset
 */
 ticks_status_e ticks_get_index_size(ticks_file_t* handle, uint64_t* out_size);
 
+/**
+ * @brief Retrieves the runtime metrics of the handle, summed over all threads that used it.
+ * Counters are cumulative since the handle was opened and cheap enough to stay enabled.
+ * @param handle The file stream handle.
+ * @param out_metrics Pointer to store the result.
+ * @return Status code indicating success or failure (0 = OK).
+ */
+ticks_status_e ticks_get_metrics(ticks_file_t* handle, ticks_metrics_t* out_metrics);
+
 /**
  * @brief Adds trade data entries to the ticks file, creating chunks as needed.
+ * Chunks are written sequentially, the index is written once when the handle is closed.
  * @param handle The file stream handle.
  * @param data Pointer to the array of trade_data_t entries to add.
  * @param num_entries Number of entries in the data array.
@@ -72,6 +105,51 @@ ticks_status_e ticks_get_index_size(ticks_file_t* handle, uint64_t* out_size);
  */
 ticks_status_e ticks_add_data(ticks_file_t* handle, trade_data_t* data, uint64_t num_entries);
 
+/**
+ * @brief Adds records of any schema to the ticks file, creating chunks as needed.
+ * Records are row-major: num_columns values per record, in the order of the header schema's columns.
+ * ticks_add_data is the same call for files using the trade layout.
+ * @param handle The file stream handle.
+ * @param rows Pointer to num_rows * num_columns values.
+ * @param num_rows Number of records.
+ * @return Status code indicating success or failure (0 = OK).
+ */
+ticks_status_e ticks_add_records(ticks_file_t* handle, const uint64_t* rows, uint64_t num_rows);
+
+/**
+ * @brief Fills in one of the built-in schemas.
+ * TICKS_SCHEMA_TRADES matches trade_data_t and TICKS_SCHEMA_QUOTES matches quote_data_t.
+ * @param kind The built-in schema to use.
+ * @param out_schema Pointer to store the schema.
+ * @return Status code indicating success or failure (0 = OK).
+ */
+ticks_status_e ticks_schema_builtin(ticks_schema_kind_e kind, ticks_schema_t* out_schema);
+
+/**
+ * @brief Converts the values of a decimal column to doubles.
+ * Decimal columns hold value * 10^scale as an integer, the scale is the column's scale in the header schema.
+ * @param values Pointer to the first value, e.g. a column of the rows returned by ticks_iterator_next_records.
+ * @param stride Distance between consecutive values, the number of columns for row-major records.
+ * @param num_values Number of values to convert.
+ * @param scale Decimal places of the column.
+ * @param out_values Pointer to num_values doubles.
+ * @return Status code indicating success or failure (0 = OK).
+ */
+ticks_status_e ticks_decimal_to_double(const uint64_t* values, uint32_t stride, uint64_t num_values, uint8_t scale,
+                                       double* out_values);
+
+/**
+ * @brief Sets the reorder window of a write handle so slightly out-of-order ticks are written sorted.
+ * Ticks are held back until they leave the window, and are written by later ticks_add_data calls or on close.
+ * Ticks older than one already written, including the chunks written before the window was set, arrived beyond
+ * the window; they are dropped and counted in the late_ticks metric, so chunks stay in time order for lookups.
+ * Ticks held under a previous window are written first.
+ * @param handle The file stream handle (write mode).
+ * @param options Window settings, all zero to disable reordering (the default).
+ * @return Status code indicating success or failure (0 = OK).
+ */
+ticks_status_e ticks_set_reorder_window(ticks_file_t* handle, const ticks_reorder_options_t* options);
+
 /**
  * @brief Converts a ticks_status_e code to a human-readable string.
  * @param status The status code to convert.
@@ -81,6 +159,8 @@ const char* ticks_status_to_string(ticks_status_e status);
 
 /*
 * @brief Creates an iterator for traversing records within a specified time range
+* Iterators on a read handle may run concurrently on different threads without locking, chunks are read
+* with positional I/O and the index is immutable after open. A write handle must not be used concurrently.
 * @param handle Pointer to the ticks file handle
 * @param from Start time (inclusive)
 * @param to End time (exclusive)
@@ -89,6 +169,50 @@ const char* ticks_status_to_string(ticks_status_e status);
 */
 ticks_status_e ticks_iterator_create(ticks_file_t* handle, time_t from, time_t to, ticks_iterator_t** out_iterator);
 
+/*
+* @brief Creates an iterator with explicit options
+* With a column mask only the selected columns are read from disk, verified and decoded. ticks_iterator_next_records
+* then returns rows of just those columns in schema order, ticks_iterator_next_batch leaves the other fields zero.
+* @param handle Pointer to the ticks file handle
+* @param from Start time (inclusive)
+* @param to End time (exclusive)
+* @param options Iterator options, NULL for the defaults
+* @param out_iterator Pointer to store the resulting iterator
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_iterator_create_ex(ticks_file_t* handle, time_t from, time_t to, const ticks_iterator_options_t* options,
+                                        ticks_iterator_t** out_iterator);
+
+/*
+* @brief Reads the next record in the iterator's time range
+* Chunk checksums are verified according to the handle's verify mode
+* @param iterator Pointer to the iterator
+* @param out_record Pointer to store the record
+* @return TICKS_OK if a record was read, TICKS_EOF when the range is exhausted, or an error code
+*/
+ticks_status_e ticks_iterator_next(ticks_iterator_t* iterator, trade_data_t* out_record);
+
+/*
+* @brief Reads up to max_records records in the iterator's time range
+* @param iterator Pointer to the iterator
+* @param out_records Array to store the records
+* @param max_records Capacity of out_records
+* @param out_num_records Pointer to store the number of records read
+* @return TICKS_OK if at least one record was read, TICKS_EOF when the range is exhausted, or an error code
+*/
+ticks_status_e ticks_iterator_next_batch(ticks_iterator_t* iterator, trade_data_t* out_records, uint32_t max_records, uint32_t* out_num_records);
+
+/*
+* @brief Reads up to max_rows records of any schema in the iterator's time range
+* Records are written row-major, one value per projected column (all columns by default) in schema order
+* @param iterator Pointer to the iterator
+* @param out_rows Array of at least max_rows * projected column count values
+* @param max_rows Capacity of out_rows in records
+* @param out_num_rows Pointer to store the number of records read
+* @return TICKS_OK if at least one record was read, TICKS_EOF when the range is exhausted, or an error code
+*/
+ticks_status_e ticks_iterator_next_records(ticks_iterator_t* iterator, uint64_t* out_rows, uint32_t max_rows, uint32_t* out_num_rows);
+
 /*
 * @brief Destroys the iterator and frees associated resources
 * @param iterator Pointer to the iterator to destroy
@@ -96,5 +220,352 @@ ticks_status_e ticks_iterator_create(ticks_file_t* handle, time_t from, time_t t
 */
 ticks_status_e ticks_iterator_destroy(ticks_iterator_t* iterator);
 
+/*
+* @brief Passes the records in a time range to a callback, in batches decoded just before each call
+* Each chunk is decoded TICKS_SCAN_BATCH_ROWS records at a time into a buffer reused for the whole scan, so the
+* callback works on rows that are still in cache. The rows are only valid during the call.
+* @param handle The file stream handle
+* @param from Start of the time range (inclusive)
+* @param to End of the time range (exclusive)
+* @param callback Called with each non-empty batch of row-major records in the header schema's layout
+* @param user Passed to the callback
+* @return Error code (OK = 0), or the first status other than TICKS_OK returned by the callback
+*/
+ticks_status_e ticks_scan(ticks_file_t* handle, time_t from, time_t to, ticks_batch_cb callback, void* user);
+
+/*
+* @brief Passes the records in a time range to a callback with explicit options
+* With a column mask each row holds only the projected columns, in schema order.
+* @param handle The file stream handle
+* @param from Start of the time range (inclusive)
+* @param to End of the time range (exclusive)
+* @param options Options, or NULL for the defaults
+* @param callback Called with each non-empty batch of row-major records
+* @param user Passed to the callback
+* @return Error code (OK = 0), or the first status other than TICKS_OK returned by the callback
+*/
+ticks_status_e ticks_scan_ex(ticks_file_t* handle, time_t from, time_t to, const ticks_iterator_options_t* options,
+                             ticks_batch_cb callback, void* user);
+
+/*
+* @brief Counts the records in a time range and sums one of their columns
+* Chunks wholly inside the range are aggregated on their stored columns without decoding them into records:
+* run-length columns once per run and dictionary columns once per dictionary value. Only the chunks at the ends
+* of the range are decoded, and only their timestamp and the aggregated column are read.
+* @param handle Pointer to the ticks file handle
+* @param from Start time (inclusive)
+* @param to End time (exclusive)
+* @param column Schema column to sum, e.g. 2 for the volume of trades
+* @param out_aggregate Pointer to store the count and sum
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_aggregate(ticks_file_t* handle, time_t from, time_t to, uint32_t column, ticks_aggregate_t* out_aggregate);
+
+/*
+* @brief Finds the last trade at or before each of a sorted array of timestamps
+* The queries are merged with the index in one forward pass: the chunk answering each query is found by galloping
+* forward from the previous query's chunk, and each chunk holding an answer is read and decoded once (shared through
+* the decoded chunk cache when it is enabled). Of trades with equal timestamps, the one written last is returned.
+* Relies on chunks being ordered by time base; records within a chunk may be out of order, and earlier chunks
+* holding ticks after a later chunk's time base, e.g. appended out of order, are consulted for the queries they answer.
+* @param handle Pointer to the ticks file handle, its schema must have the trade layout
+* @param query_ts Timestamps in milliseconds since epoch, in non-decreasing order
+* @param num_queries Number of timestamps
+* @param out_records Array receiving the trade answering each query, zeroed when there is none
+* @param out_found Array receiving 1 for each query with a trade at or before it, 0 otherwise
+* @return Status code indicating success or failure (0 = OK), TICKS_ERROR_INVALID_ARGUMENTS for unsorted queries
+*/
+ticks_status_e ticks_asof(ticks_file_t* handle, const uint64_t* query_ts, uint64_t num_queries, trade_data_t* out_records,
+                          uint8_t* out_found);
+
+/*
+* @brief Rewrites a ticks file with its rows re-chunked under a chunk policy
+* Source chunks are read and decoded in ranges of range_rows, re-encoded with the narrowest widths under
+* the policy in parallel and appended to dst in order with a fresh index. Memory use is bounded by
+* num_threads ranges. Each range boundary also ends a chunk unless it falls on a max_chunk_rows boundary.
+* dst is overwritten, and removed again if compaction fails.
+* @param src_filename Path of the file to compact
+* @param dst_filename Path of the compacted file, must not name the same file as src_filename
+* @param policy Compaction policy, NULL for the defaults
+* @return Status code indicating success or failure (0 = OK), TICKS_ERROR_INVALID_ARGUMENTS when both name one file
+*/
+ticks_status_e ticks_compact(const char* src_filename, const char* dst_filename, const ticks_compact_policy_t* policy);
+
+/*
+* @brief Sets the memory budget of the process-wide decoded chunk cache
+* Iterators on any handle and thread share decoded chunks through the cache, keyed by file
+* identity and chunk offset. Least recently used chunks are evicted once the budget is exceeded;
+* chunks in use by an iterator are never evicted. A budget of 0 (the default) disables the cache.
+* @param max_bytes Budget in bytes
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_cache_set_budget(uint64_t max_bytes);
+
+/*
+* @brief Retrieves the decoded chunk cache statistics
+* @param out_stats Pointer to store the result
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_cache_get_stats(ticks_cache_stats_t* out_stats);
+
+/*
+* @brief Sets how a write handle writes chunks
+* With TICKS_WRITE_DIRECT, chunks are staged in two aligned buffers and written with O_DIRECT by a background
+* thread while the next buffer fills, so bulk loads do not push other readers' data out of the page cache. Each
+* chunk is padded to TICKS_DIRECT_ALIGNMENT and the padding is recorded in its index entry. Where the platform or
+* filesystem refuses O_DIRECT, chunks are written buffered as before. Staged chunks are written out on close, when
+* the options change and before a chunk is read back through the handle.
+* durability selects when appended chunks are made durable through checkpoints: the chunks are synced, then an
+* index of the chunks added since the last checkpoint and a footer pointing back to it are written after them and
+* synced. TICKS_DURABILITY_GROUP checkpoints from a background
+* thread every group_commit_chunks chunks or group_commit_ms milliseconds, TICKS_DURABILITY_STRICT before each add
+* call returns. Ticks held by a reorder window are not durable until they leave it. After a crash, opening the file
+* finds the last complete checkpoint. Both modes also sync the final index on close.
+* @param handle Pointer to the ticks file handle (write mode)
+* @param options Write options
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_set_write_options(ticks_file_t* handle, const ticks_write_options_t* options);
+
+/*
+* @brief Picks up chunks a writer checkpointed since the handle's index was read
+* The file size acts as a generation counter: while it is unchanged this returns at once. Otherwise the bytes
+* appended since the last refresh are searched backwards for the newest footer whose footer and index checksums
+* hold. A checkpoint still being written fails them and is found by a later refresh, so the handle only ever moves
+* from one complete index to the next. Only the index blocks holding new entries are decoded.
+* Writers publish chunks through checkpoints (ticks_set_write_options with TICKS_DURABILITY_GROUP or STRICT) and on
+* close, chunks appended after the last of them stay invisible. Must not run concurrently with other calls on the
+* handle; a mapped index is decoded into memory on the first refresh that finds new bytes.
+* @param handle Pointer to the ticks file handle (read mode)
+* @param out_new_chunks Pointer to store the number of chunks added to the index, they follow the existing ones
+* @return Status code indicating success or failure (0 = OK), TICKS_ERROR_INVALID_FORMAT if the file shrank or
+* its index lost entries, i.e. it was replaced
+*/
+ticks_status_e ticks_refresh(ticks_file_t* handle, uint32_t* out_new_chunks);
+
+/*
+* @brief Opens a file being appended to for following
+* The follower waits for the file to change through change notifications (inotify) where available and otherwise
+* polls every poll_ms, then refreshes its index with ticks_refresh. The file may not have been checkpointed yet.
+* @param filename The name of the file to follow
+* @param options Follow options, NULL for the defaults
+* @param out_follower Pointer to store the follower
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_follow_open(const char* filename, const ticks_follow_options_t* options, ticks_follower_t** out_follower);
+
+/*
+* @brief Returns the next records of chunks checkpointed since they were last returned, waiting for them if needed
+* Records are delivered chunk by chunk in file order, each row holding every schema column.
+* A chunk that fails to read is reported once and skipped.
+* @param follower Pointer to the follower
+* @param out_rows Output array with room for max_rows rows of the schema's num_columns values
+* @param max_rows Maximum number of records to return
+* @param out_num_rows Pointer to store the number of records returned
+* @param timeout_ms Longest time to wait for new records, 0 to only check
+* @return Status code indicating success or failure (0 = OK), TICKS_EOF if no records arrived within timeout_ms
+*/
+ticks_status_e ticks_follow_next(ticks_follower_t* follower, uint64_t* out_rows, uint32_t max_rows, uint32_t* out_num_rows,
+                                 uint32_t timeout_ms);
+
+/*
+* @brief Returns the handle a follower reads through, e.g. for its header or metrics
+* @param follower Pointer to the follower
+* @return The follower's read handle, owned by the follower
+*/
+ticks_file_t* ticks_follow_handle(ticks_follower_t* follower);
+
+/*
+* @brief Closes a follower and its handle
+* @param follower Pointer to the follower
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_follow_close(ticks_follower_t* follower);
+
+/*
+* @brief Starts an async writer that adds rows to a write handle from a background encoder thread
+* Pushes copy rows into a bounded lock-free single-producer ring and return, the encoder thread collects them into
+* batches of batch_rows and adds each with ticks_add_records, so chunk encoding, writes, page faults and checkpoints
+* never run on the pushing thread. Rows that waited flush_ms are added without waiting for a full batch.
+* While the writer exists, the handle must not be used other than through it. Destroy the writer before closing it.
+* @param handle Pointer to the ticks file handle (write mode)
+* @param options Async writer options, NULL for the defaults
+* @param out_writer Pointer to store the writer
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_async_writer_create(ticks_file_t* handle, const ticks_async_options_t* options, ticks_async_writer_t** out_writer);
+
+/*
+* @brief Queues row-major records for the encoder thread, from one producer thread only
+* When the ring has no room for all of them, backpressure decides: TICKS_BACKPRESSURE_BLOCK waits for the encoder
+* thread to make room, TICKS_BACKPRESSURE_DROP drops the whole push and TICKS_BACKPRESSURE_REPORT fails it.
+* @param writer Pointer to the async writer
+* @param rows Records of the schema's num_columns values each
+* @param num_rows Number of records
+* @return Status code indicating success or failure (0 = OK), TICKS_ERROR_QUEUE_FULL when a push was refused, or the
+* error the encoder thread hit adding rows to the file, after which all pushes fail with it
+*/
+ticks_status_e ticks_async_push(ticks_async_writer_t* writer, const uint64_t* rows, uint32_t num_rows);
+
+/*
+* @brief Waits until every row pushed before the call was added to the file
+* @param writer Pointer to the async writer
+* @return Status code indicating success or failure (0 = OK), or the encoder thread's first error
+*/
+ticks_status_e ticks_async_flush(ticks_async_writer_t* writer);
+
+/*
+* @brief Retrieves queue depth, latency and backpressure counters, from any thread
+* @param writer Pointer to the async writer
+* @param out_stats Pointer to store the result
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_async_get_stats(ticks_async_writer_t* writer, ticks_async_stats_t* out_stats);
+
+/*
+* @brief Adds the rows still queued to the file, stops the encoder thread and frees the writer
+* The handle stays open, ticks_close writes its index.
+* @param writer Pointer to the async writer
+* @return Status code indicating success or failure (0 = OK), or the encoder thread's first error
+*/
+ticks_status_e ticks_async_writer_destroy(ticks_async_writer_t* writer);
+
+/*
+* @brief Opens a directory of ticks files as a dataset, one partition per file, see ticks_dataset_open_ex
+* @param dir Path of the dataset directory
+* @param out_dataset Pointer to store the dataset
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_dataset_open(const char* dir, ticks_dataset_t** out_dataset);
+
+/*
+* @brief Opens a directory of ticks files as a dataset with explicit options
+* Every file ending in .ticks in the directory and its subdirectories (names starting with a dot are skipped) is a
+* partition. The catalog of their symbols, time ranges and chunk counts is kept in a sidecar file in the directory,
+* TICKS_CATALOG_NAME. With TICKS_CATALOG_REFRESH the catalog is brought up to date as by ticks_dataset_refresh and
+* stored again if anything changed. With TICKS_CATALOG_TRUST it is used as stored, so opening reads one file however
+* many partitions there are. Queries are then planned from the catalog alone.
+* @param dir Path of the dataset directory
+* @param options Dataset options, NULL for the defaults
+* @param out_dataset Pointer to store the dataset
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_dataset_open_ex(const char* dir, const ticks_dataset_options_t* options, ticks_dataset_t** out_dataset);
+
+/*
+* @brief Brings the catalog up to date with the files in the directory
+* The directory is listed and each file's modification time and size compared with the catalog, only new and changed
+* files are opened to read their header and index (on the dataset's threads). A file that is not a complete ticks
+* file, e.g. one awaiting its first checkpoint, is listed as a partition without chunks and read again on every
+* refresh. Any other error opening a file fails the refresh. The catalog is stored if anything changed.
+* Partition numbers change with the catalog. Must not run concurrently with queries on the dataset.
+* @param dataset Pointer to the dataset
+* @param out_changed Pointer to store the number of files added, changed or removed, may be NULL
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_dataset_refresh(ticks_dataset_t* dataset, uint32_t* out_changed);
+
+/*
+* @brief Retrieves the number of partitions in the dataset's catalog
+* @param dataset Pointer to the dataset
+* @param out_num_partitions Pointer to store the result
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_dataset_get_num_partitions(ticks_dataset_t* dataset, uint32_t* out_num_partitions);
+
+/*
+* @brief Retrieves a partition's catalog record. Partitions are ordered by symbol, then by earliest timestamp.
+* @param dataset Pointer to the dataset
+* @param partition Partition number, below the number of partitions
+* @param out_partition Pointer to store the record, its path stays valid until the catalog changes
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_dataset_get_partition(ticks_dataset_t* dataset, uint32_t partition, ticks_partition_t* out_partition);
+
+/*
+* @brief Lists the partitions a query over a symbol and time range would read, from the catalog alone
+* Partitions of the symbol are found by binary search, then those whose time range overlaps [from, to) are kept.
+* @param dataset Pointer to the dataset
+* @param symbol Ticker to select, NULL for every symbol
+* @param from Start time (inclusive)
+* @param to End time (exclusive)
+* @param out_partitions Array receiving up to max_partitions partition numbers in catalog order, may be NULL if 0
+* @param max_partitions Capacity of out_partitions
+* @param out_num_partitions Pointer to store the number of partitions selected, which may exceed max_partitions
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_dataset_plan(ticks_dataset_t* dataset, const char* symbol, time_t from, time_t to, uint32_t* out_partitions,
+                                  uint32_t max_partitions, uint32_t* out_num_partitions);
+
+/*
+* @brief Scans the records of a symbol and time range across the dataset, as ticks_scan_ex does for one file
+* The partitions are selected with ticks_dataset_plan and scanned by the dataset's threads, each opening one file
+* at a time with a mapped index. The callback runs on those threads concurrently, a partition's batches arrive in
+* order from a single thread. The first error or non-OK callback status stops the scan.
+* @param dataset Pointer to the dataset
+* @param symbol Ticker to select, NULL for every symbol
+* @param from Start time (inclusive)
+* @param to End time (exclusive)
+* @param options Iterator options applied to every partition, NULL for the defaults
+* @param callback Called with the partition number and each non-empty batch of its row-major records
+* @param user Passed to the callback
+* @return Error code (OK = 0), or the first status other than TICKS_OK returned by the callback
+*/
+ticks_status_e ticks_dataset_scan(ticks_dataset_t* dataset, const char* symbol, time_t from, time_t to,
+                                  const ticks_iterator_options_t* options, ticks_partition_cb callback, void* user);
+
+/*
+* @brief Counts the records of a symbol and time range across the dataset and sums one of their columns
+* Runs ticks_aggregate on each partition selected by ticks_dataset_plan, on the dataset's threads.
+* @param dataset Pointer to the dataset
+* @param symbol Ticker to select, NULL for every symbol
+* @param from Start time (inclusive)
+* @param to End time (exclusive)
+* @param column Schema column to sum, present in every selected partition
+* @param out_aggregate Pointer to store the count and sum
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_dataset_aggregate(ticks_dataset_t* dataset, const char* symbol, time_t from, time_t to, uint32_t column,
+                                       ticks_aggregate_t* out_aggregate);
+
+/*
+* @brief Frees the dataset and its catalog, the catalog file is left as last stored
+* @param dataset Pointer to the dataset
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_dataset_close(ticks_dataset_t* dataset);
+
+/*
+* @brief Sets the allocator used for the library's memory
+* With a NULL handle this replaces the process-wide allocator, which handles copy when they are opened and which
+* serves allocations belonging to no handle (cached chunks, CSV buffers, compaction). Replace it before opening
+* handles, reading CSV or enabling the cache, since blocks it already handed out are freed through the new one.
+* With a handle, the handle's buffers and those of iterators and scans created on it afterwards use the allocator.
+* The handle's index and other long-lived buffers are moved to it; no iterator may be open on the handle.
+* @param handle Pointer to the ticks file handle, or NULL for the process-wide allocator
+* @param allocator Allocator to copy, NULL for malloc (process-wide) or the current process-wide allocator (handle)
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_set_allocator(ticks_file_t* handle, const ticks_allocator_t* allocator);
+
+/*
+* @brief Fills in the built-in hugepage allocator
+* Blocks of TICKS_HUGEPAGE_SIZE or more are mapped on hugepage boundaries, backed by reserved hugepages
+* (MAP_HUGETLB) when available and otherwise advised for transparent hugepages (MADV_HUGEPAGE), which cuts TLB
+* misses when decoding large chunks. Smaller blocks and failed mappings fall back to malloc.
+* @param out_allocator Pointer to store the allocator, pass it to ticks_set_allocator
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_allocator_hugepage(ticks_allocator_t* out_allocator);
+
+/*
+* @brief Writes the recorded trace events as Chrome/Perfetto trace-event JSON
+* Events are only recorded when the library is built with the TICKSIO_TRACE CMake option,
+* otherwise an empty trace is written. Call while no traced operations are running.
+* @param filename Path of the JSON file to write
+* @return Status code indicating success or failure (0 = OK)
+*/
+ticks_status_e ticks_trace_dump(const char* filename);
+
 // TODO: Compression
 #endif // TICKSIO_H
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef TICKSIO_ALLOC_H
+#define TICKSIO_ALLOC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ticksio/ticksio_types.h"
+
+// Every library allocation goes through a ticks_allocator_t. Handles copy the process-wide allocator
+// when they are opened and allocate their buffers through their copy, allocations that belong to no
+// handle (cached chunks, CSV buffers, compaction tasks) use the process-wide allocator directly.
+
+/*
+* @brief Returns the process-wide allocator, malloc-based unless replaced with ticks_set_allocator
+*/
+const ticks_allocator_t* mem_global_allocator(void);
+
+/*
+* @brief Replaces the process-wide allocator
+* @param allocator Allocator to copy, NULL to restore the malloc-based one
+*/
+void mem_set_global_allocator(const ticks_allocator_t* allocator);
+
+/*
+* @brief Allocates size bytes
+* @param allocator Allocator to use, NULL for the process-wide one
+* @return Pointer to the block, NULL on allocation failure
+*/
+void* mem_alloc(const ticks_allocator_t* allocator, size_t size);
+
+/*
+* @brief Allocates count * size zeroed bytes
+*/
+void* mem_calloc(const ticks_allocator_t* allocator, size_t count, size_t size);
+
+/*
+* @brief Resizes a block from mem_alloc/mem_calloc/mem_realloc, a NULL ptr allocates a new one
+* @return Pointer to the resized block, NULL on allocation failure (ptr is then still valid)
+*/
+void* mem_realloc(const ticks_allocator_t* allocator, void* ptr, size_t size);
+
+/*
+* @brief Frees a block from mem_alloc/mem_calloc/mem_realloc, NULL is ignored
+*/
+void mem_free(const ticks_allocator_t* allocator, void* ptr);
+
+/*
+* @brief Allocates size bytes aligned to alignment (a power of two)
+*/
+void* mem_aligned_alloc(const ticks_allocator_t* allocator, size_t alignment, size_t size);
+
+/*
+* @brief Frees a block from mem_aligned_alloc, NULL is ignored
+*/
+void mem_aligned_free(const ticks_allocator_t* allocator, void* ptr);
+
+#endif // TICKSIO_ALLOC_H
@@ -0,0 +1,74 @@
+#ifndef TICKSIO_ASYNC_H
+#define TICKSIO_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ticksio/ticksio_types.h"
+#include "ticksio/ticksio_platform.h"
+
+// An async writer is a single-producer single-consumer ring of rows in front of a write handle. The producer copies
+// rows in and publishes them by advancing head, the encoder thread copies them out into a batch and advances tail,
+// so neither ever takes a lock or waits on the other while the ring has room. Each side keeps its counters on its
+// own cache lines. The encoder thread adds each full batch, or the rows that waited flush_ms, to the file with
+// ticks_add_records, so chunking, reordering, writing and checkpoints all run on it.
+//
+// An idle encoder thread sleeps at most TICKS_ASYNC_IDLE_MS. The producer only wakes it early once a batch's worth
+// of rows (or half the ring) is queued, so a slow feed never pays for a wakeup per push. The wakeup is checked
+// without a fence and can be missed, which the sleep limit bounds. A blocked producer waits in short timed sleeps.
+
+#define TICKS_ASYNC_CACHE_LINE 64
+
+struct ticks_async_writer_t_internal {
+    // Written by the producer
+    volatile uint64_t head;           // Rows pushed so far, the ring holds rows [tail, head)
+    uint64_t cached_tail;             // Producer's last view of tail, reloaded when the ring looks full or deep
+    volatile uint64_t dropped_rows;
+    volatile uint64_t rejected_pushes;
+    volatile uint64_t blocked_pushes;
+    uint8_t producer_padding[TICKS_ASYNC_CACHE_LINE];
+
+    // Written by the encoder thread
+    volatile uint64_t tail;           // Rows taken off the ring so far
+    volatile uint64_t written_rows;
+    volatile uint64_t max_depth;
+    volatile uint64_t latency_sum_ns; // Wait of the oldest row of each take, summed over latency_samples takes
+    volatile uint64_t latency_samples;
+    volatile uint64_t max_latency_ns;
+    uint8_t consumer_padding[TICKS_ASYNC_CACHE_LINE];
+
+    // Sleep flags, each written by the side that sleeps and read by the other before waking it
+    volatile uint8_t encoder_sleeping;
+    volatile uint8_t producer_waiting;
+    uint8_t flag_padding[TICKS_ASYNC_CACHE_LINE];
+
+    // Set up once by ticks_async_writer_create
+    ticks_file_t* handle;
+    uint64_t* ring;                   // capacity rows of num_columns values
+    uint64_t* push_ns;                // Push time of each ring slot
+    uint64_t capacity;                // Power of two
+    uint64_t wake_rows;               // Queued rows at which the producer wakes a sleeping encoder thread
+    uint32_t num_columns;
+    ticks_backpressure_e backpressure;
+    uint64_t flush_ns;
+
+    // Owned by the encoder thread
+    uint64_t* batch;                  // Rows taken off the ring and not yet added to the file
+    uint32_t batch_rows;
+    uint32_t num_batched;
+    uint64_t batched_since_ns;        // Push time of the oldest batched row
+
+    // Flushes, the stop request and errors, under mutex
+    mutex_portable mutex;
+    cond_portable cond;
+    thread_portable thread;
+    volatile uint64_t flush_requested; // Flushes asked for so far
+    volatile uint64_t flush_done;      // Flushes completed so far
+    volatile uint8_t stop;
+    volatile uint8_t failed;           // Set with release once status holds the first error
+    ticks_status_e status;
+    ticks_allocator_t allocator;
+};
+
+#endif // TICKSIO_ASYNC_H
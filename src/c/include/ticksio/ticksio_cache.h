@@ -0,0 +1,59 @@
+#ifndef TICKSIO_CACHE_H
+#define TICKSIO_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ticksio/ticksio_types.h"
+
+// Process-wide cache of decoded chunks shared by all handles and threads.
+// Entries are reference counted: an acquired entry stays valid until released, even if it is
+// evicted in the meantime. Only unpinned entries are evicted, least recently used first.
+
+typedef struct {
+    uint64_t file_device; // Identity of the file the chunk belongs to
+    uint64_t file_inode;
+    uint64_t chunk_offset;
+    uint32_t chunk_checksum; // Guards against a file being replaced in place
+    uint32_t column_mask;    // Columns decoded into the entry
+} ticks_cache_key_t;
+
+typedef struct ticks_cache_entry_t ticks_cache_entry_t;
+
+/*
+* @brief Returns whether the cache has a non-zero budget
+*/
+int cache_enabled(void);
+
+/*
+* @brief Looks up a decoded chunk and pins it
+* @param key Chunk identity
+* @return Pinned entry, or NULL on a miss
+*/
+ticks_cache_entry_t* cache_acquire(const ticks_cache_key_t* key);
+
+/*
+* @brief Inserts decoded rows and returns a pinned entry for them
+* The cache takes ownership of rows (allocated with the process-wide allocator). If another thread inserted the same
+* chunk first, rows are freed and the existing entry is returned. Entries too large for the
+* budget are returned pinned but not cached, and freed on release.
+* @param key Chunk identity
+* @param rows Row-major records
+* @param num_records Number of rows
+* @param num_columns Values per row
+* @return Pinned entry, or NULL on allocation failure (rows are freed)
+*/
+ticks_cache_entry_t* cache_insert(const ticks_cache_key_t* key, uint64_t* rows, uint32_t num_records, uint32_t num_columns);
+
+/*
+* @brief Unpins an entry previously returned by cache_acquire or cache_insert
+*/
+void cache_release(ticks_cache_entry_t* entry);
+
+/*
+* @brief Decoded row-major records of a pinned entry
+*/
+const uint64_t* cache_entry_rows(const ticks_cache_entry_t* entry, uint32_t* out_num_records);
+
+#endif // TICKSIO_CACHE_H
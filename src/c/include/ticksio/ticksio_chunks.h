@@ -10,13 +10,163 @@ extern "C" {
 #include "ticksio/ticksio_constants.h"
 #include "ticksio/ticksio_helpers.h"
 
+typedef struct {
+    ticks_chunk_t* chunk;
+    ticks_status_e status;
+} create_chunk_result;
+
+// A ticks_predicate_t rewritten into one chunk's stored frame: a record matches when its stored value,
+// value - base at the column's width, lies in [low, high]
+typedef struct {
+    uint32_t column;
+    uint64_t low;
+    uint64_t high;
+    uint32_t run;           // Run-length cursor when the column is run-length coded
+    uint32_t run_remaining;
+} chunk_predicate_t;
+
+// Decodes a chunk a batch of records at a time, so a scan can keep the decoded rows in cache
+typedef struct {
+    const ticks_index_entry_t* entry;
+    const uint8_t* data;
+    uint32_t num_columns;                       // Columns in the file's schema
+    uint32_t column_mask;                       // Columns to decode
+    uint32_t stride;                            // Values per output row
+    uint32_t num_records;
+    uint32_t next_record;                       // First record of the next batch
+    uint32_t run[TICKS_MAX_COLUMNS];            // Current run of each run-length column
+    uint32_t run_remaining[TICKS_MAX_COLUMNS];  // Records of the current run not decoded yet
+    chunk_predicate_t predicates[TICKS_MAX_PREDICATES + 1]; // Room for a time range next to the caller's predicates
+    uint32_t num_predicates;
+    ticks_metrics_shard_t* metrics;             // Where the time spent in the codecs is recorded (may be NULL)
+} chunk_decoder_t;
+
+/*
+* @brief Encodes the rows starting at row_index into one in-memory columnar chunk with the narrowest widths that fit
+* Stops at num_rows or at the first row the chunk policy does not admit. Does not touch any file.
+* @param row_index Pointer to the current index in the rows array, advanced past the encoded rows
+* @param rows Row-major records, schema->num_columns values per row
+* @param num_rows Total number of rows in the array
+* @param schema Record layout
+* @param policy Chunking policy bounding the chunk's size, row count and time bucket
+* @param allocator Allocator for the chunk and its data
+* @return The chunk (release with free_chunk when done) and an error code (OK = 0)
+*/
+create_chunk_result create_chunk(uint64_t* const row_index, const uint64_t* rows, uint64_t num_rows,
+                                 const ticks_schema_t* schema, const ticks_chunk_policy_t* policy,
+                                 const ticks_allocator_t* allocator);
+
+/*
+* @brief Frees a chunk from create_chunk and its data
+*/
+void free_chunk(const ticks_allocator_t* allocator, ticks_chunk_t* chunk);
+
+/*
+* @brief Appends an encoded chunk to the file and adds its entry to the in-memory index
+* @param handle Pointer to the ticks file handle (write mode)
+* @param chunk Chunk produced by create_chunk
+* @return Error code (OK = 0)
+*/
+ticks_status_e append_chunk_and_update_index(ticks_file_t* handle, const ticks_chunk_t* chunk);
+
+/*
+* @brief Add records as chunks in file
+* @param handle Pointer to the ticks file handle (write mode)
+* @param rows Row-major records in the file's schema
+* @param num_rows Total number of rows in the array
+* @return Error code (OK = 0)
+*/
+ticks_status_e create_chunks(ticks_file_t* handle, const uint64_t* rows, uint64_t num_rows);
+
+/*
+* @brief Number of records stored in a chunk, checked against its column offsets, sizes and widths
+* @param entry Index entry of the chunk
+* @param num_columns Number of columns in the file's schema
+* @return Record count (0 if the entry is malformed)
+*/
+uint32_t chunk_record_count(const ticks_index_entry_t* entry, uint32_t num_columns);
+
+/*
+* @brief Reads the selected columns of a chunk into a reusable buffer and verifies them per the handle's verify mode
+* Each column is placed at its offset within the buffer, so the buffer is laid out like the chunk on disk.
+* Adjacent selected columns are read with a single positional read, unselected columns are never read.
+* @param handle Pointer to the ticks file handle
+* @param chunk_index Index of the chunk to read
+* @param column_mask Columns to read, bit c selects schema column c
+* @param buffer Pointer to the buffer, grown through the handle's allocator when too small
+* @param buffer_capacity Pointer to the buffer's capacity in bytes
+* @return Error code (OK = 0, TICKS_ERROR_CHECKSUM_MISMATCH if verification failed)
+*/
+ticks_status_e read_chunk(ticks_file_t* handle, uint32_t chunk_index, uint32_t column_mask, uint8_t** buffer, size_t* buffer_capacity);
+
+/*
+* @brief Decodes the selected columns of a chunk into row-major records
+* @param entry Index entry of the chunk
+* @param num_columns Number of columns in the file's schema
+* @param column_mask Columns to decode, each output row holds the selected columns in schema order
+* @param data Chunk bytes as filled in by read_chunk
+* @param out_rows Output array with room for chunk_record_count(entry) rows of column_mask_count(column_mask) values
+* @param out_num_records Pointer to store the number of decoded records
+* @param metrics Metric shards the time spent in the codecs is recorded in (may be NULL)
+* @return Error code (OK = 0)
+*/
+ticks_status_e decode_chunk(const ticks_index_entry_t* entry, uint32_t num_columns, uint32_t column_mask,
+                            const uint8_t* data, uint64_t* out_rows, uint32_t* out_num_records, ticks_metrics_shard_t* metrics);
+
+/*
+* @brief Rewrites predicates into a chunk's stored frame using only the chunk's index entry
+* Predicates every record of the chunk matches are dropped, so a chunk wholly inside the ranges needs no filtering.
+* @param entry Index entry of the chunk
+* @param schema Schema of the file
+* @param predicates Predicates checked by schema_validate_predicates
+* @param num_predicates Number of predicates
+* @param out_predicates Output array with room for num_predicates predicates
+* @param out_num_predicates Pointer to store the number of predicates that still need to be evaluated
+* @return 0 if no record of the chunk can match, so the chunk need not be read, 1 otherwise
+*/
+int chunk_predicates_rewrite(const ticks_index_entry_t* entry, const ticks_schema_t* schema, const ticks_predicate_t* predicates,
+                             uint32_t num_predicates, chunk_predicate_t* out_predicates, uint32_t* out_num_predicates);
+
+/*
+* @brief Prepares to decode the selected columns of a chunk in batches
+* @param decoder Pointer to the decoder to initialize
+* @param entry Index entry of the chunk
+* @param num_columns Number of columns in the file's schema
+* @param column_mask Columns to decode, each output row holds the selected columns in schema order
+* @param predicates Predicates from chunk_predicates_rewrite the decoded records must match (may be NULL)
+* @param num_predicates Number of predicates, at most TICKS_MAX_PREDICATES + 1
+* @param data Chunk bytes as filled in by read_chunk with the decoded and predicate columns, kept until the last batch
+* @param metrics Metric shards the time spent in the codecs is recorded in (may be NULL)
+* @return Error code (OK = 0)
+*/
+ticks_status_e chunk_decoder_init(chunk_decoder_t* decoder, const ticks_index_entry_t* entry, uint32_t num_columns,
+                                  uint32_t column_mask, const chunk_predicate_t* predicates, uint32_t num_predicates,
+                                  const uint8_t* data, ticks_metrics_shard_t* metrics);
+
+/*
+* @brief Decodes the next records of the chunk that match the decoder's predicates into row-major records
+* Without predicates this decodes min(max_rows, records left) records. With predicates it reads on until max_rows
+* records matched or the chunk is done, evaluating the predicates on the stored values before decoding anything.
+* @param decoder Decoder set up by chunk_decoder_init
+* @param out_rows Output array with room for max_rows rows of column_mask_count(column_mask) values
+* @param max_rows Maximum number of records to return
+* @param out_num_rows Pointer to store the number of records returned, 0 once the chunk is done
+* @return Error code (OK = 0)
+*/
+ticks_status_e chunk_decoder_next(chunk_decoder_t* decoder, uint64_t* out_rows, uint32_t max_rows, uint32_t* out_num_rows);
+
 /*
-* @brief Add trade data as chunks in file
-* @param row_index Pointer to the current index in entries array
-* @param entries Array of trade_data_t entries
-* @param num_entries Total number of entries in the array
+* @brief Sums one column of a whole chunk without decoding it into records
+* Frame-of-reference columns are summed at their stored width, run-length columns once per run and
+* dictionary columns once per dictionary value after counting the codes.
+* @param entry Index entry of the chunk
+* @param num_columns Number of columns in the file's schema
+* @param column_index Column to sum
+* @param data Chunk bytes as filled in by read_chunk, with at least column_index read
+* @param out_sum Pointer to store the sum, modulo 2^64
 * @return Error code (OK = 0)
 */
-ticks_status_e create_chunks(ticks_file_t* handle, const trade_data_t* entries, uint64_t num_entries);
+ticks_status_e sum_chunk_column(const ticks_index_entry_t* entry, uint32_t num_columns, uint32_t column_index,
+                                const uint8_t* data, uint64_t* out_sum);
 
 #endif // TICKSIO_CHUNKS_H
\ No newline at end of file
@@ -9,17 +9,70 @@ extern "C" {
 
 // --- Header constants ---
 #define TICKS_MAGIC "TICK"
+#define TICKS_FORMAT_VERSION 14
 #define TICKS_TICKER_SIZE 8
 #define TICKS_CURRENCY_SIZE 3
 #define TICKS_COUNTRY_SIZE 2
+#define TICKS_HEADER_CHECKPOINTS 0x01 // Header flag set once a writer enabled checkpoints, readers only then search for earlier footers
+
+// --- Schema constants ---
+#define TICKS_MAX_COLUMNS 8 // Keeps a chunk's column mask within one byte
+#define TICKS_COLUMN_NAME_SIZE 16
+#define TICKS_MAX_DECIMAL_SCALE 18 // 10^18 is the largest power of ten below 2^64 with room for a digit
+#define TICKS_DEFAULT_PRICE_SCALE 2 // Prices of the built-in schemas are stored in hundredths
+
+// --- Footer constants ---
+#define TICKS_FOOTER_MAGIC "TKFT"
+
+// --- Index constants ---
+#define TICKS_SPARSE_INDEX_STRIDE 1024 // One top-level sparse entry per this many index entries, each a packed index block
+#define TICKS_SPARSE_ENTRY_SIZE 16 // First time base and byte offset of a packed index block
+#define TICKS_INDEX_ALIGNMENT 8 // The index, sparse index and footer start on this alignment
 
 // --- Chunking constants ---
-#define MAX_CHUNK_SIZE 16777216 // 16 MB
+#define TICKS_DEFAULT_CHUNK_BYTES 33554432 // 32 MB, used when a chunk policy leaves max_chunk_bytes at 0
+#define TICKS_DICT_MAX_VALUES 256 // Dictionary-coded columns use one byte per code
+
+// --- Scan constants ---
+#define TICKS_SCAN_BATCH_ROWS 4096 // 96 KB of trade rows, small enough to stay in L2 between decode and callback
+#define TICKS_MAX_PREDICATES 8
+
+// --- Allocation constants ---
+#define TICKS_HUGEPAGE_SIZE 2097152 // 2 MB, blocks of at least this size get hugepages from ticks_allocator_hugepage
+
+// --- Direct write constants ---
+#define TICKS_DIRECT_ALIGNMENT 4096 // Chunks written with O_DIRECT start and end on this boundary
+#define TICKS_DIRECT_STAGING_BYTES 8388608 // 8 MB per staging buffer, two are in use per handle
+
+// --- Durability constants ---
+#define TICKS_GROUP_COMMIT_CHUNKS 64 // Chunks appended before a group commit checkpoint
+#define TICKS_GROUP_COMMIT_MS 1000   // Longest time appended chunks wait for a group commit checkpoint
+#define TICKS_FOOTER_SCAN_BYTES 1048576 // 1 MB read at a time when searching backwards for the last complete footer
+
+// --- Async writer constants ---
+#define TICKS_ASYNC_QUEUE_ROWS 1048576 // Rows an async writer's queue holds by default
+#define TICKS_ASYNC_BATCH_ROWS 65536   // Rows the encoder thread collects before adding them to the file
+#define TICKS_ASYNC_FLUSH_MS 100       // Longest time collected rows wait for a full batch
+#define TICKS_ASYNC_SPIN 256           // Spins before a blocked producer or an idle encoder thread sleeps
+#define TICKS_ASYNC_IDLE_MS 10         // Longest sleep of an idle encoder thread, bounds the cost of a missed wakeup
+
+// --- Follow constants ---
+#define TICKS_FOLLOW_POLL_MS 50 // Interval at which followers check the file where change notifications are unavailable
+
+// --- Dataset constants ---
+#define TICKS_FILE_EXTENSION ".ticks"      // Files of a dataset directory taken as partitions
+#define TICKS_CATALOG_NAME ".ticks_catalog" // Sidecar catalog kept in the dataset directory
+#define TICKS_CATALOG_MAGIC "TKCT"
+#define TICKS_CATALOG_VERSION 1
+#define TICKS_CATALOG_HEADER_SIZE 24 // Magic, version, partition count and path bytes
+#define TICKS_CATALOG_ENTRY_SIZE 64  // One fixed-size record per partition
+
+// --- Compaction constants ---
+#define TICKS_COMPACT_DEFAULT_RANGE_ROWS 4194304 // ~96 MB of decoded rows per worker
 
 // --- CSV constants ---
 #define CSV_MAX_TIMESTAMP_LEN 30
 #define CSV_MAX_LINE_LEN 1024
-// TODO: Make this adjustable based on available memory and remove this
-#define CSV_DEFAULT_CHUNK_SIZE 10000
+#define CSV_BATCH_ROWS (TICKS_DEFAULT_CHUNK_BYTES / 24) // Trade rows of 24 bytes read per batch in chunked mode, one default-sized chunk's worth
 
 #endif // TICKS_CONSTANTS_H
\ No newline at end of file
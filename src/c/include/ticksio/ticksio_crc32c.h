@@ -0,0 +1,21 @@
+#ifndef TICKSIO_CRC32C_H
+#define TICKSIO_CRC32C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* @brief Computes the CRC32C (Castagnoli) of a buffer, continuing from a previous value
+* Uses the SSE4.2 / ARMv8 crc32c instructions when the CPU supports them, slice-by-8 tables otherwise
+* @param crc Previous CRC value (0 for a new checksum)
+* @param data Pointer to the data
+* @param length Number of bytes
+* @return Updated CRC value
+*/
+uint32_t crc32c(uint32_t crc, const void* data, size_t length);
+
+#endif // TICKSIO_CRC32C_H
@@ -19,12 +19,17 @@ typedef struct {
     uint64_t current_chunk;
     uint8_t is_completed;
     uint8_t is_full_load;
+    uint8_t price_scale;  // Decimal places prices are scaled by, taken from the schema by the first read_csv call
+    uint64_t rejected_lines; // Lines that could not be parsed, each reported on stderr and left out
+    const ticks_schema_t* schema; // Schema the rows are written with, set before the first read_csv call. Its second
+                                  // column holds the prices, NULL for the built-in trades schema (TICKS_DEFAULT_PRICE_SCALE)
     FILE* file_handle;
 } csv_read_result_t;
 
 /**
  * @brief Single function that handles both full and chunked loading automatically
- * @return Error code (0 = OK)
+ * @return Error code (0 = OK, TICKS_ERROR_INVALID_ARGUMENTS when the schema is not a trades schema with a decimal
+ *         price column of at most TICKS_MAX_DECIMAL_SCALE places)
 */
 ticks_status_e read_csv(const char* filename, csv_read_result_t* result);
 
@@ -0,0 +1,39 @@
+#ifndef TICKSIO_DATASET_H
+#define TICKSIO_DATASET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ticksio/ticksio_types.h"
+
+// A dataset is a directory of ticks files, typically one per symbol and day. Its catalog holds one fixed-size record
+// per file, sorted by symbol and earliest timestamp, so a query finds its partitions by binary search without
+// opening any file. The catalog is stored next to the files (TICKS_CATALOG_NAME) and refreshed by comparing each
+// file's modification time and size with the record, only new and changed files are opened.
+
+typedef struct {
+    char symbol[TICKS_TICKER_SIZE]; // Zero-padded ticker
+    uint64_t min_time;
+    uint64_t max_time;
+    uint64_t num_records;
+    uint64_t mtime_ns;              // Modification time and size of the file when it was read, mtime 0 to read it again
+    uint64_t file_size;
+    uint64_t path_offset;           // Offset of the path within the dataset's paths, as stored in the catalog
+    const char* path;               // NUL-terminated, relative to the dataset directory
+    uint32_t path_length;
+    uint32_t num_chunks;
+} catalog_entry_t;
+
+struct ticks_dataset_t_internal {
+    char* dir;
+    catalog_entry_t* entries;       // Sorted by symbol, min_time, then path
+    uint32_t num_entries;
+    char* paths;                    // Every entry's path, NUL-terminated
+    uint64_t paths_size;
+    uint32_t num_threads;
+    uint8_t read_only;
+    ticks_allocator_t allocator;
+};
+
+#endif // TICKSIO_DATASET_H
@@ -0,0 +1,95 @@
+#ifndef TICKSIO_DIRECT_H
+#define TICKSIO_DIRECT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ticksio/ticksio_types.h"
+#include "ticksio/ticksio_platform.h"
+
+// Direct chunk writes for bulk loads. Chunks are copied into one of two aligned staging buffers, each padded to
+// TICKS_DIRECT_ALIGNMENT, and a full buffer is handed to an I/O thread that writes it with O_DIRECT while the next
+// one fills. The data never enters the page cache, so a backfill neither evicts pages readers depend on nor builds
+// up dirty pages that stall on writeback.
+
+typedef struct {
+    int fd;                       // Descriptor opened with O_DIRECT, -1 when direct writes are off
+    ticks_allocator_t allocator;  // Allocator of the staging buffers
+    uint8_t* buffers[2];          // Staging buffers aligned to TICKS_DIRECT_ALIGNMENT
+    size_t capacities[2];
+    uint32_t active;              // Buffer being filled
+    size_t used;                  // Bytes staged in the active buffer
+    uint64_t offset;              // File offset the active buffer is written to
+    // Hand-off to the I/O thread, guarded by mutex
+    mutex_portable mutex;
+    cond_portable cond;
+    thread_portable thread;
+    uint8_t pending;              // Set while the I/O thread owns a buffer
+    uint8_t stop;
+    uint32_t pending_buffer;
+    size_t pending_length;
+    uint64_t pending_offset;
+    ticks_status_e status;        // First write error, reported by the next stage or flush
+    uint8_t buffered;             // Set once O_DIRECT was refused at write time and cleared on the descriptor
+} direct_writer_t;
+
+/*
+* @brief Returns whether direct writes are on
+*/
+static inline int direct_writer_active(const direct_writer_t* writer) {
+    return writer->fd >= 0;
+}
+
+/*
+* @brief Opens a direct descriptor on the stream's file and starts the I/O thread
+* @param writer Writer to initialize, fd must be -1
+* @param file Stream of the file, already flushed
+* @param offset File offset of the first chunk, aligned to TICKS_DIRECT_ALIGNMENT
+* @param staging_bytes Size of each staging buffer, rounded up to TICKS_DIRECT_ALIGNMENT
+* @param allocator Allocator for the staging buffers
+* @return Error code (OK = 0, TICKS_ERROR_FILE_IO when the file cannot be opened for direct I/O)
+*/
+ticks_status_e direct_writer_open(direct_writer_t* writer, FILE* file, uint64_t offset, uint32_t staging_bytes,
+                                  const ticks_allocator_t* allocator);
+
+/*
+* @brief Stages a chunk, submitting the active buffer first when the chunk does not fit
+* @param writer Open writer
+* @param data Chunk bytes
+* @param size Chunk size in bytes
+* @param out_offset Pointer to store the file offset of the chunk
+* @param out_padding Pointer to store the zero bytes that follow the chunk up to the alignment
+* @return Error code (OK = 0)
+*/
+ticks_status_e direct_writer_stage(direct_writer_t* writer, const uint8_t* data, uint32_t size, uint64_t* out_offset,
+                                   uint32_t* out_padding);
+
+/*
+* @brief Writes out everything staged and waits until it is on the file
+*/
+ticks_status_e direct_writer_flush(direct_writer_t* writer);
+
+/*
+* @brief Moves a flushed writer to a new file offset, used when the stream wrote past the staged chunks
+* @param writer Open writer with nothing staged
+* @param offset File offset of the next chunk, aligned to TICKS_DIRECT_ALIGNMENT
+* @return Error code (OK = 0)
+*/
+ticks_status_e direct_writer_seek(direct_writer_t* writer, uint64_t offset);
+
+/*
+* @brief Zero-fills the stream from offset up to the next TICKS_DIRECT_ALIGNMENT boundary and flushes it
+* @param file Stream positioned at offset
+* @param offset Pointer to the stream's file offset, advanced to the boundary
+* @return Error code (OK = 0)
+*/
+ticks_status_e direct_pad_stream(FILE* file, uint64_t* offset);
+
+/*
+* @brief Flushes, stops the I/O thread and releases the descriptor and buffers
+* @return Error code of the flush or of any earlier write (OK = 0)
+*/
+ticks_status_e direct_writer_close(direct_writer_t* writer);
+
+#endif // TICKSIO_DIRECT_H
@@ -0,0 +1,59 @@
+#ifndef TICKSIO_DURABILITY_H
+#define TICKSIO_DURABILITY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ticksio/ticksio_types.h"
+#include "ticksio/ticksio_platform.h"
+
+// Checkpoints make appended chunks durable before close. A checkpoint syncs the chunks appended so far, then writes
+// an index of the chunks added since the previous checkpoint and a footer pointing back to it after the last write
+// and syncs again, so a footer never reaches the disk ahead of a chunk it references. Opening a file whose tail was torn by a crash falls back to the last complete
+// footer, which always describes a consistent prefix of the chunks.
+
+typedef struct {
+    ticks_durability_e mode;
+    uint32_t group_commit_chunks;
+    uint32_t group_commit_ms;
+    uint32_t pending_chunks;  // Chunks appended since the last checkpoint
+    // Group commit thread, waits on cond under the handle's write_mutex
+    cond_portable cond;
+    thread_portable thread;
+    uint8_t running;
+    uint8_t stop;
+    ticks_status_e status;    // First checkpoint error, reported by the next add call or close
+} durability_t;
+
+/*
+* @brief Applies the durability options of a write handle, starting the group commit thread when asked for
+* @param handle Write handle without a running group commit thread
+* @param options Writer options holding the durability mode
+* @return Error code (OK = 0)
+*/
+ticks_status_e durability_start(ticks_file_t* handle, const ticks_write_options_t* options);
+
+/*
+* @brief Stops the group commit thread if one is running, the mode is kept for the sync on close
+* @return The first error of a checkpoint (OK = 0)
+*/
+ticks_status_e durability_stop(ticks_file_t* handle);
+
+/*
+* @brief Counts an appended chunk, waking the group commit thread once enough are pending. Called under write_mutex.
+*/
+void durability_chunk_appended(ticks_file_t* handle);
+
+/*
+* @brief Ends an add call under write_mutex, checkpointing in strict mode
+* @return Error code of the checkpoint or of an earlier group commit (OK = 0)
+*/
+ticks_status_e durability_commit(ticks_file_t* handle);
+
+/*
+* @brief Syncs the file after the final index was written on close, unless durability is off
+*/
+ticks_status_e durability_sync_close(ticks_file_t* handle);
+
+#endif // TICKSIO_DURABILITY_H
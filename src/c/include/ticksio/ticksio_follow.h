@@ -0,0 +1,27 @@
+#ifndef TICKSIO_FOLLOW_H
+#define TICKSIO_FOLLOW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ticksio/ticksio_types.h"
+#include "ticksio/ticksio_chunks.h"
+
+// A follower reads a file while its writer is still appending to it. Writers only publish chunks through
+// checkpoints, an index and footer written after the chunks they reference, so the follower refreshes its handle's
+// index whenever the file changes and delivers the rows of chunks that a newer checkpoint added.
+
+struct ticks_follower_t_internal {
+    ticks_file_t* handle;       // Read handle opened to follow, its index grows with each checkpoint found
+    int watch;                  // Change notifications for the file, -1 when polling
+    uint32_t poll_ms;
+    uint32_t next_chunk;        // Next chunk whose rows are delivered
+    ticks_index_entry_t entry;  // Copy of the chunk being delivered, refreshing may move the handle's entries
+    chunk_decoder_t decoder;    // Decodes the chunk being delivered in batches
+    uint8_t decoding;           // Set while the decoder holds rows not delivered yet
+    uint8_t* chunk_buffer;      // Raw bytes of the chunk being delivered
+    size_t chunk_buffer_capacity;
+};
+
+#endif // TICKSIO_FOLLOW_H
@@ -10,4 +10,12 @@ extern "C" {
 size_e determine_min_size_uint64(uint64_t value);
 int is_little_endian();
 
+// 10^exponent, exponent at most TICKS_MAX_DECIMAL_SCALE
+uint64_t pow10_uint64(uint8_t exponent);
+
+// Parses an unsigned decimal such as "101.37" exactly into value * 10^scale, without a floating point round trip.
+// Fractional digits past scale must be zero. Returns a pointer past the number, or NULL if there is no number,
+// precision would be lost, the value overflows or scale exceeds TICKS_MAX_DECIMAL_SCALE.
+const char* parse_scaled_decimal(const char* str, uint8_t scale, uint64_t* out_value);
+
 #endif // TICKSIO_HELPERS_H
\ No newline at end of file
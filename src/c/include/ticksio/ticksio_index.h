@@ -7,12 +7,106 @@ extern "C" {
 
 #include "ticksio/ticksio_internal.h"
 #include "ticksio/ticksio_types.h"
+#include "ticksio/ticksio_platform.h"
+
+// One index as described by its footer. A checkpoint's index may only hold the entries from first_entry on, the
+// footer at previous_footer describes the index holding the entries before them.
+typedef struct {
+    uint64_t footer_offset;
+    uint64_t index_offset;
+    uint64_t index_size;
+    uint32_t first_entry;     // 0 for a complete index
+    uint32_t num_entries;     // Entries up to the end of this index, including those before first_entry
+    uint64_t previous_footer; // 0 for a complete index
+    uint32_t sparse_stride;
+    uint32_t num_sparse;      // Blocks of this index
+    uint32_t index_checksum;
+} index_segment_t;
 
 /*
-* @brief Creates the index in the ticks file
+* @brief Creates the index in the ticks file, followed by the footer, at the stream's position
 * @param handle Pointer to the ticks file handle
+* @param first_entry First index entry to write. 0 writes a complete index, otherwise the entries before it must be
+* covered by handle->last_footer and the footers it points back to
+* @param num_entries Number of leading index entries covered, less than all of them for a checkpoint
+* @return Error code (0 = OK)
+*/
+ticks_status_e create_index(ticks_file_t* handle, uint32_t first_entry, uint32_t num_entries);
+
+/*
+* @brief Largest encoding of an index entry, sizes the buffer a block is encoded into
+*/
+static inline size_t index_entry_max_bytes(uint32_t num_columns) {
+    // Chunk fields: three 10-byte and three 5-byte varints and a checksum. Columns: two layout bytes, two 10-byte
+    // and two 5-byte varints and a checksum.
+    return 49 + (size_t)num_columns * 36;
+}
+
+/*
+* @brief Smallest encoding of an index entry, bounds how many entries a packed index of a given size can hold
+*/
+static inline uint64_t index_entry_min_bytes(uint32_t num_columns) {
+    // Every varint takes at least a byte next to the fixed 4-byte checksums
+    return 10 + (uint64_t)num_columns * 9;
+}
+
+/*
+* @brief Decodes one block of the packed index
+* @param data Packed bytes starting at the block
+* @param size Bytes available from data
+* @param num_entries Entries in the block
+* @param num_columns Columns of each entry
+* @param out_entries Array receiving num_entries entries
+* @param out_used Pointer to store the bytes the block took
+* @return Error code (0 = OK, TICKS_ERROR_INVALID_FORMAT when the bytes do not hold the entries)
+*/
+ticks_status_e decode_index_block(const uint8_t* data, uint64_t size, uint32_t num_entries, uint32_t num_columns,
+                                  ticks_index_entry_t* out_entries, uint64_t* out_used);
+
+/*
+* @brief Decodes the blocks of one index from first_block on into the handle's entries array
+* @param handle Handle whose entries array has room for segment->num_entries entries
+* @param segment The index, as described by its footer
+* @param region Packed index from region_offset on, followed by the sparse index
+* @param region_offset Offset of first_block within the packed index, 0 for the whole index
+* @param first_block First block to decode, the entries of earlier blocks are left as they are
 * @return Error code (0 = OK)
 */
-ticks_status_e create_index(ticks_file_t* handle);
+ticks_status_e decode_index(ticks_file_t* handle, const index_segment_t* segment, const uint8_t* region, uint64_t region_offset,
+                            uint32_t first_block);
+
+/*
+* @brief Decodes only the sparse index, the entries of a mapped index are decoded by index_entry
+* @param handle Handle with index_size, num_sparse and the sparse array set up
+* @param region Packed index followed by the sparse index
+* @return Error code (0 = OK)
+*/
+ticks_status_e decode_sparse_index(ticks_file_t* handle, const uint8_t* region);
+
+/*
+* @brief Decodes one block of a mapped index unless another thread already did
+*/
+void decode_mapped_block(ticks_file_t* handle, uint32_t block);
+
+/*
+* @brief Returns an index entry, decoding its block first when the index is mapped
+*/
+static inline const ticks_index_entry_t* index_entry(ticks_file_t* handle, uint32_t chunk) {
+    if (handle->decoded_blocks != NULL) {
+        const uint32_t block = chunk / handle->index.sparse_stride;
+        if (atomic_load_acquire_u8_portable(&handle->decoded_blocks[block]) == 0)
+            decode_mapped_block(handle, block);
+    }
+    return &handle->index.entries[chunk];
+}
+
+/*
+* @brief Finds the chunk a timestamp falls into using the sparse index followed by a search within one block
+* @param handle Pointer to the ticks file handle
+* @param ms_since_epoch Timestamp to look up
+* @return Index of the last chunk whose time base is < ms_since_epoch, 0 if there is none, so no chunk before it
+*         holds a tick at or after the timestamp
+*/
+uint32_t find_chunk_for_time(ticks_file_t* handle, uint64_t ms_since_epoch);
 
 #endif // INDEX_H
\ No newline at end of file
@@ -12,6 +12,11 @@ extern "C" {
 #include <time.h>
 
 #include "ticksio/ticksio_types.h"
+#include "ticksio/ticksio_metrics.h"
+#include "ticksio/ticksio_cache.h"
+#include "ticksio/ticksio_reorder.h"
+#include "ticksio/ticksio_direct.h"
+#include "ticksio/ticksio_durability.h"
 
 enum file_mode_e {
     FILE_MODE_READ,
@@ -22,19 +27,64 @@ enum file_mode_e {
 struct ticks_file_t_internal {
     FILE *file_stream;  // The hidden file pointer
     ticks_header_t header; // The hidden file header
+    uint16_t version;      // Format version read from / written to the file
     uint64_t index_offset; // Byte offset where the index data starts in the file
     uint64_t index_size;   // Size of the index data in bytes
+    uint64_t write_offset; // Byte offset where the next chunk is appended (write mode only)
+    uint32_t index_checksum; // CRC32C of the index and sparse index as recorded in the footer
+    uint32_t first_entry;  // First entry held by the index at index_offset, 0 unless it is a checkpoint pointing back to earlier ones
+    uint32_t indexed_entries; // Entries covered by last_footer and the footers it points back to (write mode only)
+    uint64_t last_footer;  // Offset of the last footer this writer wrote or kept, 0 for none (write mode only)
+    uint64_t complete_index_bytes; // Bytes of the last complete index written, bounds the checkpoints after it (write mode only)
+    uint64_t chained_index_bytes;  // Bytes of the checkpoint indexes written since (write mode only)
+    uint64_t footer_end;   // End of the footer the index was taken from, newer checkpoints can only follow it
+    uint64_t scanned_size; // File size when footers were last searched for (read mode only)
+    uint8_t awaiting_header; // Followed file opened before its header was complete, ticks_refresh reads it (read mode only)
+    uint8_t index_dirty;   // Set when chunks were appended and the index/footer must be written on close
     ticks_index_t index;   // The in-memory index structure
+    void* index_map;       // Base of the index mapping when opened with TICKS_INDEX_MMAP, otherwise NULL
+    size_t index_map_length; // Length of the index mapping in bytes
+    const uint8_t* mapped_index; // Packed index within index_map, decoded a block at a time
+    volatile uint8_t* decoded_blocks; // Byte per block of a mapped index, set once its entries are decoded
+    mutex_portable index_mutex; // Serializes decoding blocks of a mapped index
     ticks_chunk_t* chunks; // The in-memory chunk structures
     uint32_t num_chunks;   // Number of chunks in the chunks array
     enum file_mode_e mode;    // File mode (read or write)
+    ticks_verify_mode_e verify_mode; // When chunk checksums are verified on read
+    volatile uint8_t* verified_columns; // Byte per chunk, bit c set once column c was verified (TICKS_VERIFY_FIRST_TOUCH only), updated atomically
+    ticks_metrics_shard_t* metrics; // Per-thread runtime counters
+    uint64_t file_device;  // File identity used to key the decoded chunk cache
+    uint64_t file_inode;
+    uint8_t file_identity_valid; // Cleared when the identity could not be determined, disabling the cache
+    ticks_reorder_t reorder; // Reorder buffer for out-of-order ticks (write mode only)
+    direct_writer_t direct;  // Direct chunk writes (write mode only), off unless enabled with ticks_set_write_options
+    durability_t durability; // Checkpointing of appended chunks (write mode only), off unless enabled with ticks_set_write_options
+    mutex_portable write_mutex; // Serializes appends with the group commit thread's checkpoints
+    ticks_allocator_t allocator;        // Allocates the handle's buffers and those of its iterators and scans
+    ticks_allocator_t handle_allocator; // Allocated the handle structure itself
 };
 
 struct ticks_iterator_t_internal {
     ticks_file_t* file_handle;
     time_t from;
     time_t to;
+    uint64_t from_ms;      // Range start in milliseconds (inclusive)
+    uint64_t to_ms;        // Range end in milliseconds (exclusive)
+    uint32_t column_mask;  // Projected columns, always including the timestamp
+    uint32_t num_columns;  // Number of projected columns, the stride of rows
+    uint32_t read_mask;    // Projected and predicate columns
+    ticks_predicate_t predicates[TICKS_MAX_PREDICATES + 1]; // The caller's predicates followed by the time range
+    uint32_t num_predicates; // 0 without predicates of the caller's
     uint32_t current_chunk;
     uint32_t current_record_in_chunk;
+    uint8_t* chunk_buffer; // Raw chunk bytes as read from the file
+    size_t chunk_buffer_capacity;
+    uint64_t* rows;        // Decoded row-major records of the current chunk when not using the cache
+    uint32_t rows_capacity;
+    const uint64_t* current_rows; // Rows of the current chunk, either rows or cache_entry's
+    ticks_cache_entry_t* cache_entry; // Pinned cache entry holding the current chunk, or NULL
+    uint32_t num_records;  // Number of decoded records in the current chunk
+    uint8_t chunk_loaded;  // Set when current_rows holds current_chunk
+    ticks_allocator_t allocator; // The handle's allocator when the iterator was created
 };
 #endif // TICKSIO_INTERNAL_H
\ No newline at end of file
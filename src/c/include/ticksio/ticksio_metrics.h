@@ -0,0 +1,77 @@
+#ifndef TICKSIO_METRICS_H
+#define TICKSIO_METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ticksio/ticksio_types.h"
+#include "ticksio/ticksio_platform.h"
+
+// Counters are kept in per-thread shards so the hot path is a relaxed atomic add on a
+// cache line no other thread is normally writing to. Threads beyond the shard count share shards.
+#define TICKS_METRICS_SHARDS 16
+#define TICKS_METRICS_CACHE_LINE 64
+
+typedef enum {
+    METRIC_BYTES_WRITTEN,
+    METRIC_BYTES_READ,
+    METRIC_CHUNKS_WRITTEN,
+    METRIC_CHUNKS_READ,
+    METRIC_ROWS_ENCODED,
+    METRIC_ROWS_DECODED,
+    METRIC_ENCODE_NS,
+    METRIC_DECODE_NS,
+    METRIC_IO_NS,
+    METRIC_CHECKSUM_NS,
+    METRIC_COMPRESSION_NS,
+    METRIC_INDEX_LOOKUPS,
+    METRIC_CACHE_HITS,
+    METRIC_CACHE_MISSES,
+    METRIC_LATE_TICKS,
+    METRIC_CHUNKS_SKIPPED,
+    METRIC_COUNT
+} ticks_metric_e;
+
+// One counter per metric, padded to whole cache lines so neighbouring shards do not share a line
+#define TICKS_METRICS_SHARD_VALUES \
+    ((METRIC_COUNT * sizeof(uint64_t) + TICKS_METRICS_CACHE_LINE - 1) / TICKS_METRICS_CACHE_LINE * TICKS_METRICS_CACHE_LINE / sizeof(uint64_t))
+
+typedef struct {
+    volatile uint64_t values[TICKS_METRICS_SHARD_VALUES];
+} ticks_metrics_shard_t;
+
+/*
+* @brief Allocates zeroed metric shards for a handle
+* @param allocator Allocator of the handle
+* @return Pointer to TICKS_METRICS_SHARDS shards, NULL on allocation failure
+*/
+ticks_metrics_shard_t* metrics_create(const ticks_allocator_t* allocator);
+
+/*
+* @brief Frees metric shards allocated with allocator
+*/
+void metrics_destroy(const ticks_allocator_t* allocator, ticks_metrics_shard_t* shards);
+
+/*
+* @brief Returns the calling thread's shard index
+*/
+uint32_t metrics_thread_shard(void);
+
+/*
+* @brief Adds a value to a counter in the calling thread's shard
+* @param shards Metric shards of the handle (may be NULL, then nothing is recorded)
+* @param metric Counter to update
+* @param value Amount to add
+*/
+static inline void metrics_add(ticks_metrics_shard_t* shards, ticks_metric_e metric, uint64_t value) {
+    if (shards != NULL)
+        atomic_add_u64_portable(&shards[metrics_thread_shard()].values[metric], value);
+}
+
+/*
+* @brief Sums all shards into a ticks_metrics_t
+*/
+void metrics_collect(const ticks_metrics_shard_t* shards, ticks_metrics_t* out_metrics);
+
+#endif // TICKSIO_METRICS_H
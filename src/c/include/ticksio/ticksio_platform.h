@@ -1,8 +1,29 @@
 #ifndef TICKSIO_PLATFORM_H
 #define TICKSIO_PLATFORM_H
 
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <time.h>
 
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+#if defined(__linux__)
+    #include <poll.h>
+    #include <sys/inotify.h>
+#endif
+
 // Portable implementation of timegm for Windows and other platforms
 static time_t timegm_portable(struct tm *t) {
     #if defined(_WIN32)
@@ -12,4 +33,677 @@ static time_t timegm_portable(struct tm *t) {
     #endif
 }
 
+// Portable 64-bit file positioning
+static inline int fseek64_portable(FILE *file, int64_t offset, int origin) {
+    #if defined(_WIN32)
+        return _fseeki64(file, offset, origin);
+    #else
+        return fseeko(file, (off_t)offset, origin);
+    #endif
+}
+
+static inline int64_t ftell64_portable(FILE *file) {
+    #if defined(_WIN32)
+        return _ftelli64(file);
+    #else
+        return (int64_t)ftello(file);
+    #endif
+}
+
+// Positional read of exactly length bytes at offset that leaves the stream position untouched,
+// so several threads can read through one FILE. Returns 0 on success, -1 on error or short read.
+static inline int read_at_portable(FILE *file, void *buffer, size_t length, uint64_t offset) {
+    uint8_t *out = (uint8_t*)buffer;
+    #if defined(_WIN32)
+        HANDLE os_handle = (HANDLE)_get_osfhandle(_fileno(file));
+        if (os_handle == INVALID_HANDLE_VALUE)
+            return -1;
+        while (length > 0) {
+            OVERLAPPED overlapped;
+            DWORD request = length > 0x40000000u ? 0x40000000u : (DWORD)length;
+            DWORD bytes_read = 0;
+            memset(&overlapped, 0, sizeof(overlapped));
+            overlapped.Offset = (DWORD)offset;
+            overlapped.OffsetHigh = (DWORD)(offset >> 32);
+            if (!ReadFile(os_handle, out, request, &bytes_read, &overlapped) || bytes_read == 0)
+                return -1;
+            out += bytes_read;
+            offset += bytes_read;
+            length -= bytes_read;
+        }
+        return 0;
+    #else
+        const int fd = fileno(file);
+        while (length > 0) {
+            ssize_t bytes_read = pread(fd, out, length, (off_t)offset);
+            if (bytes_read < 0 && errno == EINTR)
+                continue;
+            if (bytes_read <= 0)
+                return -1;
+            out += bytes_read;
+            offset += (uint64_t)bytes_read;
+            length -= (size_t)bytes_read;
+        }
+        return 0;
+    #endif
+}
+
+// Maps [offset, offset + length) of a file read-only. The mapping starts at the enclosing page boundary,
+// out_base/out_length describe the whole mapping and the return value points at offset within it.
+// Returns NULL when the region cannot be mapped, callers then fall back to reading.
+static inline void* map_file_region_portable(FILE *file, uint64_t offset, uint64_t length, void **out_base, size_t *out_length) {
+    #if defined(_WIN32)
+        (void)file; (void)offset; (void)length; (void)out_base; (void)out_length;
+        return NULL;
+    #else
+        long page_size = sysconf(_SC_PAGESIZE);
+        if (page_size <= 0 || length == 0)
+            return NULL;
+
+        uint64_t aligned_offset = offset - (offset % (uint64_t)page_size);
+        size_t map_length = (size_t)(length + (offset - aligned_offset));
+
+        void *base = mmap(NULL, map_length, PROT_READ, MAP_SHARED, fileno(file), (off_t)aligned_offset);
+        if (base == MAP_FAILED)
+            return NULL;
+
+        *out_base = base;
+        *out_length = map_length;
+        return (uint8_t*)base + (offset - aligned_offset);
+    #endif
+}
+
+static inline void unmap_file_region_portable(void *base, size_t length) {
+    #if defined(_WIN32)
+        (void)base; (void)length;
+    #else
+        if (base != NULL)
+            munmap(base, length);
+    #endif
+}
+
+// Aligned heap blocks, released with aligned_free_portable
+static inline void* aligned_alloc_portable(size_t alignment, size_t size) {
+    #if defined(_WIN32)
+        return _aligned_malloc(size, alignment);
+    #else
+        void *ptr = NULL;
+        if (alignment < sizeof(void*))
+            alignment = sizeof(void*);
+        return posix_memalign(&ptr, alignment, size) == 0 ? ptr : NULL;
+    #endif
+}
+
+static inline void aligned_free_portable(void *ptr) {
+    #if defined(_WIN32)
+        _aligned_free(ptr);
+    #else
+        free(ptr);
+    #endif
+}
+
+// Maps length bytes (a multiple of hugepage_size) of zeroed anonymous memory aligned to hugepage_size, backed by
+// hugepages where possible: reserved MAP_HUGETLB pages first, then transparent hugepages through madvise.
+// Returns NULL when no mapping could be made, callers then fall back to the heap.
+static inline void* huge_map_portable(size_t length, size_t hugepage_size) {
+    #if defined(_WIN32)
+        SIZE_T large_page = GetLargePageMinimum();
+        if (large_page != 0 && length % large_page == 0) {
+            void *base = VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (base != NULL)
+                return base;
+        }
+        (void)hugepage_size;
+        return VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    #else
+        #if defined(MAP_HUGETLB)
+            void *huge = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (huge != MAP_FAILED)
+                return huge;
+        #endif
+
+        // Over-map by one hugepage and trim so the block starts on a hugepage boundary
+        uint8_t *base = mmap(NULL, length + hugepage_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == (uint8_t*)MAP_FAILED)
+            return NULL;
+        size_t lead = (hugepage_size - ((uintptr_t)base % hugepage_size)) % hugepage_size;
+        if (lead != 0)
+            munmap(base, lead);
+        munmap(base + lead + length, hugepage_size - lead);
+        #if defined(MADV_HUGEPAGE)
+            madvise(base + lead, length, MADV_HUGEPAGE);
+        #endif
+        return base + lead;
+    #endif
+}
+
+static inline void huge_unmap_portable(void *base, size_t length) {
+    #if defined(_WIN32)
+        (void)length;
+        VirtualFree(base, 0, MEM_RELEASE);
+    #else
+        munmap(base, length);
+    #endif
+}
+
+// Opens a second write descriptor on the file of a stream that bypasses the page cache (O_DIRECT).
+// Writes through it must use buffers, lengths and offsets aligned to the device's logical block size.
+// Returns -1 where direct I/O is unavailable, callers then keep writing through the stream.
+static inline int open_direct_portable(FILE *file) {
+    #if defined(__linux__) && defined(O_DIRECT)
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", fileno(file));
+        return open(path, O_WRONLY | O_DIRECT);
+    #else
+        (void)file;
+        return -1;
+    #endif
+}
+
+// Clears O_DIRECT on a descriptor from open_direct_portable, for filesystems that accept the open but refuse the writes
+static inline int direct_disable_portable(int fd) {
+    #if defined(__linux__) && defined(O_DIRECT)
+        int flags = fcntl(fd, F_GETFL);
+        return flags == -1 ? -1 : fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+    #else
+        (void)fd;
+        return -1;
+    #endif
+}
+
+static inline void close_fd_portable(int fd) {
+    #if defined(_WIN32)
+        _close(fd);
+    #else
+        close(fd);
+    #endif
+}
+
+// Positional write of exactly length bytes at offset. Returns 0 on success, -1 on error with errno set.
+static inline int write_at_portable(int fd, const void *buffer, size_t length, uint64_t offset) {
+    #if defined(_WIN32)
+        (void)fd; (void)buffer; (void)length; (void)offset;
+        errno = ENOSYS;
+        return -1;
+    #else
+        const uint8_t *in = (const uint8_t*)buffer;
+        while (length > 0) {
+            ssize_t written = pwrite(fd, in, length, (off_t)offset);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                return -1;
+            in += written;
+            offset += (uint64_t)written;
+            length -= (size_t)written;
+        }
+        return 0;
+    #endif
+}
+
+// Cuts a file off at length, the stream must have been flushed. Returns 0 on success, -1 on error.
+static inline int truncate_file_portable(FILE *file, uint64_t length) {
+    #if defined(_WIN32)
+        return _chsize_s(_fileno(file), (__int64)length) == 0 ? 0 : -1;
+    #else
+        return ftruncate(fileno(file), (off_t)length) == 0 ? 0 : -1;
+    #endif
+}
+
+// Forces a file's written data to stable storage. Returns 0 on success, -1 on error.
+static inline int sync_file_portable(FILE *file) {
+    #if defined(_WIN32)
+        return _commit(_fileno(file)) == 0 ? 0 : -1;
+    #elif defined(__linux__)
+        return fdatasync(fileno(file)) == 0 ? 0 : -1;
+    #else
+        return fsync(fileno(file)) == 0 ? 0 : -1;
+    #endif
+}
+
+// Watches a file for appended data (inotify). Returns -1 where change notifications are unavailable, callers then poll.
+static inline int file_watch_open_portable(const char *path) {
+    #if defined(__linux__)
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd == -1)
+            return -1;
+        if (inotify_add_watch(fd, path, IN_MODIFY | IN_CLOSE_WRITE) == -1) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    #else
+        (void)path;
+        return -1;
+    #endif
+}
+
+// Waits up to timeout_ms for a file watched by file_watch_open_portable to change, consuming the pending notifications.
+// Changes made since the last wait return at once. Returns 1 on a change, 0 on timeout, -1 on error.
+static inline int file_watch_wait_portable(int watch, uint32_t timeout_ms) {
+    #if defined(__linux__)
+        struct pollfd pending;
+        pending.fd = watch;
+        pending.events = POLLIN;
+        pending.revents = 0;
+        int ready = poll(&pending, 1, timeout_ms > INT32_MAX ? INT32_MAX : (int)timeout_ms);
+        if (ready <= 0)
+            return ready == 0 || errno == EINTR ? 0 : -1;
+
+        // The events only say that the file changed, followers find out what changed from the file itself
+        char events[4096];
+        while (read(watch, events, sizeof(events)) > 0) {
+        }
+        return 1;
+    #else
+        (void)watch; (void)timeout_ms;
+        return -1;
+    #endif
+}
+
+static inline void file_watch_close_portable(int watch) {
+    #if defined(__linux__)
+        if (watch != -1)
+            close(watch);
+    #else
+        (void)watch;
+    #endif
+}
+
+static inline void sleep_ms_portable(uint32_t ms) {
+    #if defined(_WIN32)
+        Sleep(ms);
+    #else
+        struct timespec duration;
+        duration.tv_sec = ms / 1000;
+        duration.tv_nsec = (long)(ms % 1000) * 1000000L;
+        while (nanosleep(&duration, &duration) == -1 && errno == EINTR) {
+        }
+    #endif
+}
+
+// Reads a path's modification time (ns since epoch), size and whether it is a directory. Returns 0 on success, -1 on error.
+static inline int file_stat_portable(const char *path, uint64_t *out_mtime_ns, uint64_t *out_size, int *out_is_dir) {
+    #if defined(_WIN32)
+        WIN32_FILE_ATTRIBUTE_DATA info;
+        if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info))
+            return -1;
+        // FILETIME counts 100ns intervals since 1601-01-01
+        const uint64_t ticks = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+        *out_mtime_ns = (ticks - 116444736000000000ull) * 100;
+        *out_size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+        *out_is_dir = (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        return 0;
+    #else
+        struct stat st;
+        if (stat(path, &st) != 0)
+            return -1;
+        #if defined(__APPLE__)
+            *out_mtime_ns = (uint64_t)st.st_mtimespec.tv_sec * 1000000000ull + (uint64_t)st.st_mtimespec.tv_nsec;
+        #else
+            *out_mtime_ns = (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+        #endif
+        *out_size = (uint64_t)st.st_size;
+        *out_is_dir = S_ISDIR(st.st_mode);
+        return 0;
+    #endif
+}
+
+// Replaces dst with src in one step, so readers see either the old or the new file. Returns 0 on success, -1 on error.
+static inline int rename_replace_portable(const char *src, const char *dst) {
+    #if defined(_WIN32)
+        return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1;
+    #else
+        return rename(src, dst) == 0 ? 0 : -1;
+    #endif
+}
+
+// Directory listing, entries are returned by name in no particular order and include "." and ".."
+#if defined(_WIN32)
+    typedef struct {
+        HANDLE find;
+        WIN32_FIND_DATAA data;
+        int pending; // Set while data holds an entry not returned yet
+    } dir_portable;
+
+    static inline int dir_open_portable(dir_portable *dir, const char *path) {
+        char pattern[MAX_PATH];
+        if (snprintf(pattern, sizeof(pattern), "%s\\*", path) >= (int)sizeof(pattern))
+            return -1;
+        dir->find = FindFirstFileA(pattern, &dir->data);
+        dir->pending = dir->find != INVALID_HANDLE_VALUE;
+        return dir->pending ? 0 : -1;
+    }
+
+    // Returns 1 with the next entry's name, 0 once all were returned
+    static inline int dir_next_portable(dir_portable *dir, const char **out_name) {
+        if (!dir->pending && !FindNextFileA(dir->find, &dir->data))
+            return 0;
+        dir->pending = 0;
+        *out_name = dir->data.cFileName;
+        return 1;
+    }
+
+    static inline void dir_close_portable(dir_portable *dir) {
+        FindClose(dir->find);
+    }
+#else
+    typedef struct {
+        DIR *stream;
+    } dir_portable;
+
+    static inline int dir_open_portable(dir_portable *dir, const char *path) {
+        dir->stream = opendir(path);
+        return dir->stream != NULL ? 0 : -1;
+    }
+
+    // Returns 1 with the next entry's name, 0 once all were returned
+    static inline int dir_next_portable(dir_portable *dir, const char **out_name) {
+        struct dirent *entry = readdir(dir->stream);
+        if (entry == NULL)
+            return 0;
+        *out_name = entry->d_name;
+        return 1;
+    }
+
+    static inline void dir_close_portable(dir_portable *dir) {
+        closedir(dir->stream);
+    }
+#endif
+
+// Identifies the underlying file (device + inode, or volume serial + file index on Windows)
+static inline int file_identity_portable(FILE *file, uint64_t *out_device, uint64_t *out_inode) {
+    #if defined(_WIN32)
+        BY_HANDLE_FILE_INFORMATION info;
+        HANDLE os_handle = (HANDLE)_get_osfhandle(_fileno(file));
+        if (os_handle == INVALID_HANDLE_VALUE || !GetFileInformationByHandle(os_handle, &info))
+            return -1;
+        *out_device = info.dwVolumeSerialNumber;
+        *out_inode = ((uint64_t)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+        return 0;
+    #else
+        struct stat st;
+        if (fstat(fileno(file), &st) != 0)
+            return -1;
+        *out_device = (uint64_t)st.st_dev;
+        *out_inode = (uint64_t)st.st_ino;
+        return 0;
+    #endif
+}
+
+// Thread-local storage and relaxed 64-bit atomics
+#if defined(_MSC_VER)
+    #define THREAD_LOCAL_PORTABLE __declspec(thread)
+#else
+    #define THREAD_LOCAL_PORTABLE __thread
+#endif
+
+static inline void atomic_add_u64_portable(volatile uint64_t *target, uint64_t value) {
+    #if defined(_MSC_VER)
+        _InterlockedExchangeAdd64((volatile LONG64*)target, (LONG64)value);
+    #else
+        __atomic_fetch_add(target, value, __ATOMIC_RELAXED);
+    #endif
+}
+
+static inline uint64_t atomic_load_u64_portable(const volatile uint64_t *target) {
+    #if defined(_MSC_VER)
+        return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)target, 0, 0);
+    #else
+        return __atomic_load_n(target, __ATOMIC_RELAXED);
+    #endif
+}
+
+static inline uint32_t atomic_increment_u32_portable(volatile uint32_t *target) {
+    #if defined(_MSC_VER)
+        return (uint32_t)InterlockedIncrement((volatile LONG*)target);
+    #else
+        return __atomic_add_fetch(target, 1, __ATOMIC_RELAXED);
+    #endif
+}
+
+static inline uint8_t atomic_load_u8_portable(const volatile uint8_t *target) {
+    #if defined(_MSC_VER)
+        return *target;
+    #else
+        return __atomic_load_n(target, __ATOMIC_RELAXED);
+    #endif
+}
+
+static inline uint8_t atomic_load_acquire_u8_portable(const volatile uint8_t *target) {
+    #if defined(_MSC_VER)
+        const uint8_t value = *target;
+        _ReadWriteBarrier();
+        return value;
+    #else
+        return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+    #endif
+}
+
+static inline void atomic_store_release_u8_portable(volatile uint8_t *target, uint8_t value) {
+    #if defined(_MSC_VER)
+        _ReadWriteBarrier();
+        *target = value;
+    #else
+        __atomic_store_n(target, value, __ATOMIC_RELEASE);
+    #endif
+}
+
+static inline void atomic_or_u8_portable(volatile uint8_t *target, uint8_t bits) {
+    #if defined(_MSC_VER)
+        _InterlockedOr8((volatile char*)target, (char)bits);
+    #else
+        __atomic_fetch_or(target, bits, __ATOMIC_RELAXED);
+    #endif
+}
+
+// Acquire/release 64-bit atomics for single-producer single-consumer queues
+static inline uint64_t atomic_load_acquire_u64_portable(const volatile uint64_t *target) {
+    #if defined(_MSC_VER)
+        const uint64_t value = *target;
+        _ReadWriteBarrier();
+        return value;
+    #else
+        return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+    #endif
+}
+
+static inline void atomic_store_release_u64_portable(volatile uint64_t *target, uint64_t value) {
+    #if defined(_MSC_VER)
+        _ReadWriteBarrier();
+        *target = value;
+    #else
+        __atomic_store_n(target, value, __ATOMIC_RELEASE);
+    #endif
+}
+
+static inline void atomic_store_u64_portable(volatile uint64_t *target, uint64_t value) {
+    #if defined(_MSC_VER)
+        *target = value;
+    #else
+        __atomic_store_n(target, value, __ATOMIC_RELAXED);
+    #endif
+}
+
+// Hints that the caller is spinning on a value another thread will change
+static inline void cpu_relax_portable(void) {
+    #if defined(_MSC_VER)
+        YieldProcessor();
+    #elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+    #elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+    #endif
+}
+
+// Monotonic clock in nanoseconds
+static inline uint64_t monotonic_ns_portable(void) {
+    #if defined(_WIN32)
+        LARGE_INTEGER counter, frequency;
+        QueryPerformanceCounter(&counter);
+        QueryPerformanceFrequency(&frequency);
+        return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+    #else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    #endif
+}
+
+// Portable statically initialised mutex
+#if defined(_WIN32)
+    typedef SRWLOCK mutex_portable;
+    #define MUTEX_INIT_PORTABLE SRWLOCK_INIT
+
+    static inline void mutex_lock_portable(mutex_portable *mutex) { AcquireSRWLockExclusive(mutex); }
+    static inline void mutex_unlock_portable(mutex_portable *mutex) { ReleaseSRWLockExclusive(mutex); }
+#else
+    typedef pthread_mutex_t mutex_portable;
+    #define MUTEX_INIT_PORTABLE PTHREAD_MUTEX_INITIALIZER
+
+    static inline void mutex_lock_portable(mutex_portable *mutex) { pthread_mutex_lock(mutex); }
+    static inline void mutex_unlock_portable(mutex_portable *mutex) { pthread_mutex_unlock(mutex); }
+#endif
+
+// Portable condition variables, with mutexes initialised at runtime for structures that own one
+#if defined(_WIN32)
+    typedef CONDITION_VARIABLE cond_portable;
+
+    static inline void mutex_init_portable(mutex_portable *mutex) { InitializeSRWLock(mutex); }
+    static inline void mutex_destroy_portable(mutex_portable *mutex) { (void)mutex; }
+    static inline void cond_init_portable(cond_portable *cond) { InitializeConditionVariable(cond); }
+    static inline void cond_destroy_portable(cond_portable *cond) { (void)cond; }
+    static inline void cond_wait_portable(cond_portable *cond, mutex_portable *mutex) {
+        SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+    }
+    static inline void cond_broadcast_portable(cond_portable *cond) { WakeAllConditionVariable(cond); }
+    static inline void cond_timedwait_portable(cond_portable *cond, mutex_portable *mutex, uint32_t timeout_ms) {
+        SleepConditionVariableSRW(cond, mutex, timeout_ms, 0);
+    }
+#else
+    typedef pthread_cond_t cond_portable;
+
+    static inline void mutex_init_portable(mutex_portable *mutex) { pthread_mutex_init(mutex, NULL); }
+    static inline void mutex_destroy_portable(mutex_portable *mutex) { pthread_mutex_destroy(mutex); }
+    static inline void cond_init_portable(cond_portable *cond) { pthread_cond_init(cond, NULL); }
+    static inline void cond_destroy_portable(cond_portable *cond) { pthread_cond_destroy(cond); }
+    static inline void cond_wait_portable(cond_portable *cond, mutex_portable *mutex) { pthread_cond_wait(cond, mutex); }
+    static inline void cond_broadcast_portable(cond_portable *cond) { pthread_cond_broadcast(cond); }
+    static inline void cond_timedwait_portable(cond_portable *cond, mutex_portable *mutex, uint32_t timeout_ms) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(cond, mutex, &deadline);
+    }
+#endif
+
+// Portable one-time initialisation
+#if defined(_WIN32)
+    typedef INIT_ONCE once_flag_portable;
+    #define ONCE_FLAG_INIT_PORTABLE INIT_ONCE_STATIC_INIT
+
+    static BOOL CALLBACK call_once_trampoline_portable(PINIT_ONCE flag, PVOID fn, PVOID *context) {
+        (void)flag; (void)context;
+        ((void (*)(void))fn)();
+        return TRUE;
+    }
+
+    static inline void call_once_portable(once_flag_portable *flag, void (*fn)(void)) {
+        InitOnceExecuteOnce(flag, call_once_trampoline_portable, (PVOID)fn, NULL);
+    }
+#else
+    typedef pthread_once_t once_flag_portable;
+    #define ONCE_FLAG_INIT_PORTABLE PTHREAD_ONCE_INIT
+
+    static inline void call_once_portable(once_flag_portable *flag, void (*fn)(void)) {
+        pthread_once(flag, fn);
+    }
+#endif
+
+// Portable thread keys, the destructor is called with a thread's value when the thread exits
+#if defined(_WIN32)
+    typedef DWORD thread_key_portable;
+
+    static inline int thread_key_create_portable(thread_key_portable *key, void (*destructor)(void*)) {
+        *key = FlsAlloc((PFLS_CALLBACK_FUNCTION)destructor);
+        return *key == FLS_OUT_OF_INDEXES ? -1 : 0;
+    }
+
+    static inline void thread_key_set_portable(thread_key_portable key, void *value) { FlsSetValue(key, value); }
+#else
+    typedef pthread_key_t thread_key_portable;
+
+    static inline int thread_key_create_portable(thread_key_portable *key, void (*destructor)(void*)) {
+        return pthread_key_create(key, destructor) == 0 ? 0 : -1;
+    }
+
+    static inline void thread_key_set_portable(thread_key_portable key, void *value) { pthread_setspecific(key, value); }
+#endif
+
+// Portable threads. Functions follow the pthread signature, returning 0 on success.
+typedef void* (*thread_fn_portable)(void *arg);
+
+#if defined(_WIN32)
+    typedef HANDLE thread_portable;
+
+    typedef struct {
+        thread_fn_portable fn;
+        void *arg;
+    } thread_start_portable;
+
+    static DWORD WINAPI thread_trampoline_portable(LPVOID param) {
+        thread_start_portable start = *(thread_start_portable*)param;
+        free(param);
+        start.fn(start.arg);
+        return 0;
+    }
+
+    static inline int thread_create_portable(thread_portable *thread, thread_fn_portable fn, void *arg) {
+        thread_start_portable *start = (thread_start_portable*)malloc(sizeof(thread_start_portable));
+        if (start == NULL)
+            return -1;
+        start->fn = fn;
+        start->arg = arg;
+        *thread = CreateThread(NULL, 0, thread_trampoline_portable, start, 0, NULL);
+        if (*thread == NULL) {
+            free(start);
+            return -1;
+        }
+        return 0;
+    }
+
+    static inline int thread_join_portable(thread_portable thread) {
+        if (WaitForSingleObject(thread, INFINITE) != WAIT_OBJECT_0)
+            return -1;
+        CloseHandle(thread);
+        return 0;
+    }
+
+    static inline uint32_t cpu_count_portable(void) {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+    }
+#else
+    typedef pthread_t thread_portable;
+
+    static inline int thread_create_portable(thread_portable *thread, thread_fn_portable fn, void *arg) {
+        return pthread_create(thread, NULL, fn, arg) == 0 ? 0 : -1;
+    }
+
+    static inline int thread_join_portable(thread_portable thread) {
+        return pthread_join(thread, NULL) == 0 ? 0 : -1;
+    }
+
+    static inline uint32_t cpu_count_portable(void) {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (uint32_t)count : 1;
+    }
+#endif
+
 #endif // TICKSIO_PLATFORM_H
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef TICKSIO_REORDER_H
+#define TICKSIO_REORDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ticksio/ticksio_types.h"
+
+// Write-side reorder buffer. Ticks are held in a min-heap ordered by timestamp (then arrival) and
+// released once they fall out of the window, so slightly out-of-order feeds are written sorted.
+// A tick older than the last released one arrived beyond the window, it is counted as late and dropped.
+
+typedef struct {
+    uint64_t sequence; // Arrival order, keeps equal timestamps stable
+    uint64_t values[TICKS_MAX_COLUMNS]; // The row, values[0] is the timestamp
+} ticks_reorder_slot_t;
+
+typedef struct {
+    ticks_reorder_options_t options;
+    ticks_reorder_slot_t* heap;
+    uint32_t num_slots;
+    uint32_t capacity;
+    uint64_t next_sequence;
+    uint64_t max_seen_ms;  // Newest timestamp pushed so far
+    uint64_t released_ms;  // Timestamp of the last released tick, or the end of the last chunk written before
+    uint8_t has_released;
+    uint32_t num_columns;  // Values per row, set by the first reorder_push
+    uint64_t* output;      // Row-major ticks released by the last reorder_push/reorder_flush
+    uint64_t num_output;
+    uint64_t output_capacity;
+    const ticks_allocator_t* allocator; // Allocates heap and output, NULL for the process-wide allocator
+} ticks_reorder_t;
+
+/*
+* @brief Returns whether the options enable reordering
+*/
+int reorder_enabled(const ticks_reorder_options_t* options);
+
+/*
+* @brief Pushes ticks and collects the ones that left the window in output/num_output
+* @param reorder Reorder buffer
+* @param rows Row-major ticks in arrival order
+* @param num_rows Number of ticks
+* @param num_columns Values per row
+* @param out_late Pointer incremented by the number of ticks that arrived beyond the window and were dropped
+* @return Error code (OK = 0)
+*/
+ticks_status_e reorder_push(ticks_reorder_t* reorder, const uint64_t* rows, uint64_t num_rows, uint32_t num_columns, uint64_t* out_late);
+
+/*
+* @brief Releases every held tick in timestamp order into output/num_output
+* @param reorder Reorder buffer
+* @return Error code (OK = 0)
+*/
+ticks_status_e reorder_flush(ticks_reorder_t* reorder);
+
+/*
+* @brief Frees the reorder buffer's memory
+*/
+void reorder_release(ticks_reorder_t* reorder);
+
+#endif // TICKSIO_REORDER_H
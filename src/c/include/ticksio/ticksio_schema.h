@@ -0,0 +1,53 @@
+#ifndef TICKSIO_SCHEMA_H
+#define TICKSIO_SCHEMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ticksio/ticksio_types.h"
+
+/*
+* @brief Checks that a schema has 1 to TICKS_MAX_COLUMNS columns of known types and encodings,
+* with the timestamp as the first and only timestamp column
+* @param schema Schema to check
+* @return TICKS_OK or TICKS_ERROR_INVALID_ARGUMENTS
+*/
+ticks_status_e schema_validate(const ticks_schema_t* schema);
+
+/*
+* @brief Checks that predicates apply to columns of the schema and have min <= max in the column's ordering
+* @param schema Schema the predicates are evaluated against
+* @param predicates Predicates to check (may be NULL when num_predicates is 0)
+* @param num_predicates Number of predicates, at most TICKS_MAX_PREDICATES
+* @return TICKS_OK or TICKS_ERROR_INVALID_ARGUMENTS
+*/
+ticks_status_e schema_validate_predicates(const ticks_schema_t* schema, const ticks_predicate_t* predicates, uint32_t num_predicates);
+
+/*
+* @brief Column mask selecting the columns the predicates apply to
+*/
+uint32_t predicate_column_mask(const ticks_predicate_t* predicates, uint32_t num_predicates);
+
+/*
+* @brief Returns whether records of the schema have the trade_data_t layout
+*/
+int schema_has_trade_layout(const ticks_schema_t* schema);
+
+/*
+* @brief Column mask selecting every column of a schema
+*/
+uint32_t schema_all_columns(const ticks_schema_t* schema);
+
+/*
+* @brief Resolves a projection against a schema: 0 selects every column, bits past num_columns are dropped
+* and the timestamp column is always included
+*/
+uint32_t schema_projection(const ticks_schema_t* schema, uint32_t column_mask);
+
+/*
+* @brief Number of columns selected by a column mask
+*/
+uint32_t column_mask_count(uint32_t column_mask);
+
+#endif // TICKSIO_SCHEMA_H
@@ -0,0 +1,35 @@
+#ifndef TICKSIO_TRACE_H
+#define TICKSIO_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Hot-path tracing, enabled with the TICKSIO_TRACE CMake option. Each TICKS_TRACE_SCOPE records one
+// complete event (start and duration) into a per-thread ring buffer when the enclosing block exits.
+// Without TICKSIO_TRACE the macros expand to nothing.
+
+#if defined(TICKSIO_TRACE) && defined(__GNUC__)
+
+typedef struct {
+    const char* name;
+    uint64_t start_ns;
+} ticks_trace_scope_t;
+
+ticks_trace_scope_t trace_scope_begin(const char* name);
+void trace_scope_end(ticks_trace_scope_t* scope);
+
+#define TICKS_TRACE_CONCAT_INNER(a, b) a##b
+#define TICKS_TRACE_CONCAT(a, b) TICKS_TRACE_CONCAT_INNER(a, b)
+#define TICKS_TRACE_SCOPE(name) \
+    ticks_trace_scope_t TICKS_TRACE_CONCAT(trace_scope_, __LINE__) __attribute__((cleanup(trace_scope_end))) = trace_scope_begin(name)
+
+#else
+
+#define TICKS_TRACE_SCOPE(name) do {} while (0)
+
+#endif
+
+#endif // TICKSIO_TRACE_H
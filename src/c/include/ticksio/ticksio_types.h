@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stddef.h>
 #include "ticksio_constants.h"
 
 // --- Misc types ---
@@ -14,6 +15,15 @@ typedef struct {
     uint64_t price;
     uint64_t volume;
 } trade_data_t;
+// Top-of-book quote, row layout of the built-in TICKS_SCHEMA_QUOTES schema
+typedef struct {
+    uint64_t ms_since_epoch;
+    uint64_t bid;
+    uint64_t ask;
+    uint64_t bid_size;
+    uint64_t ask_size;
+    uint64_t flags;
+} quote_data_t;
 typedef uint8_t size_e;
 enum {
     SIZE_8BIT = 1,
@@ -44,6 +54,49 @@ enum {
     ENDIAN_LITTLE = 1,
     ENDIAN_BIG = 2
 };
+// Decides where chunks end. A chunk ends at whichever limit is reached first, zero fields are unlimited
+// (max_chunk_bytes = 0 selects TICKS_DEFAULT_CHUNK_BYTES). With bucket_ms set, a new chunk starts whenever a row
+// falls into a different bucket [bucket_origin_ms + k * bucket_ms, bucket_origin_ms + (k + 1) * bucket_ms),
+// e.g. bucket_ms = 3600000 for hourly chunks or 86400000 with the session open as origin for daily chunks.
+typedef struct {
+    uint32_t max_chunk_bytes;
+    uint32_t max_chunk_rows;
+    uint64_t bucket_ms;
+    uint64_t bucket_origin_ms;
+} ticks_chunk_policy_t;
+
+// --- Schema ---
+// Records are rows of one uint64_t per column. The first column is always the timestamp,
+// trade_data_t and quote_data_t are the row layouts of the built-in schemas.
+typedef uint8_t ticks_column_type_e;
+enum {
+    TICKS_COLUMN_TIMESTAMP = 1, // Milliseconds since epoch
+    TICKS_COLUMN_UINT = 2,      // Unsigned integer (prices in ticks, sizes, counts)
+    TICKS_COLUMN_INT = 3,       // Signed integer stored as two's complement
+    TICKS_COLUMN_FLAGS = 4,     // Bit field
+    TICKS_COLUMN_DECIMAL = 5    // Unsigned decimal stored as value * 10^scale (e.g. prices in cents with scale 2)
+};
+typedef uint8_t ticks_column_encoding_e;
+enum {
+    TICKS_ENCODING_AUTO = 0,  // Offset from the chunk minimum at the narrowest width that fits the chunk
+    TICKS_ENCODING_PLAIN = 1  // Full 64-bit values
+};
+typedef struct {
+    char name[TICKS_COLUMN_NAME_SIZE];
+    ticks_column_type_e type;
+    ticks_column_encoding_e encoding;
+    uint8_t scale; // Decimal places of a TICKS_COLUMN_DECIMAL column, 0 for other types
+} ticks_column_t;
+typedef struct {
+    uint8_t num_columns;
+    ticks_column_t columns[TICKS_MAX_COLUMNS];
+} ticks_schema_t;
+typedef uint8_t ticks_schema_kind_e;
+enum {
+    TICKS_SCHEMA_TRADES = 0, // ms_since_epoch, price, volume (trade_data_t)
+    TICKS_SCHEMA_QUOTES = 1  // ms_since_epoch, bid, ask, bid_size, ask_size, flags (quote_data_t)
+};
+
 typedef struct {
     char ticker[TICKS_TICKER_SIZE];
     char currency[TICKS_CURRENCY_SIZE];
@@ -51,33 +104,262 @@ typedef struct {
     char country[TICKS_COUNTRY_SIZE];
     compression_type_e compression_type;
     endian_e endianness;
+    ticks_chunk_policy_t chunk_policy; // Chunking policy used by all writers of the file
+    ticks_schema_t schema; // Record layout, num_columns = 0 at ticks_new_file selects TICKS_SCHEMA_TRADES
+    uint8_t flags;         // TICKS_HEADER_* bits, maintained by writers and ignored by ticks_new_file
 } ticks_header_t;
 
 // --- Index structures ---
+// Per-chunk codec of a column, chosen by the writer when it is smaller than frame-of-reference.
+// All codecs store values as value - base at the column's width.
+typedef uint8_t ticks_column_codec_e;
+enum {
+    TICKS_CODEC_FOR = 0,  // One value per record
+    TICKS_CODEC_RLE = 1,  // Run values followed by uint32 run lengths
+    TICKS_CODEC_DICT = 2  // Up to TICKS_DICT_MAX_VALUES dictionary values followed by one uint8 code per record
+};
+// How one column is stored within a chunk. Each column can be read and verified on its own.
+typedef struct {
+    uint64_t base;     // Values are stored as value - base
+    uint64_t max;      // Largest value of the column in the chunk, in the same units as base
+    uint32_t offset;   // Byte offset of the column from the start of the chunk
+    uint32_t size;     // Bytes of the column within the chunk
+    uint32_t checksum; // CRC32C of the column bytes
+    size_e width;      // Bytes per stored value
+    ticks_column_codec_e codec;
+    uint8_t scale_shift; // Decimal columns: values are divided by 10^scale_shift before being stored
+} ticks_column_chunk_t;
 typedef struct {
-    uint64_t chunk_time_base;
+    uint64_t chunk_time_base; // Earliest timestamp in the chunk, timestamps are stored as deltas from it
+    uint64_t chunk_max_time;  // Latest timestamp in the chunk
     uint64_t chunk_offset;
     uint32_t chunk_size;
-    size_e timestamp_size;
-    size_e price_size;
-    size_e volume_size;
+    uint32_t checksum; // CRC32C of the column checksums, identifies the chunk contents
+    uint32_t num_records;
+    uint32_t padding;  // Zero bytes after the chunk that align the next one (direct writes), 0 otherwise
+    ticks_column_chunk_t columns[TICKS_MAX_COLUMNS]; // Only the schema's num_columns are used
 } ticks_index_entry_t;
 typedef struct {
     uint32_t num_entries;
+    uint32_t capacity;
     ticks_index_entry_t* entries;
+    uint32_t sparse_stride; // Index entries covered by each sparse entry
+    uint32_t num_sparse;    // Number of sparse entries (0 when the sparse index is not available)
+    uint64_t* sparse;       // chunk_time_base of every sparse_stride-th index entry
 } ticks_index_t;
 
+// --- Open options ---
+typedef uint8_t ticks_index_mode_e;
+enum {
+    TICKS_INDEX_LOAD = 0, // Read and decode the whole index on open
+    TICKS_INDEX_MMAP = 1  // Map the index and decode each block of entries on first use
+};
+typedef uint8_t ticks_verify_mode_e;
+enum {
+    TICKS_VERIFY_FIRST_TOUCH = 0, // Verify each chunk the first time it is read through the handle
+    TICKS_VERIFY_ALWAYS = 1,      // Verify every chunk read, and the index even when it is mapped
+    TICKS_VERIFY_OFF = 2          // Never verify checksums
+};
+// Zero-initialise for the defaults
+typedef struct {
+    ticks_index_mode_e index_mode;
+    ticks_verify_mode_e verify_mode;
+    uint8_t follow; // Open a file still being written before its first checkpoint or header, with no chunks until ticks_refresh finds one
+} ticks_open_options_t;
+
+// --- Aggregation ---
+typedef struct {
+    uint64_t count; // Records in the range
+    uint64_t sum;   // Sum of the column over those records, modulo 2^64 (read as int64 for signed columns)
+} ticks_aggregate_t;
+
+// --- Predicates ---
+// Selects the records whose column value lies in [min, max], compared as int64 for signed columns.
+// Decimal columns are compared in their scaled units, e.g. a price of 101.37 is 10137 with a scale of 2.
+typedef struct {
+    uint32_t column; // Schema column the predicate applies to
+    uint64_t min;    // Smallest matching value, inclusive
+    uint64_t max;    // Largest matching value, inclusive
+} ticks_predicate_t;
+
+// --- Iterator options ---
+// Zero-initialise for the defaults
+typedef struct {
+    uint32_t column_mask; // Bit c selects schema column c, 0 selects all. The timestamp column is always included.
+    const ticks_predicate_t* predicates; // Only records matching all predicates are returned
+    uint32_t num_predicates;             // Up to TICKS_MAX_PREDICATES, predicate columns need not be projected
+} ticks_iterator_options_t;
+
+// --- Footer structures ---
+// The footer is the last thing in the file. footer_size and magic are the final
+// 8 bytes so a reader can locate the footer from EOF even if it grows later.
+// A checkpoint's index may only hold the entries from first_entry on, the earlier ones are in the index of the
+// footer at previous_footer. A complete index, as written on close, has both at 0.
+typedef struct {
+    uint64_t index_offset;
+    uint64_t index_size;
+    uint64_t num_entries;     // Entries up to the end of this index, including those before first_entry
+    uint64_t first_entry;
+    uint64_t previous_footer;
+    uint64_t sparse_index_offset;
+    uint32_t sparse_index_stride;
+    uint32_t num_sparse_entries;
+    uint32_t index_checksum;  // CRC32C of the index and sparse index
+    uint32_t footer_checksum; // CRC32C of the footer with this field set to zero
+    uint32_t footer_size;
+    char magic[4];
+} ticks_footer_t;
+
 // --- Chunk structures ---
 typedef struct {
-    uint64_t time_base;
+    uint64_t time_base; // Earliest timestamp in the chunk
+    uint64_t max_time;  // Latest timestamp in the chunk
     uint32_t num_records;
-    size_e timestamp_size;
-    size_e price_size;
-    size_e volume_size;
+    ticks_column_chunk_t columns[TICKS_MAX_COLUMNS];
+    uint32_t checksum; // CRC32C of the column checksums
     uint8_t* data;
     uint32_t data_size;
+    uint64_t compression_ns; // Time spent choosing and running the value codecs, not stored
 } ticks_chunk_t;
 
+// --- Metrics ---
+// Cumulative counters for a handle, summed over all threads that used it
+typedef struct {
+    uint64_t bytes_written;  // Chunk, index and footer bytes written
+    uint64_t bytes_read;     // Chunk bytes read
+    uint64_t chunks_written;
+    uint64_t chunks_read;
+    uint64_t rows_encoded;
+    uint64_t rows_decoded;
+    uint64_t encode_ns;      // Time spent encoding chunks
+    uint64_t decode_ns;      // Time spent decoding chunks
+    uint64_t io_ns;          // Time spent in file reads and writes
+    uint64_t checksum_ns;    // Time spent verifying chunk checksums on read
+    uint64_t compression_ns; // Time spent choosing codecs and running the run-length and dictionary codecs
+    uint64_t index_lookups;  // Time-based chunk lookups
+    uint64_t cache_hits;     // Decoded chunk cache hits
+    uint64_t cache_misses;   // Decoded chunk cache misses
+    uint64_t late_ticks;     // Ticks that arrived beyond the writer's reorder window and were dropped
+    uint64_t chunks_skipped; // Chunks a predicate ruled out from the index without reading them
+} ticks_metrics_t;
+
+// --- Writer reorder window ---
+// Ticks are held back and written in timestamp order until they are window_ms older than the newest tick
+// seen, or window_rows newer ticks are held. Both zero (the default) writes ticks in arrival order. Ticks older
+// than one already written are dropped and counted in the late_ticks metric.
+typedef struct {
+    uint64_t window_ms;
+    uint32_t window_rows;
+} ticks_reorder_options_t;
+
+// --- Compaction ---
+typedef struct {
+    ticks_chunk_policy_t chunk_policy; // Chunking policy of the output, all zero to keep the source file's policy
+    uint32_t range_rows;        // Rows each worker re-encodes at a time, 0 for TICKS_COMPACT_DEFAULT_RANGE_ROWS
+    uint32_t num_threads;       // Worker threads, 0 for one per CPU
+    ticks_verify_mode_e verify_mode; // Checksum verification applied to the source chunks
+} ticks_compact_policy_t;
+
+// --- Writer options ---
+typedef uint8_t ticks_write_io_e;
+enum {
+    TICKS_WRITE_BUFFERED = 0, // Chunks are written through the stdio stream and the page cache
+    TICKS_WRITE_DIRECT = 1    // Chunks bypass the page cache (O_DIRECT), falling back to buffered where refused
+};
+typedef uint8_t ticks_durability_e;
+enum {
+    TICKS_DURABILITY_NONE = 0,   // Nothing is synced, the file is durable once the OS writes it back after close
+    TICKS_DURABILITY_GROUP = 1,  // A background thread checkpoints every group_commit_chunks chunks or group_commit_ms
+    TICKS_DURABILITY_STRICT = 2  // Every add call that appends chunks checkpoints before returning
+};
+// Zero-initialise for the defaults
+typedef struct {
+    ticks_write_io_e io_mode;
+    uint32_t staging_bytes; // Direct writes: size of each of the two staging buffers, 0 for TICKS_DIRECT_STAGING_BYTES
+    ticks_durability_e durability;
+    uint32_t group_commit_chunks; // Group commit: chunks appended before a checkpoint, 0 for TICKS_GROUP_COMMIT_CHUNKS
+    uint32_t group_commit_ms;     // Group commit: longest wait before appended chunks are checkpointed, 0 for TICKS_GROUP_COMMIT_MS
+} ticks_write_options_t;
+
+// --- Follow options ---
+// Zero-initialise for the defaults
+typedef struct {
+    uint32_t poll_ms;   // Polling interval where change notifications are unavailable, 0 for TICKS_FOLLOW_POLL_MS
+    uint8_t from_start; // Deliver the chunks already in the file first instead of only those checkpointed after opening
+} ticks_follow_options_t;
+
+// --- Async writer options ---
+typedef uint8_t ticks_backpressure_e;
+enum {
+    TICKS_BACKPRESSURE_BLOCK = 0,  // A push waits for room in the queue
+    TICKS_BACKPRESSURE_DROP = 1,   // A push that does not fit is dropped and counted
+    TICKS_BACKPRESSURE_REPORT = 2  // A push that does not fit fails with TICKS_ERROR_QUEUE_FULL
+};
+// Zero-initialise for the defaults
+typedef struct {
+    uint32_t queue_rows;    // Rows the queue holds, rounded up to a power of two, 0 for TICKS_ASYNC_QUEUE_ROWS
+    uint32_t batch_rows;    // Rows the encoder thread collects before adding them to the file, 0 for TICKS_ASYNC_BATCH_ROWS
+    uint32_t flush_ms;      // Longest time collected rows wait for a full batch, 0 for TICKS_ASYNC_FLUSH_MS
+    ticks_backpressure_e backpressure;
+} ticks_async_options_t;
+
+typedef struct {
+    uint64_t pushed_rows;     // Rows accepted into the queue
+    uint64_t dropped_rows;    // Rows dropped with TICKS_BACKPRESSURE_DROP
+    uint64_t rejected_pushes; // Pushes failed with TICKS_ERROR_QUEUE_FULL
+    uint64_t blocked_pushes;  // Pushes that waited for room with TICKS_BACKPRESSURE_BLOCK
+    uint64_t written_rows;    // Rows added to the file by the encoder thread
+    uint64_t depth;           // Rows in the queue now
+    uint64_t max_depth;       // Most rows the encoder thread found queued at once
+    uint64_t mean_latency_ns; // Mean time from push until the encoder thread took a row off the queue
+    uint64_t max_latency_ns;
+} ticks_async_stats_t;
+
+// --- Datasets ---
+typedef uint8_t ticks_catalog_refresh_e;
+enum {
+    TICKS_CATALOG_REFRESH = 0, // Check every file's modification time and size, re-read only new or changed files
+    TICKS_CATALOG_TRUST = 1    // Use the stored catalog without looking at the files, list them only if there is none
+};
+// Zero-initialise for the defaults
+typedef struct {
+    ticks_catalog_refresh_e refresh;
+    uint32_t num_threads; // Threads reading new files and running queries, 0 for the number of CPUs
+    uint8_t read_only;    // Never write the catalog, e.g. for a directory the process cannot write to
+} ticks_dataset_options_t;
+// One file of a dataset, as recorded in its catalog
+typedef struct {
+    char symbol[TICKS_TICKER_SIZE]; // Ticker of the file's header, zero-padded, not NUL-terminated when it fills the field
+    uint64_t min_time;    // Earliest timestamp of the file's chunks (ms since epoch), UINT64_MAX when it has none
+    uint64_t max_time;    // Latest timestamp of the file's chunks (ms since epoch), 0 when it has none
+    uint64_t num_records;
+    uint32_t num_chunks;
+    const char* path;     // Relative to the dataset directory, owned by the dataset
+} ticks_partition_t;
+
+// --- Memory allocation ---
+// Callbacks every library allocation goes through. Blocks from aligned_alloc are released with
+// aligned_free, all others with free. user is passed to each callback unchanged.
+typedef struct {
+    void* (*alloc)(size_t size, void* user);
+    void* (*realloc)(void* ptr, size_t size, void* user);
+    void (*free)(void* ptr, void* user);
+    void* (*aligned_alloc)(size_t alignment, size_t size, void* user); // alignment is a power of two
+    void (*aligned_free)(void* ptr, void* user);
+    void* user;
+} ticks_allocator_t;
+
+// --- Decoded chunk cache ---
+typedef struct {
+    uint64_t budget_bytes; // Configured budget, 0 when the cache is disabled
+    uint64_t used_bytes;   // Bytes held by cached entries (pinned entries may exceed the budget)
+    uint64_t entries;
+    uint64_t pinned;       // Entries currently in use by at least one iterator
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} ticks_cache_stats_t;
+
 /* 
 * @brief Error codes for ticksio operations (0 = success, negative = error)
 */
@@ -89,12 +371,25 @@ typedef enum {
     TICKS_ERROR_FILE_IO = -4,
     TICKS_ERROR_MEMORY_ALLOCATION = -5,
     TICKS_ERROR_INVALID_FORMAT = -6,
-    TICKS_ERROR_EMPTY_CHUNK = -7
+    TICKS_ERROR_EMPTY_CHUNK = -7,
+    TICKS_ERROR_CHECKSUM_MISMATCH = -8,
+    TICKS_ERROR_QUEUE_FULL = -9
 } ticks_status_e;
 
 // Opaque ticks file handle type
 typedef struct ticks_file_t_internal ticks_file_t;
 // Opaque ticks file iterator type
 typedef struct ticks_iterator_t_internal ticks_iterator_t;
+// Opaque follower of a file being appended to
+typedef struct ticks_follower_t_internal ticks_follower_t;
+// Opaque queue feeding a write handle from a background thread
+typedef struct ticks_async_writer_t_internal ticks_async_writer_t;
+// Opaque directory of ticks files and its catalog
+typedef struct ticks_dataset_t_internal ticks_dataset_t;
+
+// Called by ticks_scan with each batch of row-major records. Returning anything but TICKS_OK stops the scan.
+typedef ticks_status_e (*ticks_batch_cb)(const uint64_t* rows, uint32_t num_rows, void* user);
+// Called by ticks_dataset_scan with each batch of a partition's records, from several threads at once
+typedef ticks_status_e (*ticks_partition_cb)(uint32_t partition, const uint64_t* rows, uint32_t num_rows, void* user);
 
 #endif // TICKS_TYPES_H
@@ -1,9 +1,37 @@
 #include "ticksio/ticksio.h"
 
 #include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_alloc.h"
 #include "ticksio/ticksio_chunks.h"
 #include "ticksio/ticksio_index.h"
-#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_crc32c.h"
+#include "ticksio/ticksio_schema.h"
+#include "ticksio/ticksio_trace.h"
+#include "ticksio/ticksio_platform.h"
+
+// Helper function to allocate a zeroed handle that allocates through a copy of the process-wide allocator
+static struct ticks_file_t_internal* alloc_handle(void) {
+    const ticks_allocator_t* allocator = mem_global_allocator();
+    struct ticks_file_t_internal* handle = mem_alloc(allocator, sizeof(struct ticks_file_t_internal));
+    if (handle == NULL)
+        return NULL;
+    memset(handle, 0, sizeof(struct ticks_file_t_internal));
+    handle->allocator = *allocator;
+    handle->handle_allocator = *allocator;
+    handle->reorder.allocator = &handle->allocator;
+    handle->direct.fd = -1;
+    mutex_init_portable(&handle->write_mutex);
+    mutex_init_portable(&handle->index_mutex);
+    return handle;
+}
+
+// Helper function to free the handle structure through the allocator it came from
+static void free_handle(struct ticks_file_t_internal* handle) {
+    const ticks_allocator_t allocator = handle->handle_allocator;
+    mutex_destroy_portable(&handle->write_mutex);
+    mutex_destroy_portable(&handle->index_mutex);
+    mem_free(&allocator, handle);
+}
 
 // Helper function to write the magic and header
 static ticks_status_e write_initial_data(FILE *file, struct ticks_file_t_internal* handle) {
@@ -12,66 +40,521 @@ static ticks_status_e write_initial_data(FILE *file, struct ticks_file_t_interna
     if (fwrite(TICKS_MAGIC, 1, magic_len, file) != magic_len)
         return TICKS_ERROR_FILE_IO;
 
+    handle->version = TICKS_FORMAT_VERSION;
+    if (fwrite(&handle->version, 1, sizeof(uint16_t), file) != sizeof(uint16_t))
+        return TICKS_ERROR_FILE_IO;
+
     if (fwrite(&handle->header, 1, sizeof(ticks_header_t), file) != sizeof(ticks_header_t))
         return TICKS_ERROR_FILE_IO;
     
-    long current_offset_long = ftell(file);
-    if (current_offset_long == -1L)
-        return TICKS_ERROR_FILE_IO;
-
-    // Offset after header + index_offset size (uint64_t) + index_size size (uint64_t)
-    uint64_t index_start_offset = (uint64_t)current_offset_long + sizeof(uint64_t) + sizeof (uint64_t);
-    if (fwrite(&index_start_offset, 1, sizeof(uint64_t), file) != sizeof(uint64_t))
+    int64_t current_offset = ftell64_portable(file);
+    if (current_offset == -1)
         return TICKS_ERROR_FILE_IO;
 
-    handle->index_offset = index_start_offset;
+    // Chunks are appended directly after the header, the index and footer follow them on close
+    handle->write_offset = (uint64_t)current_offset;
+    handle->index_offset = 0;
     handle->index_size = 0;
-    
-    // Index size is initially zero, a temporary placeholder is used to safely pass 0 value
-    uint64_t zero_placeholder = 0;
-    if (fwrite(&zero_placeholder, 1, sizeof(uint64_t), file) != sizeof(uint64_t))
-        return TICKS_ERROR_FILE_IO;
+    handle->index_dirty = 1;
 
     handle->index.num_entries = 0;
+    handle->index.capacity = 0;
     handle->index.entries = NULL;
     
     return TICKS_OK;
 }
 
-// Helper function to read the index table
-static ticks_status_e read_index_table(FILE *file, struct ticks_file_t_internal* handle) {
+// Helper function to compute where chunks start, directly after the magic, version and header
+static uint64_t data_start_offset(void) {
+    return strlen(TICKS_MAGIC) + sizeof(uint16_t) + sizeof(ticks_header_t);
+}
+
+// Helper function to read and validate the magic, version and header. Returns TICKS_EOF when the file ends before
+// them but the bytes it holds agree with a valid header, as for a file ticks_new_file is still creating.
+static ticks_status_e read_file_header(FILE *file, struct ticks_file_t_internal* handle) {
+    const size_t magic_len = strlen(TICKS_MAGIC);
+    uint8_t buffer[sizeof(TICKS_MAGIC) - 1 + sizeof(uint16_t) + sizeof(ticks_header_t)];
+    if (fseek64_portable(file, 0, SEEK_SET) != 0)
+        return TICKS_ERROR_FILE_IO;
+    const size_t length = fread(buffer, 1, sizeof(buffer), file);
+    if (length < sizeof(buffer) && ferror(file))
+        return TICKS_ERROR_FILE_IO;
+
+    if (memcmp(buffer, TICKS_MAGIC, length < magic_len ? length : magic_len) != 0)
+        return TICKS_ERROR_INVALID_FORMAT;
+    if (length >= magic_len + sizeof(uint16_t)) {
+        memcpy(&handle->version, buffer + magic_len, sizeof(uint16_t));
+        if (handle->version != TICKS_FORMAT_VERSION)
+            return TICKS_ERROR_INVALID_FORMAT;
+    }
+    if (length < sizeof(buffer))
+        return TICKS_EOF;
+
+    memcpy(&handle->header, buffer + magic_len + sizeof(uint16_t), sizeof(ticks_header_t));
+    return schema_validate(&handle->header.schema) == TICKS_OK ? TICKS_OK : TICKS_ERROR_INVALID_FORMAT;
+}
+
+// Helper function to validate a footer found at footer_offset and describe the index it points to
+static ticks_status_e parse_footer(ticks_footer_t footer, uint64_t footer_offset, int verify, const struct ticks_file_t_internal* handle,
+                                   index_segment_t* out_segment) {
+    if (strncmp(footer.magic, TICKS_FOOTER_MAGIC, sizeof(footer.magic)) != 0 || footer.footer_size != sizeof(ticks_footer_t))
+        return TICKS_ERROR_INVALID_FORMAT;
+
+    // The footer checksum is computed with its own field zeroed
+    uint32_t footer_checksum = footer.footer_checksum;
+    footer.footer_checksum = 0;
+    if (verify && crc32c(0, &footer, sizeof(ticks_footer_t)) != footer_checksum)
+        return TICKS_ERROR_CHECKSUM_MISMATCH;
+
+    // The index must sit between the header and the footer and hold the entries from first_entry on
+    if (footer.index_offset > footer_offset || footer.index_size > footer_offset - footer.index_offset ||
+        footer.index_size % TICKS_INDEX_ALIGNMENT != 0 || footer.num_entries > UINT32_MAX || footer.first_entry > footer.num_entries ||
+        footer.num_entries - footer.first_entry > footer.index_size / index_entry_min_bytes(handle->header.schema.num_columns))
+        return TICKS_ERROR_INVALID_FORMAT;
+
+    // A checkpoint holding only the later entries points back to an earlier footer, a complete index does not
+    if (footer.first_entry == 0 ? footer.previous_footer != 0
+                                : footer.previous_footer == 0 || footer.previous_footer > footer.index_offset ||
+                                      footer.index_offset - footer.previous_footer < sizeof(ticks_footer_t))
+        return TICKS_ERROR_INVALID_FORMAT;
+
+    // The sparse index follows the index and covers every sparse_index_stride-th entry from first_entry on
+    const uint64_t indexed = footer.num_entries - footer.first_entry;
+    if (footer.sparse_index_stride == 0 ||
+        footer.num_sparse_entries != (indexed + footer.sparse_index_stride - 1) / footer.sparse_index_stride ||
+        footer.sparse_index_offset != footer.index_offset + footer.index_size ||
+        (uint64_t)footer.num_sparse_entries * TICKS_SPARSE_ENTRY_SIZE != footer_offset - footer.sparse_index_offset)
+        return TICKS_ERROR_INVALID_FORMAT;
+
+    out_segment->footer_offset = footer_offset;
+    out_segment->index_offset = footer.index_offset;
+    out_segment->index_size = footer.index_size;
+    out_segment->first_entry = (uint32_t)footer.first_entry;
+    out_segment->num_entries = (uint32_t)footer.num_entries;
+    out_segment->previous_footer = footer.previous_footer;
+    out_segment->sparse_stride = footer.sparse_index_stride;
+    out_segment->num_sparse = footer.num_sparse_entries;
+    out_segment->index_checksum = footer.index_checksum;
+
+    return TICKS_OK;
+}
+
+// Helper function to make an index described by a footer the handle's index. The sparse array covers every entry,
+// including those of the earlier checkpoints a chained index points back to.
+static void use_segment(struct ticks_file_t_internal* handle, const index_segment_t* segment) {
+    handle->index_offset = segment->index_offset;
+    handle->index_size = segment->index_size;
+    handle->first_entry = segment->first_entry;
+    handle->index_checksum = segment->index_checksum;
+    handle->index.num_entries = segment->num_entries;
+    handle->index.sparse_stride = segment->sparse_stride;
+    handle->index.num_sparse = (uint32_t)(((uint64_t)segment->num_entries + segment->sparse_stride - 1) / segment->sparse_stride);
+    handle->footer_end = segment->footer_offset + sizeof(ticks_footer_t);
+}
+
+// Helper function to check the index and sparse index described by a parsed footer against its checksum
+static int index_checksum_matches(FILE *file, const index_segment_t* segment, uint8_t* buffer, size_t buffer_size) {
+    const uint64_t end = segment->index_offset + segment->index_size + (uint64_t)segment->num_sparse * TICKS_SPARSE_ENTRY_SIZE;
+    uint32_t checksum = 0;
+    for (uint64_t offset = segment->index_offset; offset < end; offset += buffer_size) {
+        const size_t length = end - offset < buffer_size ? (size_t)(end - offset) : buffer_size;
+        if (read_at_portable(file, buffer, length, offset) != 0)
+            return 0;
+        checksum = crc32c(checksum, buffer, length);
+    }
+    return checksum == segment->index_checksum;
+}
+
+// Helper function to find the last complete footer when the end of the file was torn by a crash. Each checkpoint
+// footer was synced after the chunks it references, so the last one whose footer and index checksums hold describes
+// a consistent prefix of the chunks. Footers start on TICKS_INDEX_ALIGNMENT, so only aligned offsets are tried.
+// Footers starting before scan_start are not considered.
+static ticks_status_e recover_footer(FILE *file, struct ticks_file_t_internal* handle, uint64_t file_size, uint64_t scan_start,
+                                     index_segment_t* out_segment) {
+    TICKS_TRACE_SCOPE("recover_footer");
+    if (file_size < scan_start + sizeof(ticks_footer_t))
+        return TICKS_ERROR_INVALID_FORMAT;
+
+    // The first half holds the scanned window, the second reads back candidate indexes
+    uint8_t* buffer = mem_alloc(&handle->allocator, 2 * (size_t)TICKS_FOOTER_SCAN_BYTES);
+    if (buffer == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+
+    ticks_status_e status = TICKS_ERROR_INVALID_FORMAT;
+    uint64_t candidate = (file_size - sizeof(ticks_footer_t)) / TICKS_INDEX_ALIGNMENT * TICKS_INDEX_ALIGNMENT;
+    while (candidate >= scan_start && status != TICKS_OK) {
+        const uint64_t window_end = candidate + sizeof(ticks_footer_t);
+        const uint64_t window_start = window_end - scan_start > TICKS_FOOTER_SCAN_BYTES ? window_end - TICKS_FOOTER_SCAN_BYTES : scan_start;
+        if (read_at_portable(file, buffer, (size_t)(window_end - window_start), window_start) != 0) {
+            status = TICKS_ERROR_FILE_IO;
+            break;
+        }
+
+        for (;;) {
+            ticks_footer_t footer;
+            memcpy(&footer, buffer + (candidate - window_start), sizeof(ticks_footer_t));
+            if (parse_footer(footer, candidate, 1, handle, out_segment) == TICKS_OK &&
+                index_checksum_matches(file, out_segment, buffer + TICKS_FOOTER_SCAN_BYTES, TICKS_FOOTER_SCAN_BYTES)) {
+                status = TICKS_OK;
+                break;
+            }
+            if (candidate < window_start + TICKS_INDEX_ALIGNMENT)
+                break;
+            candidate -= TICKS_INDEX_ALIGNMENT;
+        }
+        if (status == TICKS_OK || candidate < scan_start + TICKS_INDEX_ALIGNMENT)
+            break;
+        candidate -= TICKS_INDEX_ALIGNMENT;
+    }
+
+    mem_free(&handle->allocator, buffer);
+    return status;
+}
+
+// Helper function to locate and validate the footer at the end of the file. Only files that were checkpointed can
+// have been torn by a crash with a complete footer left before the end, only those fall back to searching for it.
+static ticks_status_e read_footer(FILE *file, struct ticks_file_t_internal* handle, index_segment_t* out_segment) {
+    if (!file || !handle)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    if (fseek64_portable(file, 0, SEEK_END) != 0)
+        return TICKS_ERROR_FILE_IO;
+
+    int64_t file_size = ftell64_portable(file);
+    if (file_size < (int64_t)sizeof(ticks_footer_t))
+        return TICKS_ERROR_INVALID_FORMAT;
+    handle->scanned_size = (uint64_t)file_size;
+
+    // The last 8 bytes are footer_size followed by the footer magic
+    if (fseek64_portable(file, file_size - (int64_t)sizeof(ticks_footer_t), SEEK_SET) != 0)
+        return TICKS_ERROR_FILE_IO;
+
+    ticks_footer_t footer;
+    if (fread(&footer, 1, sizeof(ticks_footer_t), file) != sizeof(ticks_footer_t))
+        return TICKS_ERROR_FILE_IO;
+
+    const uint64_t footer_offset = (uint64_t)file_size - sizeof(ticks_footer_t);
+    ticks_status_e status = parse_footer(footer, footer_offset, handle->verify_mode != TICKS_VERIFY_OFF, handle, out_segment);
+    if (status == TICKS_OK || status == TICKS_ERROR_FILE_IO || !(handle->header.flags & TICKS_HEADER_CHECKPOINTS))
+        return status;
+
+    // A crash after chunks or part of an index were written leaves no valid footer at the end
+    return recover_footer(file, handle, (uint64_t)file_size, data_start_offset(), out_segment) == TICKS_OK ? TICKS_OK : status;
+}
+
+// Helper function to allocate the decoded index arrays. Entries are left untouched until their block is decoded, so
+// a mapped index does not pay for the pages of entries it never uses.
+static ticks_status_e alloc_index_arrays(struct ticks_file_t_internal* handle) {
+    handle->index.entries = mem_alloc(&handle->allocator, (size_t)handle->index.num_entries * sizeof(ticks_index_entry_t));
+    handle->index.sparse = mem_alloc(&handle->allocator, (size_t)handle->index.num_sparse * sizeof(uint64_t));
+    handle->index.capacity = handle->index.num_entries;
+    return handle->index.entries != NULL && handle->index.sparse != NULL ? TICKS_OK : TICKS_ERROR_MEMORY_ALLOCATION;
+}
+
+// Helper function to unmap a mapped index and free the decoded arrays, keeping the counts from the footer
+static void free_index_arrays(struct ticks_file_t_internal* handle) {
+    if (handle->index_map != NULL) {
+        unmap_file_region_portable(handle->index_map, handle->index_map_length);
+        handle->index_map = NULL;
+        handle->index_map_length = 0;
+        handle->mapped_index = NULL;
+    }
+    mem_free(&handle->allocator, handle->index.entries);
+    mem_free(&handle->allocator, handle->index.sparse);
+    mem_free(&handle->allocator, (void*)handle->decoded_blocks);
+    handle->index.entries = NULL;
+    handle->index.capacity = 0;
+    handle->index.sparse = NULL;
+    handle->decoded_blocks = NULL;
+}
+
+// Helper function to release the index in whichever way it was acquired
+static void release_index_table(struct ticks_file_t_internal* handle) {
+    free_index_arrays(handle);
+
+    mem_free(&handle->allocator, (void*)handle->verified_columns);
+    handle->verified_columns = NULL;
+
+    handle->index.num_sparse = 0;
+}
+
+// Helper function to map the packed index instead of reading it. Only the sparse index is decoded on open, each
+// block of entries is decoded the first time one of them is used, so opening costs the same regardless of how
+// many chunks the file holds.
+static ticks_status_e map_index_table(FILE *file, struct ticks_file_t_internal* handle) {
+    TICKS_TRACE_SCOPE("map_index_table");
+    // Index and sparse index are contiguous, the footer was already validated to follow them directly
+    uint64_t length = handle->index_size + (uint64_t)handle->index.num_sparse * TICKS_SPARSE_ENTRY_SIZE;
+    if (handle->index.num_entries == 0)
+        return TICKS_OK;
+
+    // A checkpoint that points back to earlier ones is spread over the file, it is read instead
+    if (handle->first_entry != 0)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    uint8_t* region = map_file_region_portable(file, handle->index_offset, length, &handle->index_map, &handle->index_map_length);
+    if (region == NULL)
+        return TICKS_ERROR_FILE_IO;
+    handle->mapped_index = region;
+
+    // Verifying a mapped index touches every page of it, so it is only done when asked to always verify
+    ticks_status_e status = TICKS_OK;
+    if (handle->verify_mode == TICKS_VERIFY_ALWAYS && crc32c(0, region, length) != handle->index_checksum)
+        status = TICKS_ERROR_CHECKSUM_MISMATCH;
+    if (status == TICKS_OK)
+        status = alloc_index_arrays(handle);
+    if (status == TICKS_OK) {
+        handle->decoded_blocks = mem_calloc(&handle->allocator, handle->index.num_sparse, 1);
+        if (handle->decoded_blocks == NULL)
+            status = TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+    if (status == TICKS_OK)
+        status = decode_sparse_index(handle, region);
+
+    if (status != TICKS_OK)
+        free_index_arrays(handle);
+    return status;
+}
+
+// Helper function to decode the blocks of one index that hold entries from from_entry on. Only the newest index a
+// refresh found can be read in part, recover_footer already checked it against its checksum.
+static ticks_status_e read_index_segment(FILE *file, struct ticks_file_t_internal* handle, const index_segment_t* segment,
+                                         uint32_t from_entry) {
+    if (segment->num_entries <= from_entry || segment->num_sparse == 0)
+        return TICKS_OK;
+
+    // Each sparse entry holds its block's offset as a little-endian u64 after the block's time base
+    const uint32_t first_block = from_entry > segment->first_entry ? (from_entry - segment->first_entry) / segment->sparse_stride : 0;
+    const uint64_t sparse_offset = segment->index_offset + segment->index_size;
+    uint64_t block_offset = 0;
+    if (first_block > 0) {
+        uint8_t sparse_entry[TICKS_SPARSE_ENTRY_SIZE];
+        if (read_at_portable(file, sparse_entry, sizeof(sparse_entry), sparse_offset + (uint64_t)first_block * TICKS_SPARSE_ENTRY_SIZE) != 0)
+            return TICKS_ERROR_FILE_IO;
+        for (int i = 7; i >= 0; i--)
+            block_offset = (block_offset << 8) | sparse_entry[8 + i];
+        if (block_offset >= segment->index_size)
+            return TICKS_ERROR_INVALID_FORMAT;
+    }
+
+    // The packed bytes are only needed until they are decoded, the sparse index directly follows the index
+    const uint64_t length = segment->index_size - block_offset + (uint64_t)segment->num_sparse * TICKS_SPARSE_ENTRY_SIZE;
+    uint8_t* region = mem_alloc(&handle->allocator, (size_t)length);
+    if (region == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+
+    ticks_status_e status = read_at_portable(file, region, (size_t)length, segment->index_offset + block_offset) == 0 ? TICKS_OK : TICKS_ERROR_FILE_IO;
+    if (status == TICKS_OK && first_block == 0 && handle->verify_mode != TICKS_VERIFY_OFF &&
+        crc32c(0, region, length) != segment->index_checksum)
+        status = TICKS_ERROR_CHECKSUM_MISMATCH;
+    if (status == TICKS_OK)
+        status = decode_index(handle, segment, region, block_offset, first_block);
+
+    mem_free(&handle->allocator, region);
+    return status;
+}
+
+// Helper function to decode the entries from from_entry on into arrays sized for the newest index. A checkpoint
+// only holds the entries added since the one before it, so the footers are followed back until one holds from_entry.
+static ticks_status_e read_index_entries(FILE *file, struct ticks_file_t_internal* handle, const index_segment_t* newest,
+                                         uint32_t from_entry) {
+    TICKS_TRACE_SCOPE("read_index_entries");
+    index_segment_t segment = *newest;
+    ticks_status_e status = read_index_segment(file, handle, &segment, from_entry);
+    while (status == TICKS_OK && segment.first_entry > from_entry) {
+        // Each earlier checkpoint must end where the later one starts
+        ticks_footer_t footer;
+        index_segment_t previous;
+        if (read_at_portable(file, &footer, sizeof(ticks_footer_t), segment.previous_footer) != 0)
+            return TICKS_ERROR_FILE_IO;
+        status = parse_footer(footer, segment.previous_footer, handle->verify_mode != TICKS_VERIFY_OFF, handle, &previous);
+        if (status == TICKS_OK && (previous.num_entries != segment.first_entry || previous.sparse_stride != segment.sparse_stride))
+            status = TICKS_ERROR_INVALID_FORMAT;
+        segment = previous;
+        if (status == TICKS_OK)
+            status = read_index_segment(file, handle, &segment, from_entry);
+    }
+    if (status != TICKS_OK)
+        return status;
+
+    // Blocks of a checkpoint start at its first entry, the sparse index is rebuilt on the handle's own stride
+    const uint32_t stride = handle->index.sparse_stride;
+    for (uint32_t block = from_entry / stride; block < handle->index.num_sparse; block++)
+        handle->index.sparse[block] = handle->index.entries[(size_t)block * stride].chunk_time_base;
+    return TICKS_OK;
+}
+
+// Helper function to read the packed index table and decode it
+static ticks_status_e read_index_table(FILE *file, struct ticks_file_t_internal* handle, const index_segment_t* newest) {
+    TICKS_TRACE_SCOPE("read_index_table");
     if (!file || !handle || handle->index_offset == 0) {
         return TICKS_ERROR_INVALID_ARGUMENTS;
     }
 
     // Initialize index entries to NULL
     handle->index.entries = NULL;
+    handle->index.sparse = NULL;
+    handle->index.capacity = 0;
+
+    if (handle->index.num_entries == 0)
+        return TICKS_OK; // File without chunks, nothing to read
 
-    if (handle->index_size == 0)
-        return TICKS_ERROR_INVALID_FORMAT; // No entries to reads
+    ticks_status_e status = alloc_index_arrays(handle);
+    if (status == TICKS_OK)
+        status = read_index_entries(file, handle, newest, 0);
+    if (status != TICKS_OK)
+        free_index_arrays(handle);
+    return status;
+}
 
-    // Allocate memory for the index entries
-    uint32_t num_entries = handle->index_size / sizeof(ticks_index_entry_t);
-    handle->index.num_entries = num_entries;
-    handle->index.entries = malloc(handle->index_size);
+// Helper function to drop the mapping of a mapped index, so the index can grow in memory. The mapped bytes are not
+// decoded first, the newer index that replaces them is read instead.
+static void unmap_index_table(struct ticks_file_t_internal* handle) {
+    if (handle->decoded_blocks == NULL)
+        return;
+    unmap_file_region_portable(handle->index_map, handle->index_map_length);
+    handle->index_map = NULL;
+    handle->index_map_length = 0;
+    handle->mapped_index = NULL;
+    mem_free(&handle->allocator, (void*)handle->decoded_blocks);
+    handle->decoded_blocks = NULL;
+}
 
-    if (handle->index.entries == NULL)
+// Helper function to grow the index arrays to the counts of a newer footer, keeping the entries decoded so far
+static ticks_status_e grow_index_arrays(struct ticks_file_t_internal* handle, uint32_t previous_entries) {
+    const uint32_t num_entries = handle->index.num_entries;
+    if (num_entries > handle->index.capacity) {
+        // Doubled so a reader refreshing after every checkpoint copies each entry a bounded number of times
+        uint32_t capacity = handle->index.capacity > UINT32_MAX / 2 ? UINT32_MAX : handle->index.capacity * 2;
+        if (capacity < num_entries)
+            capacity = num_entries;
+        ticks_index_entry_t* entries = mem_realloc(&handle->allocator, handle->index.entries, (size_t)capacity * sizeof(ticks_index_entry_t));
+        if (entries == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        handle->index.entries = entries;
+        handle->index.capacity = capacity;
+    }
+
+    uint64_t* sparse = mem_realloc(&handle->allocator, handle->index.sparse, (size_t)handle->index.num_sparse * sizeof(uint64_t));
+    if (sparse == NULL)
         return TICKS_ERROR_MEMORY_ALLOCATION;
+    handle->index.sparse = sparse;
 
-    // Move file pointer to the index offset
-    if (fseek(file, handle->index_offset, SEEK_SET) != 0) {
-        free(handle->index.entries);
-        handle->index.entries = NULL;
-        return TICKS_ERROR_FILE_IO;
+    if (handle->verify_mode == TICKS_VERIFY_FIRST_TOUCH) {
+        uint8_t* verified_columns = mem_realloc(&handle->allocator, (void*)handle->verified_columns, num_entries);
+        if (verified_columns == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        memset(verified_columns + previous_entries, 0, num_entries - previous_entries);
+        handle->verified_columns = verified_columns;
+    }
+    return TICKS_OK;
+}
+
+// Helper function to decode the entries a newer footer added. Indexes only ever append entries, so the entries the
+// handle already has are kept and only the blocks from the one holding the first new entry on are read.
+static ticks_status_e extend_index_table(FILE *file, struct ticks_file_t_internal* handle, const index_segment_t* newest,
+                                         const ticks_index_t* previous) {
+    TICKS_TRACE_SCOPE("extend_index_table");
+    const uint32_t from_entry = handle->index.sparse_stride == previous->sparse_stride ? previous->num_entries : 0;
+    if (handle->index.num_entries == 0 || handle->index.num_entries == from_entry)
+        return TICKS_OK;
+
+    ticks_status_e status = grow_index_arrays(handle, previous->num_entries);
+    if (status != TICKS_OK)
+        return status;
+    return read_index_entries(file, handle, newest, from_entry);
+}
+
+// Helper function to write out every tick held in the reorder window
+static ticks_status_e flush_reorder_window(ticks_file_t* handle) {
+    ticks_status_e flush_status = reorder_flush(&handle->reorder);
+    if (flush_status != TICKS_OK || handle->reorder.num_output == 0)
+        return flush_status;
+    return create_chunks(handle, handle->reorder.output, handle->reorder.num_output);
+}
+
+// Helper function to chunk row-major records, passing them through the reorder window if one is set
+static ticks_status_e add_rows(ticks_file_t* handle, const uint64_t* rows, uint64_t num_rows) {
+    // Without a reorder window the data is chunked as given
+    if (!reorder_enabled(&handle->reorder.options)) {
+        // Create chunks from the provided data, the index is written once on close
+        ticks_status_e create_chunks_result = create_chunks(handle, rows, num_rows);
+        if (create_chunks_result != TICKS_OK)
+            return create_chunks_result;
+
+        return TICKS_OK;
     }
 
-    // Read index entries to memory
-    if (fread(handle->index.entries, 1, handle->index_size, file) != handle->index_size) {
-        free(handle->index.entries);
-        handle->index.entries = NULL;
+    // Otherwise only the ticks that left the window are chunked, the rest are held for later calls
+    uint64_t late_ticks = 0;
+    ticks_status_e reorder_status = reorder_push(&handle->reorder, rows, num_rows, handle->header.schema.num_columns, &late_ticks);
+    metrics_add(handle->metrics, METRIC_LATE_TICKS, late_ticks);
+    if (reorder_status != TICKS_OK)
+        return reorder_status;
+
+    if (handle->reorder.num_output == 0)
+        return TICKS_OK;
+    return create_chunks(handle, handle->reorder.output, handle->reorder.num_output);
+}
+
+// Helper function to flag the file as checkpointed, so readers know a torn tail may hide an earlier complete footer.
+// The flag is synced with the chunks before the first checkpoint's footer is written.
+static ticks_status_e mark_checkpointed(ticks_file_t* handle) {
+    const uint8_t flags = handle->header.flags | TICKS_HEADER_CHECKPOINTS;
+    const uint64_t flags_offset = data_start_offset() - sizeof(ticks_header_t) + offsetof(ticks_header_t, flags);
+    if (fflush(handle->file_stream) != 0 || fseek64_portable(handle->file_stream, (int64_t)flags_offset, SEEK_SET) != 0 ||
+        fwrite(&flags, 1, sizeof(flags), handle->file_stream) != sizeof(flags) ||
+        fseek64_portable(handle->file_stream, (int64_t)handle->write_offset, SEEK_SET) != 0) {
+        perror("ERROR: Writing the header flags failed");
         return TICKS_ERROR_FILE_IO;
     }
+    handle->header.flags = flags;
+    return TICKS_OK;
+}
+
+// Helper function to finish direct writes, the stream continues at the end of the last staged chunk
+static ticks_status_e stop_direct_writes(ticks_file_t* handle) {
+    if (!direct_writer_active(&handle->direct))
+        return TICKS_OK;
+    ticks_status_e status = direct_writer_close(&handle->direct);
+    if (handle->file_stream != NULL && fseek64_portable(handle->file_stream, (int64_t)handle->write_offset, SEEK_SET) != 0 &&
+        status == TICKS_OK)
+        status = TICKS_ERROR_FILE_IO;
+    return status;
+}
+
+// Helper function to start direct writes at the next aligned offset, leaving the file buffered if it refuses O_DIRECT
+static ticks_status_e start_direct_writes(ticks_file_t* handle, uint32_t staging_bytes) {
+    if (fflush(handle->file_stream) != 0)
+        return TICKS_ERROR_FILE_IO;
 
+    const uint64_t aligned_offset = (handle->write_offset + TICKS_DIRECT_ALIGNMENT - 1) / TICKS_DIRECT_ALIGNMENT * TICKS_DIRECT_ALIGNMENT;
+    ticks_status_e status = direct_writer_open(&handle->direct, handle->file_stream, aligned_offset, staging_bytes, &handle->allocator);
+    if (status == TICKS_ERROR_FILE_IO)
+        return TICKS_OK;
+    if (status != TICKS_OK)
+        return status;
+
+    // The first direct chunk starts on the alignment, the gap after the header or previous footer is zeroed
+    status = direct_pad_stream(handle->file_stream, &handle->write_offset);
+    if (status != TICKS_OK)
+        direct_writer_close(&handle->direct);
+    return status;
+}
+
+// Helper function to cut off bytes a reopened file held past the footer just written, so the footer ends the file
+static ticks_status_e truncate_after_footer(ticks_file_t* handle) {
+    if (fseek64_portable(handle->file_stream, 0, SEEK_END) != 0)
+        return TICKS_ERROR_FILE_IO;
+    const int64_t file_size = ftell64_portable(handle->file_stream);
+    if (file_size < 0)
+        return TICKS_ERROR_FILE_IO;
+    if ((uint64_t)file_size <= handle->write_offset)
+        return TICKS_OK;
+    if (fflush(handle->file_stream) != 0 || truncate_file_portable(handle->file_stream, handle->write_offset) != 0) {
+        perror("ERROR: Truncating the ticks file after its footer failed");
+        return TICKS_ERROR_FILE_IO;
+    }
     return TICKS_OK;
 }
 
@@ -80,6 +563,17 @@ ticks_status_e ticks_new_file(const char* filename, ticks_header_t* header, tick
     if (filename == NULL || header == NULL) 
         return TICKS_ERROR_INVALID_ARGUMENTS;
 
+    // A header without columns stores trades
+    ticks_schema_t schema = header->schema;
+    if (schema.num_columns == 0)
+        ticks_schema_builtin(TICKS_SCHEMA_TRADES, &schema);
+    if (schema_validate(&schema) != TICKS_OK)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    // A chunk must be able to hold at least one row at the widest widths
+    if (header->chunk_policy.max_chunk_bytes != 0 && header->chunk_policy.max_chunk_bytes < schema.num_columns * SIZE_64BIT)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
     if (header->endianness == ENDIAN_UNDEFINED) {
         if (is_little_endian())
             header->endianness = ENDIAN_LITTLE;
@@ -87,21 +581,27 @@ ticks_status_e ticks_new_file(const char* filename, ticks_header_t* header, tick
             header->endianness = ENDIAN_BIG;
     }
     // Allocate memory for the internal handle structure and zero memory
-    struct ticks_file_t_internal* handle = malloc(sizeof(struct ticks_file_t_internal));
-    memset(handle, 0, sizeof(struct ticks_file_t_internal));
-
+    struct ticks_file_t_internal* handle = alloc_handle();
     if (handle == NULL) {
         printf("Failed to allocate memory: %s\n", strerror(errno));
         return TICKS_ERROR_MEMORY_ALLOCATION;
     }
 
+    handle->metrics = metrics_create(&handle->allocator);
+    if (handle->metrics == NULL) {
+        free_handle(handle);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+
     // Open the file for writing (binary mode)
     handle->file_stream = fopen(filename, "wb");
     if (handle->file_stream == NULL) {
         printf("Failed to open file: %s\n", strerror(errno));
-        free(handle);
+        metrics_destroy(&handle->allocator, handle->metrics);
+        free_handle(handle);
         return TICKS_ERROR_FILE_IO;
     }
+    handle->file_identity_valid = file_identity_portable(handle->file_stream, &handle->file_device, &handle->file_inode) == 0;
 
     // Store a copy of the header internally
     handle->header.asset_class = header->asset_class;
@@ -109,12 +609,27 @@ ticks_status_e ticks_new_file(const char* filename, ticks_header_t* header, tick
     strncpy(handle->header.currency, header->currency, TICKS_CURRENCY_SIZE);
     strncpy(handle->header.country, header->country, TICKS_COUNTRY_SIZE);
     handle->header.compression_type = header->compression_type;
+    handle->header.endianness = header->endianness;
+    handle->header.chunk_policy = header->chunk_policy;
+    if (handle->header.chunk_policy.max_chunk_bytes == 0)
+        handle->header.chunk_policy.max_chunk_bytes = TICKS_DEFAULT_CHUNK_BYTES;
+    handle->header.schema = schema;
 
     // Write data to the file
     if (write_initial_data(handle->file_stream, (struct ticks_file_t_internal*)handle) != 0) {
         printf("Failed to write initial data: %s\n", strerror(errno));
         fclose(handle->file_stream);
-        free(handle);
+        metrics_destroy(&handle->allocator, handle->metrics);
+        free_handle(handle);
+        return TICKS_ERROR_FILE_IO;
+    }
+
+    // Followers may open the file before the first chunk, the header is pushed out so they can read it
+    if (fflush(handle->file_stream) != 0) {
+        perror("ERROR: fflush after header write failed");
+        fclose(handle->file_stream);
+        metrics_destroy(&handle->allocator, handle->metrics);
+        free_handle(handle);
         return TICKS_ERROR_FILE_IO;
     }
  
@@ -124,66 +639,106 @@ ticks_status_e ticks_new_file(const char* filename, ticks_header_t* header, tick
     return TICKS_OK;
 }
 
-ticks_status_e ticks_open(const char* filename, const char* mode, ticks_file_t** out_handle) {
-    if (filename == NULL)
+static ticks_status_e ticks_open(const char* filename, const char* mode, const ticks_open_options_t* options, ticks_file_t** out_handle) {
+    if (filename == NULL || out_handle == NULL)
        return TICKS_ERROR_INVALID_ARGUMENTS;
 
-    // Allocate memory for the internal handle structure
-    struct ticks_file_t_internal* handle = malloc(sizeof(struct ticks_file_t_internal));
+    ticks_open_options_t default_options;
+    memset(&default_options, 0, sizeof(default_options));
+    if (options == NULL)
+        options = &default_options;
+
+    // Allocate memory for the internal handle structure and zero memory
+    struct ticks_file_t_internal* handle = alloc_handle();
     if (handle == NULL)
         return TICKS_ERROR_MEMORY_ALLOCATION;
+    handle->verify_mode = options->verify_mode;
 
     // Open the file in specified mode
     handle->file_stream = fopen(filename, mode);
     if (handle->file_stream == NULL) {
-        free(handle);
+        free_handle(handle);
         return TICKS_ERROR_FILE_IO;
     }
     
-    // Read and Validate the Magic Number
-    char magic_buffer[sizeof(TICKS_MAGIC)];
-    size_t magic_len = strlen(TICKS_MAGIC); 
-
-    if (fread(magic_buffer, 1, magic_len, handle->file_stream) != magic_len) {
-        // File too short or read error
+    // Read and validate the magic, version and header. A followed file may not hold all of them yet.
+    ticks_status_e header_status = read_file_header(handle->file_stream, handle);
+    handle->awaiting_header = options->follow && header_status == TICKS_EOF;
+    if (header_status != TICKS_OK && !handle->awaiting_header) {
         fclose(handle->file_stream);
-        free(handle);
-        return feof(handle->file_stream) ? TICKS_ERROR_INVALID_FORMAT : TICKS_ERROR_FILE_IO;
+        free_handle(handle);
+        return header_status == TICKS_EOF ? TICKS_ERROR_INVALID_FORMAT : header_status;
     }
 
-    if (strncmp(magic_buffer, TICKS_MAGIC, magic_len) != 0) {
+    // Read the Index Offset and Size from the footer
+    index_segment_t newest;
+    ticks_status_e footer_status = handle->awaiting_header ? TICKS_ERROR_INVALID_FORMAT : read_footer(handle->file_stream, handle, &newest);
+    const int awaiting_checkpoint = options->follow && footer_status != TICKS_OK && footer_status != TICKS_ERROR_FILE_IO &&
+                                    footer_status != TICKS_ERROR_MEMORY_ALLOCATION;
+    if (footer_status != TICKS_OK && !awaiting_checkpoint) {
         fclose(handle->file_stream);
-        free(handle);
-        return TICKS_ERROR_INVALID_FORMAT;
+        free_handle(handle);
+        return footer_status;
     }
-    
-    // Read the Header Structure into the internal state
-    if (fread(&handle->header, 1, sizeof(ticks_header_t), handle->file_stream) != sizeof(ticks_header_t)) {
-        // Read error or file truncated
+
+    // A followed file the writer has not checkpointed yet opens without chunks, ticks_refresh picks them up
+    ticks_status_e index_status = TICKS_ERROR_FILE_IO;
+    if (awaiting_checkpoint) {
+        handle->index_offset = 0;
+        handle->index_size = 0;
+        handle->index_checksum = 0;
+        memset(&handle->index, 0, sizeof(ticks_index_t));
+        handle->footer_end = data_start_offset();
+        index_status = TICKS_OK;
+    }
+    else {
+        use_segment(handle, &newest);
+    }
+
+    // Map the Index Table in place if requested, falling back to reading it into memory
+    if (!awaiting_checkpoint && options->index_mode == TICKS_INDEX_MMAP)
+        index_status = map_index_table(handle->file_stream, handle);
+    if (index_status != TICKS_OK && index_status != TICKS_ERROR_CHECKSUM_MISMATCH)
+        index_status = read_index_table(handle->file_stream, handle, &newest);
+    if (index_status != TICKS_OK) {
         fclose(handle->file_stream);
-        free(handle);
-        return TICKS_ERROR_INVALID_FORMAT;
+        free_handle(handle);
+        return index_status;
     }
 
-    // TODO: Add more robust error checking to this function
+    // Track which columns of each chunk have been verified so each is only checked on first touch
+    if (handle->verify_mode == TICKS_VERIFY_FIRST_TOUCH && handle->index.num_entries > 0) {
+        handle->verified_columns = mem_calloc(&handle->allocator, handle->index.num_entries, 1);
+        if (handle->verified_columns == NULL) {
+            release_index_table(handle);
+            fclose(handle->file_stream);
+            free_handle(handle);
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        }
+    }
 
-    // Read the Index Offset and Size
-    if (fread(&handle->index_offset, 1, sizeof(uint64_t), handle->file_stream) != sizeof(uint64_t) || fread(&handle->index_size, 1, sizeof(uint64_t), handle->file_stream) != sizeof(uint64_t)) {
+    handle->metrics = metrics_create(&handle->allocator);
+    if (handle->metrics == NULL) {
+        release_index_table(handle);
         fclose(handle->file_stream);
-        free(handle);
-        return TICKS_ERROR_FILE_IO;
+        free_handle(handle);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
     }
 
-    // Read the Index Table into memory
-    read_index_table(handle->file_stream, handle);
+    // Decoded chunks are only shared through the cache when the file can be identified
+    handle->file_identity_valid = file_identity_portable(handle->file_stream, &handle->file_device, &handle->file_inode) == 0;
 
     *out_handle = (ticks_file_t*)handle;
     return TICKS_OK;
 }
 
 ticks_status_e ticks_open_read(const char* filename, ticks_file_t** out_handle) {
+    return ticks_open_read_ex(filename, NULL, out_handle);
+}
+
+ticks_status_e ticks_open_read_ex(const char* filename, const ticks_open_options_t* options, ticks_file_t** out_handle) {
     ticks_file_t* handle = NULL;
-    ticks_status_e open_status = ticks_open(filename, "rb", &handle);
+    ticks_status_e open_status = ticks_open(filename, "rb", options, &handle);
     if (open_status != TICKS_OK) {
         return open_status;
     }
@@ -197,36 +752,179 @@ ticks_status_e ticks_open_read(const char* filename, ticks_file_t** out_handle)
 
 ticks_status_e ticks_open_write(const char* filename, ticks_file_t** out_handle) {
     ticks_file_t* handle = NULL;
-    ticks_status_e open_status = ticks_open(filename, "rb+", &handle);
+    ticks_status_e open_status = ticks_open(filename, "rb+", NULL, &handle);
     if (open_status != TICKS_OK) {
         return open_status;
     }
 
-    handle->mode = FILE_MODE_READ;
+    // Writers only append to the index, the sparse index is rebuilt when the index is written
+    mem_free(&handle->allocator, handle->index.sparse);
+    handle->index.sparse = NULL;
+    handle->index.num_sparse = 0;
+    mem_free(&handle->allocator, (void*)handle->verified_columns);
+    handle->verified_columns = NULL;
+
+    // New chunks go after the footer the file was opened at, which stays intact until the index written on close
+    // replaces it, so a crash before then still recovers every chunk written earlier and mapped readers keep a valid
+    // index. Checkpoints and the index written on close chain back to it. Anything after it, such as a tail torn by
+    // a crash, is cut off first. The old index is left as dead bytes, ticks_compact drops them.
+    handle->write_offset = handle->footer_end;
+    handle->last_footer = handle->footer_end - sizeof(ticks_footer_t);
+    handle->indexed_entries = handle->index.num_entries;
+    handle->complete_index_bytes = handle->last_footer - handle->index_offset;
+    handle->mode = FILE_MODE_WRITE;
+    ticks_status_e status = fflush(handle->file_stream) == 0 &&
+                            truncate_file_portable(handle->file_stream, handle->write_offset) == 0 ? TICKS_OK : TICKS_ERROR_FILE_IO;
+    // Readers only search for an earlier footer in files flagged as checkpointed
+    if (status == TICKS_OK && !(handle->header.flags & TICKS_HEADER_CHECKPOINTS))
+        status = mark_checkpointed(handle);
+    if (status == TICKS_OK && (fseek64_portable(handle->file_stream, (int64_t)handle->write_offset, SEEK_SET) != 0 ||
+                               fflush(handle->file_stream) != 0))
+        status = TICKS_ERROR_FILE_IO;
+    if (status != TICKS_OK) {
+        handle->mode = FILE_MODE_READ;
+        ticks_close(handle);
+        return status;
+    }
     
     *out_handle = handle;
 
     return TICKS_OK;
 }
 
+ticks_status_e ticks_refresh(ticks_file_t* handle, uint32_t* out_new_chunks) {
+    if (handle == NULL || out_new_chunks == NULL || handle->mode != FILE_MODE_READ || handle->file_stream == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    *out_new_chunks = 0;
+
+    // The file size serves as the generation, nothing can have been checkpointed while it stays the same
+    if (fseek64_portable(handle->file_stream, 0, SEEK_END) != 0)
+        return TICKS_ERROR_FILE_IO;
+    const int64_t file_size = ftell64_portable(handle->file_stream);
+    if (file_size < 0)
+        return TICKS_ERROR_FILE_IO;
+    if ((uint64_t)file_size == handle->scanned_size)
+        return TICKS_OK;
+    if ((uint64_t)file_size < handle->scanned_size) {
+        printf("ERROR: Followed ticks file shrank, it was truncated or replaced\n");
+        return TICKS_ERROR_INVALID_FORMAT;
+    }
+    TICKS_TRACE_SCOPE("ticks_refresh");
+
+    // A follower opened before the header was complete reads it first, it has no chunks until then
+    if (handle->awaiting_header) {
+        ticks_status_e header_status = read_file_header(handle->file_stream, handle);
+        if (header_status == TICKS_EOF) {
+            handle->scanned_size = (uint64_t)file_size;
+            return TICKS_OK;
+        }
+        if (header_status != TICKS_OK)
+            return header_status;
+        handle->awaiting_header = 0;
+    }
+
+    // Footers complete at the last refresh were already tried, only those ending in the new bytes can be newer.
+    // A checkpoint still being written fails its checksums and is found by a later refresh once it is complete.
+    uint64_t scan_start = handle->footer_end;
+    if (handle->scanned_size >= scan_start + sizeof(ticks_footer_t))
+        scan_start = (handle->scanned_size - sizeof(ticks_footer_t) + TICKS_INDEX_ALIGNMENT) / TICKS_INDEX_ALIGNMENT * TICKS_INDEX_ALIGNMENT;
+
+    // A writer that never checkpoints only writes a footer on close, at the end of the file
+    if (!(handle->header.flags & TICKS_HEADER_CHECKPOINTS) &&
+        read_at_portable(handle->file_stream, &handle->header.flags, sizeof(handle->header.flags),
+                         data_start_offset() - sizeof(ticks_header_t) + offsetof(ticks_header_t, flags)) != 0)
+        return TICKS_ERROR_FILE_IO;
+    const uint64_t tail_footer = ((uint64_t)file_size - sizeof(ticks_footer_t)) / TICKS_INDEX_ALIGNMENT * TICKS_INDEX_ALIGNMENT;
+    if (!(handle->header.flags & TICKS_HEADER_CHECKPOINTS) && (uint64_t)file_size >= sizeof(ticks_footer_t) && tail_footer > scan_start)
+        scan_start = tail_footer;
+
+    const ticks_index_t previous = handle->index;
+    const uint64_t previous_offset = handle->index_offset;
+    const uint64_t previous_size = handle->index_size;
+    const uint32_t previous_first_entry = handle->first_entry;
+    const uint32_t previous_checksum = handle->index_checksum;
+    const uint64_t previous_footer_end = handle->footer_end;
+    index_segment_t newest;
+    ticks_status_e status = recover_footer(handle->file_stream, handle, (uint64_t)file_size, scan_start, &newest);
+    const int checkpoint_found = status == TICKS_OK;
+    int unmapped = 0;
+    if (checkpoint_found && newest.num_entries < previous.num_entries) {
+        printf("ERROR: Followed ticks file lost index entries, it was rewritten\n");
+        status = TICKS_ERROR_INVALID_FORMAT;
+    }
+    else if (checkpoint_found) {
+        // A mapped index is read again whole from the newer footer, its entries may not all have been decoded
+        ticks_index_t decoded = previous;
+        if (handle->decoded_blocks != NULL) {
+            unmap_index_table(handle);
+            decoded.num_entries = 0;
+            unmapped = 1;
+        }
+        use_segment(handle, &newest);
+        status = extend_index_table(handle->file_stream, handle, &newest, &decoded);
+    }
+    else if (status == TICKS_ERROR_INVALID_FORMAT) {
+        // No newer checkpoint is complete yet, the bytes searched need not be searched again
+        handle->scanned_size = (uint64_t)file_size;
+        status = TICKS_OK;
+    }
+
+    if (status != TICKS_OK || !checkpoint_found) {
+        // Keep the current index, arrays that were grown keep their larger capacity. A dropped mapping leaves
+        // entries that were never decoded, so the handle is left without chunks.
+        handle->index.num_entries = unmapped ? 0 : previous.num_entries;
+        handle->index.sparse_stride = previous.sparse_stride;
+        handle->index.num_sparse = unmapped ? 0 : previous.num_sparse;
+        handle->index_offset = previous_offset;
+        handle->index_size = previous_size;
+        handle->first_entry = previous_first_entry;
+        handle->index_checksum = previous_checksum;
+        handle->footer_end = previous_footer_end;
+        return status;
+    }
+
+    *out_new_chunks = handle->index.num_entries - previous.num_entries;
+    handle->scanned_size = (uint64_t)file_size;
+    return TICKS_OK;
+}
+
 ticks_status_e ticks_close(ticks_file_t *handle) {
     if (handle == NULL)
         return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    // Write the index and footer once, after all chunks (including held back ticks) have been appended
+    ticks_status_e index_status = durability_stop(handle);
+    if (index_status == TICKS_OK && handle->mode == FILE_MODE_WRITE && handle->file_stream != NULL)
+        index_status = flush_reorder_window(handle);
+    ticks_status_e direct_status = stop_direct_writes(handle);
+    if (index_status == TICKS_OK)
+        index_status = direct_status;
+    // A chained checkpoint is replaced by a complete index, so closed files are read from a single one
+    if (index_status == TICKS_OK && handle->mode == FILE_MODE_WRITE && (handle->index_dirty || handle->first_entry != 0) &&
+        handle->file_stream != NULL)
+        index_status = create_index(handle, 0, handle->index.num_entries);
+    if (index_status == TICKS_OK && handle->mode == FILE_MODE_WRITE && handle->file_stream != NULL)
+        index_status = truncate_after_footer(handle);
+    if (index_status == TICKS_OK && handle->mode == FILE_MODE_WRITE && handle->file_stream != NULL)
+        index_status = durability_sync_close(handle);
     
     // Try to close the internal file stream if it's open
     int status = (handle->file_stream != NULL) ? fclose(handle->file_stream) : 0;
-    if (status != 0) {
-        // fclose failed, errno is set by fclose
-        free(handle);
-        return TICKS_ERROR_FILE_IO;
-    }
 
-    // Free index entries if allocated
-    if (handle->index.entries != NULL)
-        free(handle->index.entries);
+    // Free or unmap index entries
+    release_index_table(handle);
+    reorder_release(&handle->reorder);
+    metrics_destroy(&handle->allocator, handle->metrics);
     
     // Free the dynamically allocated handle structure
-    free(handle);
+    free_handle(handle);
+
+    if (index_status != TICKS_OK)
+        return index_status;
+
+    // fclose failed, errno is set by fclose
+    if (status != 0)
+        return TICKS_ERROR_FILE_IO;
 
     return TICKS_OK;
 }
@@ -258,19 +956,143 @@ ticks_status_e ticks_get_index_size(ticks_file_t *handle, uint64_t *out_size) {
     return TICKS_OK;
 }
 
+ticks_status_e ticks_get_metrics(ticks_file_t* handle, ticks_metrics_t* out_metrics) {
+    if (handle == NULL || out_metrics == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    metrics_collect(handle->metrics, out_metrics);
+
+    return TICKS_OK;
+}
+
 ticks_status_e ticks_add_data(ticks_file_t* handle, trade_data_t* data, uint64_t num_entries) { 
     if (handle == NULL || data == NULL || num_entries == 0 || handle->file_stream == NULL)
         return TICKS_ERROR_INVALID_ARGUMENTS;
 
-    // Create chunks from the provided data
-    ticks_status_e create_chunks_result = create_chunks(handle, data, num_entries);
-    if (create_chunks_result != TICKS_OK)
-        return create_chunks_result;
-  
-    ticks_status_e create_index_result = create_index(handle);
-    if (create_index_result != TICKS_OK)
-        return create_index_result;
+    if (handle->mode != FILE_MODE_WRITE || !schema_has_trade_layout(&handle->header.schema))
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    // trade_data_t is laid out as one row of the built-in trades schema
+    mutex_lock_portable(&handle->write_mutex);
+    ticks_status_e status = add_rows(handle, (const uint64_t*)data, num_entries);
+    if (status == TICKS_OK)
+        status = durability_commit(handle);
+    mutex_unlock_portable(&handle->write_mutex);
+    return status;
+}
+
+ticks_status_e ticks_add_records(ticks_file_t* handle, const uint64_t* rows, uint64_t num_rows) {
+    if (handle == NULL || rows == NULL || num_rows == 0 || handle->file_stream == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    if (handle->mode != FILE_MODE_WRITE)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    mutex_lock_portable(&handle->write_mutex);
+    ticks_status_e status = add_rows(handle, rows, num_rows);
+    if (status == TICKS_OK)
+        status = durability_commit(handle);
+    mutex_unlock_portable(&handle->write_mutex);
+    return status;
+}
+
+ticks_status_e ticks_set_reorder_window(ticks_file_t* handle, const ticks_reorder_options_t* options) {
+    if (handle == NULL || options == NULL || handle->mode != FILE_MODE_WRITE)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
 
+    // Ticks held under the previous window are written before it changes
+    mutex_lock_portable(&handle->write_mutex);
+    ticks_status_e status = flush_reorder_window(handle);
+    if (status == TICKS_OK)
+        status = durability_commit(handle);
+    if (status == TICKS_OK) {
+        handle->reorder.options = *options;
+        // Ticks before the end of the chunks already in the file are late too, including those of an earlier session
+        const uint32_t num_entries = handle->index.num_entries;
+        const uint64_t written_ms = num_entries > 0 ? index_entry(handle, num_entries - 1)->chunk_max_time : 0;
+        if (num_entries > 0 && (!handle->reorder.has_released || handle->reorder.released_ms < written_ms)) {
+            handle->reorder.released_ms = written_ms;
+            handle->reorder.has_released = 1;
+        }
+    }
+    mutex_unlock_portable(&handle->write_mutex);
+    return status;
+}
+
+ticks_status_e ticks_set_write_options(ticks_file_t* handle, const ticks_write_options_t* options) {
+    if (handle == NULL || options == NULL || handle->mode != FILE_MODE_WRITE || handle->file_stream == NULL ||
+        options->io_mode > TICKS_WRITE_DIRECT || options->durability > TICKS_DURABILITY_STRICT)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    // The group commit thread is stopped first, it is the only other user of the stream and staging buffers.
+    // Staged chunks are written out before the mode or staging size changes.
+    ticks_status_e status = durability_stop(handle);
+    if (status == TICKS_OK)
+        status = stop_direct_writes(handle);
+
+    if (status == TICKS_OK && options->durability != TICKS_DURABILITY_NONE && !(handle->header.flags & TICKS_HEADER_CHECKPOINTS))
+        status = mark_checkpointed(handle);
+    if (status == TICKS_OK && options->io_mode == TICKS_WRITE_DIRECT)
+        status = start_direct_writes(handle, options->staging_bytes);
+    if (status != TICKS_OK)
+        return status;
+    return durability_start(handle, options);
+}
+
+ticks_status_e ticks_set_allocator(ticks_file_t* handle, const ticks_allocator_t* allocator) {
+    if (allocator != NULL && (allocator->alloc == NULL || allocator->realloc == NULL || allocator->free == NULL ||
+                              allocator->aligned_alloc == NULL || allocator->aligned_free == NULL))
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    if (handle == NULL) {
+        mem_set_global_allocator(allocator);
+        return TICKS_OK;
+    }
+
+    const ticks_allocator_t new_allocator = allocator != NULL ? *allocator : *mem_global_allocator();
+
+    // The handle's long-lived buffers move to the new allocator so each is later freed by the one that allocated it.
+    // All copies are made before anything is released, a failed allocation leaves the handle unchanged.
+    // The group commit thread reads the index and metrics, so they only move under write_mutex.
+    mutex_lock_portable(&handle->write_mutex);
+    void** blocks[] = {
+        (void**)&handle->index.entries, (void**)&handle->index.sparse, (void**)&handle->decoded_blocks,
+        (void**)&handle->verified_columns, (void**)&handle->metrics, (void**)&handle->reorder.heap,
+        (void**)&handle->reorder.output
+    };
+    const size_t sizes[] = {
+        (size_t)handle->index.capacity * sizeof(ticks_index_entry_t),
+        (size_t)handle->index.num_sparse * sizeof(uint64_t),
+        handle->decoded_blocks != NULL ? handle->index.num_sparse : 0,
+        handle->verified_columns != NULL ? handle->index.num_entries : 0,
+        TICKS_METRICS_SHARDS * sizeof(ticks_metrics_shard_t),
+        (size_t)handle->reorder.capacity * sizeof(ticks_reorder_slot_t),
+        (size_t)handle->reorder.output_capacity * handle->reorder.num_columns * sizeof(uint64_t)
+    };
+    const size_t num_blocks = sizeof(sizes) / sizeof(sizes[0]);
+
+    void* moved[sizeof(sizes) / sizeof(sizes[0])] = {0};
+    for (size_t i = 0; i < num_blocks; i++) {
+        if (*blocks[i] == NULL || sizes[i] == 0)
+            continue;
+        moved[i] = mem_alloc(&new_allocator, sizes[i]);
+        if (moved[i] == NULL) {
+            for (size_t j = 0; j < i; j++)
+                mem_free(&new_allocator, moved[j]);
+            mutex_unlock_portable(&handle->write_mutex);
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        }
+        memcpy(moved[i], *blocks[i], sizes[i]);
+    }
+    for (size_t i = 0; i < num_blocks; i++) {
+        if (moved[i] == NULL)
+            continue;
+        mem_free(&handle->allocator, *blocks[i]);
+        *blocks[i] = moved[i];
+    }
+
+    handle->allocator = new_allocator;
+    mutex_unlock_portable(&handle->write_mutex);
     return TICKS_OK;
 }
 
@@ -293,43 +1115,12 @@ const char* ticks_status_to_string(ticks_status_e status)
             return "Invalid Format";
         case TICKS_ERROR_EMPTY_CHUNK:
             return "Empty Chunk";
+        case TICKS_ERROR_CHECKSUM_MISMATCH:
+            return "Checksum Mismatch";
+        case TICKS_ERROR_QUEUE_FULL:
+            return "Queue Full";
         default:
             return "Unrecognized Status Code";   
     }
 }
 
-
-ticks_status_e ticks_iterator_create(ticks_file_t *handle, time_t from, time_t to, ticks_iterator_t** out_iterator)
-{
-    if (handle == NULL || out_iterator == NULL)
-        return TICKS_ERROR_INVALID_ARGUMENTS;
-
-    time_t now = time(NULL);
-    if (from >= to || from < 0 || to <= 0 || from > now || to > now)
-        return TICKS_ERROR_INVALID_ARGUMENTS;
-
-    ticks_iterator_t* iterator = malloc(sizeof(ticks_iterator_t));
-    if (iterator == NULL)
-        return TICKS_ERROR_MEMORY_ALLOCATION;
-    
-    memset(iterator, 0, sizeof(ticks_iterator_t));
-    iterator->file_handle = handle;
-    iterator->from = from;
-    iterator->to = to;
-    iterator->current_chunk = 0;
-    iterator->current_record_in_chunk = 0;
-
-    *out_iterator = iterator;
-
-    return TICKS_OK;
-}
-
-ticks_status_e ticks_iterator_destroy(ticks_iterator_t *iterator)
-{
-    if (iterator == NULL)
-        return TICKS_ERROR_INVALID_ARGUMENTS;
-
-    free(iterator);
-    
-    return TICKS_OK;
-}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "ticksio/ticksio.h"
+
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_chunks.h"
+#include "ticksio/ticksio_index.h"
+#include "ticksio/ticksio_platform.h"
+#include "ticksio/ticksio_trace.h"
+
+// Aggregates run on the stored columns. A chunk lying wholly inside the range contributes its record count from the
+// index and its sum from sum_chunk_column, which works on runs and dictionary codes as stored. Only the chunks at
+// the ends of the range are decoded, and then only the timestamp and the aggregated column.
+
+// Helper function to aggregate the records of a chunk that lie in [from_ms, to_ms)
+static ticks_status_e aggregate_partial_chunk(ticks_file_t* handle, const ticks_index_entry_t* entry, uint32_t column,
+                                              const uint8_t* data, uint64_t** rows, uint32_t* rows_capacity,
+                                              uint64_t from_ms, uint64_t to_ms, ticks_aggregate_t* aggregate) {
+    const uint32_t num_columns = handle->header.schema.num_columns;
+    const uint32_t column_mask = 1u | (1u << column);
+    const uint32_t stride = column == 0 ? 1 : 2;
+
+    const uint32_t num_records = chunk_record_count(entry, num_columns);
+    if (*rows_capacity < num_records) {
+        uint64_t* new_rows = mem_realloc(&handle->allocator, *rows, (size_t)num_records * stride * sizeof(uint64_t));
+        if (new_rows == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        *rows = new_rows;
+        *rows_capacity = num_records;
+    }
+
+    const uint64_t decode_start = monotonic_ns_portable();
+    uint32_t decoded = 0;
+    ticks_status_e status = decode_chunk(entry, num_columns, column_mask, data, *rows, &decoded, handle->metrics);
+    if (status != TICKS_OK)
+        return status;
+    metrics_add(handle->metrics, METRIC_DECODE_NS, monotonic_ns_portable() - decode_start);
+    metrics_add(handle->metrics, METRIC_ROWS_DECODED, decoded);
+
+    const uint64_t* row = *rows;
+    for (uint32_t i = 0; i < decoded; i++, row += stride) {
+        if (row[0] >= from_ms && row[0] < to_ms) {
+            aggregate->count++;
+            aggregate->sum += row[stride - 1];
+        }
+    }
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_aggregate(ticks_file_t* handle, time_t from, time_t to, uint32_t column, ticks_aggregate_t* out_aggregate) {
+    TICKS_TRACE_SCOPE("aggregate");
+    if (handle == NULL || out_aggregate == NULL || column >= handle->header.schema.num_columns)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    time_t now = time(NULL);
+    if (from >= to || from < 0 || to <= 0 || from > now || to > now)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    const uint64_t from_ms = (uint64_t)from * 1000;
+    const uint64_t to_ms = (uint64_t)to * 1000;
+    const uint32_t num_columns = handle->header.schema.num_columns;
+
+    ticks_aggregate_t aggregate = {0, 0};
+    uint8_t* buffer = NULL;
+    size_t buffer_capacity = 0;
+    uint64_t* rows = NULL;
+    uint32_t rows_capacity = 0;
+    ticks_status_e status = TICKS_OK;
+
+    // Chunks are ordered by time base, nothing after a chunk starting at or past the range end can match
+    for (uint32_t chunk = find_chunk_for_time(handle, from_ms);
+         chunk < handle->index.num_entries && index_entry(handle, chunk)->chunk_time_base < to_ms && status == TICKS_OK;
+         chunk++) {
+        const ticks_index_entry_t* entry = index_entry(handle, chunk);
+        if (entry->chunk_max_time < from_ms)
+            continue;
+
+        if (entry->chunk_time_base >= from_ms && entry->chunk_max_time < to_ms) {
+            status = read_chunk(handle, chunk, 1u << column, &buffer, &buffer_capacity);
+            uint64_t sum = 0;
+            if (status == TICKS_OK)
+                status = sum_chunk_column(entry, num_columns, column, buffer, &sum);
+            aggregate.count += entry->num_records;
+            aggregate.sum += sum;
+        }
+        else {
+            status = read_chunk(handle, chunk, 1u | (1u << column), &buffer, &buffer_capacity);
+            if (status == TICKS_OK)
+                status = aggregate_partial_chunk(handle, entry, column, buffer, &rows, &rows_capacity, from_ms, to_ms, &aggregate);
+        }
+    }
+
+    mem_free(&handle->allocator, buffer);
+    mem_free(&handle->allocator, rows);
+    if (status != TICKS_OK)
+        return status;
+
+    *out_aggregate = aggregate;
+    return TICKS_OK;
+}
@@ -0,0 +1,188 @@
+#include "ticksio/ticksio_alloc.h"
+
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_platform.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void* default_alloc(size_t size, void* user) {
+    (void)user;
+    return malloc(size);
+}
+
+static void* default_realloc(void* ptr, size_t size, void* user) {
+    (void)user;
+    return realloc(ptr, size);
+}
+
+static void default_free(void* ptr, void* user) {
+    (void)user;
+    free(ptr);
+}
+
+static void* default_aligned_alloc(size_t alignment, size_t size, void* user) {
+    (void)user;
+    return aligned_alloc_portable(alignment, size);
+}
+
+static void default_aligned_free(void* ptr, void* user) {
+    (void)user;
+    aligned_free_portable(ptr);
+}
+
+static const ticks_allocator_t default_allocator = {
+    default_alloc, default_realloc, default_free, default_aligned_alloc, default_aligned_free, NULL
+};
+
+static ticks_allocator_t global_allocator = {
+    default_alloc, default_realloc, default_free, default_aligned_alloc, default_aligned_free, NULL
+};
+
+const ticks_allocator_t* mem_global_allocator(void) {
+    return &global_allocator;
+}
+
+void mem_set_global_allocator(const ticks_allocator_t* allocator) {
+    global_allocator = allocator != NULL ? *allocator : default_allocator;
+}
+
+void* mem_alloc(const ticks_allocator_t* allocator, size_t size) {
+    if (allocator == NULL)
+        allocator = &global_allocator;
+    return allocator->alloc(size, allocator->user);
+}
+
+void* mem_calloc(const ticks_allocator_t* allocator, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size)
+        return NULL;
+    void* ptr = mem_alloc(allocator, count * size);
+    if (ptr != NULL)
+        memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void* mem_realloc(const ticks_allocator_t* allocator, void* ptr, size_t size) {
+    if (allocator == NULL)
+        allocator = &global_allocator;
+    return allocator->realloc(ptr, size, allocator->user);
+}
+
+void mem_free(const ticks_allocator_t* allocator, void* ptr) {
+    if (ptr == NULL)
+        return;
+    if (allocator == NULL)
+        allocator = &global_allocator;
+    allocator->free(ptr, allocator->user);
+}
+
+void* mem_aligned_alloc(const ticks_allocator_t* allocator, size_t alignment, size_t size) {
+    if (allocator == NULL)
+        allocator = &global_allocator;
+    return allocator->aligned_alloc(alignment, size, allocator->user);
+}
+
+void mem_aligned_free(const ticks_allocator_t* allocator, void* ptr) {
+    if (ptr == NULL)
+        return;
+    if (allocator == NULL)
+        allocator = &global_allocator;
+    allocator->aligned_free(ptr, allocator->user);
+}
+
+// --- Hugepage allocator ---
+// Blocks of at least TICKS_HUGEPAGE_SIZE are mapped whole hugepages at a time, smaller ones come from malloc.
+// Each block is preceded by a header recording where it came from so free and realloc can tell them apart.
+
+typedef struct {
+    void* base;           // Start of the malloc block or the mapping
+    size_t mapped_length; // Length of the mapping, 0 for malloc blocks
+    size_t size;          // Bytes usable from the returned pointer
+    size_t alignment;     // Alignment the block was allocated with
+} huge_block_t;
+
+#define HUGE_MIN_ALIGNMENT sizeof(huge_block_t)
+
+static huge_block_t* huge_block_header(void* ptr) {
+    return (huge_block_t*)((uint8_t*)ptr - sizeof(huge_block_t));
+}
+
+static void* huge_aligned_alloc(size_t alignment, size_t size, void* user) {
+    (void)user;
+    if (alignment < HUGE_MIN_ALIGNMENT)
+        alignment = HUGE_MIN_ALIGNMENT;
+    if (size > SIZE_MAX - alignment - sizeof(huge_block_t) - TICKS_HUGEPAGE_SIZE)
+        return NULL;
+
+    // Room for the header and for aligning the pointer that follows it
+    const size_t total = size + sizeof(huge_block_t) + alignment;
+    uint8_t* base = NULL;
+    size_t mapped_length = 0;
+    if (total >= TICKS_HUGEPAGE_SIZE) {
+        mapped_length = (total + TICKS_HUGEPAGE_SIZE - 1) / TICKS_HUGEPAGE_SIZE * TICKS_HUGEPAGE_SIZE;
+        base = huge_map_portable(mapped_length, TICKS_HUGEPAGE_SIZE);
+        if (base == NULL)
+            mapped_length = 0;
+    }
+    if (base == NULL)
+        base = malloc(total);
+    if (base == NULL)
+        return NULL;
+
+    uintptr_t first = (uintptr_t)base + sizeof(huge_block_t);
+    uint8_t* ptr = (uint8_t*)((first + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    huge_block_t* header = huge_block_header(ptr);
+    header->base = base;
+    header->mapped_length = mapped_length;
+    header->size = mapped_length != 0 ? (size_t)(base + mapped_length - ptr) : size;
+    header->alignment = alignment;
+    return ptr;
+}
+
+static void* huge_alloc(size_t size, void* user) {
+    return huge_aligned_alloc(HUGE_MIN_ALIGNMENT, size, user);
+}
+
+static void huge_free(void* ptr, void* user) {
+    (void)user;
+    if (ptr == NULL)
+        return;
+    huge_block_t* header = huge_block_header(ptr);
+    if (header->mapped_length != 0)
+        huge_unmap_portable(header->base, header->mapped_length);
+    else
+        free(header->base);
+}
+
+static void* huge_realloc(void* ptr, size_t size, void* user) {
+    if (ptr == NULL)
+        return huge_alloc(size, user);
+
+    // Mappings are rounded up to whole hugepages, growth within them needs no copy
+    huge_block_t* header = huge_block_header(ptr);
+    if (size <= header->size && (header->mapped_length != 0 || size * 2 >= header->size)) {
+        if (header->mapped_length == 0)
+            header->size = size;
+        return ptr;
+    }
+
+    void* resized = huge_aligned_alloc(header->alignment, size, user);
+    if (resized == NULL)
+        return NULL;
+    memcpy(resized, ptr, header->size < size ? header->size : size);
+    huge_free(ptr, user);
+    return resized;
+}
+
+ticks_status_e ticks_allocator_hugepage(ticks_allocator_t* out_allocator) {
+    if (out_allocator == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    out_allocator->alloc = huge_alloc;
+    out_allocator->realloc = huge_realloc;
+    out_allocator->free = huge_free;
+    out_allocator->aligned_alloc = huge_aligned_alloc;
+    out_allocator->aligned_free = huge_free;
+    out_allocator->user = NULL;
+    return TICKS_OK;
+}
@@ -0,0 +1,385 @@
+#include "ticksio/ticksio.h"
+
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_cache.h"
+#include "ticksio/ticksio_chunks.h"
+#include "ticksio/ticksio_index.h"
+#include "ticksio/ticksio_platform.h"
+#include "ticksio/ticksio_schema.h"
+#include "ticksio/ticksio_trace.h"
+
+// As-of lookups merge the sorted queries with the index in one forward pass. The chunk answering a query is the last
+// one whose time base is at or before it, found by galloping forward from the previous query's chunk, so queries a
+// few chunks apart cost a few index comparisons and chunks holding no answer are never read. Each chunk that holds
+// answers is decoded once and answers every query before the next chunk's time base. Chunks written in time order
+// are walked with a second gallop over their records; chunks holding out-of-order ticks are answered by bucketing
+// their records by query instead, so records never need sorting.
+// An earlier chunk whose latest tick is after a later chunk's time base, e.g. older ticks appended to a file, may
+// hold a later answer than the chunk found for a query. The pass keeps the earlier chunks whose latest tick is still
+// after the current chunk's time base and consults those whose latest tick is after an answer. Files written in time
+// order never have any, so their chunks are still decoded once.
+
+#define NO_RECORD UINT32_MAX
+
+typedef struct {
+    ticks_file_t* handle;
+    const uint64_t* rows;             // Decoded trades of the current chunk, three values per record
+    uint32_t num_records;
+    ticks_cache_entry_t* cache_entry; // Pinned entry holding rows when they came from the cache
+    uint64_t* own_rows;               // Decoded rows when the cache is off
+    uint32_t own_rows_capacity;
+    uint8_t* chunk_buffer;            // Raw bytes of the current chunk
+    size_t chunk_buffer_capacity;
+    uint32_t* candidates;             // Per query of an out-of-order chunk, the latest record at or before it
+    uint64_t candidates_capacity;
+    uint32_t* overlapping;            // Earlier chunks whose latest tick is after the current chunk's time base
+    uint32_t num_overlapping;
+    uint32_t overlapping_capacity;
+    trade_data_t* overlap_records;    // Answers of a group of queries from one overlapping chunk
+    uint8_t* overlap_found;
+    uint64_t overlap_capacity;
+} asof_state_t;
+
+// Helper function to find the last chunk from first on whose time base is <= ms_since_epoch, as first's is known to be
+static uint32_t gallop_chunk(ticks_file_t* handle, uint32_t first, uint64_t ms_since_epoch) {
+    const uint32_t num_entries = handle->index.num_entries;
+    uint32_t low = first;
+    uint64_t step = 1;
+    while (step < num_entries - low && index_entry(handle, low + (uint32_t)step)->chunk_time_base <= ms_since_epoch) {
+        low += (uint32_t)step;
+        step *= 2;
+    }
+
+    // The answer lies in [low, high)
+    uint32_t high = step < num_entries - low ? low + (uint32_t)step : num_entries;
+    while (high - low > 1) {
+        const uint32_t mid = low + (high - low) / 2;
+        if (index_entry(handle, mid)->chunk_time_base <= ms_since_epoch)
+            low = mid;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+// Helper function to drop the rows of the previous chunk
+static void release_rows(asof_state_t* state) {
+    if (state->cache_entry != NULL) {
+        cache_release(state->cache_entry);
+        state->cache_entry = NULL;
+    }
+    state->rows = NULL;
+    state->num_records = 0;
+}
+
+// Helper function to read and decode a chunk's trades into rows
+static ticks_status_e decode_trades(asof_state_t* state, uint32_t chunk, uint64_t* rows, uint32_t* out_num_records) {
+    ticks_file_t* handle = state->handle;
+    const uint32_t column_mask = schema_all_columns(&handle->header.schema);
+    ticks_status_e status = read_chunk(handle, chunk, column_mask, &state->chunk_buffer, &state->chunk_buffer_capacity);
+    if (status != TICKS_OK)
+        return status;
+
+    const uint64_t decode_start = monotonic_ns_portable();
+    status = decode_chunk(index_entry(handle, chunk), handle->header.schema.num_columns, column_mask, state->chunk_buffer,
+                          rows, out_num_records, handle->metrics);
+    if (status != TICKS_OK)
+        return status;
+    metrics_add(handle->metrics, METRIC_DECODE_NS, monotonic_ns_portable() - decode_start);
+    metrics_add(handle->metrics, METRIC_ROWS_DECODED, *out_num_records);
+    return TICKS_OK;
+}
+
+// Helper function to make a chunk's trades available in state->rows, through the cache when it is enabled
+static ticks_status_e load_chunk(asof_state_t* state, uint32_t chunk) {
+    TICKS_TRACE_SCOPE("asof_load_chunk");
+    ticks_file_t* handle = state->handle;
+    const ticks_index_entry_t* entry = index_entry(handle, chunk);
+    const uint32_t num_records = chunk_record_count(entry, handle->header.schema.num_columns);
+    if (num_records == 0)
+        return TICKS_ERROR_INVALID_FORMAT;
+
+    release_rows(state);
+    if (handle->file_identity_valid && cache_enabled()) {
+        // Keyed like an unprojected iterator, so both share the decoded chunk
+        ticks_cache_key_t key;
+        key.file_device = handle->file_device;
+        key.file_inode = handle->file_inode;
+        key.chunk_offset = entry->chunk_offset;
+        key.chunk_checksum = entry->checksum;
+        key.column_mask = schema_all_columns(&handle->header.schema);
+
+        ticks_cache_entry_t* cache_entry = cache_acquire(&key);
+        if (cache_entry != NULL) {
+            metrics_add(handle->metrics, METRIC_CACHE_HITS, 1);
+        }
+        else {
+            metrics_add(handle->metrics, METRIC_CACHE_MISSES, 1);
+            // The cache frees entries through the process-wide allocator
+            uint64_t* rows = mem_alloc(NULL, (size_t)num_records * 3 * sizeof(uint64_t));
+            if (rows == NULL)
+                return TICKS_ERROR_MEMORY_ALLOCATION;
+            uint32_t decoded_records = 0;
+            ticks_status_e status = decode_trades(state, chunk, rows, &decoded_records);
+            if (status != TICKS_OK) {
+                mem_free(NULL, rows);
+                return status;
+            }
+            cache_entry = cache_insert(&key, rows, decoded_records, 3);
+            if (cache_entry == NULL)
+                return TICKS_ERROR_MEMORY_ALLOCATION;
+        }
+        state->cache_entry = cache_entry;
+        state->rows = cache_entry_rows(cache_entry, &state->num_records);
+        return TICKS_OK;
+    }
+
+    if (state->own_rows_capacity < num_records) {
+        uint64_t* new_rows = mem_realloc(&handle->allocator, state->own_rows, (size_t)num_records * 3 * sizeof(uint64_t));
+        if (new_rows == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        state->own_rows = new_rows;
+        state->own_rows_capacity = num_records;
+    }
+    ticks_status_e status = decode_trades(state, chunk, state->own_rows, &state->num_records);
+    if (status == TICKS_OK)
+        state->rows = state->own_rows;
+    return status;
+}
+
+// Helper function to store the answer to a query, a record position or NO_RECORD
+static void store_answer(const asof_state_t* state, uint32_t record, trade_data_t* out, uint8_t* found) {
+    if (record == NO_RECORD) {
+        memset(out, 0, sizeof(trade_data_t));
+        *found = 0;
+        return;
+    }
+    const uint64_t* row = &state->rows[(size_t)record * 3];
+    out->ms_since_epoch = row[0];
+    out->price = row[1];
+    out->volume = row[2];
+    *found = 1;
+}
+
+// Helper function to answer queries [first, end) from a chunk whose records are in time order
+static void answer_sorted(const asof_state_t* state, const uint64_t* query_ts, uint64_t first, uint64_t end,
+                          trade_data_t* out, uint8_t* found) {
+    const uint64_t* rows = state->rows;
+    const uint32_t num_records = state->num_records;
+    uint32_t record = 0; // Last record at or before the previous query, or 0 before any
+
+    for (uint64_t q = first; q < end; q++) {
+        const uint64_t ms_since_epoch = query_ts[q];
+        // Gallop to the last record at or before the query, the later of equal timestamps
+        uint64_t step = 1;
+        while (step < num_records - record && rows[(size_t)(record + step) * 3] <= ms_since_epoch) {
+            record += (uint32_t)step;
+            step *= 2;
+        }
+        uint32_t high = step < num_records - record ? record + (uint32_t)step : num_records;
+        while (high - record > 1) {
+            const uint32_t mid = record + (high - record) / 2;
+            if (rows[(size_t)mid * 3] <= ms_since_epoch)
+                record = mid;
+            else
+                high = mid;
+        }
+        store_answer(state, rows[(size_t)record * 3] <= ms_since_epoch ? record : NO_RECORD, &out[q], &found[q]);
+    }
+}
+
+// Helper function to answer queries [first, end) from a chunk holding out-of-order records. Each record is the
+// candidate of the first query at or after it, the answer to a query is the latest candidate up to it.
+static ticks_status_e answer_unsorted(asof_state_t* state, const uint64_t* query_ts, uint64_t first, uint64_t end,
+                                      trade_data_t* out, uint8_t* found) {
+    const uint64_t num_queries = end - first;
+    if (state->candidates_capacity < num_queries) {
+        uint32_t* new_candidates = mem_realloc(&state->handle->allocator, state->candidates, (size_t)num_queries * sizeof(uint32_t));
+        if (new_candidates == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        state->candidates = new_candidates;
+        state->candidates_capacity = num_queries;
+    }
+    uint32_t* candidates = state->candidates;
+    for (uint64_t q = 0; q < num_queries; q++)
+        candidates[q] = NO_RECORD;
+
+    const uint64_t* rows = state->rows;
+    for (uint32_t record = 0; record < state->num_records; record++) {
+        const uint64_t ms_since_epoch = rows[(size_t)record * 3];
+        uint64_t low = first;
+        uint64_t high = end;
+        while (low < high) {
+            const uint64_t mid = low + (high - low) / 2;
+            if (query_ts[mid] < ms_since_epoch)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        if (low == end)
+            continue;
+        // Later records win ties, as in a chunk written in order
+        uint32_t* candidate = &candidates[low - first];
+        if (*candidate == NO_RECORD || rows[(size_t)*candidate * 3] <= ms_since_epoch)
+            *candidate = record;
+    }
+
+    uint32_t latest = NO_RECORD;
+    for (uint64_t q = 0; q < num_queries; q++) {
+        const uint32_t candidate = candidates[q];
+        if (candidate != NO_RECORD && (latest == NO_RECORD || rows[(size_t)candidate * 3] >= rows[(size_t)latest * 3]))
+            latest = candidate;
+        store_answer(state, latest, &out[first + q], &found[first + q]);
+    }
+    return TICKS_OK;
+}
+
+// Helper function to check whether the current chunk's records are in time order
+static int rows_sorted(const asof_state_t* state) {
+    for (uint32_t record = 1; record < state->num_records; record++) {
+        if (state->rows[(size_t)record * 3] < state->rows[(size_t)(record - 1) * 3])
+            return 0;
+    }
+    return 1;
+}
+
+// Helper function to answer queries [first, end) from the chunk in state->rows
+static ticks_status_e answer_chunk(asof_state_t* state, const uint64_t* query_ts, uint64_t first, uint64_t end,
+                                   trade_data_t* out, uint8_t* found) {
+    if (rows_sorted(state)) {
+        answer_sorted(state, query_ts, first, end, out, found);
+        return TICKS_OK;
+    }
+    return answer_unsorted(state, query_ts, first, end, out, found);
+}
+
+// Helper function to move the overlapping chunks on to chunk, dropping those whose latest tick is no longer after
+// its time base and adding the chunks [from, chunk) the pass went by whose latest tick is
+static ticks_status_e track_overlaps(asof_state_t* state, uint32_t from, uint32_t chunk) {
+    ticks_file_t* handle = state->handle;
+    const uint64_t time_base = index_entry(handle, chunk)->chunk_time_base;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < state->num_overlapping; i++) {
+        if (index_entry(handle, state->overlapping[i])->chunk_max_time > time_base)
+            state->overlapping[kept++] = state->overlapping[i];
+    }
+    state->num_overlapping = kept;
+
+    for (uint32_t earlier = from; earlier < chunk; earlier++) {
+        if (index_entry(handle, earlier)->chunk_max_time <= time_base)
+            continue;
+        if (state->num_overlapping == state->overlapping_capacity) {
+            const uint32_t capacity = state->overlapping_capacity != 0 ? state->overlapping_capacity * 2 : 16;
+            uint32_t* new_overlapping = mem_realloc(&handle->allocator, state->overlapping, (size_t)capacity * sizeof(uint32_t));
+            if (new_overlapping == NULL)
+                return TICKS_ERROR_MEMORY_ALLOCATION;
+            state->overlapping = new_overlapping;
+            state->overlapping_capacity = capacity;
+        }
+        state->overlapping[state->num_overlapping++] = earlier;
+    }
+    return TICKS_OK;
+}
+
+// Helper function to improve the answers to queries [first, end) with the overlapping chunks. Answers grow with the
+// queries, so only a leading run of them is earlier than an overlapping chunk's latest tick. The chunks are consulted
+// from the latest written, and replace an answer only with a strictly later tick, so ties go to the tick written last.
+static ticks_status_e answer_overlaps(asof_state_t* state, const uint64_t* query_ts, uint64_t first, uint64_t end,
+                                      trade_data_t* out, uint8_t* found) {
+    ticks_file_t* handle = state->handle;
+    for (uint32_t i = state->num_overlapping; i-- > 0;) {
+        const uint32_t chunk = state->overlapping[i];
+        const uint64_t max_time = index_entry(handle, chunk)->chunk_max_time;
+        uint64_t run_end = first;
+        while (run_end < end && (!found[run_end] || out[run_end].ms_since_epoch < max_time))
+            run_end++;
+        if (run_end == first)
+            continue;
+
+        const uint64_t num_queries = run_end - first;
+        if (state->overlap_capacity < num_queries) {
+            trade_data_t* new_records = mem_realloc(&handle->allocator, state->overlap_records, (size_t)num_queries * sizeof(trade_data_t));
+            if (new_records == NULL)
+                return TICKS_ERROR_MEMORY_ALLOCATION;
+            state->overlap_records = new_records;
+            uint8_t* new_found = mem_realloc(&handle->allocator, state->overlap_found, (size_t)num_queries);
+            if (new_found == NULL)
+                return TICKS_ERROR_MEMORY_ALLOCATION;
+            state->overlap_found = new_found;
+            state->overlap_capacity = num_queries;
+        }
+
+        ticks_status_e status = load_chunk(state, chunk);
+        if (status == TICKS_OK)
+            status = answer_chunk(state, query_ts + first, 0, num_queries, state->overlap_records, state->overlap_found);
+        if (status != TICKS_OK)
+            return status;
+        for (uint64_t q = 0; q < num_queries; q++) {
+            if (state->overlap_found[q] &&
+                (!found[first + q] || state->overlap_records[q].ms_since_epoch > out[first + q].ms_since_epoch)) {
+                out[first + q] = state->overlap_records[q];
+                found[first + q] = 1;
+            }
+        }
+    }
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_asof(ticks_file_t* handle, const uint64_t* query_ts, uint64_t num_queries, trade_data_t* out_records,
+                          uint8_t* out_found) {
+    TICKS_TRACE_SCOPE("asof");
+    if (handle == NULL || (num_queries > 0 && (query_ts == NULL || out_records == NULL || out_found == NULL)) ||
+        !schema_has_trade_layout(&handle->header.schema))
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    for (uint64_t q = 1; q < num_queries; q++) {
+        if (query_ts[q] < query_ts[q - 1])
+            return TICKS_ERROR_INVALID_ARGUMENTS;
+    }
+
+    // Queries before the first chunk have no answer
+    const uint32_t num_entries = handle->index.num_entries;
+    uint64_t q = 0;
+    while (q < num_queries && (num_entries == 0 || query_ts[q] < index_entry(handle, 0)->chunk_time_base)) {
+        memset(&out_records[q], 0, sizeof(trade_data_t));
+        out_found[q++] = 0;
+    }
+    if (q == num_queries)
+        return TICKS_OK;
+
+    asof_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.handle = handle;
+    ticks_status_e status = TICKS_OK;
+
+    // The sparse index places the first query, later ones gallop forward from the chunk before them. Every chunk the
+    // pass goes by is checked for ticks after the current chunk's time base, on the index alone.
+    uint32_t chunk = find_chunk_for_time(handle, query_ts[q]);
+    uint32_t passed = 0;
+    while (q < num_queries && status == TICKS_OK) {
+        chunk = gallop_chunk(handle, chunk, query_ts[q]);
+        const uint64_t next_time_base = chunk + 1 < num_entries ? index_entry(handle, chunk + 1)->chunk_time_base : UINT64_MAX;
+        uint64_t end = q + 1;
+        while (end < num_queries && query_ts[end] < next_time_base)
+            end++;
+
+        status = track_overlaps(&state, passed, chunk);
+        passed = chunk;
+        if (status == TICKS_OK)
+            status = load_chunk(&state, chunk);
+        if (status == TICKS_OK)
+            status = answer_chunk(&state, query_ts, q, end, out_records, out_found);
+        if (status == TICKS_OK && state.num_overlapping > 0)
+            status = answer_overlaps(&state, query_ts, q, end, out_records, out_found);
+        q = end;
+    }
+
+    release_rows(&state);
+    mem_free(&handle->allocator, state.own_rows);
+    mem_free(&handle->allocator, state.chunk_buffer);
+    mem_free(&handle->allocator, state.candidates);
+    mem_free(&handle->allocator, state.overlapping);
+    mem_free(&handle->allocator, state.overlap_records);
+    mem_free(&handle->allocator, state.overlap_found);
+    return status;
+}
@@ -0,0 +1,331 @@
+#include "ticksio/ticksio_async.h"
+
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_trace.h"
+
+// Helper function to wake whichever side may be sleeping on the writer's condition variable
+static void wake(ticks_async_writer_t* writer) {
+    mutex_lock_portable(&writer->mutex);
+    cond_broadcast_portable(&writer->cond);
+    mutex_unlock_portable(&writer->mutex);
+}
+
+// Helper function to record the first error, after which pushes fail and queued rows are discarded
+static void fail(ticks_async_writer_t* writer, ticks_status_e status) {
+    if (atomic_load_u8_portable(&writer->failed))
+        return;
+    writer->status = status;
+    atomic_store_release_u8_portable(&writer->failed, 1);
+}
+
+// Helper function to add the batched rows to the file
+static void write_batch(ticks_async_writer_t* writer) {
+    TICKS_TRACE_SCOPE("async_write_batch");
+    if (writer->num_batched == 0)
+        return;
+    if (!atomic_load_u8_portable(&writer->failed)) {
+        ticks_status_e status = ticks_add_records(writer->handle, writer->batch, writer->num_batched);
+        if (status != TICKS_OK)
+            fail(writer, status);
+        else
+            atomic_store_u64_portable(&writer->written_rows, writer->written_rows + writer->num_batched);
+    }
+    writer->num_batched = 0;
+}
+
+// Helper function to move queued rows into the batch and hand their slots back to the producer
+static void take_rows(ticks_async_writer_t* writer, uint64_t tail, uint64_t available) {
+    const uint64_t room = writer->batch_rows - writer->num_batched;
+    const uint64_t count = available < room ? available : room;
+    const uint64_t first = tail & (writer->capacity - 1);
+    const uint64_t before_wrap = writer->capacity - first < count ? writer->capacity - first : count;
+    const size_t row_bytes = (size_t)writer->num_columns * sizeof(uint64_t);
+
+    uint64_t* out = writer->batch + (size_t)writer->num_batched * writer->num_columns;
+    memcpy(out, writer->ring + first * writer->num_columns, (size_t)before_wrap * row_bytes);
+    if (count > before_wrap)
+        memcpy(out + (size_t)before_wrap * writer->num_columns, writer->ring, (size_t)(count - before_wrap) * row_bytes);
+
+    // The oldest row taken waited longest, its wait stands for the take
+    const uint64_t pushed_ns = writer->push_ns[first];
+    const uint64_t now = monotonic_ns_portable();
+    const uint64_t latency_ns = now > pushed_ns ? now - pushed_ns : 0;
+    if (writer->num_batched == 0)
+        writer->batched_since_ns = pushed_ns;
+    writer->num_batched += (uint32_t)count;
+
+    atomic_store_release_u64_portable(&writer->tail, tail + count);
+    if (atomic_load_u8_portable(&writer->producer_waiting))
+        wake(writer);
+
+    atomic_store_u64_portable(&writer->latency_sum_ns, writer->latency_sum_ns + latency_ns);
+    atomic_store_u64_portable(&writer->latency_samples, writer->latency_samples + 1);
+    if (latency_ns > writer->max_latency_ns)
+        atomic_store_u64_portable(&writer->max_latency_ns, latency_ns);
+    if (available > writer->max_depth)
+        atomic_store_u64_portable(&writer->max_depth, available);
+}
+
+// Helper function to sleep until the producer pushes, a flush or stop is requested, or wait_ms pass
+static void encoder_sleep(ticks_async_writer_t* writer, uint64_t tail, uint32_t wait_ms) {
+    mutex_lock_portable(&writer->mutex);
+    atomic_store_release_u8_portable(&writer->encoder_sleeping, 1);
+    if (atomic_load_acquire_u64_portable(&writer->head) == tail && !writer->stop &&
+        writer->flush_requested == writer->flush_done)
+        cond_timedwait_portable(&writer->cond, &writer->mutex, wait_ms);
+    atomic_store_release_u8_portable(&writer->encoder_sleeping, 0);
+    mutex_unlock_portable(&writer->mutex);
+}
+
+static void* encoder_thread(void* arg) {
+    ticks_async_writer_t* writer = arg;
+    uint32_t idle_spins = 0;
+    for (;;) {
+        // Read before head, so rows pushed before a flush or stop request are seen with it
+        const uint64_t flush_requested = atomic_load_acquire_u64_portable(&writer->flush_requested);
+        const uint8_t stop = atomic_load_acquire_u8_portable(&writer->stop);
+        const uint64_t tail = writer->tail;
+        const uint64_t available = atomic_load_acquire_u64_portable(&writer->head) - tail;
+
+        if (available > 0) {
+            take_rows(writer, tail, available);
+            if (writer->num_batched == writer->batch_rows)
+                write_batch(writer);
+            idle_spins = 0;
+            continue;
+        }
+
+        // The ring is empty, rows that waited flush_ns are written without waiting for a full batch
+        const uint64_t now = monotonic_ns_portable();
+        if (writer->num_batched > 0 &&
+            (now - writer->batched_since_ns >= writer->flush_ns || flush_requested != writer->flush_done || stop))
+            write_batch(writer);
+        if (flush_requested != writer->flush_done) {
+            mutex_lock_portable(&writer->mutex);
+            writer->flush_done = flush_requested;
+            cond_broadcast_portable(&writer->cond);
+            mutex_unlock_portable(&writer->mutex);
+        }
+        if (stop)
+            break;
+
+        if (++idle_spins < TICKS_ASYNC_SPIN) {
+            cpu_relax_portable();
+            continue;
+        }
+        uint32_t wait_ms = TICKS_ASYNC_IDLE_MS;
+        if (writer->num_batched > 0) {
+            const uint64_t elapsed_ns = now - writer->batched_since_ns;
+            const uint64_t remaining_ms = elapsed_ns < writer->flush_ns ? (writer->flush_ns - elapsed_ns + 999999) / 1000000 : 1;
+            if (remaining_ms < wait_ms)
+                wait_ms = (uint32_t)remaining_ms;
+        }
+        encoder_sleep(writer, tail, wait_ms);
+        idle_spins = 0;
+    }
+    return NULL;
+}
+
+// Helper function to wait for room for count rows, count being at most the capacity
+static void wait_for_room(ticks_async_writer_t* writer, uint64_t head, uint64_t count) {
+    uint32_t spins = 0;
+    while (writer->capacity - (head - writer->cached_tail) < count) {
+        if (++spins < TICKS_ASYNC_SPIN) {
+            cpu_relax_portable();
+        }
+        else {
+            mutex_lock_portable(&writer->mutex);
+            atomic_store_release_u8_portable(&writer->producer_waiting, 1);
+            if (writer->capacity - (head - atomic_load_acquire_u64_portable(&writer->tail)) < count)
+                cond_timedwait_portable(&writer->cond, &writer->mutex, 1);
+            atomic_store_release_u8_portable(&writer->producer_waiting, 0);
+            mutex_unlock_portable(&writer->mutex);
+        }
+        writer->cached_tail = atomic_load_acquire_u64_portable(&writer->tail);
+    }
+}
+
+// Helper function to copy count rows into the ring at head and publish them, room was already checked
+static void publish_rows(ticks_async_writer_t* writer, uint64_t head, const uint64_t* rows, uint64_t count) {
+    const uint64_t first = head & (writer->capacity - 1);
+    const uint64_t before_wrap = writer->capacity - first < count ? writer->capacity - first : count;
+    const size_t row_bytes = (size_t)writer->num_columns * sizeof(uint64_t);
+    memcpy(writer->ring + first * writer->num_columns, rows, (size_t)before_wrap * row_bytes);
+    if (count > before_wrap)
+        memcpy(writer->ring, rows + (size_t)before_wrap * writer->num_columns, (size_t)(count - before_wrap) * row_bytes);
+
+    const uint64_t now = monotonic_ns_portable();
+    for (uint64_t i = 0; i < count; i++)
+        writer->push_ns[(head + i) & (writer->capacity - 1)] = now;
+
+    atomic_store_release_u64_portable(&writer->head, head + count);
+
+    // A sleeping encoder thread wakes by itself within TICKS_ASYNC_IDLE_MS, so it is only woken early once enough
+    // rows are queued. The depth is checked against the cached tail first, which only overestimates it.
+    if (head + count - writer->cached_tail >= writer->wake_rows) {
+        writer->cached_tail = atomic_load_acquire_u64_portable(&writer->tail);
+        if (head + count - writer->cached_tail >= writer->wake_rows && atomic_load_u8_portable(&writer->encoder_sleeping))
+            wake(writer);
+    }
+}
+
+ticks_status_e ticks_async_writer_create(ticks_file_t* handle, const ticks_async_options_t* options, ticks_async_writer_t** out_writer) {
+    if (handle == NULL || out_writer == NULL || handle->mode != FILE_MODE_WRITE || handle->file_stream == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    ticks_async_options_t default_options;
+    memset(&default_options, 0, sizeof(default_options));
+    if (options == NULL)
+        options = &default_options;
+    if (options->backpressure > TICKS_BACKPRESSURE_REPORT || options->queue_rows > (1u << 31))
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    ticks_async_writer_t* writer = mem_alloc(&handle->allocator, sizeof(ticks_async_writer_t));
+    if (writer == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    memset(writer, 0, sizeof(ticks_async_writer_t));
+    writer->allocator = handle->allocator;
+    writer->handle = handle;
+    writer->num_columns = handle->header.schema.num_columns;
+    writer->backpressure = options->backpressure;
+    writer->flush_ns = (uint64_t)(options->flush_ms != 0 ? options->flush_ms : TICKS_ASYNC_FLUSH_MS) * 1000000;
+    writer->batch_rows = options->batch_rows != 0 ? options->batch_rows : TICKS_ASYNC_BATCH_ROWS;
+    writer->status = TICKS_OK;
+
+    // A power of two so slots are found with a mask
+    const uint64_t queue_rows = options->queue_rows != 0 ? options->queue_rows : TICKS_ASYNC_QUEUE_ROWS;
+    writer->capacity = 1;
+    while (writer->capacity < queue_rows)
+        writer->capacity *= 2;
+    writer->wake_rows = writer->batch_rows < writer->capacity / 2 ? writer->batch_rows : writer->capacity / 2;
+    if (writer->wake_rows == 0)
+        writer->wake_rows = 1;
+
+    const size_t row_bytes = (size_t)writer->num_columns * sizeof(uint64_t);
+    writer->ring = mem_alloc(&writer->allocator, (size_t)writer->capacity * row_bytes);
+    writer->push_ns = mem_alloc(&writer->allocator, (size_t)writer->capacity * sizeof(uint64_t));
+    writer->batch = mem_alloc(&writer->allocator, (size_t)writer->batch_rows * row_bytes);
+    if (writer->ring == NULL || writer->push_ns == NULL || writer->batch == NULL) {
+        mem_free(&writer->allocator, writer->ring);
+        mem_free(&writer->allocator, writer->push_ns);
+        mem_free(&writer->allocator, writer->batch);
+        mem_free(&writer->allocator, writer);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+
+    // Touched up front so the producer never takes a page fault on a fresh slot
+    memset(writer->ring, 0, (size_t)writer->capacity * row_bytes);
+    memset(writer->push_ns, 0, (size_t)writer->capacity * sizeof(uint64_t));
+
+    mutex_init_portable(&writer->mutex);
+    cond_init_portable(&writer->cond);
+    if (thread_create_portable(&writer->thread, encoder_thread, writer) != 0) {
+        cond_destroy_portable(&writer->cond);
+        mutex_destroy_portable(&writer->mutex);
+        mem_free(&writer->allocator, writer->ring);
+        mem_free(&writer->allocator, writer->push_ns);
+        mem_free(&writer->allocator, writer->batch);
+        mem_free(&writer->allocator, writer);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+
+    *out_writer = writer;
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_async_push(ticks_async_writer_t* writer, const uint64_t* rows, uint32_t num_rows) {
+    if (writer == NULL || rows == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    if (atomic_load_acquire_u8_portable(&writer->failed))
+        return writer->status;
+
+    uint64_t head = writer->head;
+    if (writer->capacity - (head - writer->cached_tail) < num_rows) {
+        writer->cached_tail = atomic_load_acquire_u64_portable(&writer->tail);
+        if (writer->capacity - (head - writer->cached_tail) < num_rows) {
+            // A full ring is always worth waking the encoder thread for
+            if (atomic_load_u8_portable(&writer->encoder_sleeping))
+                wake(writer);
+            if (writer->backpressure == TICKS_BACKPRESSURE_DROP) {
+                atomic_store_u64_portable(&writer->dropped_rows, writer->dropped_rows + num_rows);
+                return TICKS_OK;
+            }
+            if (writer->backpressure == TICKS_BACKPRESSURE_REPORT) {
+                atomic_store_u64_portable(&writer->rejected_pushes, writer->rejected_pushes + 1);
+                return TICKS_ERROR_QUEUE_FULL;
+            }
+            atomic_store_u64_portable(&writer->blocked_pushes, writer->blocked_pushes + 1);
+        }
+    }
+
+    // Pushes larger than the ring are published a ring at a time
+    uint64_t pushed = 0;
+    while (pushed < num_rows) {
+        const uint64_t count = num_rows - pushed < writer->capacity ? num_rows - pushed : writer->capacity;
+        wait_for_room(writer, head, count);
+        publish_rows(writer, head, rows + (size_t)pushed * writer->num_columns, count);
+        head += count;
+        pushed += count;
+    }
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_async_flush(ticks_async_writer_t* writer) {
+    if (writer == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    mutex_lock_portable(&writer->mutex);
+    const uint64_t target = writer->flush_requested + 1;
+    atomic_store_release_u64_portable(&writer->flush_requested, target);
+    cond_broadcast_portable(&writer->cond);
+    while (writer->flush_done < target)
+        cond_wait_portable(&writer->cond, &writer->mutex);
+    mutex_unlock_portable(&writer->mutex);
+
+    return atomic_load_acquire_u8_portable(&writer->failed) ? writer->status : TICKS_OK;
+}
+
+ticks_status_e ticks_async_get_stats(ticks_async_writer_t* writer, ticks_async_stats_t* out_stats) {
+    if (writer == NULL || out_stats == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    // Tail first, so head - tail never underflows
+    const uint64_t tail = atomic_load_acquire_u64_portable(&writer->tail);
+    const uint64_t head = atomic_load_acquire_u64_portable(&writer->head);
+    const uint64_t latency_samples = atomic_load_u64_portable(&writer->latency_samples);
+    memset(out_stats, 0, sizeof(ticks_async_stats_t));
+    out_stats->pushed_rows = head;
+    out_stats->dropped_rows = atomic_load_u64_portable(&writer->dropped_rows);
+    out_stats->rejected_pushes = atomic_load_u64_portable(&writer->rejected_pushes);
+    out_stats->blocked_pushes = atomic_load_u64_portable(&writer->blocked_pushes);
+    out_stats->written_rows = atomic_load_u64_portable(&writer->written_rows);
+    out_stats->depth = head - tail;
+    out_stats->max_depth = atomic_load_u64_portable(&writer->max_depth);
+    out_stats->mean_latency_ns = latency_samples > 0 ? atomic_load_u64_portable(&writer->latency_sum_ns) / latency_samples : 0;
+    out_stats->max_latency_ns = atomic_load_u64_portable(&writer->max_latency_ns);
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_async_writer_destroy(ticks_async_writer_t* writer) {
+    if (writer == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    // The encoder thread drains the ring and writes its last batch before it exits
+    mutex_lock_portable(&writer->mutex);
+    atomic_store_release_u8_portable(&writer->stop, 1);
+    cond_broadcast_portable(&writer->cond);
+    mutex_unlock_portable(&writer->mutex);
+    thread_join_portable(writer->thread);
+
+    const ticks_status_e status = writer->status;
+    const ticks_allocator_t allocator = writer->allocator;
+    cond_destroy_portable(&writer->cond);
+    mutex_destroy_portable(&writer->mutex);
+    mem_free(&allocator, writer->ring);
+    mem_free(&allocator, writer->push_ns);
+    mem_free(&allocator, writer->batch);
+    mem_free(&allocator, writer);
+    return status;
+}
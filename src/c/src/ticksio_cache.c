@@ -0,0 +1,252 @@
+#include "ticksio/ticksio_cache.h"
+
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_platform.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_INITIAL_BUCKETS 256
+
+struct ticks_cache_entry_t {
+    ticks_cache_key_t key;
+    uint64_t* rows;
+    uint32_t num_records;
+    uint32_t ref_count;
+    uint64_t size_bytes;
+    uint8_t cached;                    // Cleared once the entry is removed from the table
+    struct ticks_cache_entry_t* hash_next;
+    struct ticks_cache_entry_t* lru_prev; // Towards the most recently used entry
+    struct ticks_cache_entry_t* lru_next; // Towards the least recently used entry
+};
+
+// All state is guarded by cache_mutex. Lookups and inserts happen once per chunk, so a single
+// lock is not contended in practice next to the cost of reading or decoding a chunk.
+static mutex_portable cache_mutex = MUTEX_INIT_PORTABLE;
+static ticks_cache_entry_t** cache_buckets = NULL;
+static uint32_t cache_num_buckets = 0;
+static ticks_cache_entry_t* cache_lru_head = NULL; // Most recently used
+static ticks_cache_entry_t* cache_lru_tail = NULL; // Least recently used
+static ticks_cache_stats_t cache_stats = {0};
+
+static uint64_t cache_key_hash(const ticks_cache_key_t* key) {
+    uint64_t hash = key->file_device * 0x9E3779B97F4A7C15ULL;
+    hash ^= key->file_inode + 0xC2B2AE3D27D4EB4FULL + (hash << 6) + (hash >> 2);
+    hash ^= key->chunk_offset + 0x165667B19E3779F9ULL + (hash << 6) + (hash >> 2);
+    hash ^= key->chunk_checksum ^ ((uint64_t)key->column_mask << 32);
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static int cache_key_equal(const ticks_cache_key_t* a, const ticks_cache_key_t* b) {
+    return a->file_device == b->file_device && a->file_inode == b->file_inode &&
+           a->chunk_offset == b->chunk_offset && a->chunk_checksum == b->chunk_checksum &&
+           a->column_mask == b->column_mask;
+}
+
+static void lru_unlink(ticks_cache_entry_t* entry) {
+    if (entry->lru_prev != NULL)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        cache_lru_head = entry->lru_next;
+    if (entry->lru_next != NULL)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        cache_lru_tail = entry->lru_prev;
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+static void lru_push_front(ticks_cache_entry_t* entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = cache_lru_head;
+    if (cache_lru_head != NULL)
+        cache_lru_head->lru_prev = entry;
+    cache_lru_head = entry;
+    if (cache_lru_tail == NULL)
+        cache_lru_tail = entry;
+}
+
+static ticks_cache_entry_t* table_find(const ticks_cache_key_t* key) {
+    if (cache_num_buckets == 0)
+        return NULL;
+    ticks_cache_entry_t* entry = cache_buckets[cache_key_hash(key) & (cache_num_buckets - 1)];
+    while (entry != NULL && !cache_key_equal(&entry->key, key))
+        entry = entry->hash_next;
+    return entry;
+}
+
+static void table_remove(ticks_cache_entry_t* entry) {
+    ticks_cache_entry_t** link = &cache_buckets[cache_key_hash(&entry->key) & (cache_num_buckets - 1)];
+    while (*link != entry)
+        link = &(*link)->hash_next;
+    *link = entry->hash_next;
+    entry->hash_next = NULL;
+}
+
+static int table_grow(void) {
+    uint32_t new_num_buckets = cache_num_buckets == 0 ? CACHE_INITIAL_BUCKETS : cache_num_buckets * 2;
+    ticks_cache_entry_t** new_buckets = mem_calloc(NULL, new_num_buckets, sizeof(ticks_cache_entry_t*));
+    if (new_buckets == NULL)
+        return -1;
+
+    for (uint32_t bucket = 0; bucket < cache_num_buckets; bucket++) {
+        ticks_cache_entry_t* entry = cache_buckets[bucket];
+        while (entry != NULL) {
+            ticks_cache_entry_t* next = entry->hash_next;
+            uint32_t new_bucket = (uint32_t)(cache_key_hash(&entry->key) & (new_num_buckets - 1));
+            entry->hash_next = new_buckets[new_bucket];
+            new_buckets[new_bucket] = entry;
+            entry = next;
+        }
+    }
+
+    mem_free(NULL, cache_buckets);
+    cache_buckets = new_buckets;
+    cache_num_buckets = new_num_buckets;
+    return 0;
+}
+
+static void entry_free(ticks_cache_entry_t* entry) {
+    mem_free(NULL, entry->rows);
+    mem_free(NULL, entry);
+}
+
+// Removes an entry from the table and LRU list, freeing it unless it is still pinned
+static void cache_evict(ticks_cache_entry_t* entry) {
+    table_remove(entry);
+    if (entry->ref_count == 0)
+        lru_unlink(entry);
+    else
+        cache_stats.pinned--;
+    entry->cached = 0;
+    cache_stats.used_bytes -= entry->size_bytes;
+    cache_stats.entries--;
+    cache_stats.evictions++;
+    if (entry->ref_count == 0)
+        entry_free(entry);
+}
+
+// Evicts unpinned entries, least recently used first, until used_bytes fits the budget.
+// Pinned entries are not on the LRU list, so they can keep the cache over budget until released.
+static void cache_shrink_to_budget(void) {
+    while (cache_stats.used_bytes > cache_stats.budget_bytes && cache_lru_tail != NULL)
+        cache_evict(cache_lru_tail);
+}
+
+int cache_enabled(void) {
+    return atomic_load_u64_portable(&cache_stats.budget_bytes) != 0;
+}
+
+ticks_cache_entry_t* cache_acquire(const ticks_cache_key_t* key) {
+    mutex_lock_portable(&cache_mutex);
+    ticks_cache_entry_t* entry = table_find(key);
+    if (entry != NULL) {
+        if (entry->ref_count++ == 0) {
+            lru_unlink(entry);
+            cache_stats.pinned++;
+        }
+        cache_stats.hits++;
+    }
+    else {
+        cache_stats.misses++;
+    }
+    mutex_unlock_portable(&cache_mutex);
+    return entry;
+}
+
+ticks_cache_entry_t* cache_insert(const ticks_cache_key_t* key, uint64_t* rows, uint32_t num_records, uint32_t num_columns) {
+    ticks_cache_entry_t* entry = mem_alloc(NULL, sizeof(ticks_cache_entry_t));
+    if (entry == NULL) {
+        mem_free(NULL, rows);
+        return NULL;
+    }
+    memset(entry, 0, sizeof(ticks_cache_entry_t));
+    entry->key = *key;
+    entry->rows = rows;
+    entry->num_records = num_records;
+    entry->ref_count = 1;
+    entry->size_bytes = (uint64_t)num_records * num_columns * sizeof(uint64_t) + sizeof(ticks_cache_entry_t);
+
+    mutex_lock_portable(&cache_mutex);
+
+    // Another reader may have decoded the same chunk while we were
+    ticks_cache_entry_t* existing = table_find(key);
+    if (existing != NULL) {
+        if (existing->ref_count++ == 0) {
+            lru_unlink(existing);
+            cache_stats.pinned++;
+        }
+        mutex_unlock_portable(&cache_mutex);
+        entry_free(entry);
+        return existing;
+    }
+
+    if (entry->size_bytes > cache_stats.budget_bytes ||
+        (cache_stats.entries >= cache_num_buckets && table_grow() != 0)) {
+        // Handed out uncached, freed on release
+        mutex_unlock_portable(&cache_mutex);
+        return entry;
+    }
+
+    uint32_t bucket = (uint32_t)(cache_key_hash(key) & (cache_num_buckets - 1));
+    entry->hash_next = cache_buckets[bucket];
+    cache_buckets[bucket] = entry;
+    entry->cached = 1;
+    cache_stats.entries++;
+    cache_stats.pinned++;
+    cache_stats.used_bytes += entry->size_bytes;
+    cache_shrink_to_budget();
+
+    mutex_unlock_portable(&cache_mutex);
+    return entry;
+}
+
+void cache_release(ticks_cache_entry_t* entry) {
+    if (entry == NULL)
+        return;
+
+    mutex_lock_portable(&cache_mutex);
+    if (--entry->ref_count == 0) {
+        if (entry->cached) {
+            cache_stats.pinned--;
+            lru_push_front(entry);
+            cache_shrink_to_budget();
+        }
+        else {
+            entry_free(entry);
+        }
+    }
+    mutex_unlock_portable(&cache_mutex);
+}
+
+const uint64_t* cache_entry_rows(const ticks_cache_entry_t* entry, uint32_t* out_num_records) {
+    *out_num_records = entry->num_records;
+    return entry->rows;
+}
+
+ticks_status_e ticks_cache_set_budget(uint64_t max_bytes) {
+    mutex_lock_portable(&cache_mutex);
+    cache_stats.budget_bytes = max_bytes;
+    cache_shrink_to_budget();
+    if (cache_stats.entries == 0) {
+        mem_free(NULL, cache_buckets);
+        cache_buckets = NULL;
+        cache_num_buckets = 0;
+    }
+    mutex_unlock_portable(&cache_mutex);
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_cache_get_stats(ticks_cache_stats_t* out_stats) {
+    if (out_stats == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    mutex_lock_portable(&cache_mutex);
+    *out_stats = cache_stats;
+    mutex_unlock_portable(&cache_mutex);
+    return TICKS_OK;
+}
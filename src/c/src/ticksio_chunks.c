@@ -4,94 +4,344 @@
 
 #include "ticksio/ticksio_types.h"
 #include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_alloc.h"
 #include "ticksio/ticksio_constants.h"
+#include "ticksio/ticksio_crc32c.h"
+#include "ticksio/ticksio_index.h"
+#include "ticksio/ticksio_platform.h"
+#include "ticksio/ticksio_schema.h"
+#include "ticksio/ticksio_trace.h"
 
-// Helper function to write data of a specific size to a buffer
-static void write_data(uint8_t** buffer, uint64_t value, size_e size) {
-    switch (size) {
-        case SIZE_8BIT: {
-            uint8_t val = (uint8_t)value;
-            memcpy(*buffer, &val, sizeof(val));
-            *buffer += sizeof(val);
+// Helper function to store one column of row-major records as value - base at a fixed width.
+// The width switch sits outside the loop so each case is a tight, vectorizable loop.
+static void encode_column(uint8_t* out, const uint64_t* rows, uint32_t stride, uint32_t num_rows, uint64_t base, size_e width) {
+    switch (width) {
+        case SIZE_8BIT:
+            for (uint32_t i = 0; i < num_rows; i++)
+                out[i] = (uint8_t)(rows[(size_t)i * stride] - base);
             break;
-        }
-        case SIZE_16BIT: {
-            uint16_t val = (uint16_t)value;
-            memcpy(*buffer, &val, sizeof(val));
-            *buffer += sizeof(val);
+        case SIZE_16BIT:
+            for (uint32_t i = 0; i < num_rows; i++) {
+                const uint16_t value = (uint16_t)(rows[(size_t)i * stride] - base);
+                memcpy(out + (size_t)i * sizeof(value), &value, sizeof(value));
+            }
             break;
-        }
-        case SIZE_32BIT: {
-            uint32_t val = (uint32_t)value;
-            memcpy(*buffer, &val, sizeof(val));
-            *buffer += sizeof(val);
+        case SIZE_32BIT:
+            for (uint32_t i = 0; i < num_rows; i++) {
+                const uint32_t value = (uint32_t)(rows[(size_t)i * stride] - base);
+                memcpy(out + (size_t)i * sizeof(value), &value, sizeof(value));
+            }
             break;
-        }
-        case SIZE_64BIT: {
-            uint64_t val = value;
-            memcpy(*buffer, &val, sizeof(val));
-            *buffer += sizeof(val);
+        default:
+            for (uint32_t i = 0; i < num_rows; i++) {
+                const uint64_t value = rows[(size_t)i * stride] - base;
+                memcpy(out + (size_t)i * sizeof(value), &value, sizeof(value));
+            }
             break;
-        }
     }
 }
 
+// Helper function to expand one stored column into row-major records
+static void decode_column(const uint8_t* in, uint64_t* rows, uint32_t stride, uint32_t num_rows, uint64_t base, size_e width) {
+    switch (width) {
+        case SIZE_8BIT:
+            for (uint32_t i = 0; i < num_rows; i++)
+                rows[(size_t)i * stride] = base + in[i];
+            break;
+        case SIZE_16BIT:
+            for (uint32_t i = 0; i < num_rows; i++) {
+                uint16_t value;
+                memcpy(&value, in + (size_t)i * sizeof(value), sizeof(value));
+                rows[(size_t)i * stride] = base + value;
+            }
+            break;
+        case SIZE_32BIT:
+            for (uint32_t i = 0; i < num_rows; i++) {
+                uint32_t value;
+                memcpy(&value, in + (size_t)i * sizeof(value), sizeof(value));
+                rows[(size_t)i * stride] = base + value;
+            }
+            break;
+        default:
+            for (uint32_t i = 0; i < num_rows; i++) {
+                uint64_t value;
+                memcpy(&value, in + (size_t)i * sizeof(value), sizeof(value));
+                rows[(size_t)i * stride] = base + value;
+            }
+            break;
+    }
+}
+
+// Helpers to store and load a single value at a fixed width
+static void store_value(uint8_t* out, uint64_t value, size_e width) {
+    switch (width) {
+        case SIZE_8BIT: { const uint8_t v = (uint8_t)value; memcpy(out, &v, sizeof(v)); break; }
+        case SIZE_16BIT: { const uint16_t v = (uint16_t)value; memcpy(out, &v, sizeof(v)); break; }
+        case SIZE_32BIT: { const uint32_t v = (uint32_t)value; memcpy(out, &v, sizeof(v)); break; }
+        default: memcpy(out, &value, sizeof(value)); break;
+    }
+}
+
+static uint64_t load_value(const uint8_t* in, size_e width) {
+    switch (width) {
+        case SIZE_8BIT: return in[0];
+        case SIZE_16BIT: { uint16_t v; memcpy(&v, in, sizeof(v)); return v; }
+        case SIZE_32BIT: { uint32_t v; memcpy(&v, in, sizeof(v)); return v; }
+        default: { uint64_t v; memcpy(&v, in, sizeof(v)); return v; }
+    }
+}
+
+// --- Run-length and dictionary codecs ---
+#define RLE_LENGTH_SIZE sizeof(uint32_t)
+#define DICT_HASH_SLOTS (2 * TICKS_DICT_MAX_VALUES) // Half full at most, keeps probe sequences short
+
 typedef struct {
-    ticks_chunk_t* chunk;
-    ticks_status_e status;
-} create_chunk_result;
+    uint64_t slot_values[DICT_HASH_SLOTS];
+    int16_t slot_codes[DICT_HASH_SLOTS];    // -1 marks an empty slot
+    uint64_t values[TICKS_DICT_MAX_VALUES]; // Distinct values in code order
+    uint32_t num_values;
+} column_dict_t;
+
+static uint32_t dict_slot(const column_dict_t* dict, uint64_t value) {
+    uint32_t slot = (uint32_t)((value * 0x9E3779B97F4A7C15ULL) >> 55) & (DICT_HASH_SLOTS - 1);
+    while (dict->slot_codes[slot] >= 0 && dict->slot_values[slot] != value)
+        slot = (slot + 1) & (DICT_HASH_SLOTS - 1);
+    return slot;
+}
+
+// Helper function to collect the distinct values of a column, in order of first appearance.
+// Returns -1 as soon as there are more than TICKS_DICT_MAX_VALUES.
+static int dict_build(column_dict_t* dict, const uint64_t* rows, uint32_t stride, uint32_t num_rows) {
+    memset(dict->slot_codes, 0xFF, sizeof(dict->slot_codes));
+    dict->num_values = 0;
+    for (uint32_t i = 0; i < num_rows; i++) {
+        const uint64_t value = rows[(size_t)i * stride];
+        const uint32_t slot = dict_slot(dict, value);
+        if (dict->slot_codes[slot] >= 0)
+            continue;
+        if (dict->num_values == TICKS_DICT_MAX_VALUES)
+            return -1;
+        dict->slot_values[slot] = value;
+        dict->slot_codes[slot] = (int16_t)dict->num_values;
+        dict->values[dict->num_values++] = value;
+    }
+    return 0;
+}
+
+static uint32_t count_runs(const uint64_t* rows, uint32_t stride, uint32_t num_rows) {
+    uint32_t runs = 1;
+    for (uint32_t i = 1; i < num_rows; i++)
+        runs += rows[(size_t)i * stride] != rows[(size_t)(i - 1) * stride];
+    return runs;
+}
+
+// Helper function to switch a column to RLE or a dictionary when either is smaller than one value per record
+static void choose_codec(ticks_column_chunk_t* column, column_dict_t* dict, const uint64_t* rows, uint32_t stride, uint32_t num_rows) {
+    const uint64_t rle_size = (uint64_t)count_runs(rows, stride, num_rows) * (column->width + RLE_LENGTH_SIZE);
+    if (rle_size < column->size) {
+        column->codec = TICKS_CODEC_RLE;
+        column->size = (uint32_t)rle_size;
+    }
+
+    if (dict_build(dict, rows, stride, num_rows) == 0) {
+        const uint64_t dict_size = (uint64_t)dict->num_values * column->width + num_rows;
+        if (dict_size < column->size) {
+            column->codec = TICKS_CODEC_DICT;
+            column->size = (uint32_t)dict_size;
+        }
+    }
+}
+
+static void encode_rle(uint8_t* out, const ticks_column_chunk_t* column, const uint64_t* rows, uint32_t stride, uint32_t num_rows) {
+    const uint32_t num_runs = column->size / (column->width + RLE_LENGTH_SIZE);
+    uint8_t* lengths = out + (size_t)num_runs * column->width;
+    uint32_t run = 0;
+    uint32_t run_start = 0;
+    for (uint32_t i = 1; i <= num_rows; i++) {
+        if (i < num_rows && rows[(size_t)i * stride] == rows[(size_t)run_start * stride])
+            continue;
+        const uint32_t length = i - run_start;
+        store_value(out + (size_t)run * column->width, rows[(size_t)run_start * stride] - column->base, column->width);
+        memcpy(lengths + (size_t)run * RLE_LENGTH_SIZE, &length, RLE_LENGTH_SIZE);
+        run++;
+        run_start = i;
+    }
+}
+
+static void encode_dict(uint8_t* out, const ticks_column_chunk_t* column, const column_dict_t* dict, const uint64_t* rows, uint32_t stride, uint32_t num_rows) {
+    encode_column(out, dict->values, 1, dict->num_values, column->base, column->width);
+    uint8_t* codes = out + (size_t)dict->num_values * column->width;
+    for (uint32_t i = 0; i < num_rows; i++)
+        codes[i] = (uint8_t)dict->slot_codes[dict_slot(dict, rows[(size_t)i * stride])];
+}
+
+static uint32_t rle_run_length(const uint8_t* in, const ticks_column_chunk_t* column, uint32_t run) {
+    const uint32_t num_runs = column->size / (column->width + RLE_LENGTH_SIZE);
+    uint32_t length;
+    memcpy(&length, in + (size_t)num_runs * column->width + (size_t)run * RLE_LENGTH_SIZE, RLE_LENGTH_SIZE);
+    return length;
+}
+
+// Helper function to check that the runs of a run-length column add up to the chunk's record count
+static ticks_status_e check_rle(const uint8_t* in, const ticks_column_chunk_t* column, uint32_t num_records) {
+    const uint32_t num_runs = column->size / (column->width + RLE_LENGTH_SIZE);
+    uint32_t row = 0;
+    for (uint32_t run = 0; run < num_runs; run++) {
+        const uint32_t length = rle_run_length(in, column, run);
+        if (length > num_records - row)
+            return TICKS_ERROR_INVALID_FORMAT;
+        row += length;
+    }
+    return row == num_records ? TICKS_OK : TICKS_ERROR_INVALID_FORMAT;
+}
+
+// Decodes the next num_rows values of a run-length column checked by check_rle, resuming from the cursor's run
+static void decode_rle(const uint8_t* in, const ticks_column_chunk_t* column, uint32_t* run, uint32_t* run_remaining,
+                       uint64_t* rows, uint32_t stride, uint32_t num_rows) {
+    uint32_t row = 0;
+    while (row < num_rows) {
+        while (*run_remaining == 0)
+            *run_remaining = rle_run_length(in, column, ++*run);
+        const uint64_t value = column->base + load_value(in + (size_t)*run * column->width, column->width);
+        const uint32_t length = *run_remaining < num_rows - row ? *run_remaining : num_rows - row;
+        for (uint32_t end = row + length; row < end; row++)
+            rows[(size_t)row * stride] = value;
+        *run_remaining -= length;
+    }
+}
+
+// Advances a run-length cursor past num_rows records without decoding them
+static void skip_rle(const uint8_t* in, const ticks_column_chunk_t* column, uint32_t* run, uint32_t* run_remaining, uint32_t num_rows) {
+    while (num_rows > 0) {
+        while (*run_remaining == 0)
+            *run_remaining = rle_run_length(in, column, ++*run);
+        const uint32_t length = *run_remaining < num_rows ? *run_remaining : num_rows;
+        *run_remaining -= length;
+        num_rows -= length;
+    }
+}
+
+// Decodes num_rows values of a dictionary column starting at record first_row
+static ticks_status_e decode_dict(const uint8_t* in, const ticks_column_chunk_t* column, uint32_t num_records, uint32_t first_row,
+                                  uint64_t* rows, uint32_t stride, uint32_t num_rows) {
+    // Unused codes decode to 0, a code past the dictionary is reported once the column is decoded
+    uint64_t values[TICKS_DICT_MAX_VALUES] = {0};
+    const uint32_t num_values = (column->size - num_records) / column->width;
+    decode_column(in, values, 1, num_values, column->base, column->width);
+
+    const uint8_t* codes = in + (size_t)num_values * column->width + first_row;
+    uint8_t max_code = 0;
+    for (uint32_t i = 0; i < num_rows; i++) {
+        rows[(size_t)i * stride] = values[codes[i]];
+        max_code = codes[i] > max_code ? codes[i] : max_code;
+    }
+    return max_code < num_values ? TICKS_OK : TICKS_ERROR_INVALID_FORMAT;
+}
+
+// Helper function to find the largest power of ten, up to max_shift, that divides every value of a column.
+// A chunk of prices quoted in whole cents in a file scaled to 1/10000 then stores cents.
+static uint8_t decimal_scale_shift(const uint64_t* rows, uint32_t stride, uint32_t num_rows, uint8_t max_shift) {
+    uint8_t shift = max_shift;
+    for (uint32_t i = 0; i < num_rows && shift > 0; i++) {
+        const uint64_t value = rows[(size_t)i * stride];
+        while (shift > 0 && value % pow10_uint64(shift) != 0)
+            shift--;
+    }
+    return shift;
+}
+
+// Helper function to multiply a decoded decimal column back up to the file's scale
+static void apply_scale_shift(uint64_t* rows, uint32_t stride, uint32_t num_rows, uint8_t scale_shift) {
+    const uint64_t multiplier = pow10_uint64(scale_shift);
+    for (uint32_t i = 0; i < num_rows; i++)
+        rows[(size_t)i * stride] *= multiplier;
+}
+
+// Helper function to compare two column values by the column's logical type
+static int column_less(ticks_column_type_e type, uint64_t a, uint64_t b) {
+    if (type == TICKS_COLUMN_INT)
+        return (int64_t)a < (int64_t)b;
+    return a < b;
+}
 
-static create_chunk_result create_chunk(uint64_t* const row_index, const trade_data_t* entries, uint64_t num_entries) {
-    if (*row_index >= num_entries) {
+// Helper function to find the time bucket of a timestamp under a chunk policy, rounding towards negative infinity
+static int64_t chunk_bucket(const ticks_chunk_policy_t* policy, uint64_t ms_since_epoch) {
+    if (policy->bucket_ms == 0)
+        return 0;
+    if (ms_since_epoch >= policy->bucket_origin_ms)
+        return (int64_t)((ms_since_epoch - policy->bucket_origin_ms) / policy->bucket_ms);
+    return -(int64_t)((policy->bucket_origin_ms - ms_since_epoch + policy->bucket_ms - 1) / policy->bucket_ms);
+}
+
+create_chunk_result create_chunk(uint64_t* const row_index, const uint64_t* rows, uint64_t num_rows,
+                                 const ticks_schema_t* schema, const ticks_chunk_policy_t* policy,
+                                 const ticks_allocator_t* allocator) {
+    TICKS_TRACE_SCOPE("create_chunk");
+    if (*row_index >= num_rows) {
         perror("ERROR: row_index out of bounds in create_chunk\n");
         return (create_chunk_result){.chunk = NULL, .status = TICKS_ERROR_INVALID_ARGUMENTS};
     }
 
-    ticks_chunk_t* chunk = malloc(sizeof(ticks_chunk_t));
+    ticks_chunk_t* chunk = mem_alloc(allocator, sizeof(ticks_chunk_t));
     if (chunk == NULL) {
         perror("ERROR: Unable to allocate memory for chunk structure\n");
         return (create_chunk_result){.chunk = NULL, .status = TICKS_ERROR_MEMORY_ALLOCATION};
     }
+    memset(chunk, 0, sizeof(ticks_chunk_t));
 
-    chunk->data = malloc(MAX_CHUNK_SIZE);
-    if (chunk->data == NULL) {
-        free(chunk);
-        perror("ERROR: Unable to allocate memory for chunk data\n");
-        return (create_chunk_result){.chunk = NULL, .status = TICKS_ERROR_MEMORY_ALLOCATION};
-    }
-
-    // Pass 1: "Dry run" to determine the final data types and number of records for the chunk.
-    // Pass 2: "Serialization" to write the records using the determined data types.
+    // Pass 1: "Dry run" to determine each column's range, and so its width, and the number of records for the chunk.
+    // Pass 2: "Serialization" to write each column using the determined base and width.
 
-    chunk->time_base = entries[*row_index].ms_since_epoch;
-    chunk->num_records = 0;
-    chunk->timestamp_size = SIZE_8BIT;
-    chunk->price_size = SIZE_8BIT;
-    chunk->volume_size = SIZE_8BIT;
-    
+    const uint32_t num_columns = schema->num_columns;
     const uint64_t start_row_index = *row_index;
-    uint64_t temp_row_index = *row_index;
+    const uint64_t* first_row = &rows[start_row_index * num_columns];
+    uint64_t column_min[TICKS_MAX_COLUMNS];
+    uint64_t column_max[TICKS_MAX_COLUMNS];
+    for (uint32_t c = 0; c < num_columns; c++) {
+        column_min[c] = first_row[c];
+        column_max[c] = first_row[c];
+        chunk->columns[c].width = schema->columns[c].encoding == TICKS_ENCODING_PLAIN ? SIZE_64BIT : SIZE_8BIT;
+    }
+
+    const uint64_t max_chunk_bytes = policy->max_chunk_bytes ? policy->max_chunk_bytes : TICKS_DEFAULT_CHUNK_BYTES;
+    const int64_t first_bucket = chunk_bucket(policy, first_row[0]);
 
     // Determine optimal sizes and record count for this chunk.
-    for (; temp_row_index < num_entries; temp_row_index++) {
-        const uint64_t time_delta = entries[temp_row_index].ms_since_epoch - chunk->time_base;
-        size_e needed_ts_size = determine_min_size_uint64(time_delta);
-        size_e needed_p_size = determine_min_size_uint64(entries[temp_row_index].price);
-        size_e needed_v_size = determine_min_size_uint64(entries[temp_row_index].volume);
-        
-        size_e new_ts_size = (needed_ts_size > chunk->timestamp_size) ? needed_ts_size : chunk->timestamp_size;
-        size_e new_p_size = (needed_p_size > chunk->price_size) ? needed_p_size : chunk->price_size;
-        size_e new_v_size = (needed_v_size > chunk->volume_size) ? needed_v_size : chunk->volume_size;
-        
-        uint64_t potential_total_size = (chunk->num_records + 1) * (uint64_t)(new_ts_size + new_p_size + new_v_size);
-        
-        if (potential_total_size > MAX_CHUNK_SIZE) {
+    for (uint64_t temp_row_index = start_row_index; temp_row_index < num_rows; temp_row_index++) {
+        if (policy->max_chunk_rows != 0 && chunk->num_records == policy->max_chunk_rows)
+            break;
+
+        const uint64_t* row = &rows[temp_row_index * num_columns];
+        if (policy->bucket_ms != 0 && chunk_bucket(policy, row[0]) != first_bucket)
+            break; // The row starts a new time bucket
+
+        // Values are stored relative to the column minimum, so a value below the first lowers the base
+        // instead of underflowing
+        uint64_t new_min[TICKS_MAX_COLUMNS];
+        uint64_t new_max[TICKS_MAX_COLUMNS];
+        size_e new_width[TICKS_MAX_COLUMNS];
+        uint64_t record_size = 0;
+        for (uint32_t c = 0; c < num_columns; c++) {
+            const ticks_column_type_e type = schema->columns[c].type;
+            new_min[c] = column_less(type, row[c], column_min[c]) ? row[c] : column_min[c];
+            new_max[c] = column_less(type, column_max[c], row[c]) ? row[c] : column_max[c];
+            new_width[c] = chunk->columns[c].width;
+            if (schema->columns[c].encoding == TICKS_ENCODING_AUTO) {
+                const size_e needed = determine_min_size_uint64(new_max[c] - new_min[c]);
+                if (needed > new_width[c])
+                    new_width[c] = needed;
+            }
+            record_size += new_width[c];
+        }
+
+        if ((chunk->num_records + 1) * record_size > max_chunk_bytes)
             break; // This record won't fit, finalize chunk before it.
+
+        for (uint32_t c = 0; c < num_columns; c++) {
+            column_min[c] = new_min[c];
+            column_max[c] = new_max[c];
+            chunk->columns[c].width = new_width[c];
         }
-        
-        chunk->timestamp_size = new_ts_size;
-        chunk->price_size = new_p_size;
-        chunk->volume_size = new_v_size;
         chunk->num_records++;
     }
 
@@ -101,110 +351,189 @@ static create_chunk_result create_chunk(uint64_t* const row_index, const trade_d
             (*row_index)++; // Advance to prevent infinite loop.
         }
 
-        free(chunk->data);
-        free(chunk);
+        mem_free(allocator, chunk);
         perror("ERROR: Unable to fit any records into chunk due to size constraints\n");
         return (create_chunk_result){.chunk = NULL, .status = TICKS_ERROR_EMPTY_CHUNK};
     }
 
-    // Serialize the records using the determined optimal sizes.
-    uint8_t* data_ptr = chunk->data;
-    for (uint64_t i = start_row_index; i < start_row_index + chunk->num_records; ++i) {
-        const uint64_t time_delta = entries[i].ms_since_epoch - chunk->time_base;
-        write_data(&data_ptr, time_delta, chunk->timestamp_size);
-        write_data(&data_ptr, entries[i].price, chunk->price_size);
-        write_data(&data_ptr, entries[i].volume, chunk->volume_size);
+    chunk->time_base = column_min[0];
+    chunk->max_time = column_max[0];
+
+    // Decimal columns drop the trailing zeros every value of the chunk shares, which also narrows them.
+    // The divided values are staged so the codecs below see a plain column.
+    const uint64_t* column_values[TICKS_MAX_COLUMNS];
+    uint32_t column_stride[TICKS_MAX_COLUMNS];
+    uint64_t* shifted_values[TICKS_MAX_COLUMNS] = {NULL};
+    for (uint32_t c = 0; c < num_columns; c++) {
+        column_values[c] = first_row + c;
+        column_stride[c] = num_columns;
+        if (schema->columns[c].type != TICKS_COLUMN_DECIMAL || schema->columns[c].encoding != TICKS_ENCODING_AUTO)
+            continue;
+
+        const uint8_t shift = decimal_scale_shift(first_row + c, num_columns, chunk->num_records, schema->columns[c].scale);
+        if (shift == 0)
+            continue;
+        shifted_values[c] = mem_alloc(allocator, (size_t)chunk->num_records * sizeof(uint64_t));
+        if (shifted_values[c] == NULL) {
+            for (uint32_t s = 0; s < c; s++)
+                mem_free(allocator, shifted_values[s]);
+            mem_free(allocator, chunk);
+            perror("ERROR: Unable to allocate memory for scaled column\n");
+            return (create_chunk_result){.chunk = NULL, .status = TICKS_ERROR_MEMORY_ALLOCATION};
+        }
+        const uint64_t divisor = pow10_uint64(shift);
+        for (uint32_t i = 0; i < chunk->num_records; i++)
+            shifted_values[c][i] = first_row[(size_t)i * num_columns + c] / divisor;
+        column_values[c] = shifted_values[c];
+        column_stride[c] = 1;
+        column_min[c] /= divisor;
+        column_max[c] /= divisor;
+        chunk->columns[c].scale_shift = shift;
+        chunk->columns[c].width = determine_min_size_uint64(column_max[c] - column_min[c]);
     }
-    
-    chunk->data_size = data_ptr - chunk->data;
+
+    // Value columns may be run-length or dictionary coded when that is smaller. Timestamps always keep one
+    // value per record so time filtering never has to expand runs.
+    column_dict_t dict;
+    uint64_t data_size = 0;
+    const uint64_t select_start = monotonic_ns_portable();
+    for (uint32_t c = 0; c < num_columns; c++) {
+        chunk->columns[c].base = schema->columns[c].encoding == TICKS_ENCODING_PLAIN ? 0 : column_min[c];
+        chunk->columns[c].max = column_max[c];
+        chunk->columns[c].offset = (uint32_t)data_size;
+        chunk->columns[c].size = chunk->num_records * chunk->columns[c].width;
+        chunk->columns[c].codec = TICKS_CODEC_FOR;
+        if (c != 0 && schema->columns[c].encoding == TICKS_ENCODING_AUTO)
+            choose_codec(&chunk->columns[c], &dict, column_values[c], column_stride[c], chunk->num_records);
+        data_size += chunk->columns[c].size;
+    }
+    chunk->compression_ns = monotonic_ns_portable() - select_start;
+
+    // The widths are final, so the data can be allocated at its exact size
+    chunk->data = mem_alloc(allocator, (size_t)data_size);
+    if (chunk->data == NULL) {
+        for (uint32_t c = 0; c < num_columns; c++)
+            mem_free(allocator, shifted_values[c]);
+        mem_free(allocator, chunk);
+        perror("ERROR: Unable to allocate memory for chunk data\n");
+        return (create_chunk_result){.chunk = NULL, .status = TICKS_ERROR_MEMORY_ALLOCATION};
+    }
+
+    // Serialize the columns one after another using the determined bases and widths.
+    // Each column gets its own checksum so a projected read can verify just the columns it reads.
+    uint32_t column_checksums[TICKS_MAX_COLUMNS];
+    for (uint32_t c = 0; c < num_columns; c++) {
+        const ticks_column_chunk_t* column = &chunk->columns[c];
+        uint8_t* column_data = chunk->data + column->offset;
+        if (column->codec == TICKS_CODEC_FOR) {
+            encode_column(column_data, column_values[c], column_stride[c], chunk->num_records, column->base, column->width);
+        }
+        else {
+            const uint64_t codec_start = monotonic_ns_portable();
+            if (column->codec == TICKS_CODEC_RLE) {
+                encode_rle(column_data, column, column_values[c], column_stride[c], chunk->num_records);
+            }
+            else {
+                dict_build(&dict, column_values[c], column_stride[c], chunk->num_records);
+                encode_dict(column_data, column, &dict, column_values[c], column_stride[c], chunk->num_records);
+            }
+            chunk->compression_ns += monotonic_ns_portable() - codec_start;
+        }
+        mem_free(allocator, shifted_values[c]);
+        chunk->columns[c].checksum = crc32c(0, column_data, chunk->columns[c].size);
+        column_checksums[c] = chunk->columns[c].checksum;
+    }
+    chunk->checksum = crc32c(0, column_checksums, num_columns * sizeof(uint32_t));
+
+    chunk->data_size = (uint32_t)data_size;
     *row_index = start_row_index + chunk->num_records; // Advance the main index
 
     return (create_chunk_result){.chunk = chunk, .status = TICKS_OK};
 }
 
 // Appends a chunk's data to the file and adds its metadata to the in-memory index.
+// The stream always sits at write_offset, so this is a single sequential write.
 ticks_status_e append_chunk_and_update_index(ticks_file_t* handle, const ticks_chunk_t* chunk) {
+    TICKS_TRACE_SCOPE("append_chunk_and_update_index");
     if (handle == NULL || chunk == NULL || handle->file_stream == NULL || chunk->data_size == 0) {
         perror("ERROR: Invalid arguments to append_chunk_and_update_index\n");
         return TICKS_ERROR_INVALID_ARGUMENTS;
     }
 
-    // Flushing the stream serves as a robust check. If the underlying file descriptor is invalid, fflush will fail and return an error.
-    // This helps confirm that the file stream has been closed externally.
-    if (fflush(handle->file_stream) != 0) {
-        perror("ERROR: fflush failed before writing chunk data. The file stream is likely closed");
-        return TICKS_ERROR_FILE_IO;
+    // Grow the index geometrically so appending stays amortised O(1)
+    if (handle->index.num_entries == handle->index.capacity) {
+        uint32_t new_capacity = handle->index.capacity ? handle->index.capacity * 2 : 64;
+        ticks_index_entry_t* new_entries = mem_realloc(&handle->allocator, handle->index.entries, new_capacity * sizeof(ticks_index_entry_t));
+
+        if (new_entries == NULL) {
+            // If realloc fails, the original handle->index.entries pointer is still valid.
+            perror("ERROR: Unable to allocate memory for index entries\n");
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        }
+        handle->index.entries = new_entries;
+        handle->index.capacity = new_capacity;
     }
 
-    const uint64_t chunk_write_pos = handle->index_offset;
+    uint64_t chunk_write_pos = handle->write_offset;
+    uint32_t padding = 0;
 
-    if (_fseeki64(handle->file_stream, chunk_write_pos, SEEK_SET) != 0) {
-        perror("ERROR: _fseeki64 before chunk write failed");
-        return TICKS_ERROR_FILE_IO;
+    const uint64_t io_start = monotonic_ns_portable();
+    if (direct_writer_active(&handle->direct)) {
+        // Staged chunks are written by the direct writer's I/O thread, padded to the alignment
+        ticks_status_e stage_status = direct_writer_stage(&handle->direct, chunk->data, chunk->data_size, &chunk_write_pos, &padding);
+        if (stage_status != TICKS_OK)
+            return stage_status;
     }
-
-    if (fwrite(chunk->data, 1, chunk->data_size, handle->file_stream) != chunk->data_size) {
+    else if (fwrite(chunk->data, 1, chunk->data_size, handle->file_stream) != chunk->data_size) {
         perror("FATAL ERROR on fwrite (chunk data)");
         return TICKS_ERROR_FILE_IO;
     }
+    metrics_add(handle->metrics, METRIC_IO_NS, monotonic_ns_portable() - io_start);
+    metrics_add(handle->metrics, METRIC_BYTES_WRITTEN, (uint64_t)chunk->data_size + padding);
+    metrics_add(handle->metrics, METRIC_CHUNKS_WRITTEN, 1);
     
-    handle->index_offset = chunk_write_pos + chunk->data_size;
+    handle->write_offset = chunk_write_pos + chunk->data_size + padding;
     
-    const ticks_index_entry_t new_index_entry = {
-        .chunk_time_base = chunk->time_base,
-        .chunk_offset = chunk_write_pos,
-        .chunk_size = chunk->data_size,
-        .timestamp_size = chunk->timestamp_size,
-        .price_size = chunk->price_size,
-        .volume_size = chunk->volume_size
-    };
-    
-    // TODO: This approach resizes the array for every single chunk, which is inefficient
-    // for a large number of chunks. It is necessary because the ticks_file_t_internal
-    // struct does not have a field to track the allocated capacity of the index array,
-    // preventing a more efficient growth strategy (e.g., doubling capacity).
-    ticks_index_entry_t* new_entries = realloc(handle->index.entries, (handle->index.num_entries + 1) * sizeof(ticks_index_entry_t));
-
-    if (new_entries == NULL) {
-        // If realloc fails, the original handle->index.entries pointer is still valid.
-        perror("ERROR: Unable to allocate memory for index entries\n");
-        return TICKS_ERROR_MEMORY_ALLOCATION;
-    }
-    handle->index.entries = new_entries;
-
-    // Add the new entry to the now-larger array and increment the count.
-    handle->index.entries[handle->index.num_entries] = new_index_entry;
+    // Add the new entry to the array and increment the count. The slot is zeroed first so
+    // struct padding written to disk (and covered by the index checksum) is deterministic.
+    ticks_index_entry_t* new_index_entry = &handle->index.entries[handle->index.num_entries];
+    memset(new_index_entry, 0, sizeof(ticks_index_entry_t));
+    new_index_entry->chunk_time_base = chunk->time_base;
+    new_index_entry->chunk_max_time = chunk->max_time;
+    new_index_entry->chunk_offset = chunk_write_pos;
+    new_index_entry->chunk_size = chunk->data_size;
+    new_index_entry->checksum = chunk->checksum;
+    new_index_entry->num_records = chunk->num_records;
+    new_index_entry->padding = padding;
+    memcpy(new_index_entry->columns, chunk->columns, sizeof(chunk->columns));
     handle->index.num_entries++;
-
-    // Get the current file position to update index_offset
-    long current_pos_long = ftell(handle->file_stream);
-    if (current_pos_long == -1L) {
-        perror("ERROR: ftell failed after writing chunk data");
-        return TICKS_ERROR_FILE_IO;
-    }
-    handle->index_offset = (uint64_t)current_pos_long;
-
-    // Write new index_offset
-    if (_fseeki64(handle->file_stream, 4 + sizeof(ticks_header_t), SEEK_SET) != 0) {
-        perror("ERROR: _fseeki64 before index_offset update failed");
-        return TICKS_ERROR_FILE_IO;
-    }
-    if (fwrite(&handle->index_offset, 1, sizeof(uint64_t), handle->file_stream) != sizeof(uint64_t)) {
-        perror("ERROR: fwrite (index_offset update)");
-        return TICKS_ERROR_FILE_IO;
-    }
+    handle->index_dirty = 1;
+    durability_chunk_appended(handle);
 
     return TICKS_OK;
 }
 
+void free_chunk(const ticks_allocator_t* allocator, ticks_chunk_t* chunk) {
+    if (chunk == NULL)
+        return;
+    mem_free(allocator, chunk->data);
+    mem_free(allocator, chunk);
+}
 
-ticks_status_e create_chunks(ticks_file_t* handle, const trade_data_t* entries, uint64_t num_entries)
+ticks_status_e create_chunks(ticks_file_t* handle, const uint64_t* rows, uint64_t num_rows)
 {
     uint64_t row_index = 0;
 
-    while (row_index < num_entries) {
-        create_chunk_result result = create_chunk(&row_index, entries, num_entries);
+    while (row_index < num_rows) {
+        const uint64_t encode_start = monotonic_ns_portable();
+        create_chunk_result result = create_chunk(&row_index, rows, num_rows, &handle->header.schema, &handle->header.chunk_policy,
+                                                   &handle->allocator);
         ticks_chunk_t* chunk = result.chunk;
+        metrics_add(handle->metrics, METRIC_ENCODE_NS, monotonic_ns_portable() - encode_start);
+        if (chunk != NULL) {
+            metrics_add(handle->metrics, METRIC_ROWS_ENCODED, chunk->num_records);
+            metrics_add(handle->metrics, METRIC_COMPRESSION_NS, chunk->compression_ns);
+        }
         if (chunk == NULL || result.status != TICKS_OK) {
             if (result.status == TICKS_ERROR_EMPTY_CHUNK) {
                 continue;
@@ -218,16 +547,549 @@ ticks_status_e create_chunks(ticks_file_t* handle, const trade_data_t* entries,
 
         ticks_status_e append_chunk_result = append_chunk_and_update_index(handle, chunk);
         if (append_chunk_result != TICKS_OK) {
-            free(chunk->data);
-            free(chunk);
+            free_chunk(&handle->allocator, chunk);
             perror("ERROR: append_chunk_and_update_index failed\n");
             return append_chunk_result;
         }
         
-        free(chunk->data);
-        free(chunk);
+        free_chunk(&handle->allocator, chunk);
     }
 
     return TICKS_OK;
 }
 
+
+static int is_valid_size(size_e size) {
+    return size == SIZE_8BIT || size == SIZE_16BIT || size == SIZE_32BIT || size == SIZE_64BIT;
+}
+
+// Helper function to check that a column's size is consistent with its codec and the chunk's record count
+static int is_valid_column_size(const ticks_column_chunk_t* column, uint32_t num_records) {
+    switch (column->codec) {
+        case TICKS_CODEC_FOR:
+            return column->size == (uint64_t)num_records * column->width;
+        case TICKS_CODEC_RLE: {
+            const uint32_t run_size = column->width + RLE_LENGTH_SIZE;
+            return column->size % run_size == 0 && column->size / run_size >= 1 && column->size / run_size <= num_records;
+        }
+        case TICKS_CODEC_DICT:
+            return column->size > num_records && (column->size - num_records) % column->width == 0 &&
+                   (column->size - num_records) / column->width <= TICKS_DICT_MAX_VALUES;
+        default:
+            return 0;
+    }
+}
+
+uint32_t chunk_record_count(const ticks_index_entry_t* entry, uint32_t num_columns) {
+    // Every column must hold num_records values and lie within the chunk, anything else is a malformed entry
+    for (uint32_t c = 0; c < num_columns; c++) {
+        const ticks_column_chunk_t* column = &entry->columns[c];
+        if (!is_valid_size(column->width) || !is_valid_column_size(column, entry->num_records) ||
+            column->scale_shift > TICKS_MAX_DECIMAL_SCALE ||
+            (uint64_t)column->offset + column->size > entry->chunk_size)
+            return 0;
+    }
+    return entry->num_records;
+}
+
+ticks_status_e read_chunk(ticks_file_t* handle, uint32_t chunk_index, uint32_t column_mask, uint8_t** buffer, size_t* buffer_capacity) {
+    TICKS_TRACE_SCOPE("read_chunk");
+    if (handle == NULL || buffer == NULL || buffer_capacity == NULL || handle->file_stream == NULL ||
+        chunk_index >= handle->index.num_entries)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    const ticks_index_entry_t* entry = index_entry(handle, chunk_index);
+    const uint32_t num_columns = handle->header.schema.num_columns;
+    if (chunk_record_count(entry, num_columns) == 0)
+        return TICKS_ERROR_INVALID_FORMAT;
+
+    // Reuse the caller's buffer across chunks, only growing it when needed
+    if (*buffer_capacity < entry->chunk_size) {
+        uint8_t* new_buffer = mem_realloc(&handle->allocator, *buffer, entry->chunk_size);
+        if (new_buffer == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        *buffer = new_buffer;
+        *buffer_capacity = entry->chunk_size;
+    }
+
+    // Appended chunks may still sit in the stream buffer or a direct staging buffer of a write handle
+    if (handle->mode == FILE_MODE_WRITE) {
+        mutex_lock_portable(&handle->write_mutex);
+        ticks_status_e flush_status = fflush(handle->file_stream) == 0 ? TICKS_OK : TICKS_ERROR_FILE_IO;
+        if (flush_status == TICKS_OK && direct_writer_active(&handle->direct))
+            flush_status = direct_writer_flush(&handle->direct);
+        mutex_unlock_portable(&handle->write_mutex);
+        if (flush_status != TICKS_OK)
+            return flush_status;
+    }
+
+    // Positional reads leave the shared stream untouched, so iterators on several threads can read concurrently.
+    // Runs of selected columns that are adjacent in the file are read together.
+    const uint64_t io_start = monotonic_ns_portable();
+    uint64_t bytes_read = 0;
+    for (uint32_t c = 0; c < num_columns; c++) {
+        if (!(column_mask & (1u << c)))
+            continue;
+        const uint32_t run_start = entry->columns[c].offset;
+        uint32_t run_end = run_start + entry->columns[c].size;
+        while (c + 1 < num_columns && (column_mask & (1u << (c + 1))) && entry->columns[c + 1].offset == run_end)
+            run_end += entry->columns[++c].size;
+
+        if (read_at_portable(handle->file_stream, *buffer + run_start, run_end - run_start, entry->chunk_offset + run_start) != 0)
+            return TICKS_ERROR_FILE_IO;
+        bytes_read += run_end - run_start;
+    }
+    metrics_add(handle->metrics, METRIC_IO_NS, monotonic_ns_portable() - io_start);
+    metrics_add(handle->metrics, METRIC_BYTES_READ, bytes_read);
+    metrics_add(handle->metrics, METRIC_CHUNKS_READ, 1);
+
+    // Verify the columns according to the handle's verification mode, first touch tracks each column separately
+    uint32_t verify_mask = 0;
+    if (handle->verify_mode == TICKS_VERIFY_ALWAYS)
+        verify_mask = column_mask;
+    else if (handle->verify_mode == TICKS_VERIFY_FIRST_TOUCH)
+        verify_mask = handle->verified_columns == NULL ? column_mask :
+                      column_mask & ~(uint32_t)atomic_load_u8_portable(&handle->verified_columns[chunk_index]);
+
+    if (verify_mask != 0) {
+        const uint64_t checksum_start = monotonic_ns_portable();
+        for (uint32_t c = 0; c < num_columns; c++) {
+            const ticks_column_chunk_t* column = &entry->columns[c];
+            if ((verify_mask & (1u << c)) && crc32c(0, *buffer + column->offset, column->size) != column->checksum)
+                return TICKS_ERROR_CHECKSUM_MISMATCH;
+        }
+        metrics_add(handle->metrics, METRIC_CHECKSUM_NS, monotonic_ns_portable() - checksum_start);
+        if (handle->verify_mode == TICKS_VERIFY_FIRST_TOUCH && handle->verified_columns != NULL)
+            atomic_or_u8_portable(&handle->verified_columns[chunk_index], (uint8_t)verify_mask);
+    }
+
+    return TICKS_OK;
+}
+
+// --- Predicates ---
+
+// Helper function to clear the selection of records whose stored value lies outside [low, high].
+// Both bounds are in the chunk's stored frame, so each value is tested at its stored width without widening, with
+// one unsigned compare: value - low <= high - low. The loops vectorize into SIMD compares writing one byte per record.
+static void select_stored_range(const uint8_t* in, uint32_t num_rows, size_e width, uint64_t low, uint64_t high, uint8_t* selection) {
+    switch (width) {
+        case SIZE_8BIT: {
+            const uint8_t low_value = (uint8_t)low;
+            const uint8_t span = (uint8_t)(high - low);
+            for (uint32_t i = 0; i < num_rows; i++)
+                selection[i] &= (uint8_t)(in[i] - low_value) <= span;
+            break;
+        }
+        case SIZE_16BIT: {
+            const uint16_t low_value = (uint16_t)low;
+            const uint16_t span = (uint16_t)(high - low);
+            for (uint32_t i = 0; i < num_rows; i++) {
+                uint16_t value;
+                memcpy(&value, in + (size_t)i * sizeof(value), sizeof(value));
+                selection[i] &= (uint16_t)(value - low_value) <= span;
+            }
+            break;
+        }
+        case SIZE_32BIT: {
+            const uint32_t low_value = (uint32_t)low;
+            const uint32_t span = (uint32_t)(high - low);
+            for (uint32_t i = 0; i < num_rows; i++) {
+                uint32_t value;
+                memcpy(&value, in + (size_t)i * sizeof(value), sizeof(value));
+                selection[i] &= (uint32_t)(value - low_value) <= span;
+            }
+            break;
+        }
+        default: {
+            const uint64_t span = high - low;
+            for (uint32_t i = 0; i < num_rows; i++) {
+                uint64_t value;
+                memcpy(&value, in + (size_t)i * sizeof(value), sizeof(value));
+                selection[i] &= value - low <= span;
+            }
+            break;
+        }
+    }
+}
+
+// Helper function to clear the selection of the records among num_rows from first_row that fail a predicate.
+// Run-length columns are tested once per run and dictionary columns once per dictionary value.
+static ticks_status_e select_predicate(chunk_predicate_t* predicate, const ticks_index_entry_t* entry, const uint8_t* data,
+                                       uint32_t num_records, uint32_t first_row, uint32_t num_rows, uint8_t* selection) {
+    const ticks_column_chunk_t* column = &entry->columns[predicate->column];
+    const uint8_t* in = data + column->offset;
+    const uint64_t span = predicate->high - predicate->low;
+
+    if (column->codec == TICKS_CODEC_RLE) {
+        uint32_t row = 0;
+        while (row < num_rows) {
+            while (predicate->run_remaining == 0)
+                predicate->run_remaining = rle_run_length(in, column, ++predicate->run);
+            const uint32_t length = predicate->run_remaining < num_rows - row ? predicate->run_remaining : num_rows - row;
+            if (load_value(in + (size_t)predicate->run * column->width, column->width) - predicate->low > span)
+                memset(selection + row, 0, length);
+            predicate->run_remaining -= length;
+            row += length;
+        }
+    }
+    else if (column->codec == TICKS_CODEC_DICT) {
+        uint8_t value_matches[TICKS_DICT_MAX_VALUES] = {0};
+        const uint32_t num_values = (column->size - num_records) / column->width;
+        for (uint32_t v = 0; v < num_values; v++)
+            value_matches[v] = load_value(in + (size_t)v * column->width, column->width) - predicate->low <= span;
+
+        const uint8_t* codes = in + (size_t)num_values * column->width + first_row;
+        uint8_t max_code = 0;
+        for (uint32_t i = 0; i < num_rows; i++) {
+            selection[i] &= value_matches[codes[i]];
+            max_code = codes[i] > max_code ? codes[i] : max_code;
+        }
+        if (max_code >= num_values)
+            return TICKS_ERROR_INVALID_FORMAT;
+    }
+    else {
+        select_stored_range(in + (size_t)first_row * column->width, num_rows, column->width, predicate->low, predicate->high, selection);
+    }
+    return TICKS_OK;
+}
+
+int chunk_predicates_rewrite(const ticks_index_entry_t* entry, const ticks_schema_t* schema, const ticks_predicate_t* predicates,
+                             uint32_t num_predicates, chunk_predicate_t* out_predicates, uint32_t* out_num_predicates) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < num_predicates; i++) {
+        const ticks_predicate_t* predicate = &predicates[i];
+        const ticks_column_chunk_t* column = &entry->columns[predicate->column];
+        const ticks_column_type_e type = schema->columns[predicate->column].type;
+
+        // Decimal columns store value / 10^scale_shift, round the bounds inwards to whole stored units
+        uint64_t min = predicate->min;
+        uint64_t max = predicate->max;
+        if (column->scale_shift != 0) {
+            const uint64_t divisor = pow10_uint64(column->scale_shift);
+            min = min / divisor + (min % divisor != 0);
+            max = max / divisor;
+        }
+
+        // The column's values lie in [base, max], so the index alone tells whether none or all of them match
+        if (column_less(type, max, min) || column_less(type, max, column->base) || column_less(type, column->max, min))
+            return 0;
+        if (!column_less(type, column->base, min) && !column_less(type, max, column->max))
+            continue;
+
+        chunk_predicate_t* out = &out_predicates[count++];
+        memset(out, 0, sizeof(chunk_predicate_t));
+        out->column = predicate->column;
+        out->low = column_less(type, min, column->base) ? 0 : min - column->base;
+        out->high = (column_less(type, column->max, max) ? column->max : max) - column->base;
+    }
+
+    *out_num_predicates = count;
+    return 1;
+}
+
+// --- Batch decoding ---
+#define DECODER_SPARSE_RATIO 8 // Selections of fewer than 1 in 8 records are decoded record by record
+
+ticks_status_e chunk_decoder_init(chunk_decoder_t* decoder, const ticks_index_entry_t* entry, uint32_t num_columns,
+                                  uint32_t column_mask, const chunk_predicate_t* predicates, uint32_t num_predicates,
+                                  const uint8_t* data, ticks_metrics_shard_t* metrics) {
+    if (decoder == NULL || entry == NULL || data == NULL || num_predicates > TICKS_MAX_PREDICATES + 1)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    memset(decoder, 0, sizeof(chunk_decoder_t));
+    decoder->entry = entry;
+    decoder->data = data;
+    decoder->metrics = metrics;
+    decoder->num_columns = num_columns;
+    decoder->column_mask = column_mask;
+    decoder->stride = column_mask_count(column_mask);
+    decoder->num_records = chunk_record_count(entry, num_columns);
+    if (decoder->num_records == 0)
+        return TICKS_ERROR_INVALID_FORMAT;
+
+    uint32_t used_columns = column_mask;
+    for (uint32_t i = 0; i < num_predicates; i++) {
+        decoder->predicates[i] = predicates[i];
+        used_columns |= 1u << predicates[i].column;
+    }
+    decoder->num_predicates = num_predicates;
+
+    // Runs are checked up front so later batches can follow them without bounds checks
+    for (uint32_t c = 0; c < num_columns; c++) {
+        const ticks_column_chunk_t* column = &entry->columns[c];
+        if (!(used_columns & (1u << c)) || column->codec != TICKS_CODEC_RLE)
+            continue;
+        ticks_status_e status = check_rle(data + column->offset, column, decoder->num_records);
+        if (status != TICKS_OK)
+            return status;
+        decoder->run_remaining[c] = rle_run_length(data + column->offset, column, 0);
+    }
+    for (uint32_t i = 0; i < num_predicates; i++) {
+        decoder->predicates[i].run = 0;
+        decoder->predicates[i].run_remaining = decoder->run_remaining[decoder->predicates[i].column];
+    }
+
+    return TICKS_OK;
+}
+
+// Helper function to decode the selected columns of the next num_rows records
+static ticks_status_e decode_rows(chunk_decoder_t* decoder, uint64_t* out_rows, uint32_t num_rows) {
+    const ticks_index_entry_t* entry = decoder->entry;
+    const uint32_t first_row = decoder->next_record;
+
+    // Selected columns are packed into each output row in schema order
+    const uint32_t stride = decoder->stride;
+    uint32_t out_column = 0;
+    for (uint32_t c = 0; c < decoder->num_columns; c++) {
+        if (!(decoder->column_mask & (1u << c)))
+            continue;
+        const ticks_column_chunk_t* column = &entry->columns[c];
+        const uint8_t* in = decoder->data + column->offset;
+        uint64_t* out_column_rows = out_rows + out_column++;
+        ticks_status_e status = TICKS_OK;
+        if (column->codec == TICKS_CODEC_FOR) {
+            decode_column(in + (size_t)first_row * column->width, out_column_rows, stride, num_rows, column->base, column->width);
+        }
+        else {
+            const uint64_t codec_start = monotonic_ns_portable();
+            if (column->codec == TICKS_CODEC_RLE)
+                decode_rle(in, column, &decoder->run[c], &decoder->run_remaining[c], out_column_rows, stride, num_rows);
+            else
+                status = decode_dict(in, column, decoder->num_records, first_row, out_column_rows, stride, num_rows);
+            metrics_add(decoder->metrics, METRIC_COMPRESSION_NS, monotonic_ns_portable() - codec_start);
+        }
+        if (status != TICKS_OK)
+            return status;
+        if (column->scale_shift != 0)
+            apply_scale_shift(out_column_rows, stride, num_rows, column->scale_shift);
+    }
+
+    decoder->next_record += num_rows;
+    return TICKS_OK;
+}
+
+// Helper function to decode the selected columns of only the listed records among the next num_rows.
+// Frame-of-reference and dictionary columns are read at the listed positions, run-length columns follow their runs.
+static ticks_status_e decode_selected_rows(chunk_decoder_t* decoder, const uint16_t* positions, uint32_t num_selected,
+                                           uint32_t num_rows, uint64_t* out_rows) {
+    const ticks_index_entry_t* entry = decoder->entry;
+    const uint32_t first_row = decoder->next_record;
+    const uint32_t stride = decoder->stride;
+    uint32_t out_column = 0;
+    for (uint32_t c = 0; c < decoder->num_columns; c++) {
+        if (!(decoder->column_mask & (1u << c)))
+            continue;
+        const ticks_column_chunk_t* column = &entry->columns[c];
+        const uint8_t* in = decoder->data + column->offset;
+        uint64_t* out_column_rows = out_rows + out_column++;
+        const uint64_t codec_start = column->codec != TICKS_CODEC_FOR ? monotonic_ns_portable() : 0;
+        if (column->codec == TICKS_CODEC_RLE) {
+            uint32_t row = 0;
+            for (uint32_t i = 0; i < num_selected; i++) {
+                skip_rle(in, column, &decoder->run[c], &decoder->run_remaining[c], positions[i] - row);
+                row = positions[i];
+                while (decoder->run_remaining[c] == 0)
+                    decoder->run_remaining[c] = rle_run_length(in, column, ++decoder->run[c]);
+                out_column_rows[(size_t)i * stride] = column->base + load_value(in + (size_t)decoder->run[c] * column->width, column->width);
+            }
+            skip_rle(in, column, &decoder->run[c], &decoder->run_remaining[c], num_rows - row);
+        }
+        else if (column->codec == TICKS_CODEC_DICT) {
+            uint64_t values[TICKS_DICT_MAX_VALUES] = {0};
+            const uint32_t num_values = (column->size - decoder->num_records) / column->width;
+            decode_column(in, values, 1, num_values, column->base, column->width);
+            const uint8_t* codes = in + (size_t)num_values * column->width + first_row;
+            for (uint32_t i = 0; i < num_selected; i++) {
+                if (codes[positions[i]] >= num_values)
+                    return TICKS_ERROR_INVALID_FORMAT;
+                out_column_rows[(size_t)i * stride] = values[codes[positions[i]]];
+            }
+        }
+        else {
+            const uint8_t* values = in + (size_t)first_row * column->width;
+            for (uint32_t i = 0; i < num_selected; i++)
+                out_column_rows[(size_t)i * stride] = column->base + load_value(values + (size_t)positions[i] * column->width, column->width);
+        }
+        if (column->codec != TICKS_CODEC_FOR)
+            metrics_add(decoder->metrics, METRIC_COMPRESSION_NS, monotonic_ns_portable() - codec_start);
+        if (column->scale_shift != 0)
+            apply_scale_shift(out_column_rows, stride, num_selected, column->scale_shift);
+    }
+
+    decoder->next_record += num_rows;
+    return TICKS_OK;
+}
+
+// Helper function to move past the next num_rows records without decoding them
+static void skip_rows(chunk_decoder_t* decoder, uint32_t num_rows) {
+    for (uint32_t c = 0; c < decoder->num_columns; c++) {
+        const ticks_column_chunk_t* column = &decoder->entry->columns[c];
+        if ((decoder->column_mask & (1u << c)) && column->codec == TICKS_CODEC_RLE)
+            skip_rle(decoder->data + column->offset, column, &decoder->run[c], &decoder->run_remaining[c], num_rows);
+    }
+    decoder->next_record += num_rows;
+}
+
+ticks_status_e chunk_decoder_next(chunk_decoder_t* decoder, uint64_t* out_rows, uint32_t max_rows, uint32_t* out_num_rows) {
+    const uint32_t stride = decoder->stride;
+    if (decoder->num_predicates == 0) {
+        const uint32_t remaining = decoder->num_records - decoder->next_record;
+        const uint32_t num_rows = remaining < max_rows ? remaining : max_rows;
+        *out_num_rows = num_rows;
+        return decode_rows(decoder, out_rows, num_rows);
+    }
+
+    // The predicates fill a selection for each batch from the stored columns. Batches nothing matches are never
+    // decoded, sparse selections are decoded record by record and dense ones are decoded whole and compacted.
+    uint8_t selection[TICKS_SCAN_BATCH_ROWS];
+    uint16_t positions[TICKS_SCAN_BATCH_ROWS];
+    uint32_t count = 0;
+    *out_num_rows = 0;
+    while (count < max_rows && decoder->next_record < decoder->num_records) {
+        uint32_t num_rows = decoder->num_records - decoder->next_record;
+        num_rows = num_rows < max_rows - count ? num_rows : max_rows - count;
+        num_rows = num_rows < TICKS_SCAN_BATCH_ROWS ? num_rows : TICKS_SCAN_BATCH_ROWS;
+
+        memset(selection, 1, num_rows);
+        for (uint32_t i = 0; i < decoder->num_predicates; i++) {
+            ticks_status_e status = select_predicate(&decoder->predicates[i], decoder->entry, decoder->data,
+                                                     decoder->num_records, decoder->next_record, num_rows, selection);
+            if (status != TICKS_OK)
+                return status;
+        }
+
+        uint32_t num_selected = 0;
+        for (uint32_t i = 0; i < num_rows; i++) {
+            positions[num_selected] = (uint16_t)i;
+            num_selected += selection[i];
+        }
+        if (num_selected == 0) {
+            skip_rows(decoder, num_rows);
+            continue;
+        }
+
+        uint64_t* batch_rows = out_rows + (size_t)count * stride;
+        if (num_selected < num_rows / DECODER_SPARSE_RATIO) {
+            ticks_status_e status = decode_selected_rows(decoder, positions, num_selected, num_rows, batch_rows);
+            if (status != TICKS_OK)
+                return status;
+            count += num_selected;
+            continue;
+        }
+
+        ticks_status_e status = decode_rows(decoder, batch_rows, num_rows);
+        if (status != TICKS_OK)
+            return status;
+        if (num_selected < num_rows) {
+            uint32_t kept = 0;
+            for (uint32_t i = 0; i < num_rows; i++) {
+                if (!selection[i])
+                    continue;
+                for (uint32_t c = 0; c < stride; c++)
+                    batch_rows[(size_t)kept * stride + c] = batch_rows[(size_t)i * stride + c];
+                kept++;
+            }
+        }
+        count += num_selected;
+    }
+
+    *out_num_rows = count;
+    return TICKS_OK;
+}
+
+ticks_status_e decode_chunk(const ticks_index_entry_t* entry, uint32_t num_columns, uint32_t column_mask,
+                            const uint8_t* data, uint64_t* out_rows, uint32_t* out_num_records, ticks_metrics_shard_t* metrics) {
+    TICKS_TRACE_SCOPE("decode_chunk");
+    if (out_rows == NULL || out_num_records == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    chunk_decoder_t decoder;
+    ticks_status_e status = chunk_decoder_init(&decoder, entry, num_columns, column_mask, NULL, 0, data, metrics);
+    if (status != TICKS_OK)
+        return status;
+    return chunk_decoder_next(&decoder, out_rows, decoder.num_records, out_num_records);
+}
+
+// Helper function to sum num_values stored values of a fixed width
+static uint64_t sum_stored_values(const uint8_t* in, uint32_t num_values, size_e width) {
+    uint64_t sum = 0;
+    switch (width) {
+        case SIZE_8BIT:
+            for (uint32_t i = 0; i < num_values; i++)
+                sum += in[i];
+            break;
+        case SIZE_16BIT:
+            for (uint32_t i = 0; i < num_values; i++) {
+                uint16_t value;
+                memcpy(&value, in + (size_t)i * sizeof(value), sizeof(value));
+                sum += value;
+            }
+            break;
+        case SIZE_32BIT:
+            for (uint32_t i = 0; i < num_values; i++) {
+                uint32_t value;
+                memcpy(&value, in + (size_t)i * sizeof(value), sizeof(value));
+                sum += value;
+            }
+            break;
+        default:
+            for (uint32_t i = 0; i < num_values; i++) {
+                uint64_t value;
+                memcpy(&value, in + (size_t)i * sizeof(value), sizeof(value));
+                sum += value;
+            }
+            break;
+    }
+    return sum;
+}
+
+ticks_status_e sum_chunk_column(const ticks_index_entry_t* entry, uint32_t num_columns, uint32_t column_index,
+                                const uint8_t* data, uint64_t* out_sum) {
+    TICKS_TRACE_SCOPE("sum_chunk_column");
+    if (entry == NULL || data == NULL || out_sum == NULL || column_index >= num_columns)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    const uint32_t num_records = chunk_record_count(entry, num_columns);
+    if (num_records == 0)
+        return TICKS_ERROR_INVALID_FORMAT;
+
+    const ticks_column_chunk_t* column = &entry->columns[column_index];
+    const uint8_t* in = data + column->offset;
+
+    // Every stored value is offset by base, so base is added once per record
+    uint64_t sum = column->base * num_records;
+    if (column->codec == TICKS_CODEC_RLE) {
+        // One multiply per run
+        const uint32_t num_runs = column->size / (column->width + RLE_LENGTH_SIZE);
+        const uint8_t* lengths = in + (size_t)num_runs * column->width;
+        uint64_t total = 0;
+        for (uint32_t run = 0; run < num_runs; run++) {
+            uint32_t length;
+            memcpy(&length, lengths + (size_t)run * RLE_LENGTH_SIZE, RLE_LENGTH_SIZE);
+            sum += load_value(in + (size_t)run * column->width, column->width) * length;
+            total += length;
+        }
+        if (total != num_records)
+            return TICKS_ERROR_INVALID_FORMAT;
+    }
+    else if (column->codec == TICKS_CODEC_DICT) {
+        // Count the codes, then one multiply per dictionary value
+        const uint32_t num_values = (column->size - num_records) / column->width;
+        const uint8_t* codes = in + (size_t)num_values * column->width;
+        uint32_t code_counts[TICKS_DICT_MAX_VALUES] = {0};
+        for (uint32_t i = 0; i < num_records; i++)
+            code_counts[codes[i]]++;
+        for (uint32_t code = num_values; code < TICKS_DICT_MAX_VALUES; code++) {
+            if (code_counts[code] != 0)
+                return TICKS_ERROR_INVALID_FORMAT;
+        }
+        for (uint32_t code = 0; code < num_values; code++)
+            sum += load_value(in + (size_t)code * column->width, column->width) * code_counts[code];
+    }
+    else {
+        sum += sum_stored_values(in, num_records, column->width);
+    }
+
+    *out_sum = sum * pow10_uint64(column->scale_shift);
+    return TICKS_OK;
+}
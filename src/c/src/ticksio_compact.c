@@ -0,0 +1,279 @@
+#include "ticksio/ticksio.h"
+
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_chunks.h"
+#include "ticksio/ticksio_constants.h"
+#include "ticksio/ticksio_index.h"
+#include "ticksio/ticksio_platform.h"
+#include "ticksio/ticksio_schema.h"
+
+// Offline compaction: the source rows are split into ranges of range_rows, each range is decoded and
+// re-encoded under the output chunk policy by a worker, and the resulting chunks are appended to the
+// destination in order. Work proceeds in rounds of num_threads ranges so memory stays bounded by the
+// number of workers. Range boundaries also end a chunk, so range_rows trades memory for chunk fill.
+
+typedef struct {
+    ticks_file_t* source;
+    const ticks_schema_t* schema;              // Schema shared by the source and output files
+    const ticks_chunk_policy_t* chunk_policy; // Policy of the output file
+    const ticks_allocator_t* chunk_allocator; // Allocator of the output file, used for the encoded chunks
+    const uint64_t* chunk_first_row; // Global row number of each source chunk's first record, plus the total
+    uint64_t row_start;              // Range of global rows this task re-encodes
+    uint64_t row_end;
+    uint64_t* rows;                  // Decoded row-major records of the range
+    uint64_t* chunk_records;         // Decoded records of one source chunk
+    uint32_t chunk_records_capacity;
+    uint8_t* chunk_buffer;           // Raw bytes of one source chunk
+    size_t chunk_buffer_capacity;
+    ticks_chunk_t** chunks;          // Encoded output chunks, appended by the main thread
+    uint32_t num_chunks;
+    uint32_t chunks_capacity;
+    ticks_status_e status;
+} compact_task_t;
+
+// Helper function to find the source chunk containing a global row
+static uint32_t find_chunk_for_row(const uint64_t* chunk_first_row, uint32_t num_chunks, uint64_t row) {
+    uint32_t low = 0;
+    uint32_t high = num_chunks;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (chunk_first_row[mid + 1] <= row)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+// Helper function to decode the task's row range from the source chunks that overlap it
+static ticks_status_e decode_task_rows(compact_task_t* task) {
+    ticks_file_t* source = task->source;
+    const uint32_t num_source_chunks = source->index.num_entries;
+    const uint32_t num_columns = task->schema->num_columns;
+    uint64_t row = task->row_start;
+    uint64_t out_count = 0;
+
+    for (uint32_t chunk = find_chunk_for_row(task->chunk_first_row, num_source_chunks, row);
+         chunk < num_source_chunks && row < task->row_end; chunk++) {
+        const ticks_index_entry_t* entry = index_entry(source, chunk);
+        const uint32_t num_records = chunk_record_count(entry, num_columns);
+
+        if (task->chunk_records_capacity < num_records) {
+            uint64_t* new_records = mem_realloc(&task->source->allocator, task->chunk_records, (size_t)num_records * num_columns * sizeof(uint64_t));
+            if (new_records == NULL)
+                return TICKS_ERROR_MEMORY_ALLOCATION;
+            task->chunk_records = new_records;
+            task->chunk_records_capacity = num_records;
+        }
+
+        const uint32_t column_mask = schema_all_columns(task->schema);
+        ticks_status_e status = read_chunk(source, chunk, column_mask, &task->chunk_buffer, &task->chunk_buffer_capacity);
+        if (status != TICKS_OK)
+            return status;
+
+        uint32_t decoded = 0;
+        status = decode_chunk(entry, num_columns, column_mask, task->chunk_buffer, task->chunk_records, &decoded, source->metrics);
+        if (status != TICKS_OK)
+            return status;
+
+        const uint64_t first = row - task->chunk_first_row[chunk];
+        uint64_t count = decoded - first;
+        if (count > task->row_end - row)
+            count = task->row_end - row;
+        memcpy(&task->rows[out_count * num_columns], &task->chunk_records[first * num_columns],
+               (size_t)count * num_columns * sizeof(uint64_t));
+        out_count += count;
+        row += count;
+    }
+
+    return row == task->row_end ? TICKS_OK : TICKS_ERROR_INVALID_FORMAT;
+}
+
+static void* compact_worker(void* arg) {
+    compact_task_t* task = arg;
+
+    task->status = decode_task_rows(task);
+    if (task->status != TICKS_OK)
+        return NULL;
+
+    const uint64_t num_rows = task->row_end - task->row_start;
+    uint64_t row_index = 0;
+    while (row_index < num_rows) {
+        if (task->num_chunks == task->chunks_capacity) {
+            uint32_t new_capacity = task->chunks_capacity ? task->chunks_capacity * 2 : 16;
+            ticks_chunk_t** new_chunks = mem_realloc(NULL, task->chunks, new_capacity * sizeof(ticks_chunk_t*));
+            if (new_chunks == NULL) {
+                task->status = TICKS_ERROR_MEMORY_ALLOCATION;
+                return NULL;
+            }
+            task->chunks = new_chunks;
+            task->chunks_capacity = new_capacity;
+        }
+        create_chunk_result result = create_chunk(&row_index, task->rows, num_rows, task->schema, task->chunk_policy, task->chunk_allocator);
+        if (result.status != TICKS_OK) {
+            task->status = result.status;
+            return NULL;
+        }
+        task->chunks[task->num_chunks++] = result.chunk;
+    }
+
+    return NULL;
+}
+
+static void free_task_chunks(compact_task_t* task) {
+    for (uint32_t i = 0; i < task->num_chunks; i++)
+        free_chunk(task->chunk_allocator, task->chunks[i]);
+    task->num_chunks = 0;
+}
+
+// Helper function to check whether filename names the file a handle has open
+static int same_file(const ticks_file_t* handle, const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL)
+        return 0;
+    uint64_t device = 0, inode = 0;
+    const int same = handle->file_identity_valid && file_identity_portable(file, &device, &inode) == 0 &&
+                     device == handle->file_device && inode == handle->file_inode;
+    fclose(file);
+    return same;
+}
+
+ticks_status_e ticks_compact(const char* src_filename, const char* dst_filename, const ticks_compact_policy_t* policy) {
+    if (src_filename == NULL || dst_filename == NULL || strcmp(src_filename, dst_filename) == 0)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    ticks_compact_policy_t effective_policy;
+    memset(&effective_policy, 0, sizeof(effective_policy));
+    if (policy != NULL)
+        effective_policy = *policy;
+    if (effective_policy.range_rows == 0)
+        effective_policy.range_rows = TICKS_COMPACT_DEFAULT_RANGE_ROWS;
+    if (effective_policy.num_threads == 0)
+        effective_policy.num_threads = cpu_count_portable();
+
+    ticks_open_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.verify_mode = effective_policy.verify_mode;
+
+    ticks_file_t* source = NULL;
+    ticks_status_e status = ticks_open_read_ex(src_filename, &options, &source);
+    if (status != TICKS_OK)
+        return status;
+
+    // The source under another path would be truncated while it is read
+    if (same_file(source, dst_filename)) {
+        ticks_close(source);
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    }
+
+    const uint32_t num_source_chunks = source->index.num_entries;
+    uint64_t* chunk_first_row = mem_alloc(NULL, ((size_t)num_source_chunks + 1) * sizeof(uint64_t));
+    compact_task_t* tasks = mem_calloc(NULL, effective_policy.num_threads, sizeof(compact_task_t));
+    thread_portable* threads = mem_calloc(NULL, effective_policy.num_threads, sizeof(thread_portable));
+    if (chunk_first_row == NULL || tasks == NULL || threads == NULL) {
+        mem_free(NULL, chunk_first_row);
+        mem_free(NULL, tasks);
+        mem_free(NULL, threads);
+        ticks_close(source);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+
+    chunk_first_row[0] = 0;
+    for (uint32_t chunk = 0; chunk < num_source_chunks; chunk++)
+        chunk_first_row[chunk + 1] = chunk_first_row[chunk] +
+                                     chunk_record_count(index_entry(source, chunk), source->header.schema.num_columns);
+    const uint64_t total_rows = chunk_first_row[num_source_chunks];
+
+    // Keep the source's chunk policy unless one is given
+    ticks_header_t header = source->header;
+    const ticks_chunk_policy_t no_policy = {0};
+    if (memcmp(&effective_policy.chunk_policy, &no_policy, sizeof(no_policy)) != 0)
+        header.chunk_policy = effective_policy.chunk_policy;
+
+    // Ranges spanning whole row-limited chunks do not cut any chunk short
+    const uint32_t max_chunk_rows = header.chunk_policy.max_chunk_rows;
+    if (max_chunk_rows != 0)
+        effective_policy.range_rows = effective_policy.range_rows > max_chunk_rows ?
+                                      effective_policy.range_rows - effective_policy.range_rows % max_chunk_rows : max_chunk_rows;
+
+    ticks_file_t* destination = NULL;
+    status = ticks_new_file(dst_filename, &header, &destination);
+
+    for (uint32_t i = 0; i < effective_policy.num_threads && status == TICKS_OK; i++) {
+        tasks[i].source = source;
+        tasks[i].schema = &destination->header.schema;
+        tasks[i].chunk_policy = &destination->header.chunk_policy;
+        tasks[i].chunk_allocator = &destination->allocator;
+        tasks[i].chunk_first_row = chunk_first_row;
+        tasks[i].rows = mem_alloc(NULL, (size_t)effective_policy.range_rows * header.schema.num_columns * sizeof(uint64_t));
+        if (tasks[i].rows == NULL)
+            status = TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+
+    uint64_t next_row = 0;
+    while (status == TICKS_OK && next_row < total_rows) {
+        // Hand one range to each worker, the last round may use fewer
+        uint32_t num_tasks = 0;
+        for (; num_tasks < effective_policy.num_threads && next_row < total_rows; num_tasks++) {
+            compact_task_t* task = &tasks[num_tasks];
+            task->row_start = next_row;
+            task->row_end = total_rows - next_row > effective_policy.range_rows ?
+                            next_row + effective_policy.range_rows : total_rows;
+            task->status = TICKS_OK;
+            next_row = task->row_end;
+        }
+
+        const uint64_t encode_start = monotonic_ns_portable();
+        if (num_tasks == 1) {
+            compact_worker(&tasks[0]);
+        }
+        else {
+            uint32_t num_started = 0;
+            for (; num_started < num_tasks; num_started++) {
+                if (thread_create_portable(&threads[num_started], compact_worker, &tasks[num_started]) != 0)
+                    break;
+            }
+            // Run whatever could not be started on this thread
+            for (uint32_t i = num_started; i < num_tasks; i++)
+                compact_worker(&tasks[i]);
+            for (uint32_t i = 0; i < num_started; i++)
+                thread_join_portable(threads[i]);
+        }
+        metrics_add(destination->metrics, METRIC_ENCODE_NS, monotonic_ns_portable() - encode_start);
+
+        // Append in range order so the destination keeps the source's row order
+        for (uint32_t i = 0; i < num_tasks; i++) {
+            compact_task_t* task = &tasks[i];
+            if (status == TICKS_OK)
+                status = task->status;
+            for (uint32_t c = 0; c < task->num_chunks && status == TICKS_OK; c++) {
+                status = append_chunk_and_update_index(destination, task->chunks[c]);
+                metrics_add(destination->metrics, METRIC_ROWS_ENCODED, task->chunks[c]->num_records);
+                metrics_add(destination->metrics, METRIC_COMPRESSION_NS, task->chunks[c]->compression_ns);
+            }
+            free_task_chunks(task);
+        }
+    }
+
+    for (uint32_t i = 0; i < effective_policy.num_threads; i++) {
+        mem_free(NULL, tasks[i].rows);
+        mem_free(&source->allocator, tasks[i].chunk_records);
+        mem_free(&source->allocator, tasks[i].chunk_buffer);
+        mem_free(NULL, tasks[i].chunks);
+    }
+    mem_free(NULL, tasks);
+    mem_free(NULL, threads);
+    mem_free(NULL, chunk_first_row);
+    ticks_close(source);
+
+    if (destination != NULL) {
+        ticks_status_e close_status = ticks_close(destination);
+        if (status == TICKS_OK)
+            status = close_status;
+    }
+    if (status != TICKS_OK)
+        remove(dst_filename);
+
+    return status;
+}
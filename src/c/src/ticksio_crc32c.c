@@ -0,0 +1,194 @@
+#include "ticksio/ticksio_crc32c.h"
+
+#include <string.h>
+
+#include "ticksio/ticksio_helpers.h"
+#include "ticksio/ticksio_platform.h"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
+    #define CRC32C_HAVE_SSE42 1
+    #include <nmmintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    #define CRC32C_HAVE_ARMV8 1
+    #include <arm_acle.h>
+#endif
+
+#define CRC32C_POLY 0x82F63B78u // Reflected Castagnoli polynomial
+
+// Bytes per lane for the hardware path. Three lanes are processed in parallel to hide the
+// latency of the crc32 instruction and then merged, which keeps it at memory speed.
+#define CRC32C_LANE_SIZE 4096
+
+static uint32_t crc32c_table[8][256];
+static uint32_t crc32c_lane_shift; // x^(8 * CRC32C_LANE_SIZE) mod P, used to merge lanes
+static uint32_t (*crc32c_impl)(uint32_t, const uint8_t*, size_t);
+static once_flag_portable crc32c_once = ONCE_FLAG_INIT_PORTABLE;
+
+// Slice-by-8 software implementation on the raw (non-inverted) CRC register
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t* data, size_t length) {
+    while (length > 0 && ((uintptr_t)data & 7) != 0) {
+        crc = crc32c_table[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+        length--;
+    }
+
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        if (!is_little_endian()) {
+            word = ((word & 0x00000000000000FFull) << 56) | ((word & 0x000000000000FF00ull) << 40) |
+                   ((word & 0x0000000000FF0000ull) << 24) | ((word & 0x00000000FF000000ull) << 8) |
+                   ((word & 0x000000FF00000000ull) >> 8) | ((word & 0x0000FF0000000000ull) >> 24) |
+                   ((word & 0x00FF000000000000ull) >> 40) | ((word & 0xFF00000000000000ull) >> 56);
+        }
+        word ^= crc;
+        crc = crc32c_table[7][word & 0xFF] ^
+              crc32c_table[6][(word >> 8) & 0xFF] ^
+              crc32c_table[5][(word >> 16) & 0xFF] ^
+              crc32c_table[4][(word >> 24) & 0xFF] ^
+              crc32c_table[3][(word >> 32) & 0xFF] ^
+              crc32c_table[2][(word >> 40) & 0xFF] ^
+              crc32c_table[1][(word >> 48) & 0xFF] ^
+              crc32c_table[0][word >> 56];
+        data += 8;
+        length -= 8;
+    }
+
+    while (length > 0) {
+        crc = crc32c_table[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+        length--;
+    }
+
+    return crc;
+}
+
+// Multiplies two polynomials modulo P in the reflected domain
+static uint32_t crc32c_multmodp(uint32_t a, uint32_t b) {
+    uint32_t m = (uint32_t)1 << 31;
+    uint32_t p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0)
+                break;
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+    return p;
+}
+
+#if defined(CRC32C_HAVE_SSE42)
+#if defined(__GNUC__)
+__attribute__((target("sse4.2")))
+#endif
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t* data, size_t length) {
+    while (length > 0 && ((uintptr_t)data & 7) != 0) {
+        crc = _mm_crc32_u8(crc, *data++);
+        length--;
+    }
+
+    // Three independent lanes per iteration, merged by shifting the earlier lanes over the later ones
+    while (length >= 3 * CRC32C_LANE_SIZE) {
+        uint64_t crc0 = crc, crc1 = 0, crc2 = 0;
+        const uint8_t* lane1 = data + CRC32C_LANE_SIZE;
+        const uint8_t* lane2 = data + 2 * CRC32C_LANE_SIZE;
+        for (size_t i = 0; i < CRC32C_LANE_SIZE; i += 8) {
+            uint64_t w0, w1, w2;
+            memcpy(&w0, data + i, 8);
+            memcpy(&w1, lane1 + i, 8);
+            memcpy(&w2, lane2 + i, 8);
+            crc0 = _mm_crc32_u64(crc0, w0);
+            crc1 = _mm_crc32_u64(crc1, w1);
+            crc2 = _mm_crc32_u64(crc2, w2);
+        }
+        crc = crc32c_multmodp(crc32c_lane_shift, (uint32_t)crc0) ^ (uint32_t)crc1;
+        crc = crc32c_multmodp(crc32c_lane_shift, crc) ^ (uint32_t)crc2;
+        data += 3 * CRC32C_LANE_SIZE;
+        length -= 3 * CRC32C_LANE_SIZE;
+    }
+
+    uint64_t crc64 = crc;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        length -= 8;
+    }
+    crc = (uint32_t)crc64;
+
+    while (length > 0) {
+        crc = _mm_crc32_u8(crc, *data++);
+        length--;
+    }
+
+    return crc;
+}
+
+static int crc32c_hw_supported(void) {
+    #if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] >> 20) & 1;
+    #else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.2");
+    #endif
+}
+#elif defined(CRC32C_HAVE_ARMV8)
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t* data, size_t length) {
+    while (length > 0 && ((uintptr_t)data & 7) != 0) {
+        crc = __crc32cb(crc, *data++);
+        length--;
+    }
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        crc = __crc32cd(crc, word);
+        data += 8;
+        length -= 8;
+    }
+    while (length > 0) {
+        crc = __crc32cb(crc, *data++);
+        length--;
+    }
+    return crc;
+}
+
+static int crc32c_hw_supported(void) {
+    return 1;
+}
+#endif
+
+static void crc32c_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        crc32c_table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int slice = 1; slice < 8; slice++)
+            crc32c_table[slice][i] = crc32c_table[0][crc32c_table[slice - 1][i] & 0xFF] ^ (crc32c_table[slice - 1][i] >> 8);
+    }
+
+    // x^0 is 0x80000000 in the reflected domain, feeding it zero bytes yields x^(8n) mod P
+    static const uint8_t zeros[CRC32C_LANE_SIZE] = {0};
+    crc32c_lane_shift = crc32c_sw(0x80000000u, zeros, sizeof(zeros));
+
+    crc32c_impl = crc32c_sw;
+    #if defined(CRC32C_HAVE_SSE42) || defined(CRC32C_HAVE_ARMV8)
+        if (crc32c_hw_supported())
+            crc32c_impl = crc32c_hw;
+    #endif
+}
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t length) {
+    call_once_portable(&crc32c_once, crc32c_init);
+    if (data == NULL || length == 0)
+        return crc;
+    return ~crc32c_impl(~crc, (const uint8_t*)data, length);
+}
@@ -1,6 +1,9 @@
 #include "ticksio/ticksio_csv.h"
 
+#include "ticksio/ticksio_alloc.h"
 #include "ticksio/ticksio_constants.h"
+#include "ticksio/ticksio_helpers.h"
+#include "ticksio/ticksio_trace.h"
 
 // Helper function to convert timestamp string to milliseconds since epoch
 static uint64_t timestamp_to_ms(const char *timestamp_str) {
@@ -50,6 +53,7 @@ static ticks_status_e skip_header(FILE *fp) {
 
 static uint64_t count_csv_records(FILE *fp)
 {
+    TICKS_TRACE_SCOPE("count_csv_records");
     if (!fp) return 0;
 
     long current_pos = ftell(fp); // Save current position
@@ -72,8 +76,31 @@ static uint64_t count_csv_records(FILE *fp)
     return count;
 }
 
-static int read_csv_chunk(FILE *fp, trade_data_t *buffer, int max_records)
+// Helper function to parse a "timestamp,price,volume" line. Prices are parsed straight into scaled
+// integers so a quote like 0.29 is stored exactly rather than as the nearest double.
+static int parse_csv_line(const char *line, uint8_t price_scale, char *timestamp, trade_data_t *record)
 {
+    const char *comma = strchr(line, ',');
+    if (comma == NULL || (size_t)(comma - line) >= CSV_MAX_TIMESTAMP_LEN) {
+        return 0;
+    }
+    memcpy(timestamp, line, (size_t)(comma - line));
+    timestamp[comma - line] = '\0';
+
+    const char *end = parse_scaled_decimal(comma + 1, price_scale, &record->price);
+    if (end == NULL || *end != ',') {
+        return 1;
+    }
+    end = parse_scaled_decimal(end + 1, 0, &record->volume);
+    if (end == NULL || (*end != '\0' && *end != '\r' && *end != '\n')) {
+        return 2;
+    }
+    return 3;
+}
+
+static int read_csv_chunk(FILE *fp, trade_data_t *buffer, int max_records, uint8_t price_scale, uint64_t *rejected_lines)
+{
+    TICKS_TRACE_SCOPE("read_csv_chunk");
     if (!fp || !buffer || max_records <= 0) {
         return -1;
     }
@@ -88,13 +115,7 @@ static int read_csv_chunk(FILE *fp, trade_data_t *buffer, int max_records)
             continue;
         }
 
-        int items_matched = sscanf(
-            line,
-            "%[^,],%lf,%d",
-            temp_timestamp,
-            &buffer[records_read].price,
-            &buffer[records_read].volume
-        );
+        int items_matched = parse_csv_line(line, price_scale, temp_timestamp, &buffer[records_read]);
 
         if (items_matched == 3) {
             buffer[records_read].ms_since_epoch = timestamp_to_ms(temp_timestamp);
@@ -102,9 +123,11 @@ static int read_csv_chunk(FILE *fp, trade_data_t *buffer, int max_records)
                 records_read++;
             } else {
                 fprintf(stderr, "Timestamp conversion failed for: %s", line);
+                (*rejected_lines)++;
             }
-        } else if (items_matched > 0) {
-            fprintf(stderr, "Incomplete data in line: %s", line);
+        } else {
+            fprintf(stderr, items_matched > 0 ? "Incomplete data in line: %s" : "Malformed line: %s", line);
+            (*rejected_lines)++;
         }
     }
 
@@ -133,10 +156,10 @@ static ticks_status_e attempt_full_load(csv_read_result_t *result, const char *f
     size_t required_memory = result->total_records * sizeof(trade_data_t);
     double memory_mb = (double)required_memory / (1024.0 * 1024.0);
     
-    printf("Loading %llu records (%.2f MB) into memory...\n",  result->total_records, memory_mb);
+    printf("Loading %llu records (%.2f MB) into memory...\n", (unsigned long long)result->total_records, memory_mb);
 
     // Attempt to allocate memory for all records
-    result->buffer = (trade_data_t*)malloc(required_memory);
+    result->buffer = (trade_data_t*)mem_alloc(NULL, required_memory);
     if (!result->buffer) {
         fclose(fp);
         fprintf(stderr, "Full load failed: Cannot allocate %.2f MB. Falling back to chunked loading.\n", memory_mb);
@@ -147,11 +170,13 @@ static ticks_status_e attempt_full_load(csv_read_result_t *result, const char *f
     fseek(fp, 0, SEEK_SET);
     skip_header(fp);
     
-    int records_read = read_csv_chunk(fp, result->buffer, (int)result->total_records);
+    int records_read = read_csv_chunk(fp, result->buffer, (int)result->total_records, result->price_scale,
+                                      &result->rejected_lines);
     fclose(fp);
 
     if (records_read != (int)result->total_records) {
-        fprintf(stderr, "Warning: Expected %llu records but read %d\n", result->total_records, records_read);
+        fprintf(stderr, "Warning: Expected %llu records but read %d, %llu lines rejected\n",
+                (unsigned long long)result->total_records, records_read, (unsigned long long)result->rejected_lines);
         result->total_records = records_read;
     }
 
@@ -160,7 +185,7 @@ static ticks_status_e attempt_full_load(csv_read_result_t *result, const char *f
     result->is_completed = 1;
     result->current_chunk = 1;
     
-    printf("Full load successful! Loaded %llu records.\n", result->records_in_buffer);
+    printf("Full load successful! Loaded %llu records.\n", (unsigned long long)result->records_in_buffer);
     return TICKS_OK;
 }
 
@@ -170,7 +195,23 @@ static ticks_status_e csv_reader_init(csv_read_result_t *result, const char *fil
         return TICKS_ERROR_INVALID_ARGUMENTS;
     }
 
+    // Prices are scaled like the price column of the schema the rows are written with
+    const ticks_schema_t* schema = result->schema;
+    uint8_t price_scale = TICKS_DEFAULT_PRICE_SCALE;
+    if (schema != NULL) {
+        if (schema->num_columns != 3 || schema->columns[1].type != TICKS_COLUMN_DECIMAL) {
+            fprintf(stderr, "CSV rows need a trades schema with a decimal price column\n");
+            return TICKS_ERROR_INVALID_ARGUMENTS;
+        }
+        price_scale = schema->columns[1].scale;
+    }
+    if (price_scale > TICKS_MAX_DECIMAL_SCALE) {
+        fprintf(stderr, "Price scale %u exceeds the maximum of %d\n", (unsigned)price_scale, TICKS_MAX_DECIMAL_SCALE);
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    }
     memset(result, 0, sizeof(csv_read_result_t));
+    result->schema = schema;
+    result->price_scale = price_scale;
     
     // First attempt full load for maximum performance
     if (attempt_full_load(result, filename) == TICKS_OK) {
@@ -193,7 +234,7 @@ static ticks_status_e csv_reader_init(csv_read_result_t *result, const char *fil
         return TICKS_ERROR_INVALID_FORMAT;
     }
 
-    printf("File contains %llu records, loading in chunks...\n", result->total_records);
+    printf("File contains %llu records, loading in chunks...\n", (unsigned long long)result->total_records);
     
     // Reset to beginning after counting
     fseek(result->file_handle, 0, SEEK_SET);
@@ -220,21 +261,22 @@ static ticks_status_e csv_read_next_chunk(csv_read_result_t *result, size_t chun
 
     // Free previous buffer if it exists
     if (result->buffer) {
-        free(result->buffer);
+        mem_free(NULL, result->buffer);
         result->buffer = NULL;
     }
 
     // Allocate buffer for chunk
-    result->buffer = (trade_data_t*)malloc(chunk_size * sizeof(trade_data_t));
+    result->buffer = (trade_data_t*)mem_alloc(NULL, chunk_size * sizeof(trade_data_t));
     if (!result->buffer) {
         fprintf(stderr, "Failed to allocate memory for chunk\n");
         return TICKS_ERROR_MEMORY_ALLOCATION;
     }
 
     // Read chunk
-    int records_read = read_csv_chunk(result->file_handle, result->buffer, (int)chunk_size);
+    int records_read = read_csv_chunk(result->file_handle, result->buffer, (int)chunk_size, result->price_scale,
+                                      &result->rejected_lines);
     if (records_read < 0) {
-        free(result->buffer);
+        mem_free(NULL, result->buffer);
         result->buffer = NULL;
         return TICKS_ERROR_FILE_IO;
     }
@@ -245,7 +287,7 @@ static ticks_status_e csv_read_next_chunk(csv_read_result_t *result, size_t chun
     // Show progress for chunked loading
     uint64_t total_loaded = (result->current_chunk - 1) * chunk_size + records_read;
     printf("Chunk %llu: loaded %llu records (%.1f%%)\n", 
-           result->current_chunk, total_loaded,
+           (unsigned long long)result->current_chunk, (unsigned long long)total_loaded,
            (double)total_loaded / result->total_records * 100.0);
 
     if (records_read == 0 || feof(result->file_handle)) {
@@ -272,7 +314,7 @@ ticks_status_e read_csv(const char *filename, csv_read_result_t *result)
     // Subsequent calls - read next chunk if in chunked mode
     // TODO: Dynamically adjust chunk size based on available memory for better performance
     if (!result->is_full_load && !result->is_completed) {
-        return csv_read_next_chunk(result, MAX_CHUNK_SIZE);
+        return csv_read_next_chunk(result, CSV_BATCH_ROWS);
     }
 
     // If we did a full load, first call returns all data, subsequent calls return EOF
@@ -289,7 +331,7 @@ void csv_reader_cleanup(csv_read_result_t* result)
     }
 
     if (result->buffer) {
-        free(result->buffer);
+        mem_free(NULL, result->buffer);
         result->buffer = NULL;
     }
 
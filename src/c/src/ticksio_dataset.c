@@ -0,0 +1,810 @@
+#include "ticksio/ticksio_dataset.h"
+
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_crc32c.h"
+#include "ticksio/ticksio_index.h"
+#include "ticksio/ticksio_platform.h"
+#include "ticksio/ticksio_trace.h"
+
+// The catalog file is a header, one TICKS_CATALOG_ENTRY_SIZE record per partition in catalog order, the paths the
+// records point into and a CRC32C of everything before it. Integers are little-endian so the bytes are the same on
+// every host, see docs/ticks-format.md.
+
+#define MAX_DIRECTORY_DEPTH 16 // Deeper subdirectories are not listed, which also ends symbolic link loops
+#define CATALOG_WRITE_ENTRIES 1024 // Records encoded per write when storing the catalog
+
+// Files found by listing the directory, with the catalog records they keep or get
+typedef struct {
+    catalog_entry_t* entries;
+    uint32_t num_entries;
+    uint32_t capacity;
+    char* paths;
+    uint64_t paths_size;
+    uint64_t paths_capacity;
+    const ticks_allocator_t* allocator;
+} listing_t;
+
+typedef struct dataset_work_t dataset_work_t;
+typedef ticks_status_e (*dataset_task_fn)(dataset_work_t* work, uint32_t item);
+
+// Items handed out to the workers of one call, each takes the next until none are left or one failed
+struct dataset_work_t {
+    dataset_task_fn fn;
+    void* context;
+    uint32_t num_items;
+    volatile uint32_t next_item;
+    volatile uint8_t failed; // Set with release once status holds the first error
+    ticks_status_e status;
+    mutex_portable mutex;
+};
+
+// A query fanned out over the partitions selected by plan_partitions
+typedef struct {
+    ticks_dataset_t* dataset;
+    const uint32_t* partitions;
+    time_t from;
+    time_t to;
+    const ticks_iterator_options_t* options;
+    ticks_partition_cb callback;
+    void* user;
+    uint32_t column;
+    volatile uint64_t count;
+    volatile uint64_t sum;
+} dataset_query_t;
+
+typedef struct {
+    dataset_work_t* work;
+    dataset_query_t* query;
+    uint32_t partition;
+} partition_scan_t;
+
+// New and changed files whose catalog records are read on the dataset's threads
+typedef struct {
+    const ticks_dataset_t* dataset;
+    catalog_entry_t* entries;
+    const uint32_t* to_read;
+} partition_read_t;
+
+static uint32_t load_le32(const uint8_t* in) {
+    return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+static uint64_t load_le64(const uint8_t* in) {
+    return (uint64_t)load_le32(in) | (uint64_t)load_le32(in + 4) << 32;
+}
+
+static void store_le32(uint8_t* out, uint32_t value) {
+    for (uint32_t i = 0; i < 4; i++)
+        out[i] = (uint8_t)(value >> (8 * i));
+}
+
+static void store_le64(uint8_t* out, uint64_t value) {
+    for (uint32_t i = 0; i < 8; i++)
+        out[i] = (uint8_t)(value >> (8 * i));
+}
+
+// Helper function to copy a ticker up to its first NUL, zero-padded, so equal symbols compare equal bytewise
+static void copy_symbol(char* out, const char* symbol) {
+    uint32_t i = 0;
+    for (; i < TICKS_TICKER_SIZE && symbol[i] != '\0'; i++)
+        out[i] = symbol[i];
+    for (; i < TICKS_TICKER_SIZE; i++)
+        out[i] = '\0';
+}
+
+// Helper function to join two path components with a separator, an empty prefix is left out
+static char* join_path(const ticks_allocator_t* allocator, const char* prefix, const char* name) {
+    const size_t prefix_length = strlen(prefix);
+    const size_t name_length = strlen(name);
+    char* path = mem_alloc(allocator, prefix_length + name_length + 2);
+    if (path == NULL)
+        return NULL;
+    if (prefix_length == 0) {
+        memcpy(path, name, name_length + 1);
+    }
+    else {
+        memcpy(path, prefix, prefix_length);
+        path[prefix_length] = '/';
+        memcpy(path + prefix_length + 1, name, name_length + 1);
+    }
+    return path;
+}
+
+static int has_ticks_extension(const char* name) {
+    const size_t length = strlen(name);
+    const size_t extension_length = strlen(TICKS_FILE_EXTENSION);
+    return length > extension_length && strcmp(name + length - extension_length, TICKS_FILE_EXTENSION) == 0;
+}
+
+static int compare_entry_paths(const void* a, const void* b) {
+    return strcmp((*(const catalog_entry_t* const*)a)->path, (*(const catalog_entry_t* const*)b)->path);
+}
+
+static int compare_listed_paths(const void* a, const void* b) {
+    return strcmp(((const catalog_entry_t*)a)->path, ((const catalog_entry_t*)b)->path);
+}
+
+// Catalog order: symbol, then earliest timestamp, then path so the order is total
+static int compare_catalog_order(const void* a, const void* b) {
+    const catalog_entry_t* x = a;
+    const catalog_entry_t* y = b;
+    const int symbol = memcmp(x->symbol, y->symbol, TICKS_TICKER_SIZE);
+    if (symbol != 0)
+        return symbol;
+    if (x->min_time != y->min_time)
+        return x->min_time < y->min_time ? -1 : 1;
+    return strcmp(x->path, y->path);
+}
+
+// --- Worker pool ---
+static void* dataset_worker(void* arg) {
+    dataset_work_t* work = arg;
+    while (!atomic_load_acquire_u8_portable(&work->failed)) {
+        const uint32_t item = atomic_increment_u32_portable(&work->next_item) - 1;
+        if (item >= work->num_items)
+            break;
+
+        ticks_status_e status = work->fn(work, item);
+        if (status != TICKS_OK) {
+            mutex_lock_portable(&work->mutex);
+            if (!work->failed) {
+                work->status = status;
+                atomic_store_release_u8_portable(&work->failed, 1);
+            }
+            mutex_unlock_portable(&work->mutex);
+        }
+    }
+    return NULL;
+}
+
+// Helper function to run fn on items [0, num_items) on up to num_threads threads, the calling thread included
+static ticks_status_e run_parallel(uint32_t num_threads, uint32_t num_items, dataset_task_fn fn, void* context) {
+    dataset_work_t work;
+    memset(&work, 0, sizeof(work));
+    work.fn = fn;
+    work.context = context;
+    work.num_items = num_items;
+    mutex_init_portable(&work.mutex);
+
+    const uint32_t num_workers = num_threads < num_items ? num_threads : num_items;
+    thread_portable* threads = num_workers > 1 ? mem_calloc(NULL, num_workers - 1, sizeof(thread_portable)) : NULL;
+    uint32_t num_started = 0;
+    if (threads != NULL) {
+        for (; num_started < num_workers - 1; num_started++) {
+            if (thread_create_portable(&threads[num_started], dataset_worker, &work) != 0)
+                break;
+        }
+    }
+    // The calling thread takes items too, all of them if no thread could be started
+    dataset_worker(&work);
+    for (uint32_t i = 0; i < num_started; i++)
+        thread_join_portable(threads[i]);
+
+    mem_free(NULL, threads);
+    mutex_destroy_portable(&work.mutex);
+    return work.status;
+}
+
+// --- Catalog file ---
+// Helper function to read and validate a stored catalog, a missing or damaged one leaves the dataset empty
+static ticks_status_e load_catalog(ticks_dataset_t* dataset, int* out_loaded) {
+    *out_loaded = 0;
+    char* catalog_path = join_path(&dataset->allocator, dataset->dir, TICKS_CATALOG_NAME);
+    if (catalog_path == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    FILE* file = fopen(catalog_path, "rb");
+    mem_free(&dataset->allocator, catalog_path);
+    if (file == NULL)
+        return TICKS_OK;
+
+    int64_t size = -1;
+    if (fseek64_portable(file, 0, SEEK_END) == 0)
+        size = ftell64_portable(file);
+    if (size < TICKS_CATALOG_HEADER_SIZE + 4 || (uint64_t)size > SIZE_MAX || fseek64_portable(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return TICKS_OK;
+    }
+
+    uint8_t* buffer = mem_alloc(&dataset->allocator, (size_t)size);
+    if (buffer == NULL) {
+        fclose(file);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+    const int read_ok = fread(buffer, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+
+    const uint64_t num_entries = load_le64(buffer + 8);
+    const uint64_t paths_size = load_le64(buffer + 16);
+    const uint64_t entries_size = (uint64_t)(size - TICKS_CATALOG_HEADER_SIZE - 4);
+    if (!read_ok || memcmp(buffer, TICKS_CATALOG_MAGIC, 4) != 0 || load_le32(buffer + 4) != TICKS_CATALOG_VERSION ||
+        num_entries > UINT32_MAX || paths_size > entries_size ||
+        num_entries * TICKS_CATALOG_ENTRY_SIZE != entries_size - paths_size ||
+        crc32c(0, buffer, (size_t)size - 4) != load_le32(buffer + size - 4)) {
+        mem_free(&dataset->allocator, buffer);
+        return TICKS_OK;
+    }
+
+    catalog_entry_t* entries = mem_alloc(&dataset->allocator, num_entries > 0 ? (size_t)num_entries * sizeof(catalog_entry_t) : 1);
+    char* paths = mem_alloc(&dataset->allocator, paths_size > 0 ? (size_t)paths_size : 1);
+    if (entries == NULL || paths == NULL) {
+        mem_free(&dataset->allocator, entries);
+        mem_free(&dataset->allocator, paths);
+        mem_free(&dataset->allocator, buffer);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+    memcpy(paths, buffer + TICKS_CATALOG_HEADER_SIZE + num_entries * TICKS_CATALOG_ENTRY_SIZE, (size_t)paths_size);
+
+    int valid = 1;
+    for (uint32_t i = 0; i < num_entries && valid; i++) {
+        const uint8_t* record = buffer + TICKS_CATALOG_HEADER_SIZE + (size_t)i * TICKS_CATALOG_ENTRY_SIZE;
+        catalog_entry_t* entry = &entries[i];
+        memcpy(entry->symbol, record, TICKS_TICKER_SIZE);
+        entry->min_time = load_le64(record + 8);
+        entry->max_time = load_le64(record + 16);
+        entry->num_records = load_le64(record + 24);
+        entry->mtime_ns = load_le64(record + 32);
+        entry->file_size = load_le64(record + 40);
+        entry->path_offset = load_le64(record + 48);
+        entry->path_length = load_le32(record + 56);
+        entry->num_chunks = load_le32(record + 60);
+        entry->path = paths + entry->path_offset;
+
+        // Each path must be NUL-terminated within the paths and the records in catalog order
+        valid = entry->path_offset < paths_size && entry->path_length < paths_size - entry->path_offset &&
+                paths[entry->path_offset + entry->path_length] == '\0' && strlen(entry->path) == entry->path_length &&
+                (i == 0 || compare_catalog_order(&entries[i - 1], entry) < 0);
+    }
+    mem_free(&dataset->allocator, buffer);
+    if (!valid) {
+        mem_free(&dataset->allocator, entries);
+        mem_free(&dataset->allocator, paths);
+        return TICKS_OK;
+    }
+
+    dataset->entries = entries;
+    dataset->num_entries = (uint32_t)num_entries;
+    dataset->paths = paths;
+    dataset->paths_size = paths_size;
+    *out_loaded = 1;
+    return TICKS_OK;
+}
+
+// Helper function to write bytes to the catalog file and continue its checksum
+static int write_catalog_bytes(FILE* file, const void* data, size_t length, uint32_t* checksum) {
+    if (length == 0)
+        return 1;
+    *checksum = crc32c(*checksum, data, length);
+    return fwrite(data, 1, length, file) == length;
+}
+
+// Helper function to store the catalog, written to a temporary file that then replaces the old catalog
+static ticks_status_e store_catalog(ticks_dataset_t* dataset) {
+    TICKS_TRACE_SCOPE("dataset_store_catalog");
+    char temp_name[64];
+    snprintf(temp_name, sizeof(temp_name), "%s.%llu.tmp", TICKS_CATALOG_NAME, (unsigned long long)monotonic_ns_portable());
+    char* temp_path = join_path(&dataset->allocator, dataset->dir, temp_name);
+    char* catalog_path = join_path(&dataset->allocator, dataset->dir, TICKS_CATALOG_NAME);
+    uint8_t* records = mem_alloc(&dataset->allocator, (size_t)CATALOG_WRITE_ENTRIES * TICKS_CATALOG_ENTRY_SIZE);
+    if (temp_path == NULL || catalog_path == NULL || records == NULL) {
+        mem_free(&dataset->allocator, temp_path);
+        mem_free(&dataset->allocator, catalog_path);
+        mem_free(&dataset->allocator, records);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+
+    ticks_status_e status = TICKS_ERROR_FILE_IO;
+    FILE* file = fopen(temp_path, "wb");
+    if (file != NULL) {
+        uint32_t checksum = 0;
+        uint8_t header[TICKS_CATALOG_HEADER_SIZE];
+        memcpy(header, TICKS_CATALOG_MAGIC, 4);
+        store_le32(header + 4, TICKS_CATALOG_VERSION);
+        store_le64(header + 8, dataset->num_entries);
+        store_le64(header + 16, dataset->paths_size);
+        int ok = write_catalog_bytes(file, header, sizeof(header), &checksum);
+
+        for (uint32_t first = 0; first < dataset->num_entries && ok; first += CATALOG_WRITE_ENTRIES) {
+            const uint32_t count = dataset->num_entries - first < CATALOG_WRITE_ENTRIES ? dataset->num_entries - first : CATALOG_WRITE_ENTRIES;
+            for (uint32_t i = 0; i < count; i++) {
+                const catalog_entry_t* entry = &dataset->entries[first + i];
+                uint8_t* record = records + (size_t)i * TICKS_CATALOG_ENTRY_SIZE;
+                memcpy(record, entry->symbol, TICKS_TICKER_SIZE);
+                store_le64(record + 8, entry->min_time);
+                store_le64(record + 16, entry->max_time);
+                store_le64(record + 24, entry->num_records);
+                store_le64(record + 32, entry->mtime_ns);
+                store_le64(record + 40, entry->file_size);
+                store_le64(record + 48, entry->path_offset);
+                store_le32(record + 56, entry->path_length);
+                store_le32(record + 60, entry->num_chunks);
+            }
+            ok = write_catalog_bytes(file, records, (size_t)count * TICKS_CATALOG_ENTRY_SIZE, &checksum);
+        }
+        if (ok)
+            ok = write_catalog_bytes(file, dataset->paths, (size_t)dataset->paths_size, &checksum);
+
+        uint8_t trailer[4];
+        store_le32(trailer, checksum);
+        if (ok)
+            ok = fwrite(trailer, 1, sizeof(trailer), file) == sizeof(trailer) && fflush(file) == 0 && sync_file_portable(file) == 0;
+        if (fclose(file) != 0)
+            ok = 0;
+        if (ok && rename_replace_portable(temp_path, catalog_path) == 0)
+            status = TICKS_OK;
+        else
+            remove(temp_path);
+    }
+    if (status != TICKS_OK)
+        printf("Failed to store dataset catalog %s: %s\n", catalog_path, strerror(errno));
+
+    mem_free(&dataset->allocator, temp_path);
+    mem_free(&dataset->allocator, catalog_path);
+    mem_free(&dataset->allocator, records);
+    return status;
+}
+
+// --- Refresh ---
+// Helper function to add a file found while listing, its catalog record is filled in later
+static ticks_status_e add_listed_file(listing_t* listing, const char* path, uint64_t mtime_ns, uint64_t file_size) {
+    if (listing->num_entries == UINT32_MAX)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    if (listing->num_entries == listing->capacity) {
+        const uint32_t new_capacity = listing->capacity ? (listing->capacity > UINT32_MAX / 2 ? UINT32_MAX : listing->capacity * 2) : 1024;
+        catalog_entry_t* new_entries = mem_realloc(listing->allocator, listing->entries, (size_t)new_capacity * sizeof(catalog_entry_t));
+        if (new_entries == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        listing->entries = new_entries;
+        listing->capacity = new_capacity;
+    }
+
+    const size_t path_length = strlen(path);
+    if (listing->paths_size + path_length + 1 > listing->paths_capacity) {
+        uint64_t new_capacity = listing->paths_capacity ? listing->paths_capacity * 2 : 65536;
+        while (new_capacity < listing->paths_size + path_length + 1)
+            new_capacity *= 2;
+        char* new_paths = mem_realloc(listing->allocator, listing->paths, (size_t)new_capacity);
+        if (new_paths == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        listing->paths = new_paths;
+        listing->paths_capacity = new_capacity;
+    }
+
+    catalog_entry_t* entry = &listing->entries[listing->num_entries++];
+    memset(entry, 0, sizeof(catalog_entry_t));
+    entry->mtime_ns = mtime_ns;
+    entry->file_size = file_size;
+    entry->path_offset = listing->paths_size;
+    entry->path_length = (uint32_t)path_length;
+    memcpy(listing->paths + listing->paths_size, path, path_length + 1);
+    listing->paths_size += path_length + 1;
+    return TICKS_OK;
+}
+
+// Helper function to list the ticks files under root/relative, recursing into subdirectories
+static ticks_status_e list_files(listing_t* listing, const char* root, const char* relative, uint32_t depth) {
+    char* dir_path = join_path(listing->allocator, root, relative);
+    if (dir_path == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    dir_portable dir;
+    if (dir_open_portable(&dir, relative[0] != '\0' ? dir_path : root) != 0) {
+        printf("Failed to list dataset directory %s: %s\n", relative[0] != '\0' ? dir_path : root, strerror(errno));
+        mem_free(listing->allocator, dir_path);
+        return TICKS_ERROR_FILE_IO;
+    }
+
+    ticks_status_e status = TICKS_OK;
+    const char* name = NULL;
+    while (status == TICKS_OK && dir_next_portable(&dir, &name) == 1) {
+        // Skips ".", "..", hidden files and the catalog itself
+        if (name[0] == '.')
+            continue;
+
+        char* child = join_path(listing->allocator, relative, name);
+        char* child_path = child != NULL ? join_path(listing->allocator, root, child) : NULL;
+        uint64_t mtime_ns = 0;
+        uint64_t file_size = 0;
+        int is_dir = 0;
+        if (child_path == NULL)
+            status = TICKS_ERROR_MEMORY_ALLOCATION;
+        // A file removed since it was listed is left out
+        else if (file_stat_portable(child_path, &mtime_ns, &file_size, &is_dir) == 0) {
+            if (is_dir && depth < MAX_DIRECTORY_DEPTH)
+                status = list_files(listing, root, child, depth + 1);
+            else if (!is_dir && has_ticks_extension(name))
+                status = add_listed_file(listing, child, mtime_ns, file_size);
+        }
+        mem_free(listing->allocator, child);
+        mem_free(listing->allocator, child_path);
+    }
+
+    dir_close_portable(&dir);
+    mem_free(listing->allocator, dir_path);
+    return status;
+}
+
+// Helper function to read the catalog record of a new or changed file, one that cannot be opened gets no chunks
+static ticks_status_e read_partition(dataset_work_t* work, uint32_t item) {
+    TICKS_TRACE_SCOPE("dataset_read_partition");
+    partition_read_t* read = work->context;
+    catalog_entry_t* entry = &read->entries[read->to_read[item]];
+    memset(entry->symbol, 0, TICKS_TICKER_SIZE);
+    entry->min_time = UINT64_MAX;
+    entry->max_time = 0;
+    entry->num_records = 0;
+    entry->num_chunks = 0;
+
+    char* path = join_path(&read->dataset->allocator, read->dataset->dir, entry->path);
+    if (path == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    // A file changing while it is read keeps the modification time it was listed with, so it is read again later
+    ticks_file_t* handle = NULL;
+    ticks_status_e status = ticks_open_read(path, &handle);
+    mem_free(&read->dataset->allocator, path);
+    if (status == TICKS_ERROR_INVALID_FORMAT) {
+        // Not a complete ticks file (yet), e.g. one still awaiting its first checkpoint. It is listed without chunks
+        // and without a modification time, so the next refresh reads it again.
+        entry->mtime_ns = 0;
+        return TICKS_OK;
+    }
+    if (status != TICKS_OK)
+        return status;
+
+    copy_symbol(entry->symbol, handle->header.ticker);
+    entry->num_chunks = handle->index.num_entries;
+    for (uint32_t chunk = 0; chunk < handle->index.num_entries; chunk++) {
+        const ticks_index_entry_t* index = index_entry(handle, chunk);
+        if (index->chunk_time_base < entry->min_time)
+            entry->min_time = index->chunk_time_base;
+        if (index->chunk_max_time > entry->max_time)
+            entry->max_time = index->chunk_max_time;
+        entry->num_records += index->num_records;
+    }
+    ticks_close(handle);
+    return TICKS_OK;
+}
+
+// Helper function to list the directory, read the files that are new or changed since the catalog was built and
+// replace the catalog, storing it when it changed or store is set
+static ticks_status_e refresh_catalog(ticks_dataset_t* dataset, int store, uint32_t* out_changed) {
+    TICKS_TRACE_SCOPE("dataset_refresh");
+    listing_t listing;
+    memset(&listing, 0, sizeof(listing));
+    listing.allocator = &dataset->allocator;
+    ticks_status_e status = list_files(&listing, dataset->dir, "", 0);
+
+    const uint32_t num_old = dataset->num_entries;
+    const catalog_entry_t** old_by_path = NULL;
+    uint32_t* to_read = NULL;
+    if (status == TICKS_OK) {
+        old_by_path = mem_alloc(&dataset->allocator, ((size_t)num_old + 1) * sizeof(catalog_entry_t*));
+        to_read = mem_alloc(&dataset->allocator, ((size_t)listing.num_entries + 1) * sizeof(uint32_t));
+        if (old_by_path == NULL || to_read == NULL)
+            status = TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+
+    uint32_t changed = 0;
+    if (status == TICKS_OK) {
+        // Both sides in path order, so each listed file is matched with its old record in one pass
+        for (uint32_t i = 0; i < listing.num_entries; i++)
+            listing.entries[i].path = listing.paths + listing.entries[i].path_offset;
+        if (listing.num_entries > 1)
+            qsort(listing.entries, listing.num_entries, sizeof(catalog_entry_t), compare_listed_paths);
+        for (uint32_t i = 0; i < num_old; i++)
+            old_by_path[i] = &dataset->entries[i];
+        qsort(old_by_path, num_old, sizeof(catalog_entry_t*), compare_entry_paths);
+
+        // Files to read fill to_read from the front, files tried again from the back
+        uint32_t num_to_read = 0;
+        uint32_t num_retried = 0;
+        uint32_t old = 0;
+        for (uint32_t i = 0; i < listing.num_entries; i++) {
+            catalog_entry_t* entry = &listing.entries[i];
+            for (; old < num_old && strcmp(old_by_path[old]->path, entry->path) < 0; old++)
+                changed++;
+            if (old < num_old && strcmp(old_by_path[old]->path, entry->path) == 0) {
+                const catalog_entry_t* previous = old_by_path[old++];
+                if (previous->mtime_ns != 0 && previous->mtime_ns == entry->mtime_ns && previous->file_size == entry->file_size) {
+                    memcpy(entry->symbol, previous->symbol, TICKS_TICKER_SIZE);
+                    entry->min_time = previous->min_time;
+                    entry->max_time = previous->max_time;
+                    entry->num_records = previous->num_records;
+                    entry->num_chunks = previous->num_chunks;
+                    continue;
+                }
+                // A file that did not open before is tried again, it only counts as changed once it opens
+                if (previous->mtime_ns == 0 && previous->file_size == entry->file_size) {
+                    to_read[listing.num_entries - ++num_retried] = i;
+                    continue;
+                }
+            }
+            to_read[num_to_read++] = i;
+            changed++;
+        }
+        changed += num_old - old;
+
+        memmove(&to_read[num_to_read], &to_read[listing.num_entries - num_retried], (size_t)num_retried * sizeof(uint32_t));
+        partition_read_t read = { .dataset = dataset, .entries = listing.entries, .to_read = to_read };
+        status = run_parallel(dataset->num_threads, num_to_read + num_retried, read_partition, &read);
+        for (uint32_t i = num_to_read; i < num_to_read + num_retried; i++)
+            changed += listing.entries[to_read[i]].mtime_ns != 0;
+    }
+
+    mem_free(&dataset->allocator, old_by_path);
+    mem_free(&dataset->allocator, to_read);
+    if (status != TICKS_OK) {
+        mem_free(&dataset->allocator, listing.entries);
+        mem_free(&dataset->allocator, listing.paths);
+        return status;
+    }
+
+    if (listing.num_entries > 1)
+        qsort(listing.entries, listing.num_entries, sizeof(catalog_entry_t), compare_catalog_order);
+    mem_free(&dataset->allocator, dataset->entries);
+    mem_free(&dataset->allocator, dataset->paths);
+    dataset->entries = listing.entries;
+    dataset->num_entries = listing.num_entries;
+    dataset->paths = listing.paths;
+    dataset->paths_size = listing.paths_size;
+
+    if (out_changed != NULL)
+        *out_changed = changed;
+    if ((changed > 0 || store) && !dataset->read_only)
+        return store_catalog(dataset);
+    return TICKS_OK;
+}
+
+// --- Queries ---
+// Helper function to find the catalog range [first, end) of a symbol's partitions, all partitions for NULL
+static void symbol_range(const ticks_dataset_t* dataset, const char* symbol, uint32_t* out_first, uint32_t* out_end) {
+    *out_first = 0;
+    *out_end = dataset->num_entries;
+    if (symbol == NULL)
+        return;
+    if (strlen(symbol) > TICKS_TICKER_SIZE) {
+        *out_end = 0;
+        return;
+    }
+
+    char key[TICKS_TICKER_SIZE];
+    copy_symbol(key, symbol);
+    uint32_t low = 0;
+    uint32_t high = dataset->num_entries;
+    while (low < high) {
+        const uint32_t mid = low + (high - low) / 2;
+        if (memcmp(dataset->entries[mid].symbol, key, TICKS_TICKER_SIZE) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    *out_first = low;
+    high = dataset->num_entries;
+    while (low < high) {
+        const uint32_t mid = low + (high - low) / 2;
+        if (memcmp(dataset->entries[mid].symbol, key, TICKS_TICKER_SIZE) <= 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    *out_end = low;
+}
+
+// Helper function to select the partitions overlapping [from, to), writing up to max_partitions and counting all
+static uint32_t plan_partitions(const ticks_dataset_t* dataset, const char* symbol, time_t from, time_t to,
+                                uint32_t* out_partitions, uint32_t max_partitions) {
+    TICKS_TRACE_SCOPE("dataset_plan");
+    const uint64_t from_ms = (uint64_t)from * 1000;
+    const uint64_t to_ms = (uint64_t)to * 1000;
+    uint32_t first = 0;
+    uint32_t end = 0;
+    symbol_range(dataset, symbol, &first, &end);
+
+    uint32_t count = 0;
+    for (uint32_t i = first; i < end; i++) {
+        const catalog_entry_t* entry = &dataset->entries[i];
+        // One symbol's partitions are ordered by earliest timestamp, none after this one can start in time
+        if (symbol != NULL && entry->min_time >= to_ms)
+            break;
+        if (entry->num_chunks == 0 || entry->min_time >= to_ms || entry->max_time < from_ms)
+            continue;
+        if (count < max_partitions)
+            out_partitions[count] = i;
+        count++;
+    }
+    return count;
+}
+
+// Helper function to plan a query into an allocated array of partition numbers
+static ticks_status_e plan_query(ticks_dataset_t* dataset, const char* symbol, time_t from, time_t to, uint32_t** out_partitions,
+                                 uint32_t* out_num_partitions) {
+    const uint32_t num_partitions = plan_partitions(dataset, symbol, from, to, NULL, 0);
+    uint32_t* partitions = mem_alloc(&dataset->allocator, ((size_t)num_partitions + 1) * sizeof(uint32_t));
+    if (partitions == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    plan_partitions(dataset, symbol, from, to, partitions, num_partitions);
+    *out_partitions = partitions;
+    *out_num_partitions = num_partitions;
+    return TICKS_OK;
+}
+
+static ticks_status_e open_partition(const ticks_dataset_t* dataset, uint32_t partition, ticks_file_t** out_handle) {
+    char* path = join_path(&dataset->allocator, dataset->dir, dataset->entries[partition].path);
+    if (path == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    // Only the index blocks the query reaches are decoded
+    ticks_open_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.index_mode = TICKS_INDEX_MMAP;
+    ticks_status_e status = ticks_open_read_ex(path, &options, out_handle);
+    mem_free(&dataset->allocator, path);
+    return status;
+}
+
+static ticks_status_e scan_batch(const uint64_t* rows, uint32_t num_rows, void* user) {
+    partition_scan_t* scan = user;
+    // Another partition failed, so this one stops too
+    if (atomic_load_acquire_u8_portable(&scan->work->failed))
+        return scan->work->status;
+    return scan->query->callback(scan->partition, rows, num_rows, scan->query->user);
+}
+
+static ticks_status_e scan_partition(dataset_work_t* work, uint32_t item) {
+    TICKS_TRACE_SCOPE("dataset_scan_partition");
+    dataset_query_t* query = work->context;
+    partition_scan_t scan = { .work = work, .query = query, .partition = query->partitions[item] };
+    ticks_file_t* handle = NULL;
+    ticks_status_e status = open_partition(query->dataset, scan.partition, &handle);
+    if (status != TICKS_OK)
+        return status;
+    status = ticks_scan_ex(handle, query->from, query->to, query->options, scan_batch, &scan);
+    ticks_close(handle);
+    return status;
+}
+
+static ticks_status_e aggregate_partition(dataset_work_t* work, uint32_t item) {
+    TICKS_TRACE_SCOPE("dataset_aggregate_partition");
+    dataset_query_t* query = work->context;
+    ticks_file_t* handle = NULL;
+    ticks_status_e status = open_partition(query->dataset, query->partitions[item], &handle);
+    if (status != TICKS_OK)
+        return status;
+    ticks_aggregate_t aggregate;
+    status = ticks_aggregate(handle, query->from, query->to, query->column, &aggregate);
+    ticks_close(handle);
+    if (status == TICKS_OK) {
+        atomic_add_u64_portable(&query->count, aggregate.count);
+        atomic_add_u64_portable(&query->sum, aggregate.sum);
+    }
+    return status;
+}
+
+// --- API ---
+ticks_status_e ticks_dataset_open(const char* dir, ticks_dataset_t** out_dataset) {
+    return ticks_dataset_open_ex(dir, NULL, out_dataset);
+}
+
+ticks_status_e ticks_dataset_open_ex(const char* dir, const ticks_dataset_options_t* options, ticks_dataset_t** out_dataset) {
+    if (dir == NULL || dir[0] == '\0' || out_dataset == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    const ticks_allocator_t* allocator = mem_global_allocator();
+    ticks_dataset_t* dataset = mem_alloc(allocator, sizeof(ticks_dataset_t));
+    if (dataset == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    memset(dataset, 0, sizeof(ticks_dataset_t));
+    dataset->allocator = *allocator;
+    dataset->num_threads = options != NULL && options->num_threads != 0 ? options->num_threads : cpu_count_portable();
+    dataset->read_only = options != NULL && options->read_only;
+
+    // Trailing separators are dropped so joined paths have one
+    size_t dir_length = strlen(dir);
+    while (dir_length > 1 && (dir[dir_length - 1] == '/' || dir[dir_length - 1] == '\\'))
+        dir_length--;
+    dataset->dir = mem_alloc(&dataset->allocator, dir_length + 1);
+    if (dataset->dir == NULL) {
+        ticks_dataset_close(dataset);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+    memcpy(dataset->dir, dir, dir_length);
+    dataset->dir[dir_length] = '\0';
+
+    int loaded = 0;
+    ticks_status_e status = load_catalog(dataset, &loaded);
+    // Without a usable catalog the directory is listed even when trusting it, and the rebuilt catalog stored
+    if (status == TICKS_OK && (!loaded || options == NULL || options->refresh == TICKS_CATALOG_REFRESH))
+        status = refresh_catalog(dataset, !loaded, NULL);
+    if (status != TICKS_OK) {
+        ticks_dataset_close(dataset);
+        return status;
+    }
+
+    *out_dataset = dataset;
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_dataset_refresh(ticks_dataset_t* dataset, uint32_t* out_changed) {
+    if (dataset == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    return refresh_catalog(dataset, 0, out_changed);
+}
+
+ticks_status_e ticks_dataset_get_num_partitions(ticks_dataset_t* dataset, uint32_t* out_num_partitions) {
+    if (dataset == NULL || out_num_partitions == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    *out_num_partitions = dataset->num_entries;
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_dataset_get_partition(ticks_dataset_t* dataset, uint32_t partition, ticks_partition_t* out_partition) {
+    if (dataset == NULL || partition >= dataset->num_entries || out_partition == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    const catalog_entry_t* entry = &dataset->entries[partition];
+    memcpy(out_partition->symbol, entry->symbol, TICKS_TICKER_SIZE);
+    out_partition->min_time = entry->min_time;
+    out_partition->max_time = entry->max_time;
+    out_partition->num_records = entry->num_records;
+    out_partition->num_chunks = entry->num_chunks;
+    out_partition->path = entry->path;
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_dataset_plan(ticks_dataset_t* dataset, const char* symbol, time_t from, time_t to, uint32_t* out_partitions,
+                                  uint32_t max_partitions, uint32_t* out_num_partitions) {
+    if (dataset == NULL || (out_partitions == NULL && max_partitions > 0) || out_num_partitions == NULL || from < 0 || from >= to)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    *out_num_partitions = plan_partitions(dataset, symbol, from, to, out_partitions, max_partitions);
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_dataset_scan(ticks_dataset_t* dataset, const char* symbol, time_t from, time_t to,
+                                  const ticks_iterator_options_t* options, ticks_partition_cb callback, void* user) {
+    TICKS_TRACE_SCOPE("dataset_scan");
+    if (dataset == NULL || callback == NULL || from < 0 || from >= to)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    dataset_query_t query = { .dataset = dataset, .from = from, .to = to, .options = options, .callback = callback, .user = user };
+    uint32_t* partitions = NULL;
+    uint32_t num_partitions = 0;
+    ticks_status_e status = plan_query(dataset, symbol, from, to, &partitions, &num_partitions);
+    if (status != TICKS_OK)
+        return status;
+    query.partitions = partitions;
+    status = run_parallel(dataset->num_threads, num_partitions, scan_partition, &query);
+    mem_free(&dataset->allocator, partitions);
+    return status;
+}
+
+ticks_status_e ticks_dataset_aggregate(ticks_dataset_t* dataset, const char* symbol, time_t from, time_t to, uint32_t column,
+                                       ticks_aggregate_t* out_aggregate) {
+    TICKS_TRACE_SCOPE("dataset_aggregate");
+    if (dataset == NULL || out_aggregate == NULL || from < 0 || from >= to)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    dataset_query_t query = { .dataset = dataset, .from = from, .to = to, .column = column };
+    uint32_t* partitions = NULL;
+    uint32_t num_partitions = 0;
+    ticks_status_e status = plan_query(dataset, symbol, from, to, &partitions, &num_partitions);
+    if (status != TICKS_OK)
+        return status;
+    query.partitions = partitions;
+    status = run_parallel(dataset->num_threads, num_partitions, aggregate_partition, &query);
+    mem_free(&dataset->allocator, partitions);
+
+    out_aggregate->count = query.count;
+    out_aggregate->sum = query.sum;
+    return status;
+}
+
+ticks_status_e ticks_dataset_close(ticks_dataset_t* dataset) {
+    if (dataset == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    const ticks_allocator_t allocator = dataset->allocator;
+    mem_free(&allocator, dataset->entries);
+    mem_free(&allocator, dataset->paths);
+    mem_free(&allocator, dataset->dir);
+    mem_free(&allocator, dataset);
+    return TICKS_OK;
+}
@@ -0,0 +1,200 @@
+// O_DIRECT is only declared with _GNU_SOURCE
+#define _GNU_SOURCE
+#include "ticksio/ticksio_direct.h"
+
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_trace.h"
+
+// Helper function to round a size up to the direct I/O alignment
+static size_t align_up(size_t size) {
+    return (size + TICKS_DIRECT_ALIGNMENT - 1) / TICKS_DIRECT_ALIGNMENT * TICKS_DIRECT_ALIGNMENT;
+}
+
+// Helper function to write one staged buffer, switching the descriptor to buffered writes if O_DIRECT is refused
+static ticks_status_e write_buffer(direct_writer_t* writer, const uint8_t* data, size_t length, uint64_t offset) {
+    TICKS_TRACE_SCOPE("direct_write");
+    if (write_at_portable(writer->fd, data, length, offset) == 0)
+        return TICKS_OK;
+
+    // Some filesystems accept O_DIRECT on open but fail the writes, those continue through the page cache
+    if (errno == EINVAL && !writer->buffered && direct_disable_portable(writer->fd) == 0) {
+        writer->buffered = 1;
+        if (write_at_portable(writer->fd, data, length, offset) == 0)
+            return TICKS_OK;
+    }
+    perror("ERROR: Direct chunk write failed");
+    return TICKS_ERROR_FILE_IO;
+}
+
+static void* direct_io_thread(void* arg) {
+    direct_writer_t* writer = arg;
+
+    mutex_lock_portable(&writer->mutex);
+    for (;;) {
+        while (!writer->pending && !writer->stop)
+            cond_wait_portable(&writer->cond, &writer->mutex);
+        if (!writer->pending)
+            break;
+
+        const uint8_t* data = writer->buffers[writer->pending_buffer];
+        const size_t length = writer->pending_length;
+        const uint64_t offset = writer->pending_offset;
+        mutex_unlock_portable(&writer->mutex);
+
+        ticks_status_e status = write_buffer(writer, data, length, offset);
+
+        mutex_lock_portable(&writer->mutex);
+        if (status != TICKS_OK && writer->status == TICKS_OK)
+            writer->status = status;
+        writer->pending = 0;
+        cond_broadcast_portable(&writer->cond);
+    }
+    mutex_unlock_portable(&writer->mutex);
+    return NULL;
+}
+
+// Helper function to wait until the I/O thread is done with its buffer, returning the first write error
+static ticks_status_e wait_idle(direct_writer_t* writer) {
+    mutex_lock_portable(&writer->mutex);
+    while (writer->pending)
+        cond_wait_portable(&writer->cond, &writer->mutex);
+    ticks_status_e status = writer->status;
+    mutex_unlock_portable(&writer->mutex);
+    return status;
+}
+
+// Helper function to hand the active buffer to the I/O thread and continue in the other one
+static ticks_status_e submit_active(direct_writer_t* writer) {
+    if (writer->used == 0)
+        return TICKS_OK;
+
+    ticks_status_e status = wait_idle(writer);
+    if (status != TICKS_OK)
+        return status;
+
+    mutex_lock_portable(&writer->mutex);
+    writer->pending_buffer = writer->active;
+    writer->pending_length = writer->used;
+    writer->pending_offset = writer->offset;
+    writer->pending = 1;
+    cond_broadcast_portable(&writer->cond);
+    mutex_unlock_portable(&writer->mutex);
+
+    writer->offset += writer->used;
+    writer->used = 0;
+    writer->active ^= 1;
+    return TICKS_OK;
+}
+
+ticks_status_e direct_writer_open(direct_writer_t* writer, FILE* file, uint64_t offset, uint32_t staging_bytes,
+                                  const ticks_allocator_t* allocator) {
+    if (writer == NULL || file == NULL || writer->fd >= 0 || offset % TICKS_DIRECT_ALIGNMENT != 0)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    const int fd = open_direct_portable(file);
+    if (fd < 0)
+        return TICKS_ERROR_FILE_IO;
+
+    memset(writer, 0, sizeof(direct_writer_t));
+    writer->fd = fd;
+    writer->allocator = *allocator;
+    writer->offset = offset;
+    const size_t capacity = align_up(staging_bytes != 0 ? staging_bytes : TICKS_DIRECT_STAGING_BYTES);
+    for (uint32_t i = 0; i < 2; i++) {
+        writer->buffers[i] = mem_aligned_alloc(&writer->allocator, TICKS_DIRECT_ALIGNMENT, capacity);
+        writer->capacities[i] = capacity;
+    }
+
+    mutex_init_portable(&writer->mutex);
+    cond_init_portable(&writer->cond);
+    if (writer->buffers[0] == NULL || writer->buffers[1] == NULL ||
+        thread_create_portable(&writer->thread, direct_io_thread, writer) != 0) {
+        mem_aligned_free(&writer->allocator, writer->buffers[0]);
+        mem_aligned_free(&writer->allocator, writer->buffers[1]);
+        cond_destroy_portable(&writer->cond);
+        mutex_destroy_portable(&writer->mutex);
+        close_fd_portable(fd);
+        writer->fd = -1;
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+    return TICKS_OK;
+}
+
+ticks_status_e direct_writer_stage(direct_writer_t* writer, const uint8_t* data, uint32_t size, uint64_t* out_offset,
+                                   uint32_t* out_padding) {
+    const size_t padded = align_up(size);
+    if (writer->used + padded > writer->capacities[writer->active]) {
+        ticks_status_e status = submit_active(writer);
+        if (status != TICKS_OK)
+            return status;
+    }
+
+    // A chunk larger than the staging buffer gets a buffer of its own size, the I/O thread never holds the active one
+    if (padded > writer->capacities[writer->active]) {
+        uint8_t* grown = mem_aligned_alloc(&writer->allocator, TICKS_DIRECT_ALIGNMENT, padded);
+        if (grown == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        mem_aligned_free(&writer->allocator, writer->buffers[writer->active]);
+        writer->buffers[writer->active] = grown;
+        writer->capacities[writer->active] = padded;
+    }
+
+    uint8_t* out = writer->buffers[writer->active] + writer->used;
+    memcpy(out, data, size);
+    memset(out + size, 0, padded - size);
+    *out_offset = writer->offset + writer->used;
+    *out_padding = (uint32_t)(padded - size);
+    writer->used += padded;
+    return TICKS_OK;
+}
+
+ticks_status_e direct_writer_flush(direct_writer_t* writer) {
+    ticks_status_e status = submit_active(writer);
+    if (status != TICKS_OK)
+        return status;
+    return wait_idle(writer);
+}
+
+ticks_status_e direct_writer_seek(direct_writer_t* writer, uint64_t offset) {
+    if (writer->fd < 0 || writer->used != 0 || offset % TICKS_DIRECT_ALIGNMENT != 0)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    ticks_status_e status = wait_idle(writer);
+    if (status != TICKS_OK)
+        return status;
+    writer->offset = offset;
+    return TICKS_OK;
+}
+
+ticks_status_e direct_pad_stream(FILE* file, uint64_t* offset) {
+    static const uint8_t zeros[TICKS_DIRECT_ALIGNMENT] = {0};
+    const size_t gap = (size_t)((TICKS_DIRECT_ALIGNMENT - *offset % TICKS_DIRECT_ALIGNMENT) % TICKS_DIRECT_ALIGNMENT);
+    if (fwrite(zeros, 1, gap, file) != gap || fflush(file) != 0)
+        return TICKS_ERROR_FILE_IO;
+    *offset += gap;
+    return TICKS_OK;
+}
+
+ticks_status_e direct_writer_close(direct_writer_t* writer) {
+    if (writer->fd < 0)
+        return TICKS_OK;
+
+    ticks_status_e status = direct_writer_flush(writer);
+
+    mutex_lock_portable(&writer->mutex);
+    writer->stop = 1;
+    cond_broadcast_portable(&writer->cond);
+    mutex_unlock_portable(&writer->mutex);
+    thread_join_portable(writer->thread);
+
+    cond_destroy_portable(&writer->cond);
+    mutex_destroy_portable(&writer->mutex);
+    close_fd_portable(writer->fd);
+    mem_aligned_free(&writer->allocator, writer->buffers[0]);
+    mem_aligned_free(&writer->allocator, writer->buffers[1]);
+    writer->buffers[0] = NULL;
+    writer->buffers[1] = NULL;
+    writer->fd = -1;
+    return status;
+}
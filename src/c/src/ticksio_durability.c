@@ -0,0 +1,195 @@
+#include "ticksio/ticksio_durability.h"
+
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_index.h"
+#include "ticksio/ticksio_trace.h"
+
+// Group commit holds write_mutex while it flushes and writes the checkpoint index, but not while it syncs, so the
+// writer keeps appending chunks while the disk catches up. Those chunks land before the checkpoint's footer without
+// being referenced by it and are picked up by the next checkpoint.
+
+// Helper function to push appended chunks out of the stream and the direct staging buffers
+static ticks_status_e flush_chunks(ticks_file_t* handle) {
+    if (fflush(handle->file_stream) != 0)
+        return TICKS_ERROR_FILE_IO;
+    if (direct_writer_active(&handle->direct))
+        return direct_writer_flush(&handle->direct);
+    return TICKS_OK;
+}
+
+// Helper function to sync the file, storing the time it took
+static ticks_status_e sync_file(ticks_file_t* handle, uint64_t* out_ns) {
+    TICKS_TRACE_SCOPE("sync_file");
+    const uint64_t sync_start = monotonic_ns_portable();
+    if (sync_file_portable(handle->file_stream) != 0) {
+        perror("ERROR: Syncing the ticks file failed");
+        return TICKS_ERROR_FILE_IO;
+    }
+    *out_ns = monotonic_ns_portable() - sync_start;
+    return TICKS_OK;
+}
+
+// Helper function to write the index of the chunks the last checkpoint did not cover. The checkpoints after a
+// complete index only hold the entries added since the one before them. Once they add up to the size of that
+// complete index, the next checkpoint writes a complete index again, so the file grows by at most twice the size
+// of the final index and a reader follows a bounded chain of footers.
+static ticks_status_e write_index(ticks_file_t* handle, uint32_t num_entries) {
+    if (handle->last_footer == 0 || handle->chained_index_bytes >= handle->complete_index_bytes)
+        return create_index(handle, 0, num_entries);
+    return create_index(handle, handle->indexed_entries, num_entries);
+}
+
+// Helper function to write the index of the first num_entries chunks after the last write
+static ticks_status_e write_checkpoint_index(ticks_file_t* handle, uint32_t num_entries) {
+    // Nothing was appended since the last checkpoint, its footer still covers every chunk
+    if (handle->last_footer != 0 && num_entries == handle->indexed_entries)
+        return TICKS_OK;
+    if (!direct_writer_active(&handle->direct))
+        return write_index(handle, num_entries);
+
+    // Direct writes bypass the stream, which is moved past the last staged chunk first
+    ticks_status_e status = direct_writer_flush(&handle->direct);
+    if (status != TICKS_OK)
+        return status;
+    if (fseek64_portable(handle->file_stream, (int64_t)handle->write_offset, SEEK_SET) != 0)
+        return TICKS_ERROR_FILE_IO;
+    status = write_index(handle, num_entries);
+    if (status != TICKS_OK)
+        return status;
+
+    // Direct writes resume on the next alignment after the footer
+    status = direct_pad_stream(handle->file_stream, &handle->write_offset);
+    if (status != TICKS_OK)
+        return status;
+    return direct_writer_seek(&handle->direct, handle->write_offset);
+}
+
+// Helper function to checkpoint every chunk appended so far without releasing write_mutex
+static ticks_status_e checkpoint(ticks_file_t* handle) {
+    TICKS_TRACE_SCOPE("checkpoint");
+    uint64_t sync_ns = 0;
+    uint64_t index_sync_ns = 0;
+    ticks_status_e status = flush_chunks(handle);
+    if (status == TICKS_OK)
+        status = sync_file(handle, &sync_ns);
+    if (status == TICKS_OK)
+        status = write_checkpoint_index(handle, handle->index.num_entries);
+    if (status == TICKS_OK)
+        status = sync_file(handle, &index_sync_ns);
+    metrics_add(handle->metrics, METRIC_IO_NS, sync_ns + index_sync_ns);
+    handle->durability.pending_chunks = 0;
+    return status;
+}
+
+// Helper function to checkpoint the chunks appended so far, releasing write_mutex while syncing
+static ticks_status_e group_commit(ticks_file_t* handle) {
+    TICKS_TRACE_SCOPE("group_commit");
+    uint64_t sync_ns = 0;
+    uint64_t index_sync_ns = 0;
+    ticks_status_e status = flush_chunks(handle);
+    const uint32_t num_entries = handle->index.num_entries;
+    handle->durability.pending_chunks = 0;
+
+    mutex_unlock_portable(&handle->write_mutex);
+    if (status == TICKS_OK)
+        status = sync_file(handle, &sync_ns);
+    mutex_lock_portable(&handle->write_mutex);
+
+    // Chunks appended during the sync are not covered by it and stay out of this index
+    if (status == TICKS_OK)
+        status = write_checkpoint_index(handle, num_entries);
+
+    mutex_unlock_portable(&handle->write_mutex);
+    if (status == TICKS_OK)
+        status = sync_file(handle, &index_sync_ns);
+    mutex_lock_portable(&handle->write_mutex);
+
+    metrics_add(handle->metrics, METRIC_IO_NS, sync_ns + index_sync_ns);
+    return status;
+}
+
+static void* group_commit_thread(void* arg) {
+    ticks_file_t* handle = arg;
+    durability_t* durability = &handle->durability;
+    uint64_t last_commit = monotonic_ns_portable();
+
+    mutex_lock_portable(&handle->write_mutex);
+    while (!durability->stop && durability->status == TICKS_OK) {
+        const uint64_t elapsed_ms = (monotonic_ns_portable() - last_commit) / 1000000;
+        if (durability->pending_chunks >= durability->group_commit_chunks ||
+            (durability->pending_chunks > 0 && elapsed_ms >= durability->group_commit_ms)) {
+            durability->status = group_commit(handle);
+            last_commit = monotonic_ns_portable();
+            continue;
+        }
+        const uint64_t wait_ms = elapsed_ms < durability->group_commit_ms ? durability->group_commit_ms - elapsed_ms :
+                                 durability->group_commit_ms;
+        cond_timedwait_portable(&durability->cond, &handle->write_mutex, (uint32_t)wait_ms);
+    }
+    mutex_unlock_portable(&handle->write_mutex);
+    return NULL;
+}
+
+ticks_status_e durability_start(ticks_file_t* handle, const ticks_write_options_t* options) {
+    durability_t* durability = &handle->durability;
+    if (durability->running)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    durability->mode = options->durability;
+    durability->group_commit_chunks = options->group_commit_chunks != 0 ? options->group_commit_chunks : TICKS_GROUP_COMMIT_CHUNKS;
+    durability->group_commit_ms = options->group_commit_ms != 0 ? options->group_commit_ms : TICKS_GROUP_COMMIT_MS;
+    durability->pending_chunks = 0;
+    durability->status = TICKS_OK;
+    if (durability->mode != TICKS_DURABILITY_GROUP)
+        return TICKS_OK;
+
+    durability->stop = 0;
+    durability->running = 1;
+    cond_init_portable(&durability->cond);
+    if (thread_create_portable(&durability->thread, group_commit_thread, handle) != 0) {
+        cond_destroy_portable(&durability->cond);
+        durability->running = 0;
+        durability->mode = TICKS_DURABILITY_NONE;
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+    return TICKS_OK;
+}
+
+ticks_status_e durability_stop(ticks_file_t* handle) {
+    durability_t* durability = &handle->durability;
+    if (!durability->running)
+        return durability->status;
+
+    mutex_lock_portable(&handle->write_mutex);
+    durability->stop = 1;
+    cond_broadcast_portable(&durability->cond);
+    mutex_unlock_portable(&handle->write_mutex);
+    thread_join_portable(durability->thread);
+
+    cond_destroy_portable(&durability->cond);
+    durability->running = 0;
+    return durability->status;
+}
+
+void durability_chunk_appended(ticks_file_t* handle) {
+    durability_t* durability = &handle->durability;
+    if (++durability->pending_chunks == durability->group_commit_chunks && durability->running)
+        cond_broadcast_portable(&durability->cond);
+}
+
+ticks_status_e durability_commit(ticks_file_t* handle) {
+    durability_t* durability = &handle->durability;
+    if (durability->status != TICKS_OK)
+        return durability->status;
+    if (durability->mode == TICKS_DURABILITY_STRICT && durability->pending_chunks > 0)
+        durability->status = checkpoint(handle);
+    return durability->status;
+}
+
+ticks_status_e durability_sync_close(ticks_file_t* handle) {
+    uint64_t sync_ns = 0;
+    if (handle->durability.mode == TICKS_DURABILITY_NONE)
+        return TICKS_OK;
+    return sync_file(handle, &sync_ns);
+}
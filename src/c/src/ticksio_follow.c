@@ -0,0 +1,134 @@
+#include "ticksio/ticksio_follow.h"
+
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_chunks.h"
+#include "ticksio/ticksio_index.h"
+#include "ticksio/ticksio_platform.h"
+#include "ticksio/ticksio_schema.h"
+#include "ticksio/ticksio_trace.h"
+
+// Helper function to start delivering the next chunk of the index, which is skipped if it fails to read
+static ticks_status_e load_next_chunk(ticks_follower_t* follower) {
+    TICKS_TRACE_SCOPE("follow_load_chunk");
+    ticks_file_t* handle = follower->handle;
+    const uint32_t chunk = follower->next_chunk++;
+    const uint32_t column_mask = schema_all_columns(&handle->header.schema);
+    ticks_status_e status = read_chunk(handle, chunk, column_mask, &follower->chunk_buffer, &follower->chunk_buffer_capacity);
+    if (status != TICKS_OK)
+        return status;
+
+    follower->entry = *index_entry(handle, chunk);
+    status = chunk_decoder_init(&follower->decoder, &follower->entry, handle->header.schema.num_columns, column_mask, NULL, 0,
+                                follower->chunk_buffer, handle->metrics);
+    if (status != TICKS_OK)
+        return status;
+    metrics_add(handle->metrics, METRIC_ROWS_DECODED, follower->decoder.num_records);
+    follower->decoding = 1;
+    return TICKS_OK;
+}
+
+// Helper function to return rows of chunks already in the index, none once every chunk was delivered
+static ticks_status_e next_indexed_rows(ticks_follower_t* follower, uint64_t* out_rows, uint32_t max_rows, uint32_t* out_num_rows) {
+    for (;;) {
+        if (follower->decoding) {
+            ticks_status_e status = chunk_decoder_next(&follower->decoder, out_rows, max_rows, out_num_rows);
+            if (status != TICKS_OK || *out_num_rows > 0)
+                return status;
+            follower->decoding = 0;
+        }
+        if (follower->next_chunk >= follower->handle->index.num_entries)
+            return TICKS_OK;
+
+        ticks_status_e status = load_next_chunk(follower);
+        if (status != TICKS_OK)
+            return status;
+    }
+}
+
+// Helper function to wait up to timeout_ms for the file to change, falling back to polling if notifications fail
+static void wait_for_change(ticks_follower_t* follower, uint32_t timeout_ms) {
+    if (follower->watch != -1) {
+        if (file_watch_wait_portable(follower->watch, timeout_ms) != -1)
+            return;
+        file_watch_close_portable(follower->watch);
+        follower->watch = -1;
+    }
+    sleep_ms_portable(timeout_ms < follower->poll_ms ? timeout_ms : follower->poll_ms);
+}
+
+ticks_status_e ticks_follow_open(const char* filename, const ticks_follow_options_t* options, ticks_follower_t** out_follower) {
+    if (filename == NULL || out_follower == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    // The watch is set up first so a checkpoint written while opening still ends the first wait
+    const int watch = file_watch_open_portable(filename);
+
+    ticks_open_options_t open_options;
+    memset(&open_options, 0, sizeof(open_options));
+    open_options.follow = 1;
+    ticks_file_t* handle = NULL;
+    ticks_status_e status = ticks_open_read_ex(filename, &open_options, &handle);
+    if (status != TICKS_OK) {
+        file_watch_close_portable(watch);
+        return status;
+    }
+
+    ticks_follower_t* follower = mem_alloc(&handle->allocator, sizeof(ticks_follower_t));
+    if (follower == NULL) {
+        file_watch_close_portable(watch);
+        ticks_close(handle);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+    memset(follower, 0, sizeof(ticks_follower_t));
+    follower->handle = handle;
+    follower->watch = watch;
+    follower->poll_ms = options != NULL && options->poll_ms != 0 ? options->poll_ms : TICKS_FOLLOW_POLL_MS;
+    follower->next_chunk = options != NULL && options->from_start ? 0 : handle->index.num_entries;
+
+    *out_follower = follower;
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_follow_next(ticks_follower_t* follower, uint64_t* out_rows, uint32_t max_rows, uint32_t* out_num_rows,
+                                 uint32_t timeout_ms) {
+    if (follower == NULL || out_rows == NULL || max_rows == 0 || out_num_rows == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    *out_num_rows = 0;
+
+    const uint64_t deadline = monotonic_ns_portable() + (uint64_t)timeout_ms * 1000000;
+    for (;;) {
+        ticks_status_e status = next_indexed_rows(follower, out_rows, max_rows, out_num_rows);
+        if (status != TICKS_OK || *out_num_rows > 0)
+            return status;
+
+        uint32_t new_chunks = 0;
+        status = ticks_refresh(follower->handle, &new_chunks);
+        if (status != TICKS_OK)
+            return status;
+        if (new_chunks > 0)
+            continue;
+
+        const uint64_t now = monotonic_ns_portable();
+        if (now >= deadline)
+            return TICKS_EOF;
+        // Rounded up so a wait never ends just short of the deadline and spins
+        wait_for_change(follower, (uint32_t)((deadline - now + 999999) / 1000000));
+    }
+}
+
+ticks_file_t* ticks_follow_handle(ticks_follower_t* follower) {
+    return follower != NULL ? follower->handle : NULL;
+}
+
+ticks_status_e ticks_follow_close(ticks_follower_t* follower) {
+    if (follower == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    ticks_file_t* handle = follower->handle;
+    file_watch_close_portable(follower->watch);
+    mem_free(&handle->allocator, follower->chunk_buffer);
+    mem_free(&handle->allocator, follower);
+    return ticks_close(handle);
+}
@@ -1,5 +1,7 @@
 #include "ticksio/ticksio_helpers.h"
 
+#include <stddef.h>
+
 size_e determine_min_size_uint64(uint64_t value)
 {
     if (value < UINT8_MAX) {
@@ -13,6 +15,59 @@ size_e determine_min_size_uint64(uint64_t value)
     }
 }
 
+uint64_t pow10_uint64(uint8_t exponent)
+{
+    static const uint64_t powers[TICKS_MAX_DECIMAL_SCALE + 1] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+        1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+        100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+        1000000000000000000ULL
+    };
+    return powers[exponent];
+}
+
+const char* parse_scaled_decimal(const char* str, uint8_t scale, uint64_t* out_value)
+{
+    if (scale > TICKS_MAX_DECIMAL_SCALE)
+        return NULL; // Past the powers of ten pow10_uint64 holds
+    while (*str == ' ' || *str == '\t')
+        str++;
+
+    uint64_t value = 0;
+    int num_digits = 0;
+    for (; *str >= '0' && *str <= '9'; str++, num_digits++) {
+        const uint64_t digit = (uint64_t)(*str - '0');
+        if (value > (UINT64_MAX - digit) / 10)
+            return NULL;
+        value = value * 10 + digit;
+    }
+
+    uint8_t fraction_digits = 0;
+    if (*str == '.') {
+        for (str++; *str >= '0' && *str <= '9'; str++, num_digits++) {
+            const uint64_t digit = (uint64_t)(*str - '0');
+            if (fraction_digits == scale) {
+                if (digit != 0)
+                    return NULL; // More decimals than the scale can hold
+                continue;
+            }
+            if (value > (UINT64_MAX - digit) / 10)
+                return NULL;
+            value = value * 10 + digit;
+            fraction_digits++;
+        }
+    }
+    if (num_digits == 0)
+        return NULL;
+
+    // Pad missing decimals, "101.3" at scale 2 is 10130
+    const uint64_t multiplier = pow10_uint64((uint8_t)(scale - fraction_digits));
+    if (value > UINT64_MAX / multiplier)
+        return NULL;
+    *out_value = value * multiplier;
+    return str;
+}
+
 int is_little_endian() {
     int x = 1;
     char* y = (char*)&x;
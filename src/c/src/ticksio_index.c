@@ -1,39 +1,401 @@
 #include "ticksio/ticksio_index.h"
 
-ticks_status_e create_index(ticks_file_t* handle) {
-    if (handle == NULL || handle->file_stream == NULL) {
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_crc32c.h"
+#include "ticksio/ticksio_trace.h"
+
+// The index is stored packed rather than as ticks_index_entry_t structs. Entries are grouped in blocks of
+// TICKS_SPARSE_INDEX_STRIDE and delta coded within a block: each chunk's time base against the previous chunk's, its
+// offset against the end of the previous chunk and each column's base against the same column in the previous chunk.
+// Integers are LEB128 varints, signed deltas zigzag coded, checksums fixed little-endian, so the bytes are the same on
+// every host. A block can be decoded on its own from the offset its sparse entry records.
+
+#define LAYOUT_SCALE_SHIFT 0x10   // Set in a column's layout byte when a scale_shift byte follows
+
+// Delta coding state, reset at the start of each block
+typedef struct {
+    uint64_t time_base;
+    uint64_t chunk_end; // Offset after the previous chunk and its padding
+    uint64_t column_base[TICKS_MAX_COLUMNS];
+} index_delta_t;
+
+typedef struct {
+    const uint8_t* pos;
+    const uint8_t* end;
+    int ok; // Cleared once a read ran past end or a value was malformed
+} index_reader_t;
+
+static uint32_t load_le32(const uint8_t* in) {
+    return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+static uint64_t load_le64(const uint8_t* in) {
+    return (uint64_t)load_le32(in) | (uint64_t)load_le32(in + 4) << 32;
+}
+
+static void store_le64(uint8_t* out, uint64_t value) {
+    for (uint32_t i = 0; i < 8; i++)
+        out[i] = (uint8_t)(value >> (8 * i));
+}
+
+static uint8_t* put_varint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+// Helper function to write a wrapping difference, small either side of zero, as a zigzag varint
+static uint8_t* put_delta(uint8_t* out, uint64_t value, uint64_t reference) {
+    const uint64_t delta = value - reference;
+    return put_varint(out, (delta << 1) ^ (0 - (delta >> 63)));
+}
+
+static uint8_t* put_le32(uint8_t* out, uint32_t value) {
+    for (uint32_t i = 0; i < 4; i++)
+        *out++ = (uint8_t)(value >> (8 * i));
+    return out;
+}
+
+static inline uint64_t get_varint(index_reader_t* reader) {
+    // Most fields of a delta coded entry fit in one byte
+    if (reader->pos < reader->end && *reader->pos < 0x80)
+        return *reader->pos++;
+
+    uint64_t value = 0;
+    for (uint32_t shift = 0; shift < 64 && reader->pos < reader->end; shift += 7) {
+        const uint8_t byte = *reader->pos++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (byte < 0x80)
+            return value;
+    }
+    reader->ok = 0;
+    return 0;
+}
+
+static inline uint64_t get_delta(index_reader_t* reader, uint64_t reference) {
+    const uint64_t zigzag = get_varint(reader);
+    return reference + ((zigzag >> 1) ^ (0 - (zigzag & 1)));
+}
+
+static inline uint32_t get_le32(index_reader_t* reader) {
+    if (reader->end - reader->pos < 4) {
+        reader->ok = 0;
+        return 0;
+    }
+    const uint32_t value = load_le32(reader->pos);
+    reader->pos += 4;
+    return value;
+}
+
+static inline uint8_t get_byte(index_reader_t* reader) {
+    if (reader->pos == reader->end) {
+        reader->ok = 0;
+        return 0;
+    }
+    return *reader->pos++;
+}
+
+// Helper function to encode one entry, returning the end of its bytes
+static uint8_t* encode_entry(uint8_t* out, const ticks_index_entry_t* entry, uint32_t num_columns, index_delta_t* delta) {
+    out = put_delta(out, entry->chunk_time_base, delta->time_base);
+    out = put_varint(out, entry->chunk_max_time - entry->chunk_time_base);
+    out = put_delta(out, entry->chunk_offset, delta->chunk_end);
+    out = put_varint(out, entry->chunk_size);
+    out = put_varint(out, entry->padding);
+    out = put_varint(out, entry->num_records);
+    out = put_le32(out, entry->checksum);
+    delta->time_base = entry->chunk_time_base;
+    delta->chunk_end = entry->chunk_offset + entry->chunk_size + entry->padding;
+
+    uint32_t column_end = 0;
+    for (uint32_t c = 0; c < num_columns; c++) {
+        const ticks_column_chunk_t* column = &entry->columns[c];
+        const uint8_t width_log2 = column->width == SIZE_64BIT ? 3 : column->width == SIZE_32BIT ? 2 : column->width == SIZE_16BIT ? 1 : 0;
+        *out++ = (uint8_t)(width_log2 | column->codec << 2 | (column->scale_shift != 0 ? LAYOUT_SCALE_SHIFT : 0));
+        if (column->scale_shift != 0)
+            *out++ = column->scale_shift;
+        out = put_delta(out, column->base, delta->column_base[c]);
+        out = put_varint(out, column->max - column->base);
+        out = put_varint(out, (uint32_t)(column->offset - column_end));
+        out = put_varint(out, column->size);
+        out = put_le32(out, column->checksum);
+        delta->column_base[c] = column->base;
+        column_end = column->offset + column->size;
+    }
+    return out;
+}
+
+// Helper function to decode one entry, the caller checks reader->ok
+static void decode_entry(index_reader_t* reader, ticks_index_entry_t* entry, uint32_t num_columns, index_delta_t* delta) {
+    entry->chunk_time_base = get_delta(reader, delta->time_base);
+    entry->chunk_max_time = entry->chunk_time_base + get_varint(reader);
+    entry->chunk_offset = get_delta(reader, delta->chunk_end);
+    entry->chunk_size = (uint32_t)get_varint(reader);
+    entry->padding = (uint32_t)get_varint(reader);
+    entry->num_records = (uint32_t)get_varint(reader);
+    entry->checksum = get_le32(reader);
+    delta->time_base = entry->chunk_time_base;
+    delta->chunk_end = entry->chunk_offset + entry->chunk_size + entry->padding;
+
+    // Only the schema's columns are written, zeroing the whole 296-byte entry first would cost more than decoding it
+    uint32_t column_end = 0;
+    for (uint32_t c = 0; c < num_columns; c++) {
+        ticks_column_chunk_t* column = &entry->columns[c];
+        const uint8_t layout = get_byte(reader);
+        column->width = (size_e)(1u << (layout & 0x3));
+        column->codec = (ticks_column_codec_e)((layout >> 2) & 0x3);
+        column->scale_shift = (layout & LAYOUT_SCALE_SHIFT) ? get_byte(reader) : 0;
+        column->base = get_delta(reader, delta->column_base[c]);
+        column->max = column->base + get_varint(reader);
+        column->offset = column_end + (uint32_t)get_varint(reader);
+        column->size = (uint32_t)get_varint(reader);
+        column->checksum = get_le32(reader);
+        delta->column_base[c] = column->base;
+        column_end = column->offset + column->size;
+    }
+}
+
+ticks_status_e decode_index_block(const uint8_t* data, uint64_t size, uint32_t num_entries, uint32_t num_columns,
+                                  ticks_index_entry_t* out_entries, uint64_t* out_used) {
+    index_reader_t reader = { data, data + size, 1 };
+    index_delta_t delta;
+    memset(&delta, 0, sizeof(delta));
+    for (uint32_t i = 0; i < num_entries && reader.ok; i++)
+        decode_entry(&reader, &out_entries[i], num_columns, &delta);
+    if (!reader.ok)
+        return TICKS_ERROR_INVALID_FORMAT;
+    *out_used = (uint64_t)(reader.pos - data);
+    return TICKS_OK;
+}
+
+ticks_status_e decode_index(ticks_file_t* handle, const index_segment_t* segment, const uint8_t* region, uint64_t region_offset,
+                            uint32_t first_block) {
+    TICKS_TRACE_SCOPE("decode_index");
+    const uint32_t num_columns = handle->header.schema.num_columns;
+    const uint32_t stride = segment->sparse_stride;
+    const uint8_t* sparse = region + (segment->index_size - region_offset);
+    uint64_t offset = region_offset;
+
+    for (uint32_t block = first_block; block < segment->num_sparse; block++) {
+        // Blocks are contiguous, the sparse index only records where each starts
+        if (load_le64(sparse + (size_t)block * TICKS_SPARSE_ENTRY_SIZE + 8) != offset)
+            return TICKS_ERROR_INVALID_FORMAT;
+
+        const uint32_t first = segment->first_entry + block * stride;
+        const uint32_t count = segment->num_entries - first < stride ? segment->num_entries - first : stride;
+        uint64_t used = 0;
+        ticks_status_e status = decode_index_block(region + (offset - region_offset), segment->index_size - offset, count,
+                                                   num_columns, &handle->index.entries[first], &used);
+        if (status != TICKS_OK)
+            return status;
+        offset += used;
+    }
+
+    // Only the alignment padding may follow the last block
+    return segment->index_size - offset < TICKS_INDEX_ALIGNMENT ? TICKS_OK : TICKS_ERROR_INVALID_FORMAT;
+}
+
+ticks_status_e decode_sparse_index(ticks_file_t* handle, const uint8_t* region) {
+    const uint8_t* sparse = region + handle->index_size;
+    for (uint32_t block = 0; block < handle->index.num_sparse; block++) {
+        handle->index.sparse[block] = load_le64(sparse + (size_t)block * TICKS_SPARSE_ENTRY_SIZE);
+        if (load_le64(sparse + (size_t)block * TICKS_SPARSE_ENTRY_SIZE + 8) >= handle->index_size)
+            return TICKS_ERROR_INVALID_FORMAT;
+    }
+    return TICKS_OK;
+}
+
+void decode_mapped_block(ticks_file_t* handle, uint32_t block) {
+    TICKS_TRACE_SCOPE("decode_mapped_block");
+    mutex_lock_portable(&handle->index_mutex);
+    if (atomic_load_acquire_u8_portable(&handle->decoded_blocks[block]) == 0) {
+        const uint8_t* region = handle->mapped_index;
+        const uint64_t offset = load_le64(region + handle->index_size + (size_t)block * TICKS_SPARSE_ENTRY_SIZE + 8);
+        const uint32_t first = block * handle->index.sparse_stride;
+        const uint32_t remaining = handle->index.num_entries - first;
+        const uint32_t count = remaining < handle->index.sparse_stride ? remaining : handle->index.sparse_stride;
+        uint64_t used = 0;
+        // A block that does not decode keeps zeroed entries, which read as empty chunks and fail to load
+        if (offset >= handle->index_size ||
+            decode_index_block(region + offset, handle->index_size - offset, count, handle->header.schema.num_columns,
+                               &handle->index.entries[first], &used) != TICKS_OK) {
+            memset(&handle->index.entries[first], 0, (size_t)count * sizeof(ticks_index_entry_t));
+            perror("ERROR: Index block does not decode");
+        }
+        atomic_store_release_u8_portable(&handle->decoded_blocks[block], 1);
+    }
+    mutex_unlock_portable(&handle->index_mutex);
+}
+
+ticks_status_e create_index(ticks_file_t* handle, uint32_t first_entry, uint32_t num_entries) {
+    TICKS_TRACE_SCOPE("create_index");
+    if (handle == NULL || handle->file_stream == NULL || num_entries > handle->index.num_entries || first_entry > num_entries ||
+        (first_entry != 0 && (first_entry != handle->indexed_entries || handle->last_footer == 0))) {
         perror("ERROR: Invalid handle in create_index\n");
         return TICKS_ERROR_INVALID_ARGUMENTS;
     }
 
-    // Make sure index entries are allocated and initialized
-    if (handle->index.entries == NULL || handle->index.num_entries == 0) {
-        perror("WARN: No index entries to write in create_index\n");
-        return TICKS_ERROR_INVALID_FORMAT;
+    const uint64_t io_start = monotonic_ns_portable();
+    static const uint8_t padding[TICKS_INDEX_ALIGNMENT] = {0};
+    const uint32_t num_columns = handle->header.schema.num_columns;
+
+    // One block is encoded at a time, the sparse entries are collected and written after the last block. Blocks
+    // start at first_entry, so a checkpoint only encodes the entries added since the previous one.
+    const uint32_t num_sparse = (num_entries - first_entry + TICKS_SPARSE_INDEX_STRIDE - 1) / TICKS_SPARSE_INDEX_STRIDE;
+    const uint64_t sparse_size = (uint64_t)num_sparse * TICKS_SPARSE_ENTRY_SIZE;
+    uint8_t* block_buffer = mem_alloc(&handle->allocator, (size_t)TICKS_SPARSE_INDEX_STRIDE * index_entry_max_bytes(num_columns));
+    uint8_t* sparse = mem_alloc(&handle->allocator, sparse_size > 0 ? (size_t)sparse_size : 1);
+    if (block_buffer == NULL || sparse == NULL) {
+        mem_free(&handle->allocator, block_buffer);
+        mem_free(&handle->allocator, sparse);
+        return TICKS_ERROR_MEMORY_ALLOCATION;
     }
 
-    // Calculate index size
-    handle->index_size = handle->index.num_entries * sizeof(ticks_index_entry_t);
+    ticks_status_e status = TICKS_OK;
 
-    // Write index entries to file
-    if (_fseeki64(handle->file_stream, handle->index_offset, SEEK_SET) != 0) {
-        perror("ERROR: _fseeki64 to index_offset failed");
-        return TICKS_ERROR_FILE_IO;
+    // Pad after the last chunk so the index, sparse index and footer start aligned
+    const uint64_t padding_size = (TICKS_INDEX_ALIGNMENT - handle->write_offset % TICKS_INDEX_ALIGNMENT) % TICKS_INDEX_ALIGNMENT;
+    if (padding_size > 0 && fwrite(padding, 1, padding_size, handle->file_stream) != padding_size) {
+        perror("ERROR: fwrite of index padding failed");
+        status = TICKS_ERROR_FILE_IO;
     }
-    if (fwrite(handle->index.entries, 1, handle->index_size, handle->file_stream) != handle->index_size) {
-        perror("ERROR: fwrite of index entries failed");
-        return TICKS_ERROR_FILE_IO;
+
+    // Write the packed index blocks directly after the last chunk
+    const uint64_t index_offset = handle->write_offset + padding_size;
+    uint64_t index_size = 0;
+    uint32_t index_checksum = 0;
+    for (uint32_t block = 0; block < num_sparse && status == TICKS_OK; block++) {
+        const uint32_t first = first_entry + block * TICKS_SPARSE_INDEX_STRIDE;
+        const uint32_t count = num_entries - first < TICKS_SPARSE_INDEX_STRIDE ? num_entries - first : TICKS_SPARSE_INDEX_STRIDE;
+        index_delta_t delta;
+        memset(&delta, 0, sizeof(delta));
+        uint8_t* end = block_buffer;
+        for (uint32_t i = 0; i < count; i++)
+            end = encode_entry(end, &handle->index.entries[first + i], num_columns, &delta);
+
+        store_le64(sparse + (size_t)block * TICKS_SPARSE_ENTRY_SIZE, handle->index.entries[first].chunk_time_base);
+        store_le64(sparse + (size_t)block * TICKS_SPARSE_ENTRY_SIZE + 8, index_size);
+
+        const size_t block_size = (size_t)(end - block_buffer);
+        if (fwrite(block_buffer, 1, block_size, handle->file_stream) != block_size) {
+            perror("ERROR: fwrite of index entries failed");
+            status = TICKS_ERROR_FILE_IO;
+        }
+        index_checksum = crc32c(index_checksum, block_buffer, block_size);
+        index_size += block_size;
+    }
+
+    // The packed index is padded so the sparse index and footer stay aligned
+    const uint64_t index_padding = (TICKS_INDEX_ALIGNMENT - index_size % TICKS_INDEX_ALIGNMENT) % TICKS_INDEX_ALIGNMENT;
+    if (status == TICKS_OK && index_padding > 0) {
+        if (fwrite(padding, 1, index_padding, handle->file_stream) != index_padding) {
+            perror("ERROR: fwrite of index padding failed");
+            status = TICKS_ERROR_FILE_IO;
+        }
+        index_checksum = crc32c(index_checksum, padding, index_padding);
+        index_size += index_padding;
     }
 
-    // Update index_size in file header
-    if (_fseeki64(handle->file_stream, 4 + sizeof(ticks_header_t) + sizeof(uint64_t), SEEK_SET) != 0) {
-        perror("ERROR: _fseeki64 before index_size update failed");
+    // Write the sparse index, the time base and block offset of every TICKS_SPARSE_INDEX_STRIDE-th entry
+    if (status == TICKS_OK && sparse_size > 0 && fwrite(sparse, 1, sparse_size, handle->file_stream) != sparse_size) {
+        perror("ERROR: fwrite of sparse index failed");
+        status = TICKS_ERROR_FILE_IO;
+    }
+    index_checksum = crc32c(index_checksum, sparse, sparse_size);
+    mem_free(&handle->allocator, block_buffer);
+    mem_free(&handle->allocator, sparse);
+    if (status != TICKS_OK)
+        return status;
+
+    // Write the footer that points back to the index
+    ticks_footer_t footer;
+    memset(&footer, 0, sizeof(footer));
+    footer.index_offset = index_offset;
+    footer.index_size = index_size;
+    footer.num_entries = num_entries;
+    footer.first_entry = first_entry;
+    footer.previous_footer = first_entry != 0 ? handle->last_footer : 0;
+    footer.sparse_index_offset = index_offset + index_size;
+    footer.sparse_index_stride = TICKS_SPARSE_INDEX_STRIDE;
+    footer.num_sparse_entries = num_sparse;
+    footer.index_checksum = index_checksum;
+    footer.footer_size = sizeof(ticks_footer_t);
+    memcpy(footer.magic, TICKS_FOOTER_MAGIC, sizeof(footer.magic));
+    footer.footer_checksum = crc32c(0, &footer, sizeof(ticks_footer_t));
+
+    if (fwrite(&footer, 1, sizeof(ticks_footer_t), handle->file_stream) != sizeof(ticks_footer_t)) {
+        perror("ERROR: fwrite (footer)");
         return TICKS_ERROR_FILE_IO;
     }
-    if (fwrite(&handle->index_size, 1, sizeof(uint64_t), handle->file_stream) != sizeof(uint64_t)) {
-        perror("ERROR: fwrite (index_size update)");
+
+    if (fflush(handle->file_stream) != 0) {
+        perror("ERROR: fflush after footer write failed");
         return TICKS_ERROR_FILE_IO;
     }
 
+    metrics_add(handle->metrics, METRIC_IO_NS, monotonic_ns_portable() - io_start);
+    metrics_add(handle->metrics, METRIC_BYTES_WRITTEN, padding_size + index_size + sparse_size + sizeof(ticks_footer_t));
+
+    handle->index_offset = index_offset;
+    handle->index_size = index_size;
+    handle->first_entry = first_entry;
+    handle->last_footer = index_offset + index_size + sparse_size;
+    handle->indexed_entries = num_entries;
+    handle->write_offset = handle->last_footer + sizeof(ticks_footer_t);
+    if (first_entry == 0) {
+        handle->complete_index_bytes = index_size + sparse_size;
+        handle->chained_index_bytes = 0;
+    } else {
+        handle->chained_index_bytes += index_size + sparse_size;
+    }
+    // A checkpoint of a prefix leaves the later entries to the next index
+    handle->index_dirty = num_entries < handle->index.num_entries;
+
     return TICKS_OK;
-}
\ No newline at end of file
+}
+
+uint32_t find_chunk_for_time(ticks_file_t* handle, uint64_t ms_since_epoch) {
+    if (handle == NULL || handle->index.num_entries == 0)
+        return 0;
+
+    metrics_add(handle->metrics, METRIC_INDEX_LOOKUPS, 1);
+
+    uint32_t low = 0;
+    uint32_t high = handle->index.num_entries;
+
+    // Level one: narrow the search to a single block using the sparse index
+    if (handle->index.sparse != NULL && handle->index.num_sparse > 0) {
+        uint32_t sparse_low = 0;
+        uint32_t sparse_high = handle->index.num_sparse;
+        while (sparse_low < sparse_high) {
+            uint32_t mid = sparse_low + (sparse_high - sparse_low) / 2;
+            if (handle->index.sparse[mid] < ms_since_epoch)
+                sparse_low = mid + 1;
+            else
+                sparse_high = mid;
+        }
+
+        uint32_t block = sparse_low > 0 ? sparse_low - 1 : 0;
+        low = block * handle->index.sparse_stride;
+        if (handle->index.num_entries - low > handle->index.sparse_stride)
+            high = low + handle->index.sparse_stride;
+        // A mapped index decodes the block on first use
+        index_entry(handle, low);
+    }
+    const ticks_index_entry_t* entries = handle->index.entries;
+
+    // Level two: first entry in the block with a time base at or after the timestamp. The chunk before it can still
+    // end at the timestamp when a run of equal timestamps spans a chunk boundary, so the search starts there.
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (entries[mid].chunk_time_base < ms_since_epoch)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low > 0 ? low - 1 : 0;
+}
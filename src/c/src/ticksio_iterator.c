@@ -1,2 +1,308 @@
 #include "ticksio/ticksio_iterator.h"
-#include "ticksio_iterator.h"
\ No newline at end of file
+
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_chunks.h"
+#include "ticksio/ticksio_index.h"
+#include "ticksio/ticksio_schema.h"
+#include "ticksio/ticksio_trace.h"
+
+// Helper function to read a chunk and decode the records matching the iterator's predicates into rows.
+// The decoded rows depend on the predicates, so they are not shared through the cache.
+static ticks_status_e load_filtered_chunk(ticks_iterator_t* iterator, const chunk_predicate_t* predicates, uint32_t num_predicates,
+                                          uint32_t num_records) {
+    ticks_file_t* handle = iterator->file_handle;
+    const ticks_index_entry_t* entry = index_entry(handle, iterator->current_chunk);
+
+    if (iterator->rows_capacity < num_records) {
+        uint64_t* new_rows = mem_realloc(&iterator->allocator, iterator->rows, (size_t)num_records * iterator->num_columns * sizeof(uint64_t));
+        if (new_rows == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        iterator->rows = new_rows;
+        iterator->rows_capacity = num_records;
+    }
+
+    ticks_status_e status = read_chunk(handle, iterator->current_chunk, iterator->read_mask,
+                                       &iterator->chunk_buffer, &iterator->chunk_buffer_capacity);
+    if (status != TICKS_OK)
+        return status;
+
+    const uint64_t decode_start = monotonic_ns_portable();
+    chunk_decoder_t decoder;
+    status = chunk_decoder_init(&decoder, entry, handle->header.schema.num_columns, iterator->column_mask,
+                                predicates, num_predicates, iterator->chunk_buffer, handle->metrics);
+    if (status == TICKS_OK)
+        status = chunk_decoder_next(&decoder, iterator->rows, num_records, &iterator->num_records);
+    if (status != TICKS_OK)
+        return status;
+    metrics_add(handle->metrics, METRIC_DECODE_NS, monotonic_ns_portable() - decode_start);
+    metrics_add(handle->metrics, METRIC_ROWS_DECODED, iterator->num_records);
+
+    iterator->current_rows = iterator->rows;
+    return TICKS_OK;
+}
+
+// Helper function to read and decode a chunk into row-major records
+static ticks_status_e read_and_decode_chunk(ticks_iterator_t* iterator, uint64_t* rows, uint32_t* out_num_records) {
+    ticks_file_t* handle = iterator->file_handle;
+    const ticks_index_entry_t* entry = index_entry(handle, iterator->current_chunk);
+
+    ticks_status_e read_status = read_chunk(handle, iterator->current_chunk, iterator->column_mask,
+                                            &iterator->chunk_buffer, &iterator->chunk_buffer_capacity);
+    if (read_status != TICKS_OK)
+        return read_status;
+
+    const uint64_t decode_start = monotonic_ns_portable();
+    ticks_status_e decode_status = decode_chunk(entry, handle->header.schema.num_columns, iterator->column_mask,
+                                                 iterator->chunk_buffer, rows, out_num_records, handle->metrics);
+    if (decode_status != TICKS_OK)
+        return decode_status;
+    metrics_add(handle->metrics, METRIC_DECODE_NS, monotonic_ns_portable() - decode_start);
+    metrics_add(handle->metrics, METRIC_ROWS_DECODED, *out_num_records);
+    return TICKS_OK;
+}
+
+// Helper function to load the iterator's current chunk from the shared cache, decoding it on a miss
+static ticks_status_e load_cached_chunk(ticks_iterator_t* iterator, uint32_t num_records) {
+    ticks_file_t* handle = iterator->file_handle;
+    const ticks_index_entry_t* entry = index_entry(handle, iterator->current_chunk);
+
+    ticks_cache_key_t key;
+    key.file_device = handle->file_device;
+    key.file_inode = handle->file_inode;
+    key.chunk_offset = entry->chunk_offset;
+    key.chunk_checksum = entry->checksum;
+    key.column_mask = iterator->column_mask;
+
+    ticks_cache_entry_t* cache_entry = cache_acquire(&key);
+    if (cache_entry != NULL) {
+        metrics_add(handle->metrics, METRIC_CACHE_HITS, 1);
+    }
+    else {
+        metrics_add(handle->metrics, METRIC_CACHE_MISSES, 1);
+
+        const uint32_t num_columns = iterator->num_columns;
+        // The cache frees entries through the process-wide allocator
+        uint64_t* rows = mem_alloc(NULL, (size_t)num_records * num_columns * sizeof(uint64_t));
+        if (rows == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+
+        uint32_t decoded_records = 0;
+        ticks_status_e status = read_and_decode_chunk(iterator, rows, &decoded_records);
+        if (status != TICKS_OK) {
+            mem_free(NULL, rows);
+            return status;
+        }
+
+        cache_entry = cache_insert(&key, rows, decoded_records, num_columns);
+        if (cache_entry == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+    }
+
+    iterator->cache_entry = cache_entry;
+    iterator->current_rows = cache_entry_rows(cache_entry, &iterator->num_records);
+    return TICKS_OK;
+}
+
+// Helper function to make the iterator's current chunk available in current_rows
+static ticks_status_e load_current_chunk(ticks_iterator_t* iterator, const chunk_predicate_t* predicates, uint32_t num_predicates) {
+    TICKS_TRACE_SCOPE("iterator_load_chunk");
+    ticks_file_t* handle = iterator->file_handle;
+    const ticks_index_entry_t* entry = index_entry(handle, iterator->current_chunk);
+
+    const uint32_t num_columns = iterator->num_columns;
+    const uint32_t num_records = chunk_record_count(entry, handle->header.schema.num_columns);
+    if (num_records == 0)
+        return TICKS_ERROR_INVALID_FORMAT;
+
+    if (iterator->num_predicates != 0) {
+        ticks_status_e filter_status = load_filtered_chunk(iterator, predicates, num_predicates, num_records);
+        if (filter_status != TICKS_OK)
+            return filter_status;
+    }
+    else if (handle->file_identity_valid && cache_enabled()) {
+        ticks_status_e cache_status = load_cached_chunk(iterator, num_records);
+        if (cache_status != TICKS_OK)
+            return cache_status;
+    }
+    else {
+        if (iterator->rows_capacity < num_records) {
+            uint64_t* new_rows = mem_realloc(&iterator->allocator, iterator->rows, (size_t)num_records * num_columns * sizeof(uint64_t));
+            if (new_rows == NULL)
+                return TICKS_ERROR_MEMORY_ALLOCATION;
+            iterator->rows = new_rows;
+            iterator->rows_capacity = num_records;
+        }
+
+        ticks_status_e decode_status = read_and_decode_chunk(iterator, iterator->rows, &iterator->num_records);
+        if (decode_status != TICKS_OK)
+            return decode_status;
+        iterator->current_rows = iterator->rows;
+    }
+
+    iterator->current_record_in_chunk = 0;
+    iterator->chunk_loaded = 1;
+
+    return TICKS_OK;
+}
+
+// Helper function to move past the current chunk, unpinning it if it came from the cache
+static void release_current_chunk(ticks_iterator_t* iterator) {
+    cache_release(iterator->cache_entry);
+    iterator->cache_entry = NULL;
+    iterator->current_rows = NULL;
+    iterator->chunk_loaded = 0;
+}
+
+ticks_status_e ticks_iterator_create(ticks_file_t *handle, time_t from, time_t to, ticks_iterator_t** out_iterator)
+{
+    return ticks_iterator_create_ex(handle, from, to, NULL, out_iterator);
+}
+
+ticks_status_e ticks_iterator_create_ex(ticks_file_t* handle, time_t from, time_t to, const ticks_iterator_options_t* options,
+                                        ticks_iterator_t** out_iterator)
+{
+    if (handle == NULL || out_iterator == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    time_t now = time(NULL);
+    if (from >= to || from < 0 || to <= 0 || from > now || to > now)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    const ticks_predicate_t* predicates = options != NULL ? options->predicates : NULL;
+    const uint32_t num_predicates = options != NULL ? options->num_predicates : 0;
+    if (schema_validate_predicates(&handle->header.schema, predicates, num_predicates) != TICKS_OK)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    ticks_iterator_t* iterator = mem_alloc(&handle->allocator, sizeof(ticks_iterator_t));
+    if (iterator == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+    
+    memset(iterator, 0, sizeof(ticks_iterator_t));
+    iterator->allocator = handle->allocator;
+    iterator->file_handle = handle;
+    iterator->from = from;
+    iterator->to = to;
+    iterator->from_ms = (uint64_t)from * 1000;
+    iterator->to_ms = (uint64_t)to * 1000;
+    iterator->column_mask = schema_projection(&handle->header.schema, options != NULL ? options->column_mask : 0);
+    iterator->num_columns = column_mask_count(iterator->column_mask);
+    iterator->read_mask = iterator->column_mask | predicate_column_mask(predicates, num_predicates);
+    if (num_predicates != 0) {
+        // The time range joins the predicates so records outside it are dropped before they are decoded
+        memcpy(iterator->predicates, predicates, num_predicates * sizeof(ticks_predicate_t));
+        iterator->predicates[num_predicates].column = 0;
+        iterator->predicates[num_predicates].min = iterator->from_ms;
+        iterator->predicates[num_predicates].max = iterator->to_ms - 1;
+        iterator->num_predicates = num_predicates + 1;
+    }
+    iterator->current_chunk = find_chunk_for_time(handle, iterator->from_ms);
+    iterator->current_record_in_chunk = 0;
+
+    *out_iterator = iterator;
+
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_iterator_next_records(ticks_iterator_t* iterator, uint64_t* out_rows, uint32_t max_rows, uint32_t* out_num_rows)
+{
+    if (iterator == NULL || out_rows == NULL || out_num_rows == NULL || max_rows == 0)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    ticks_file_t* handle = iterator->file_handle;
+    const uint32_t num_columns = iterator->num_columns;
+    uint32_t count = 0;
+    *out_num_rows = 0;
+
+    while (count < max_rows) {
+        if (!iterator->chunk_loaded) {
+            // Chunks are ordered by time base, nothing after a chunk starting at or past the range end can match
+            if (iterator->current_chunk >= handle->index.num_entries ||
+                index_entry(handle, iterator->current_chunk)->chunk_time_base >= iterator->to_ms)
+                break;
+
+            // Chunks ending before the range start are skipped without being read
+            if (index_entry(handle, iterator->current_chunk)->chunk_max_time < iterator->from_ms) {
+                iterator->current_chunk++;
+                continue;
+            }
+
+            // Chunks the predicates rule out from their index stats are skipped without being read
+            chunk_predicate_t predicates[TICKS_MAX_PREDICATES + 1];
+            uint32_t num_predicates = 0;
+            if (iterator->num_predicates != 0 &&
+                !chunk_predicates_rewrite(index_entry(handle, iterator->current_chunk), &handle->header.schema,
+                                          iterator->predicates, iterator->num_predicates, predicates, &num_predicates)) {
+                metrics_add(handle->metrics, METRIC_CHUNKS_SKIPPED, 1);
+                iterator->current_chunk++;
+                continue;
+            }
+
+            ticks_status_e load_status = load_current_chunk(iterator, predicates, num_predicates);
+            if (load_status != TICKS_OK)
+                return load_status;
+        }
+
+        while (count < max_rows && iterator->current_record_in_chunk < iterator->num_records) {
+            const uint64_t* row = &iterator->current_rows[(size_t)iterator->current_record_in_chunk++ * num_columns];
+            if (row[0] >= iterator->from_ms && row[0] < iterator->to_ms)
+                memcpy(&out_rows[(size_t)count++ * num_columns], row, num_columns * sizeof(uint64_t));
+        }
+
+        if (iterator->current_record_in_chunk >= iterator->num_records) {
+            release_current_chunk(iterator);
+            iterator->current_chunk++;
+        }
+    }
+
+    *out_num_rows = count;
+    return count > 0 ? TICKS_OK : TICKS_EOF;
+}
+
+ticks_status_e ticks_iterator_next_batch(ticks_iterator_t* iterator, trade_data_t* out_records, uint32_t max_records, uint32_t* out_num_records)
+{
+    if (iterator == NULL || !schema_has_trade_layout(&iterator->file_handle->header.schema))
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    // trade_data_t is laid out as one row of the built-in trades schema
+    ticks_status_e status = ticks_iterator_next_records(iterator, (uint64_t*)out_records, max_records, out_num_records);
+    if (status != TICKS_OK || iterator->num_columns == 3)
+        return status;
+
+    // Spread the packed projected values out to their fields, from the back so no value is overwritten before
+    // it is moved, leaving the unprojected fields zero
+    // (the timestamp is always projected, so only price or volume can be missing)
+    uint64_t* values = (uint64_t*)out_records;
+    const uint32_t stride = iterator->num_columns;
+    const int has_price = (iterator->column_mask & 0x2) != 0;
+    for (uint32_t i = *out_num_records; i-- > 0;) {
+        const uint64_t* packed = &values[(size_t)i * stride];
+        const uint64_t ms_since_epoch = packed[0];
+        const uint64_t price = has_price ? packed[1] : 0;
+        const uint64_t volume = has_price ? 0 : (stride == 2 ? packed[1] : 0);
+        out_records[i].ms_since_epoch = ms_since_epoch;
+        out_records[i].price = price;
+        out_records[i].volume = volume;
+    }
+    return TICKS_OK;
+}
+
+ticks_status_e ticks_iterator_next(ticks_iterator_t* iterator, trade_data_t* out_record)
+{
+    uint32_t num_records = 0;
+    return ticks_iterator_next_batch(iterator, out_record, 1, &num_records);
+}
+
+ticks_status_e ticks_iterator_destroy(ticks_iterator_t *iterator)
+{
+    if (iterator == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    release_current_chunk(iterator);
+    const ticks_allocator_t allocator = iterator->allocator;
+    mem_free(&allocator, iterator->chunk_buffer);
+    mem_free(&allocator, iterator->rows);
+    mem_free(&allocator, iterator);
+    
+    return TICKS_OK;
+}
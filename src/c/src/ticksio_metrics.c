@@ -0,0 +1,51 @@
+#include "ticksio/ticksio_metrics.h"
+#include "ticksio/ticksio_alloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static volatile uint32_t metrics_next_thread_slot = 0;
+static THREAD_LOCAL_PORTABLE uint32_t metrics_thread_slot = 0; // 0 = not assigned yet
+
+ticks_metrics_shard_t* metrics_create(const ticks_allocator_t* allocator) {
+    return mem_calloc(allocator, TICKS_METRICS_SHARDS, sizeof(ticks_metrics_shard_t));
+}
+
+void metrics_destroy(const ticks_allocator_t* allocator, ticks_metrics_shard_t* shards) {
+    mem_free(allocator, shards);
+}
+
+uint32_t metrics_thread_shard(void) {
+    if (metrics_thread_slot == 0)
+        metrics_thread_slot = atomic_increment_u32_portable(&metrics_next_thread_slot);
+    return (metrics_thread_slot - 1) % TICKS_METRICS_SHARDS;
+}
+
+void metrics_collect(const ticks_metrics_shard_t* shards, ticks_metrics_t* out_metrics) {
+    uint64_t totals[METRIC_COUNT];
+    memset(totals, 0, sizeof(totals));
+
+    if (shards != NULL) {
+        for (uint32_t shard = 0; shard < TICKS_METRICS_SHARDS; shard++) {
+            for (uint32_t metric = 0; metric < METRIC_COUNT; metric++)
+                totals[metric] += atomic_load_u64_portable(&shards[shard].values[metric]);
+        }
+    }
+
+    out_metrics->bytes_written = totals[METRIC_BYTES_WRITTEN];
+    out_metrics->bytes_read = totals[METRIC_BYTES_READ];
+    out_metrics->chunks_written = totals[METRIC_CHUNKS_WRITTEN];
+    out_metrics->chunks_read = totals[METRIC_CHUNKS_READ];
+    out_metrics->rows_encoded = totals[METRIC_ROWS_ENCODED];
+    out_metrics->rows_decoded = totals[METRIC_ROWS_DECODED];
+    out_metrics->encode_ns = totals[METRIC_ENCODE_NS];
+    out_metrics->decode_ns = totals[METRIC_DECODE_NS];
+    out_metrics->io_ns = totals[METRIC_IO_NS];
+    out_metrics->checksum_ns = totals[METRIC_CHECKSUM_NS];
+    out_metrics->compression_ns = totals[METRIC_COMPRESSION_NS];
+    out_metrics->index_lookups = totals[METRIC_INDEX_LOOKUPS];
+    out_metrics->cache_hits = totals[METRIC_CACHE_HITS];
+    out_metrics->cache_misses = totals[METRIC_CACHE_MISSES];
+    out_metrics->late_ticks = totals[METRIC_LATE_TICKS];
+    out_metrics->chunks_skipped = totals[METRIC_CHUNKS_SKIPPED];
+}
@@ -0,0 +1,134 @@
+#include "ticksio/ticksio_reorder.h"
+#include "ticksio/ticksio_alloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int slot_less(const ticks_reorder_slot_t* a, const ticks_reorder_slot_t* b) {
+    if (a->values[0] != b->values[0])
+        return a->values[0] < b->values[0];
+    return a->sequence < b->sequence;
+}
+
+static void heap_sift_up(ticks_reorder_slot_t* heap, uint32_t index) {
+    ticks_reorder_slot_t slot = heap[index];
+    while (index > 0) {
+        uint32_t parent = (index - 1) / 2;
+        if (!slot_less(&slot, &heap[parent]))
+            break;
+        heap[index] = heap[parent];
+        index = parent;
+    }
+    heap[index] = slot;
+}
+
+static void heap_sift_down(ticks_reorder_slot_t* heap, uint32_t num_slots, uint32_t index) {
+    ticks_reorder_slot_t slot = heap[index];
+    for (;;) {
+        uint32_t child = index * 2 + 1;
+        if (child >= num_slots)
+            break;
+        if (child + 1 < num_slots && slot_less(&heap[child + 1], &heap[child]))
+            child++;
+        if (!slot_less(&heap[child], &slot))
+            break;
+        heap[index] = heap[child];
+        index = child;
+    }
+    heap[index] = slot;
+}
+
+// Helper function to append a tick to the output, growing it geometrically
+static ticks_status_e output_append(ticks_reorder_t* reorder, const uint64_t* row) {
+    if (reorder->num_output == reorder->output_capacity) {
+        uint64_t new_capacity = reorder->output_capacity ? reorder->output_capacity * 2 : 1024;
+        uint64_t* new_output = mem_realloc(reorder->allocator, reorder->output, (size_t)new_capacity * reorder->num_columns * sizeof(uint64_t));
+        if (new_output == NULL)
+            return TICKS_ERROR_MEMORY_ALLOCATION;
+        reorder->output = new_output;
+        reorder->output_capacity = new_capacity;
+    }
+    memcpy(&reorder->output[reorder->num_output++ * reorder->num_columns], row, reorder->num_columns * sizeof(uint64_t));
+    return TICKS_OK;
+}
+
+// Helper function to move the oldest held tick to the output
+static ticks_status_e release_oldest(ticks_reorder_t* reorder) {
+    const ticks_reorder_slot_t oldest = reorder->heap[0];
+    reorder->heap[0] = reorder->heap[--reorder->num_slots];
+    if (reorder->num_slots > 0)
+        heap_sift_down(reorder->heap, reorder->num_slots, 0);
+
+    reorder->released_ms = oldest.values[0];
+    reorder->has_released = 1;
+    return output_append(reorder, oldest.values);
+}
+
+// Helper function to check whether the oldest held tick has left the window
+static int oldest_expired(const ticks_reorder_t* reorder) {
+    if (reorder->num_slots == 0)
+        return 0;
+    if (reorder->options.window_rows != 0 && reorder->num_slots > reorder->options.window_rows)
+        return 1;
+    return reorder->options.window_ms != 0 &&
+           reorder->heap[0].values[0] + reorder->options.window_ms <= reorder->max_seen_ms;
+}
+
+int reorder_enabled(const ticks_reorder_options_t* options) {
+    return options->window_ms != 0 || options->window_rows != 0;
+}
+
+ticks_status_e reorder_push(ticks_reorder_t* reorder, const uint64_t* rows, uint64_t num_rows, uint32_t num_columns, uint64_t* out_late) {
+    reorder->num_output = 0;
+    reorder->num_columns = num_columns;
+
+    for (uint64_t i = 0; i < num_rows; i++) {
+        const uint64_t* row = &rows[i * num_columns];
+
+        // Older than a tick already released, it can no longer be placed in order. Writing it anyway would start a
+        // chunk before the end of an earlier one, which time lookups rely on not happening, so it is dropped.
+        if (reorder->has_released && row[0] < reorder->released_ms) {
+            (*out_late)++;
+            continue;
+        }
+
+        if (reorder->num_slots == reorder->capacity) {
+            uint32_t new_capacity = reorder->capacity ? reorder->capacity * 2 : 1024;
+            ticks_reorder_slot_t* new_heap = mem_realloc(reorder->allocator, reorder->heap, (size_t)new_capacity * sizeof(ticks_reorder_slot_t));
+            if (new_heap == NULL)
+                return TICKS_ERROR_MEMORY_ALLOCATION;
+            reorder->heap = new_heap;
+            reorder->capacity = new_capacity;
+        }
+
+        memcpy(reorder->heap[reorder->num_slots].values, row, num_columns * sizeof(uint64_t));
+        reorder->heap[reorder->num_slots].sequence = reorder->next_sequence++;
+        heap_sift_up(reorder->heap, reorder->num_slots++);
+        if (row[0] > reorder->max_seen_ms)
+            reorder->max_seen_ms = row[0];
+
+        while (oldest_expired(reorder)) {
+            ticks_status_e status = release_oldest(reorder);
+            if (status != TICKS_OK)
+                return status;
+        }
+    }
+
+    return TICKS_OK;
+}
+
+ticks_status_e reorder_flush(ticks_reorder_t* reorder) {
+    reorder->num_output = 0;
+    while (reorder->num_slots > 0) {
+        ticks_status_e status = release_oldest(reorder);
+        if (status != TICKS_OK)
+            return status;
+    }
+    return TICKS_OK;
+}
+
+void reorder_release(ticks_reorder_t* reorder) {
+    mem_free(reorder->allocator, reorder->heap);
+    mem_free(reorder->allocator, reorder->output);
+    memset(reorder, 0, sizeof(ticks_reorder_t));
+}
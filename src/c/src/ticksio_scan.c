@@ -0,0 +1,190 @@
+#include "ticksio/ticksio.h"
+
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_chunks.h"
+#include "ticksio/ticksio_index.h"
+#include "ticksio/ticksio_platform.h"
+#include "ticksio/ticksio_schema.h"
+#include "ticksio/ticksio_trace.h"
+
+// Scans hand each batch to the callback right after decoding it. Chunks are decoded TICKS_SCAN_BATCH_ROWS records at
+// a time into one buffer reused for the whole scan, so the callback reads rows that are still in cache instead of
+// rows streamed out to memory and read back. Chunks already in the decoded chunk cache are passed on from it in the
+// same batch sizes. Scans never decode a whole chunk, so they do not add chunks to the cache.
+//
+// The time range is handled as one more predicate on the timestamp column. Predicates first rule out chunks from
+// their index stats, then select records from the stored columns batch by batch, so a selective filter mostly
+// skips chunks and compares narrow integers. Scans with predicates of their own bypass the cache, whose rows may
+// lack the predicate columns.
+
+typedef struct {
+    ticks_file_t* handle;
+    uint64_t from_ms;
+    uint64_t to_ms;
+    uint32_t column_mask;
+    uint32_t read_mask;     // Projected and predicate columns
+    uint32_t stride;        // Values per row
+    ticks_predicate_t predicates[TICKS_MAX_PREDICATES + 1]; // The caller's predicates followed by the time range
+    uint32_t num_predicates;
+    uint64_t* batch;        // TICKS_SCAN_BATCH_ROWS rows
+    uint8_t* chunk_buffer;  // Raw bytes of the current chunk
+    size_t chunk_buffer_capacity;
+    ticks_batch_cb callback;
+    void* user;
+} scan_state_t;
+
+// Helper function to copy the rows in [from_ms, to_ms) to out_rows, which may be rows itself
+static uint32_t filter_rows(const uint64_t* rows, uint32_t num_rows, uint32_t stride, uint64_t from_ms, uint64_t to_ms,
+                            uint64_t* out_rows) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < num_rows; i++) {
+        const uint64_t* row = &rows[(size_t)i * stride];
+        if (row[0] < from_ms || row[0] >= to_ms)
+            continue;
+        uint64_t* out_row = &out_rows[(size_t)count++ * stride];
+        for (uint32_t c = 0; c < stride; c++)
+            out_row[c] = row[c];
+    }
+    return count;
+}
+
+// Helper function to pass the rows of a chunk held in the cache to the callback
+static ticks_status_e scan_cached_rows(scan_state_t* scan, const uint64_t* rows, uint32_t num_records, int whole_chunk) {
+    for (uint32_t first = 0; first < num_records; first += TICKS_SCAN_BATCH_ROWS) {
+        const uint32_t num_rows = num_records - first < TICKS_SCAN_BATCH_ROWS ? num_records - first : TICKS_SCAN_BATCH_ROWS;
+        const uint64_t* batch_rows = &rows[(size_t)first * scan->stride];
+        uint32_t count = num_rows;
+        if (!whole_chunk) {
+            count = filter_rows(batch_rows, num_rows, scan->stride, scan->from_ms, scan->to_ms, scan->batch);
+            batch_rows = scan->batch;
+        }
+        if (count == 0)
+            continue;
+        ticks_status_e status = scan->callback(batch_rows, count, scan->user);
+        if (status != TICKS_OK)
+            return status;
+    }
+    return TICKS_OK;
+}
+
+// Helper function to read a chunk and pass it to the callback one decoded batch at a time
+static ticks_status_e scan_decoded_rows(scan_state_t* scan, uint32_t chunk, const chunk_predicate_t* predicates, uint32_t num_predicates) {
+    ticks_file_t* handle = scan->handle;
+    ticks_status_e status = read_chunk(handle, chunk, scan->read_mask, &scan->chunk_buffer, &scan->chunk_buffer_capacity);
+    if (status != TICKS_OK)
+        return status;
+
+    chunk_decoder_t decoder;
+    status = chunk_decoder_init(&decoder, index_entry(handle, chunk), handle->header.schema.num_columns,
+                                scan->column_mask, predicates, num_predicates, scan->chunk_buffer, handle->metrics);
+    if (status != TICKS_OK)
+        return status;
+
+    for (;;) {
+        const uint64_t decode_start = monotonic_ns_portable();
+        uint32_t num_rows = 0;
+        status = chunk_decoder_next(&decoder, scan->batch, TICKS_SCAN_BATCH_ROWS, &num_rows);
+        if (status != TICKS_OK || num_rows == 0)
+            return status;
+        metrics_add(handle->metrics, METRIC_DECODE_NS, monotonic_ns_portable() - decode_start);
+        metrics_add(handle->metrics, METRIC_ROWS_DECODED, num_rows);
+
+        status = scan->callback(scan->batch, num_rows, scan->user);
+        if (status != TICKS_OK)
+            return status;
+    }
+}
+
+// Helper function to scan one chunk, from the cache when it holds the chunk
+static ticks_status_e scan_chunk(scan_state_t* scan, uint32_t chunk) {
+    TICKS_TRACE_SCOPE("scan_chunk");
+    ticks_file_t* handle = scan->handle;
+    const ticks_index_entry_t* entry = index_entry(handle, chunk);
+    const int whole_chunk = entry->chunk_time_base >= scan->from_ms && entry->chunk_max_time < scan->to_ms;
+
+    chunk_predicate_t predicates[TICKS_MAX_PREDICATES + 1];
+    uint32_t num_predicates = 0;
+    if (!chunk_predicates_rewrite(entry, &handle->header.schema, scan->predicates, scan->num_predicates, predicates, &num_predicates)) {
+        metrics_add(handle->metrics, METRIC_CHUNKS_SKIPPED, 1);
+        return TICKS_OK;
+    }
+
+    // With only the time range to apply, the cached rows hold every column needed
+    if (scan->num_predicates == 1 && handle->file_identity_valid && cache_enabled()) {
+        ticks_cache_key_t key;
+        key.file_device = handle->file_device;
+        key.file_inode = handle->file_inode;
+        key.chunk_offset = entry->chunk_offset;
+        key.chunk_checksum = entry->checksum;
+        key.column_mask = scan->column_mask;
+
+        ticks_cache_entry_t* cache_entry = cache_acquire(&key);
+        if (cache_entry != NULL) {
+            metrics_add(handle->metrics, METRIC_CACHE_HITS, 1);
+            uint32_t num_records = 0;
+            const uint64_t* rows = cache_entry_rows(cache_entry, &num_records);
+            ticks_status_e status = scan_cached_rows(scan, rows, num_records, whole_chunk);
+            cache_release(cache_entry);
+            return status;
+        }
+        metrics_add(handle->metrics, METRIC_CACHE_MISSES, 1);
+    }
+
+    return scan_decoded_rows(scan, chunk, predicates, num_predicates);
+}
+
+ticks_status_e ticks_scan(ticks_file_t* handle, time_t from, time_t to, ticks_batch_cb callback, void* user) {
+    return ticks_scan_ex(handle, from, to, NULL, callback, user);
+}
+
+ticks_status_e ticks_scan_ex(ticks_file_t* handle, time_t from, time_t to, const ticks_iterator_options_t* options,
+                             ticks_batch_cb callback, void* user) {
+    TICKS_TRACE_SCOPE("scan");
+    if (handle == NULL || callback == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    time_t now = time(NULL);
+    if (from >= to || from < 0 || to <= 0 || from > now || to > now)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    const ticks_predicate_t* predicates = options != NULL ? options->predicates : NULL;
+    const uint32_t num_predicates = options != NULL ? options->num_predicates : 0;
+    ticks_status_e status = schema_validate_predicates(&handle->header.schema, predicates, num_predicates);
+    if (status != TICKS_OK)
+        return status;
+
+    scan_state_t scan;
+    memset(&scan, 0, sizeof(scan));
+    scan.handle = handle;
+    scan.from_ms = (uint64_t)from * 1000;
+    scan.to_ms = (uint64_t)to * 1000;
+    scan.column_mask = schema_projection(&handle->header.schema, options != NULL ? options->column_mask : 0);
+    scan.read_mask = scan.column_mask | predicate_column_mask(predicates, num_predicates);
+    scan.stride = column_mask_count(scan.column_mask);
+    for (uint32_t i = 0; i < num_predicates; i++)
+        scan.predicates[scan.num_predicates++] = predicates[i];
+    scan.predicates[scan.num_predicates].column = 0;
+    scan.predicates[scan.num_predicates].min = scan.from_ms;
+    scan.predicates[scan.num_predicates++].max = scan.to_ms - 1;
+    scan.callback = callback;
+    scan.user = user;
+    // Cache-line aligned so each batch row starts at a predictable line offset
+    scan.batch = mem_aligned_alloc(&handle->allocator, 64, (size_t)TICKS_SCAN_BATCH_ROWS * scan.stride * sizeof(uint64_t));
+    if (scan.batch == NULL)
+        return TICKS_ERROR_MEMORY_ALLOCATION;
+
+    // Chunks are ordered by time base, nothing after a chunk starting at or past the range end can match
+    for (uint32_t chunk = find_chunk_for_time(handle, scan.from_ms);
+         chunk < handle->index.num_entries && index_entry(handle, chunk)->chunk_time_base < scan.to_ms && status == TICKS_OK;
+         chunk++) {
+        // Chunks ending before the range start are skipped without being read
+        if (index_entry(handle, chunk)->chunk_max_time < scan.from_ms)
+            continue;
+        status = scan_chunk(&scan, chunk);
+    }
+
+    mem_aligned_free(&handle->allocator, scan.batch);
+    mem_free(&handle->allocator, scan.chunk_buffer);
+    return status;
+}
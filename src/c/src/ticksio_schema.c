@@ -0,0 +1,118 @@
+#include "ticksio/ticksio_schema.h"
+
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_helpers.h"
+
+#include <string.h>
+
+// Helper function to fill in one column of a built-in schema
+static void set_column(ticks_schema_t* schema, const char* name, ticks_column_type_e type) {
+    ticks_column_t* column = &schema->columns[schema->num_columns++];
+    strncpy(column->name, name, TICKS_COLUMN_NAME_SIZE);
+    column->type = type;
+    column->encoding = TICKS_ENCODING_AUTO;
+    column->scale = type == TICKS_COLUMN_DECIMAL ? TICKS_DEFAULT_PRICE_SCALE : 0;
+}
+
+ticks_status_e ticks_schema_builtin(ticks_schema_kind_e kind, ticks_schema_t* out_schema) {
+    if (out_schema == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    memset(out_schema, 0, sizeof(ticks_schema_t));
+    switch (kind) {
+        case TICKS_SCHEMA_TRADES:
+            set_column(out_schema, "ms_since_epoch", TICKS_COLUMN_TIMESTAMP);
+            set_column(out_schema, "price", TICKS_COLUMN_DECIMAL);
+            set_column(out_schema, "volume", TICKS_COLUMN_UINT);
+            return TICKS_OK;
+        case TICKS_SCHEMA_QUOTES:
+            set_column(out_schema, "ms_since_epoch", TICKS_COLUMN_TIMESTAMP);
+            set_column(out_schema, "bid", TICKS_COLUMN_DECIMAL);
+            set_column(out_schema, "ask", TICKS_COLUMN_DECIMAL);
+            set_column(out_schema, "bid_size", TICKS_COLUMN_UINT);
+            set_column(out_schema, "ask_size", TICKS_COLUMN_UINT);
+            set_column(out_schema, "flags", TICKS_COLUMN_FLAGS);
+            return TICKS_OK;
+        default:
+            return TICKS_ERROR_INVALID_ARGUMENTS;
+    }
+}
+
+ticks_status_e ticks_decimal_to_double(const uint64_t* values, uint32_t stride, uint64_t num_values, uint8_t scale,
+                                       double* out_values) {
+    if ((values == NULL || out_values == NULL) && num_values != 0)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+    if (stride == 0 || scale > TICKS_MAX_DECIMAL_SCALE)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    // Values below 2^53 and the powers of ten convert exactly, so the division rounds once and 29 at scale 2
+    // gives the double nearest 0.29. Multiplying by a reciprocal would round twice.
+    const double divisor = (double)pow10_uint64(scale);
+    for (uint64_t i = 0; i < num_values; i++)
+        out_values[i] = (double)values[i * stride] / divisor;
+    return TICKS_OK;
+}
+
+ticks_status_e schema_validate(const ticks_schema_t* schema) {
+    if (schema->num_columns == 0 || schema->num_columns > TICKS_MAX_COLUMNS)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    for (uint8_t i = 0; i < schema->num_columns; i++) {
+        const ticks_column_t* column = &schema->columns[i];
+        if ((column->type == TICKS_COLUMN_TIMESTAMP) != (i == 0))
+            return TICKS_ERROR_INVALID_ARGUMENTS;
+        if (column->type < TICKS_COLUMN_TIMESTAMP || column->type > TICKS_COLUMN_DECIMAL)
+            return TICKS_ERROR_INVALID_ARGUMENTS;
+        if (column->type == TICKS_COLUMN_DECIMAL ? column->scale > TICKS_MAX_DECIMAL_SCALE : column->scale != 0)
+            return TICKS_ERROR_INVALID_ARGUMENTS;
+        if (column->encoding > TICKS_ENCODING_PLAIN)
+            return TICKS_ERROR_INVALID_ARGUMENTS;
+    }
+
+    return TICKS_OK;
+}
+
+ticks_status_e schema_validate_predicates(const ticks_schema_t* schema, const ticks_predicate_t* predicates, uint32_t num_predicates) {
+    if (num_predicates > TICKS_MAX_PREDICATES || (predicates == NULL && num_predicates != 0))
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    for (uint32_t i = 0; i < num_predicates; i++) {
+        const ticks_predicate_t* predicate = &predicates[i];
+        if (predicate->column >= schema->num_columns)
+            return TICKS_ERROR_INVALID_ARGUMENTS;
+        const int empty = schema->columns[predicate->column].type == TICKS_COLUMN_INT ?
+                          (int64_t)predicate->max < (int64_t)predicate->min : predicate->max < predicate->min;
+        if (empty)
+            return TICKS_ERROR_INVALID_ARGUMENTS;
+    }
+
+    return TICKS_OK;
+}
+
+uint32_t predicate_column_mask(const ticks_predicate_t* predicates, uint32_t num_predicates) {
+    uint32_t column_mask = 0;
+    for (uint32_t i = 0; i < num_predicates; i++)
+        column_mask |= 1u << predicates[i].column;
+    return column_mask;
+}
+
+int schema_has_trade_layout(const ticks_schema_t* schema) {
+    return schema->num_columns == sizeof(trade_data_t) / sizeof(uint64_t);
+}
+
+uint32_t schema_all_columns(const ticks_schema_t* schema) {
+    return (1u << schema->num_columns) - 1;
+}
+
+uint32_t schema_projection(const ticks_schema_t* schema, uint32_t column_mask) {
+    if (column_mask == 0)
+        return schema_all_columns(schema);
+    return (column_mask & schema_all_columns(schema)) | 1u;
+}
+
+uint32_t column_mask_count(uint32_t column_mask) {
+    uint32_t count = 0;
+    for (; column_mask != 0; column_mask &= column_mask - 1)
+        count++;
+    return count;
+}
@@ -0,0 +1,150 @@
+#include "ticksio/ticksio_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ticksio/ticksio.h"
+#include "ticksio/ticksio_platform.h"
+
+#if defined(TICKSIO_TRACE) && defined(__GNUC__)
+
+#define TICKS_TRACE_RING_SIZE 65536 // Events kept per thread, older events are overwritten
+
+typedef struct {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+} trace_event_t;
+
+typedef struct trace_ring_t {
+    uint32_t thread_id;
+    uint64_t num_written; // Total events written, the ring holds the last TICKS_TRACE_RING_SIZE
+    struct trace_ring_t* next;
+    struct trace_ring_t* next_free; // Next ring of an exited thread, waiting to be reused
+    trace_event_t events[TICKS_TRACE_RING_SIZE];
+} trace_ring_t;
+
+// Rings outlive their threads so events from finished workers can still be dumped. A thread's ring is reused by
+// the next thread that starts tracing after it exited, so the rings are bounded by the most threads alive at once.
+static mutex_portable trace_registry_mutex = MUTEX_INIT_PORTABLE;
+static trace_ring_t* trace_registry = NULL;
+static trace_ring_t* trace_free_rings = NULL;
+static uint32_t trace_next_thread_id = 0;
+static once_flag_portable trace_key_once = ONCE_FLAG_INIT_PORTABLE;
+static thread_key_portable trace_ring_key;
+static int trace_key_valid = 0;
+static THREAD_LOCAL_PORTABLE trace_ring_t* trace_thread_ring = NULL;
+
+// Helper function to hand the ring of an exiting thread to the next thread that traces
+static void trace_release_ring(void* value) {
+    trace_ring_t* ring = value;
+    mutex_lock_portable(&trace_registry_mutex);
+    ring->next_free = trace_free_rings;
+    trace_free_rings = ring;
+    mutex_unlock_portable(&trace_registry_mutex);
+}
+
+static void trace_key_init(void) {
+    trace_key_valid = thread_key_create_portable(&trace_ring_key, trace_release_ring) == 0;
+}
+
+static trace_ring_t* trace_get_ring(void) {
+    if (trace_thread_ring != NULL)
+        return trace_thread_ring;
+    call_once_portable(&trace_key_once, trace_key_init);
+
+    // The registry lock is only taken once per thread, a reused ring keeps its place in the registry
+    mutex_lock_portable(&trace_registry_mutex);
+    trace_ring_t* ring = trace_free_rings;
+    if (ring != NULL) {
+        trace_free_rings = ring->next_free;
+        ring->num_written = 0;
+    }
+    else {
+        ring = calloc(1, sizeof(trace_ring_t));
+        if (ring != NULL) {
+            ring->next = trace_registry;
+            trace_registry = ring;
+        }
+    }
+    if (ring != NULL)
+        ring->thread_id = ++trace_next_thread_id;
+    mutex_unlock_portable(&trace_registry_mutex);
+    if (ring == NULL)
+        return NULL;
+
+    // Without the key the ring is kept for good, as the thread's exit cannot be seen
+    if (trace_key_valid)
+        thread_key_set_portable(trace_ring_key, ring);
+    trace_thread_ring = ring;
+    return ring;
+}
+
+ticks_trace_scope_t trace_scope_begin(const char* name) {
+    ticks_trace_scope_t scope = { name, monotonic_ns_portable() };
+    return scope;
+}
+
+void trace_scope_end(ticks_trace_scope_t* scope) {
+    const uint64_t end_ns = monotonic_ns_portable();
+    trace_ring_t* ring = trace_get_ring();
+    if (ring == NULL)
+        return;
+
+    trace_event_t* event = &ring->events[ring->num_written % TICKS_TRACE_RING_SIZE];
+    event->name = scope->name;
+    event->start_ns = scope->start_ns;
+    event->duration_ns = end_ns - scope->start_ns;
+    ring->num_written++;
+}
+
+ticks_status_e ticks_trace_dump(const char* filename) {
+    if (filename == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    FILE* file = fopen(filename, "w");
+    if (file == NULL)
+        return TICKS_ERROR_FILE_IO;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    int first = 1;
+    mutex_lock_portable(&trace_registry_mutex);
+    for (trace_ring_t* ring = trace_registry; ring != NULL; ring = ring->next) {
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"ticksio-%u\"}}",
+                first ? "" : ",", ring->thread_id, ring->thread_id);
+        first = 0;
+
+        const uint64_t num_written = ring->num_written;
+        const uint64_t begin = num_written > TICKS_TRACE_RING_SIZE ? num_written - TICKS_TRACE_RING_SIZE : 0;
+        for (uint64_t i = begin; i < num_written; i++) {
+            const trace_event_t* event = &ring->events[i % TICKS_TRACE_RING_SIZE];
+            // Trace event timestamps are in microseconds
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"ticksio\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    event->name, ring->thread_id, event->start_ns / 1000.0, event->duration_ns / 1000.0);
+        }
+    }
+    mutex_unlock_portable(&trace_registry_mutex);
+
+    fprintf(file, "\n]}\n");
+
+    return fclose(file) == 0 ? TICKS_OK : TICKS_ERROR_FILE_IO;
+}
+
+#else
+
+ticks_status_e ticks_trace_dump(const char* filename) {
+    if (filename == NULL)
+        return TICKS_ERROR_INVALID_ARGUMENTS;
+
+    // Tracing is compiled out, write a valid but empty trace
+    FILE* file = fopen(filename, "w");
+    if (file == NULL)
+        return TICKS_ERROR_FILE_IO;
+
+    fprintf(file, "{\"traceEvents\":[]}\n");
+
+    return fclose(file) == 0 ? TICKS_OK : TICKS_ERROR_FILE_IO;
+}
+
+#endif
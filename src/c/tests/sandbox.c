@@ -111,7 +111,7 @@ int main() {
         if (index_size == 0)
             printf("└── Index Size: %llu\n", (unsigned long long)index_size);
         else
-            printf("├── Index Size: %llu (%llu Entries)\n", (unsigned long long)index_size , (unsigned long long)(index_size / sizeof(ticks_index_entry_t)));
+            printf("├── Index Size: %llu (%llu Entries)\n", (unsigned long long)index_size , (unsigned long long)read_handle->index.num_entries);
     else
         print_error("ticks_get_index_size", get_index_size_status);
 
@@ -120,9 +120,10 @@ int main() {
         printf("    ├── Time Base: %llu\n", (unsigned long long)read_handle->index.entries[0].chunk_time_base);
         printf("    ├── Offset: %llu\n", (unsigned long long)read_handle->index.entries[0].chunk_offset);
         printf("    ├── Size: %u\n", read_handle->index.entries[0].chunk_size);
-        printf("    ├── Timestamp Size: %u\n", read_handle->index.entries[0].timestamp_size);
-        printf("    ├── Price Size: %u\n", read_handle->index.entries[0].price_size);
-        printf("    └── Volume Size: %u\n", read_handle->index.entries[0].volume_size);
+        printf("    ├── Records: %u\n", read_handle->index.entries[0].num_records);
+        printf("    ├── Timestamp Size: %u\n", read_handle->index.entries[0].columns[0].width);
+        printf("    ├── Price Size: %u\n", read_handle->index.entries[0].columns[1].width);
+        printf("    └── Volume Size: %u\n", read_handle->index.entries[0].columns[2].width);
     }
 
     ticks_status_e read_close_status = ticks_close(read_handle);
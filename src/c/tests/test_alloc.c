@@ -0,0 +1,261 @@
+#include "test_util.h"
+#include "ticksio/ticksio_constants.h"
+#include "ticksio/ticksio_platform.h"
+
+#include <stdint.h>
+
+#define NUM_ROWS 50000
+#define LATER_ROWS 2000
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+static uint64_t later_rows[LATER_ROWS * 3];
+
+// Each block is preceded by a header naming the allocator and call that made it, so a block freed by another
+// allocator or through the wrong call is caught
+typedef struct {
+    const void* owner;
+    void* base;
+    uint64_t aligned;
+    uint64_t padding;
+} counted_block_t;
+
+typedef struct {
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t live;
+    uint64_t wrong_frees;
+} counting_t;
+
+static counted_block_t* counted_header(void* ptr) {
+    return (counted_block_t*)((uint8_t*)ptr - sizeof(counted_block_t));
+}
+
+static void* counting_alloc(size_t size, void* user) {
+    counting_t* counting = user;
+    counted_block_t* block = malloc(sizeof(counted_block_t) + size);
+    if (block == NULL)
+        return NULL;
+    block->owner = counting;
+    block->base = block;
+    block->aligned = 0;
+    counting->allocs++;
+    counting->live++;
+    return block + 1;
+}
+
+static void counting_free(void* ptr, void* user) {
+    counting_t* counting = user;
+    if (ptr == NULL)
+        return;
+    counted_block_t* block = counted_header(ptr);
+    if (block->owner != counting || block->aligned) {
+        counting->wrong_frees++;
+        return;
+    }
+    block->owner = NULL;
+    counting->frees++;
+    counting->live--;
+    free(block->base);
+}
+
+static void* counting_realloc(void* ptr, size_t size, void* user) {
+    counting_t* counting = user;
+    if (ptr == NULL)
+        return counting_alloc(size, user);
+    counted_block_t* block = counted_header(ptr);
+    if (block->owner != counting || block->aligned) {
+        counting->wrong_frees++;
+        return NULL;
+    }
+    counted_block_t* resized = realloc(block, sizeof(counted_block_t) + size);
+    if (resized == NULL)
+        return NULL;
+    resized->base = resized;
+    return resized + 1;
+}
+
+static void* counting_aligned_alloc(size_t alignment, size_t size, void* user) {
+    counting_t* counting = user;
+    const size_t offset = alignment > sizeof(counted_block_t) ? alignment : sizeof(counted_block_t);
+    uint8_t* base = aligned_alloc_portable(alignment, offset + size);
+    if (base == NULL)
+        return NULL;
+    uint8_t* ptr = base + offset;
+    counted_block_t* block = counted_header(ptr);
+    block->owner = counting;
+    block->base = base;
+    block->aligned = 1;
+    counting->allocs++;
+    counting->live++;
+    return ptr;
+}
+
+static void counting_aligned_free(void* ptr, void* user) {
+    counting_t* counting = user;
+    if (ptr == NULL)
+        return;
+    counted_block_t* block = counted_header(ptr);
+    if (block->owner != counting || !block->aligned) {
+        counting->wrong_frees++;
+        return;
+    }
+    block->owner = NULL;
+    counting->frees++;
+    counting->live--;
+    aligned_free_portable(block->base);
+}
+
+static ticks_allocator_t counting_allocator(counting_t* counting) {
+    memset(counting, 0, sizeof(counting_t));
+    ticks_allocator_t allocator = {counting_alloc, counting_realloc, counting_free, counting_aligned_alloc,
+                                   counting_aligned_free, counting};
+    return allocator;
+}
+
+// Helper function to write, read, scan through the cache and compact a file with the current allocators
+static void exercise(const char* path, const char* compact_path) {
+    test_write_file(path, rows, NUM_ROWS, 1000);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_write(path, &handle));
+    CHECK_OK(ticks_add_records(handle, rows, 10));
+    CHECK_OK(ticks_close(handle));
+
+    CHECK_OK(ticks_cache_set_budget(1u << 20));
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS + 10);
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS + 10);
+    CHECK_OK(ticks_close(handle));
+    CHECK_OK(ticks_cache_set_budget(0));
+
+    ticks_compact_policy_t policy;
+    memset(&policy, 0, sizeof(policy));
+    policy.num_threads = 2;
+    policy.range_rows = 10000;
+    CHECK_OK(ticks_compact(path, compact_path, &policy));
+}
+
+// Whole hugepage mappings start on a hugepage boundary, the block header sits before the returned pointer
+static int is_mapped(const void* ptr) {
+    return (uintptr_t)ptr % TICKS_HUGEPAGE_SIZE != 0 && (uintptr_t)ptr % TICKS_HUGEPAGE_SIZE <= 64;
+}
+
+static void fill(uint8_t* ptr, size_t size, uint8_t seed) {
+    for (size_t i = 0; i < size; i++)
+        ptr[i] = (uint8_t)(i * 31 + seed);
+}
+
+static int filled(const uint8_t* ptr, size_t size, uint8_t seed) {
+    for (size_t i = 0; i < size; i++) {
+        if (ptr[i] != (uint8_t)(i * 31 + seed))
+            return 0;
+    }
+    return 1;
+}
+
+int main(void) {
+    const char* path = "test_alloc.ticks";
+    const char* compact_path = "test_alloc_compact.ticks";
+
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i;
+        rows[i * 3 + 1] = 10000 + i % 977;
+        rows[i * 3 + 2] = i % 13;
+    }
+    // Appended after the file's last row, so the reorder window passes every one of them on
+    for (uint64_t i = 0; i < LATER_ROWS; i++) {
+        later_rows[i * 3] = BASE_MS + NUM_ROWS + i;
+        later_rows[i * 3 + 1] = 10000 + i % 977;
+        later_rows[i * 3 + 2] = i % 13;
+    }
+
+    printf("--- Every block from the process-wide allocator is freed ---\n");
+    counting_t global;
+    ticks_allocator_t allocator = counting_allocator(&global);
+    CHECK_OK(ticks_set_allocator(NULL, &allocator));
+    exercise(path, compact_path);
+    CHECK(global.allocs > 0);
+    CHECK(global.live == 0 && global.frees == global.allocs);
+    CHECK(global.wrong_frees == 0);
+
+    printf("--- A live handle's buffers move to its own allocator ---\n");
+    counting_t own;
+    ticks_allocator_t own_allocator = counting_allocator(&own);
+    ticks_file_t* handle = NULL;
+    ticks_reorder_options_t reorder = {.window_ms = 0, .window_rows = 64};
+    CHECK_OK(ticks_open_write(path, &handle));
+    CHECK_OK(ticks_set_reorder_window(handle, &reorder));
+    CHECK_OK(ticks_add_records(handle, later_rows, LATER_ROWS / 2));
+    const uint64_t global_live = global.live;
+    CHECK_OK(ticks_set_allocator(handle, &own_allocator));
+    // The index, metrics and reorder buffers left the process-wide allocator, only the handle itself stays there
+    CHECK(global.live < global_live);
+    CHECK(own.live > 0);
+    CHECK_OK(ticks_add_records(handle, &later_rows[LATER_ROWS / 2 * 3], LATER_ROWS / 2));
+    CHECK_OK(ticks_close(handle));
+    CHECK(own.live == 0 && own.frees == own.allocs);
+    CHECK(global.live == 0);
+
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK_OK(ticks_set_allocator(handle, &own_allocator));
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS + 10 + LATER_ROWS);
+    CHECK_OK(ticks_close(handle));
+    CHECK(own.live == 0 && own.wrong_frees == 0);
+    CHECK(global.live == 0 && global.wrong_frees == 0);
+    CHECK_OK(ticks_set_allocator(NULL, NULL));
+
+    printf("--- Hugepage blocks round trip ---\n");
+    ticks_allocator_t huge;
+    CHECK_OK(ticks_allocator_hugepage(&huge));
+    const size_t big_size = TICKS_HUGEPAGE_SIZE + 4096;
+    uint8_t* big = huge.alloc(big_size, huge.user);
+    CHECK(big != NULL);
+    const int mapped = is_mapped(big);
+    fill(big, big_size, 1);
+    // Shrinking a mapping and growing it again within its hugepages keeps the block in place
+    uint8_t* resized = huge.realloc(big, 4096, huge.user);
+    CHECK(resized != NULL && filled(resized, 4096, 1));
+    CHECK(!mapped || resized == big);
+    big = huge.realloc(resized, big_size + 8192, huge.user);
+    CHECK(big != NULL && filled(big, 4096, 1));
+    CHECK(!mapped || big == resized);
+    fill(big, big_size + 8192, 2);
+    // Growing past the mapping copies to a larger one
+    resized = huge.realloc(big, 3 * (size_t)TICKS_HUGEPAGE_SIZE, huge.user);
+    CHECK(resized != NULL && filled(resized, big_size + 8192, 2));
+    fill(resized, 3 * (size_t)TICKS_HUGEPAGE_SIZE, 3);
+    huge.free(resized, huge.user);
+
+    // Small blocks come from malloc, shrinking one by more than half moves it
+    uint8_t* small = huge.alloc(1000, huge.user);
+    CHECK(small != NULL && !is_mapped(small));
+    fill(small, 1000, 4);
+    small = huge.realloc(small, 900, huge.user);
+    CHECK(small != NULL && filled(small, 900, 4));
+    small = huge.realloc(small, 100, huge.user);
+    CHECK(small != NULL && filled(small, 100, 4));
+    small = huge.realloc(small, 50000, huge.user);
+    CHECK(small != NULL && filled(small, 100, 4));
+    huge.free(small, huge.user);
+    small = huge.realloc(NULL, 64, huge.user);
+    CHECK(small != NULL);
+    huge.free(small, huge.user);
+
+    uint8_t* aligned = huge.aligned_alloc(4096, TICKS_HUGEPAGE_SIZE, huge.user);
+    CHECK(aligned != NULL && (uintptr_t)aligned % 4096 == 0);
+    fill(aligned, TICKS_HUGEPAGE_SIZE, 5);
+    huge.aligned_free(aligned, huge.user);
+
+    printf("--- Files read and written through hugepage buffers ---\n");
+    CHECK_OK(ticks_set_allocator(NULL, &huge));
+    exercise(path, compact_path);
+    CHECK_OK(ticks_open_read(compact_path, &handle));
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS + 10);
+    CHECK_OK(ticks_close(handle));
+    CHECK_OK(ticks_set_allocator(NULL, NULL));
+
+    remove(path);
+    remove(compact_path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+
+#define NUM_ROWS 300000
+#define SESSION_ROWS 100000
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+
+static uint64_t file_size(const char* path) {
+    FILE* file = fopen(path, "rb");
+    CHECK(file != NULL);
+    CHECK(fseek(file, 0, SEEK_END) == 0);
+    const long size = ftell(file);
+    fclose(file);
+    return (uint64_t)size;
+}
+
+// Helper function to copy the bytes a file holds right now, as a crash would leave them
+static void copy_file(const char* from, const char* to) {
+    FILE* in = fopen(from, "rb");
+    FILE* out = fopen(to, "wb");
+    CHECK(in != NULL && out != NULL);
+    uint8_t buffer[65536];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        CHECK(fwrite(buffer, 1, length, out) == length);
+    fclose(in);
+    fclose(out);
+}
+
+// Helper function to reopen a file and append rows to it
+static void append_rows(const char* path, const uint64_t* data, uint64_t num_rows) {
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_write(path, &handle));
+    CHECK_OK(ticks_add_records(handle, data, num_rows));
+    CHECK_OK(ticks_close(handle));
+}
+
+int main(void) {
+    const char* whole_path = "test_append_whole.ticks";
+    const char* path = "test_append.ticks";
+    const char* copy_path = "test_append_copy.ticks";
+
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i;
+        rows[i * 3 + 1] = 10000 + i % 977;
+        rows[i * 3 + 2] = i % 13;
+    }
+
+    printf("--- Reopening appends after the old footer ---\n");
+    ticks_header_t header;
+    test_header(&header, 10000);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(whole_path, &header, &handle));
+    for (uint64_t i = 0; i < NUM_ROWS; i += SESSION_ROWS)
+        CHECK_OK(ticks_add_records(handle, &rows[i * 3], SESSION_ROWS));
+    CHECK_OK(ticks_close(handle));
+
+    test_write_file(path, rows, SESSION_ROWS, 10000);
+    for (uint64_t i = SESSION_ROWS; i < NUM_ROWS; i += SESSION_ROWS) {
+        append_rows(path, &rows[i * 3], SESSION_ROWS);
+        printf("%llu rows: %llu bytes\n", (unsigned long long)(i + SESSION_ROWS), (unsigned long long)file_size(path));
+    }
+    // Each reopen leaves the index it found behind, compaction drops them again
+    CHECK(file_size(path) > file_size(whole_path));
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(handle->header.flags & TICKS_HEADER_CHECKPOINTS);
+    CHECK(handle->index.num_entries == NUM_ROWS / 10000);
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS);
+    CHECK_OK(ticks_close(handle));
+    CHECK_OK(ticks_compact(path, copy_path, NULL));
+    CHECK(file_size(copy_path) < file_size(whole_path) + TICKS_INDEX_ALIGNMENT);
+    CHECK_OK(ticks_open_read(copy_path, &handle));
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS);
+    CHECK_OK(ticks_close(handle));
+
+    printf("--- Reopening without appending keeps the file ---\n");
+    const uint64_t size = file_size(path);
+    CHECK_OK(ticks_open_write(path, &handle));
+    CHECK_OK(ticks_close(handle));
+    CHECK(file_size(path) == size);
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS);
+    CHECK_OK(ticks_close(handle));
+
+    printf("--- A writer dying after reopening leaves the rows it found ---\n");
+    test_write_file(path, rows, SESSION_ROWS, 10000);
+    CHECK_OK(ticks_open_write(path, &handle));
+    CHECK_OK(ticks_add_records(handle, &rows[SESSION_ROWS * 3], SESSION_ROWS));
+    copy_file(path, copy_path);
+    CHECK_OK(ticks_close(handle));
+    ticks_file_t* reader = NULL;
+    CHECK_OK(ticks_open_read(copy_path, &reader));
+    CHECK(test_count_range(reader, 1600000000, 1600001000) == SESSION_ROWS);
+    CHECK_OK(ticks_close(reader));
+    // Reopening the crashed file cuts off the chunks written after the footer it recovered
+    append_rows(copy_path, &rows[SESSION_ROWS * 3], SESSION_ROWS);
+    CHECK_OK(ticks_open_read(copy_path, &reader));
+    CHECK(test_count_range(reader, 1600000000, 1600001000) == 2 * SESSION_ROWS);
+    CHECK_OK(ticks_close(reader));
+
+    printf("--- A torn tail is cut off ---\n");
+    // Only files that were checkpointed are searched for an earlier footer
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    ticks_write_options_t write_options;
+    memset(&write_options, 0, sizeof(write_options));
+    write_options.durability = TICKS_DURABILITY_STRICT;
+    CHECK_OK(ticks_set_write_options(handle, &write_options));
+    CHECK_OK(ticks_add_records(handle, rows, SESSION_ROWS));
+    CHECK_OK(ticks_close(handle));
+    const uint64_t clean_size = file_size(path);
+    FILE* file = fopen(path, "ab");
+    CHECK(file != NULL);
+    static const uint8_t garbage[4096] = {1};
+    CHECK(fwrite(garbage, 1, sizeof(garbage), file) == sizeof(garbage));
+    fclose(file);
+    append_rows(path, &rows[SESSION_ROWS * 3], 10);
+    CHECK(file_size(path) < clean_size + 1024);
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == SESSION_ROWS + 10);
+    CHECK_OK(ticks_close(handle));
+
+    printf("--- Mapped readers keep their index and pick up the new one ---\n");
+    test_write_file(path, rows, SESSION_ROWS, 10000);
+    ticks_open_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.index_mode = TICKS_INDEX_MMAP;
+    ticks_file_t* mapped = NULL;
+    CHECK_OK(ticks_open_read_ex(path, &options, &mapped));
+    append_rows(path, &rows[SESSION_ROWS * 3], SESSION_ROWS);
+    // No block of the mapped index was decoded before the append, the mapped bytes must still be the old index
+    CHECK(test_count_range(mapped, 1600000000, 1600001000) == SESSION_ROWS);
+    uint32_t new_chunks = 0;
+    CHECK_OK(ticks_refresh(mapped, &new_chunks));
+    CHECK(new_chunks == SESSION_ROWS / 10000);
+    CHECK(test_count_range(mapped, 1600000000, 1600001000) == 2 * SESSION_ROWS);
+    CHECK_OK(ticks_close(mapped));
+
+    remove(path);
+    remove(copy_path);
+    remove(whole_path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
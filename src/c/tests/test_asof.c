@@ -0,0 +1,202 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+
+#define NUM_ROWS 300000
+#define CHUNK_ROWS 1000
+#define MAX_QUERIES 100000
+#define BASE_MS 1600000000000ULL
+
+static trade_data_t trades[NUM_ROWS];
+static uint64_t queries[MAX_QUERIES];
+static trade_data_t answers[MAX_QUERIES], expected[MAX_QUERIES];
+static uint8_t found[MAX_QUERIES], expected_found[MAX_QUERIES];
+
+// Helper function to answer sorted queries over sorted trades by binary search, the last trade wins on equal timestamps
+static void expected_asof(const trade_data_t* rows, uint64_t num_rows, const uint64_t* query_ts, uint64_t num_queries) {
+    for (uint64_t i = 0; i < num_queries; i++) {
+        uint64_t low = 0;
+        uint64_t high = num_rows;
+        while (low < high) {
+            const uint64_t middle = (low + high) / 2;
+            if (rows[middle].ms_since_epoch <= query_ts[i])
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        expected_found[i] = low > 0;
+        if (low > 0)
+            expected[i] = rows[low - 1];
+        else
+            memset(&expected[i], 0, sizeof(expected[i]));
+    }
+}
+
+static void check_answers(uint64_t num_queries) {
+    for (uint64_t i = 0; i < num_queries; i++) {
+        CHECK(found[i] == expected_found[i]);
+        CHECK(memcmp(&answers[i], &expected[i], sizeof(trade_data_t)) == 0);
+    }
+}
+
+// Orders trades by timestamp, then by price, which the tests set to the position the trade was written at
+static int compare_trades(const void* a, const void* b) {
+    const trade_data_t* left = a;
+    const trade_data_t* right = b;
+    if (left->ms_since_epoch != right->ms_since_epoch)
+        return left->ms_since_epoch < right->ms_since_epoch ? -1 : 1;
+    return left->price < right->price ? -1 : left->price > right->price;
+}
+
+static void write_trades(const char* path, trade_data_t* rows, uint64_t num_rows, uint32_t max_chunk_rows) {
+    ticks_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.chunk_policy.max_chunk_rows = max_chunk_rows;
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    CHECK_OK(ticks_add_data(handle, rows, num_rows));
+    CHECK_OK(ticks_close(handle));
+}
+
+int main(void) {
+    const char* path = "test_asof.ticks";
+
+    // Runs of equal timestamps cross chunk boundaries
+    uint64_t ts = BASE_MS;
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        if (i % 3 == 0)
+            ts += 1 + (i % 7 == 0 ? 50 : 0);
+        trades[i].ms_since_epoch = ts;
+        trades[i].price = 100000 + i;
+        trades[i].volume = i;
+    }
+    write_trades(path, trades, NUM_ROWS, CHUNK_ROWS);
+    const uint64_t low = trades[0].ms_since_epoch - 100;
+    const uint64_t high = trades[NUM_ROWS - 1].ms_since_epoch + 100;
+
+    printf("--- Dense, sparse and repeated queries ---\n");
+    for (int mode = 0; mode < 4; mode++) {
+        ticks_cache_set_budget(mode & 1 ? 1 << 26 : 0);
+        ticks_open_options_t options;
+        memset(&options, 0, sizeof(options));
+        options.index_mode = mode & 2 ? TICKS_INDEX_MMAP : TICKS_INDEX_LOAD;
+        ticks_file_t* handle = NULL;
+        CHECK_OK(ticks_open_read_ex(path, &options, &handle));
+
+        uint64_t num_queries = 0;
+        for (uint64_t query = low; query <= high && num_queries < MAX_QUERIES; query += (high - low) / (MAX_QUERIES - 1000) + 1)
+            queries[num_queries++] = query;
+        expected_asof(trades, NUM_ROWS, queries, num_queries);
+        CHECK_OK(ticks_asof(handle, queries, num_queries, answers, found));
+        check_answers(num_queries);
+
+        num_queries = 0;
+        for (uint64_t query = low; query <= high; query += (high - low) / 37) {
+            queries[num_queries++] = query;
+            queries[num_queries++] = query;
+        }
+        queries[num_queries++] = high + 1000000;
+        expected_asof(trades, NUM_ROWS, queries, num_queries);
+        CHECK_OK(ticks_asof(handle, queries, num_queries, answers, found));
+        check_answers(num_queries);
+
+        for (uint64_t i = 0; i < NUM_ROWS; i += 997) {
+            queries[0] = trades[i].ms_since_epoch - 1;
+            queries[1] = trades[i].ms_since_epoch;
+            expected_asof(trades, NUM_ROWS, queries, 2);
+            CHECK_OK(ticks_asof(handle, queries, 2, answers, found));
+            check_answers(2);
+        }
+
+        queries[0] = 5;
+        queries[1] = 4;
+        CHECK(ticks_asof(handle, queries, 2, answers, found) == TICKS_ERROR_INVALID_ARGUMENTS);
+        CHECK_OK(ticks_asof(handle, queries, 0, NULL, NULL));
+        CHECK_OK(ticks_close(handle));
+    }
+    ticks_cache_set_budget(0);
+
+    printf("--- Each chunk is decoded at most once ---\n");
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    uint64_t num_queries = 0;
+    for (uint64_t query = low; query <= high && num_queries < MAX_QUERIES; query += 3)
+        queries[num_queries++] = query;
+    ticks_metrics_t before, after;
+    CHECK_OK(ticks_get_metrics(handle, &before));
+    CHECK_OK(ticks_asof(handle, queries, num_queries, answers, found));
+    CHECK_OK(ticks_get_metrics(handle, &after));
+    CHECK(after.rows_decoded - before.rows_decoded <= NUM_ROWS);
+    CHECK_OK(ticks_close(handle));
+
+    printf("--- Out-of-order ticks within chunks ---\n");
+    static trade_data_t unsorted[20000];
+    const uint32_t unsorted_chunk_rows = 500;
+    for (uint64_t i = 0; i < 20000; i++) {
+        unsorted[i].ms_since_epoch = BASE_MS + i * 10 + ((i * 7919) % 13) * 3 - (i % 5 == 0 ? 25 : 0);
+        unsorted[i].price = i;
+        unsorted[i].volume = i % 11;
+    }
+    // Equal timestamps out of order too
+    for (uint64_t i = 0; i < 20000; i += 50)
+        unsorted[i].ms_since_epoch = unsorted[i + 1].ms_since_epoch;
+    write_trades(path, unsorted, 20000, unsorted_chunk_rows);
+    CHECK_OK(ticks_open_read(path, &handle));
+    num_queries = 0;
+    for (uint64_t query = BASE_MS - 100; query < BASE_MS + 200100; query += 7)
+        queries[num_queries++] = query;
+    // Chunks overlap their neighbours, the answer is the latest tick of any chunk, the one written last on ties
+    static trade_data_t sorted[20000];
+    memcpy(sorted, unsorted, sizeof(sorted));
+    qsort(sorted, 20000, sizeof(trade_data_t), compare_trades);
+    expected_asof(sorted, 20000, queries, num_queries);
+    CHECK_OK(ticks_asof(handle, queries, num_queries, answers, found));
+    check_answers(num_queries);
+    CHECK_OK(ticks_close(handle));
+
+    printf("--- Earlier chunks holding later ticks ---\n");
+    // Chunk A spans {100, 500} and chunk B {200, 250}, A's 500 answers queries after B's ticks
+    static trade_data_t overlapping[] = {{100, 0, 1}, {500, 1, 1}, {200, 2, 1}, {250, 3, 1}, {300, 4, 1}, {500, 5, 1},
+                                         {600, 6, 1}, {700, 7, 1}};
+    const uint64_t num_overlapping = sizeof(overlapping) / sizeof(overlapping[0]);
+    for (int mode = 0; mode < 2; mode++) {
+        write_trades(path, overlapping, mode == 0 ? 4 : num_overlapping, 2);
+        CHECK_OK(ticks_open_read(path, &handle));
+        num_queries = 0;
+        for (uint64_t query = 0; query <= 800; query += 25)
+            queries[num_queries++] = query;
+        memcpy(sorted, overlapping, sizeof(overlapping));
+        qsort(sorted, mode == 0 ? 4 : num_overlapping, sizeof(trade_data_t), compare_trades);
+        expected_asof(sorted, mode == 0 ? 4 : num_overlapping, queries, num_queries);
+        CHECK_OK(ticks_asof(handle, queries, num_queries, answers, found));
+        check_answers(num_queries);
+        // A single query, as well as among the others
+        const uint64_t after_b = 600;
+        CHECK_OK(ticks_asof(handle, &after_b, 1, answers, found));
+        CHECK(found[0] && answers[0].ms_since_epoch == (mode == 0 ? 500 : 600));
+        CHECK(mode == 0 ? answers[0].price == 1 : answers[0].price == 6);
+        // The second chunk's 500 was written after the first chunk's
+        const uint64_t tie = 550;
+        CHECK_OK(ticks_asof(handle, &tie, 1, answers, found));
+        CHECK(found[0] && answers[0].ms_since_epoch == 500 && answers[0].price == (mode == 0 ? 1 : 5));
+        CHECK_OK(ticks_close(handle));
+    }
+
+    printf("--- Other schemas and empty files ---\n");
+    ticks_header_t header;
+    memset(&header, 0, sizeof(header));
+    CHECK_OK(ticks_schema_builtin(TICKS_SCHEMA_QUOTES, &header.schema));
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    CHECK(ticks_asof(handle, queries, 1, answers, found) == TICKS_ERROR_INVALID_ARGUMENTS);
+    CHECK_OK(ticks_close(handle));
+    memset(&header, 0, sizeof(header));
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    CHECK_OK(ticks_close(handle));
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK_OK(ticks_asof(handle, queries, 3, answers, found));
+    CHECK(!found[0] && !found[2]);
+    CHECK_OK(ticks_close(handle));
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include "test_util.h"
+#include "ticksio/ticksio_async.h"
+#include "ticksio/ticksio_platform.h"
+
+#define NUM_ROWS 400000
+#define CHUNK_ROWS 50000
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+static uint64_t buffer[1024 * 3];
+
+// Helper function to check a file holds exactly the first num_rows rows
+static void check_file(const char* path, uint64_t num_rows) {
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    ticks_iterator_t* iterator = NULL;
+    CHECK_OK(ticks_iterator_create(handle, 1600000000, 1600100000, &iterator));
+    uint64_t total = 0;
+    uint32_t num_records = 0;
+    while (ticks_iterator_next_records(iterator, buffer, 1024, &num_records) == TICKS_OK) {
+        CHECK(total + num_records <= num_rows);
+        CHECK(memcmp(buffer, &rows[total * 3], (size_t)num_records * 3 * sizeof(uint64_t)) == 0);
+        total += num_records;
+    }
+    CHECK(total == num_rows);
+    ticks_iterator_destroy(iterator);
+    CHECK_OK(ticks_close(handle));
+}
+
+// Helper function to check a file holds an ordered subset of the first num_rows rows and return its size
+static uint64_t check_subset(const char* path, uint64_t num_rows) {
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    ticks_iterator_t* iterator = NULL;
+    CHECK_OK(ticks_iterator_create(handle, 1600000000, 1600100000, &iterator));
+    uint64_t total = 0;
+    uint64_t next = 0;
+    uint32_t num_records = 0;
+    while (ticks_iterator_next_records(iterator, buffer, 1024, &num_records) == TICKS_OK) {
+        for (uint32_t i = 0; i < num_records; i++) {
+            while (next < num_rows && memcmp(&buffer[i * 3], &rows[next * 3], 3 * sizeof(uint64_t)) != 0)
+                next++;
+            CHECK(next++ < num_rows);
+        }
+        total += num_records;
+    }
+    ticks_iterator_destroy(iterator);
+    CHECK_OK(ticks_close(handle));
+    return total;
+}
+
+static ticks_file_t* new_file(const char* path) {
+    ticks_header_t header;
+    test_header(&header, CHUNK_ROWS);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    return handle;
+}
+
+int main(void) {
+    const char* path = "test_async.ticks";
+
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i / 10;
+        rows[i * 3 + 1] = 100000 + (i * 7919) % 1000;
+        rows[i * 3 + 2] = i % 97;
+    }
+
+    printf("--- Single-row pushes ---\n");
+    ticks_file_t* handle = new_file(path);
+    ticks_async_writer_t* writer = NULL;
+    CHECK_OK(ticks_async_writer_create(handle, NULL, &writer));
+    for (uint64_t i = 0; i < NUM_ROWS; i++)
+        CHECK_OK(ticks_async_push(writer, &rows[i * 3], 1));
+    CHECK_OK(ticks_async_flush(writer));
+    ticks_async_stats_t stats;
+    CHECK_OK(ticks_async_get_stats(writer, &stats));
+    CHECK(stats.pushed_rows == NUM_ROWS && stats.written_rows == NUM_ROWS && stats.depth == 0);
+    CHECK(stats.max_depth > 0 && stats.max_latency_ns >= stats.mean_latency_ns);
+    CHECK_OK(ticks_async_writer_destroy(writer));
+    CHECK_OK(ticks_close(handle));
+    check_file(path, NUM_ROWS);
+
+    printf("--- Blocking on a small queue with group commit ---\n");
+    handle = new_file(path);
+    ticks_write_options_t write_options;
+    memset(&write_options, 0, sizeof(write_options));
+    write_options.durability = TICKS_DURABILITY_GROUP;
+    CHECK_OK(ticks_set_write_options(handle, &write_options));
+    ticks_async_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.queue_rows = 100;
+    options.batch_rows = 777;
+    options.flush_ms = 1;
+    CHECK_OK(ticks_async_writer_create(handle, &options, &writer));
+    CHECK(writer->capacity == 128);
+    // Pushes of up to 300 rows, some larger than the queue
+    uint64_t pushed = 0;
+    uint64_t state = 1;
+    while (pushed < NUM_ROWS / 4) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t num_rows = 1 + (uint32_t)((state >> 33) % 300);
+        if (pushed + num_rows > NUM_ROWS / 4)
+            num_rows = (uint32_t)(NUM_ROWS / 4 - pushed);
+        CHECK_OK(ticks_async_push(writer, &rows[pushed * 3], num_rows));
+        pushed += num_rows;
+    }
+    CHECK_OK(ticks_async_get_stats(writer, &stats));
+    CHECK(stats.blocked_pushes > 0);
+    CHECK_OK(ticks_async_writer_destroy(writer));
+    CHECK_OK(ticks_close(handle));
+    check_file(path, NUM_ROWS / 4);
+
+    printf("--- Dropping and reporting pushes that do not fit ---\n");
+    for (ticks_backpressure_e backpressure = TICKS_BACKPRESSURE_DROP; backpressure <= TICKS_BACKPRESSURE_REPORT; backpressure++) {
+        handle = new_file(path);
+        memset(&options, 0, sizeof(options));
+        options.queue_rows = 64;
+        options.backpressure = backpressure;
+        options.batch_rows = CHUNK_ROWS;
+        CHECK_OK(ticks_async_writer_create(handle, &options, &writer));
+        uint64_t full = 0;
+        for (uint64_t i = 0; i < NUM_ROWS; i += 16) {
+            const ticks_status_e status = ticks_async_push(writer, &rows[i * 3], 16);
+            if (status != TICKS_OK) {
+                CHECK(status == TICKS_ERROR_QUEUE_FULL && backpressure == TICKS_BACKPRESSURE_REPORT);
+                full++;
+            }
+        }
+        CHECK_OK(ticks_async_flush(writer));
+        CHECK_OK(ticks_async_get_stats(writer, &stats));
+        CHECK(stats.written_rows == stats.pushed_rows);
+        if (backpressure == TICKS_BACKPRESSURE_DROP)
+            CHECK(stats.pushed_rows + stats.dropped_rows == NUM_ROWS);
+        else
+            CHECK(stats.rejected_pushes == full && stats.pushed_rows == NUM_ROWS - full * 16);
+        CHECK_OK(ticks_async_writer_destroy(writer));
+        CHECK_OK(ticks_close(handle));
+        CHECK(check_subset(path, NUM_ROWS) == stats.pushed_rows);
+    }
+
+    printf("--- Rows waiting flush_ms are written without a flush ---\n");
+    handle = new_file(path);
+    memset(&options, 0, sizeof(options));
+    options.flush_ms = 20;
+    CHECK_OK(ticks_async_writer_create(handle, &options, &writer));
+    CHECK_OK(ticks_async_push(writer, rows, 10));
+    const uint64_t start_ns = monotonic_ns_portable();
+    do {
+        CHECK_OK(ticks_async_get_stats(writer, &stats));
+    } while (stats.written_rows < 10 && monotonic_ns_portable() - start_ns < 5000000000ULL);
+    CHECK(stats.written_rows == 10);
+    CHECK_OK(ticks_async_writer_destroy(writer));
+    CHECK_OK(ticks_close(handle));
+    check_file(path, 10);
+
+    // Only write handles take an async writer
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(ticks_async_writer_create(handle, NULL, &writer) == TICKS_ERROR_INVALID_ARGUMENTS);
+    CHECK_OK(ticks_close(handle));
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+
+#define NUM_ROWS 40000
+#define CHUNK_ROWS 10000
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+
+static const ticks_verify_mode_e verify_modes[] = {TICKS_VERIFY_FIRST_TOUCH, TICKS_VERIFY_ALWAYS, TICKS_VERIFY_OFF};
+static const char* verify_names[] = {"first touch", "always", "off"};
+static const ticks_index_mode_e index_modes[] = {TICKS_INDEX_LOAD, TICKS_INDEX_MMAP};
+static const char* index_names[] = {"load", "mmap"};
+
+// Helper function to flip the bits of one byte of a file
+static void corrupt_byte(const char* path, uint64_t offset) {
+    FILE* file = fopen(path, "r+b");
+    CHECK(file != NULL);
+    CHECK(fseek(file, (long)offset, SEEK_SET) == 0);
+    const int value = fgetc(file);
+    CHECK(value != EOF);
+    CHECK(fseek(file, (long)offset, SEEK_SET) == 0);
+    CHECK(fputc(value ^ 0xff, file) != EOF);
+    fclose(file);
+}
+
+static ticks_status_e open_file(const char* path, ticks_index_mode_e index_mode, ticks_verify_mode_e verify_mode,
+                                ticks_file_t** out_handle) {
+    ticks_open_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.index_mode = index_mode;
+    options.verify_mode = verify_mode;
+    return ticks_open_read_ex(path, &options, out_handle);
+}
+
+// Helper function to read every row, returning how the iterator ended
+static ticks_status_e read_all(ticks_file_t* handle, uint64_t* out_total) {
+    ticks_iterator_t* iterator = NULL;
+    CHECK_OK(ticks_iterator_create(handle, 1600000000, 1600001000, &iterator));
+    uint64_t buffer[1024 * 3];
+    uint32_t num_records = 0;
+    ticks_status_e status;
+    *out_total = 0;
+    while ((status = ticks_iterator_next_records(iterator, buffer, 1024, &num_records)) == TICKS_OK)
+        *out_total += num_records;
+    ticks_iterator_destroy(iterator);
+    return status;
+}
+
+// Helper function to write a clean file and describe where its second chunk's price column and its index sit
+static void write_clean(const char* path, ticks_column_chunk_t* out_price, uint64_t* out_chunk_offset,
+                        uint64_t* out_index_offset, uint64_t* out_index_size) {
+    test_write_file(path, rows, NUM_ROWS, CHUNK_ROWS);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(handle->index.num_entries == NUM_ROWS / CHUNK_ROWS);
+    *out_price = handle->index.entries[1].columns[1];
+    *out_chunk_offset = handle->index.entries[1].chunk_offset;
+    CHECK_OK(ticks_get_index_offset(handle, out_index_offset));
+    CHECK_OK(ticks_get_index_size(handle, out_index_size));
+    CHECK_OK(ticks_close(handle));
+}
+
+int main(void) {
+    const char* path = "test_checksums.ticks";
+
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i;
+        rows[i * 3 + 1] = 10000 + i % 977;
+        rows[i * 3 + 2] = i % 13;
+    }
+
+    ticks_column_chunk_t price;
+    uint64_t chunk_offset, index_offset, index_size;
+    ticks_file_t* handle = NULL;
+    uint64_t total = 0;
+
+    printf("--- A corrupted chunk fails to read unless verification is off ---\n");
+    for (size_t i = 0; i < sizeof(index_modes) / sizeof(index_modes[0]); i++) {
+        for (size_t v = 0; v < sizeof(verify_modes) / sizeof(verify_modes[0]); v++) {
+            printf("%s index, verify %s\n", index_names[i], verify_names[v]);
+            write_clean(path, &price, &chunk_offset, &index_offset, &index_size);
+            corrupt_byte(path, chunk_offset + price.offset + price.size / 2);
+            CHECK_OK(open_file(path, index_modes[i], verify_modes[v], &handle));
+            const ticks_status_e expected = verify_modes[v] == TICKS_VERIFY_OFF ? TICKS_EOF : TICKS_ERROR_CHECKSUM_MISMATCH;
+            CHECK(read_all(handle, &total) == expected);
+            // A column that failed verification is not remembered as verified
+            CHECK(read_all(handle, &total) == expected);
+            // Only rows before the corrupted chunk are returned
+            CHECK(expected == TICKS_EOF ? total == NUM_ROWS : total <= CHUNK_ROWS);
+            CHECK_OK(ticks_close(handle));
+        }
+    }
+
+    printf("--- A corrupted index entry fails to open unless it is not verified ---\n");
+    for (size_t i = 0; i < sizeof(index_modes) / sizeof(index_modes[0]); i++) {
+        for (size_t v = 0; v < sizeof(verify_modes) / sizeof(verify_modes[0]); v++) {
+            printf("%s index, verify %s\n", index_names[i], verify_names[v]);
+            write_clean(path, &price, &chunk_offset, &index_offset, &index_size);
+            corrupt_byte(path, index_offset + index_size / 2);
+            const ticks_status_e status = open_file(path, index_modes[i], verify_modes[v], &handle);
+            // A mapped index is only verified as a whole when always verifying, its blocks decode on first use
+            if (verify_modes[v] == TICKS_VERIFY_OFF || (index_modes[i] == TICKS_INDEX_MMAP && verify_modes[v] == TICKS_VERIFY_FIRST_TOUCH))
+                CHECK(status == TICKS_OK);
+            else
+                CHECK(status == TICKS_ERROR_CHECKSUM_MISMATCH);
+            if (status == TICKS_OK)
+                CHECK_OK(ticks_close(handle));
+        }
+    }
+
+    printf("--- A corrupted sparse index fails to open ---\n");
+    for (size_t i = 0; i < sizeof(index_modes) / sizeof(index_modes[0]); i++) {
+        for (size_t v = 0; v < sizeof(verify_modes) / sizeof(verify_modes[0]); v++) {
+            printf("%s index, verify %s\n", index_names[i], verify_names[v]);
+            write_clean(path, &price, &chunk_offset, &index_offset, &index_size);
+            // The top byte of the first block's offset, a mapped index rejects it and is read instead
+            corrupt_byte(path, index_offset + index_size + 15);
+            // Without verification the block offsets still have to match the blocks they point to
+            const ticks_status_e expected = verify_modes[v] == TICKS_VERIFY_OFF ? TICKS_ERROR_INVALID_FORMAT : TICKS_ERROR_CHECKSUM_MISMATCH;
+            CHECK(open_file(path, index_modes[i], verify_modes[v], &handle) == expected);
+        }
+    }
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
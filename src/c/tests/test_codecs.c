@@ -0,0 +1,124 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+
+#define NUM_ROWS 200000
+#define CHUNK_ROWS 50000
+#define NUM_COLUMNS 4
+#define BASE_MS 1600000000000ULL
+#define FROM 1600000000
+#define TO 1600000400
+
+static uint64_t rows[NUM_ROWS * NUM_COLUMNS];
+static uint64_t expected[NUM_ROWS * NUM_COLUMNS];
+static uint64_t actual[NUM_ROWS * NUM_COLUMNS];
+static ticks_schema_t schema;
+
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Helper function to write the rows with the given schema columns and reopen the file for reading
+static ticks_file_t* write_rows(const char* path, uint8_t num_columns) {
+    ticks_header_t header;
+    test_header(&header, CHUNK_ROWS);
+    header.schema = schema;
+    header.schema.num_columns = num_columns;
+    // Records are packed rows of the schema's columns
+    for (uint64_t i = 0; i < NUM_ROWS; i++)
+        memcpy(&expected[i * num_columns], &rows[i * NUM_COLUMNS], num_columns * sizeof(uint64_t));
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    CHECK_OK(ticks_add_records(handle, expected, NUM_ROWS));
+    CHECK_OK(ticks_close(handle));
+    CHECK_OK(ticks_open_read(path, &handle));
+    return handle;
+}
+
+// Helper function to check a file returns every row and sums every column over a few ranges as stored
+static void check_round_trip(ticks_file_t* handle, uint8_t num_columns) {
+    ticks_iterator_t* iterator = NULL;
+    CHECK_OK(ticks_iterator_create(handle, FROM, TO, &iterator));
+    uint64_t total = 0;
+    uint32_t num_records = 0;
+    while (ticks_iterator_next_records(iterator, &actual[total * num_columns], 7000, &num_records) == TICKS_OK)
+        total += num_records;
+    ticks_iterator_destroy(iterator);
+    CHECK(total == NUM_ROWS);
+    for (uint64_t i = 0; i < NUM_ROWS; i++)
+        CHECK(memcmp(&actual[i * num_columns], &rows[i * NUM_COLUMNS], num_columns * sizeof(uint64_t)) == 0);
+
+    for (time_t from = FROM; from < FROM + 200; from += 37) {
+        const time_t to = from + 1 + (from - FROM) / 2;
+        for (uint32_t column = 0; column < num_columns; column++) {
+            ticks_aggregate_t aggregate;
+            CHECK_OK(ticks_aggregate(handle, from, to, column, &aggregate));
+            uint64_t count = 0;
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < NUM_ROWS; i++) {
+                if (rows[i * NUM_COLUMNS] >= (uint64_t)from * 1000 && rows[i * NUM_COLUMNS] < (uint64_t)to * 1000) {
+                    count++;
+                    sum += rows[i * NUM_COLUMNS + column];
+                }
+            }
+            CHECK(aggregate.count == count && aggregate.sum == sum);
+        }
+    }
+}
+
+// Helper function to check the volume column of every chunk was stored with the given codec
+static void check_volume_codec(ticks_file_t* handle, uint8_t codec) {
+    CHECK(handle->index.num_entries == NUM_ROWS / CHUNK_ROWS);
+    for (uint32_t chunk = 0; chunk < handle->index.num_entries; chunk++)
+        CHECK(handle->index.entries[chunk].columns[2].codec == codec);
+}
+
+int main(void) {
+    const char* path = "test_codecs.ticks";
+
+    memset(&schema, 0, sizeof(schema));
+    schema.num_columns = NUM_COLUMNS;
+    strcpy(schema.columns[0].name, "ts");
+    schema.columns[0].type = TICKS_COLUMN_TIMESTAMP;
+    strcpy(schema.columns[1].name, "price");
+    schema.columns[1].type = TICKS_COLUMN_DECIMAL;
+    schema.columns[1].scale = 4;
+    strcpy(schema.columns[2].name, "volume");
+    schema.columns[2].type = TICKS_COLUMN_UINT;
+    strcpy(schema.columns[3].name, "delta");
+    schema.columns[3].type = TICKS_COLUMN_INT;
+
+    printf("--- Volume codecs ---\n");
+    uint64_t state = 99;
+    static const uint64_t lots[] = {100, 200, 500, 1000};
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        const uint64_t random = next_random(&state);
+        rows[i * NUM_COLUMNS] = BASE_MS + i;
+        rows[i * NUM_COLUMNS + 1] = 5000 + random % 100;
+        rows[i * NUM_COLUMNS + 2] = lots[(random >> 11) % 4];
+    }
+    ticks_file_t* handle = write_rows(path, 3);
+    check_volume_codec(handle, TICKS_CODEC_DICT);
+    check_round_trip(handle, 3);
+    CHECK_OK(ticks_close(handle));
+
+    for (uint64_t i = 0; i < NUM_ROWS; i++)
+        rows[i * NUM_COLUMNS + 2] = 100000 + i / 1000;
+    handle = write_rows(path, 3);
+    check_volume_codec(handle, TICKS_CODEC_RLE);
+    check_round_trip(handle, 3);
+    CHECK_OK(ticks_close(handle));
+
+    for (uint64_t i = 0; i < NUM_ROWS; i++)
+        rows[i * NUM_COLUMNS + 2] = next_random(&state) % 100000;
+    handle = write_rows(path, 3);
+    check_volume_codec(handle, TICKS_CODEC_FOR);
+    check_round_trip(handle, 3);
+    CHECK_OK(ticks_close(handle));
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+
+#define NUM_ROWS 100000
+#define BATCH_ROWS 333
+#define CHUNK_ROWS 1000
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+static uint64_t read_rows[NUM_ROWS * 3];
+
+static int file_exists(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return 0;
+    fclose(file);
+    return 1;
+}
+
+// Helper function to read every row of a file in order, returning the number of chunks
+static uint32_t read_file(const char* path, uint64_t* out_rows, uint64_t* out_num_rows) {
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    const uint32_t num_chunks = handle->index.num_entries;
+    ticks_iterator_t* iterator = NULL;
+    CHECK_OK(ticks_iterator_create(handle, 1600000000, 1600001000, &iterator));
+    uint64_t total = 0;
+    uint32_t num_records = 0;
+    ticks_status_e status;
+    while ((status = ticks_iterator_next_records(iterator, out_rows + total * 3, 1024, &num_records)) == TICKS_OK)
+        total += num_records;
+    CHECK(status == TICKS_EOF);
+    ticks_iterator_destroy(iterator);
+    CHECK_OK(ticks_close(handle));
+    *out_num_rows = total;
+    return num_chunks;
+}
+
+int main(void) {
+    const char* path = "test_compact.ticks";
+    const char* compact_path = "test_compact_out.ticks";
+
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i;
+        rows[i * 3 + 1] = 10000 + i % 977;
+        rows[i * 3 + 2] = i % 13;
+    }
+
+    // Written in small batches, each ends a chunk well short of the policy's limit
+    ticks_header_t header;
+    test_header(&header, CHUNK_ROWS);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    for (uint64_t i = 0; i < NUM_ROWS; i += BATCH_ROWS)
+        CHECK_OK(ticks_add_records(handle, &rows[i * 3], i + BATCH_ROWS < NUM_ROWS ? BATCH_ROWS : NUM_ROWS - i));
+    CHECK_OK(ticks_close(handle));
+    uint64_t num_rows = 0;
+    const uint32_t source_chunks = read_file(path, read_rows, &num_rows);
+    CHECK(num_rows == NUM_ROWS);
+    CHECK(source_chunks == (NUM_ROWS + BATCH_ROWS - 1) / BATCH_ROWS);
+
+    printf("--- Ranges compacted on several threads keep every row in order ---\n");
+    ticks_compact_policy_t policy;
+    memset(&policy, 0, sizeof(policy));
+    policy.num_threads = 4;
+    policy.range_rows = 4500; // Rounded down to whole chunks of the policy, so 25 ranges in 7 rounds
+    CHECK_OK(ticks_compact(path, compact_path, &policy));
+    const uint32_t compact_chunks = read_file(compact_path, read_rows, &num_rows);
+    CHECK(num_rows == NUM_ROWS);
+    CHECK(memcmp(read_rows, rows, sizeof(rows)) == 0);
+    CHECK(compact_chunks == NUM_ROWS / CHUNK_ROWS);
+
+    printf("--- A new chunk policy re-chunks the rows ---\n");
+    policy.chunk_policy.max_chunk_rows = 7000;
+    policy.range_rows = 10000; // Rounded down to one chunk, so only the last chunk is short
+    CHECK_OK(ticks_compact(path, compact_path, &policy));
+    CHECK(read_file(compact_path, read_rows, &num_rows) == NUM_ROWS / 7000 + 1);
+    CHECK(num_rows == NUM_ROWS);
+    CHECK(memcmp(read_rows, rows, sizeof(rows)) == 0);
+
+    printf("--- Compacting a file into itself is rejected ---\n");
+    CHECK(ticks_compact(path, path, &policy) == TICKS_ERROR_INVALID_ARGUMENTS);
+    char other_path[64];
+    snprintf(other_path, sizeof(other_path), "./%s", path);
+    CHECK(ticks_compact(path, other_path, &policy) == TICKS_ERROR_INVALID_ARGUMENTS);
+    CHECK(read_file(path, read_rows, &num_rows) == source_chunks);
+    CHECK(num_rows == NUM_ROWS);
+
+    printf("--- A failed compaction removes its output ---\n");
+    // Corrupt a chunk in the last range, so the output already holds earlier chunks when it fails
+    CHECK_OK(ticks_open_read(path, &handle));
+    const ticks_index_entry_t entry = handle->index.entries[source_chunks - 2];
+    CHECK_OK(ticks_close(handle));
+    FILE* file = fopen(path, "r+b");
+    CHECK(file != NULL);
+    CHECK(fseek(file, (long)(entry.chunk_offset + entry.columns[1].offset), SEEK_SET) == 0);
+    const int value = fgetc(file);
+    CHECK(fseek(file, (long)(entry.chunk_offset + entry.columns[1].offset), SEEK_SET) == 0);
+    CHECK(fputc(value ^ 0xff, file) != EOF);
+    fclose(file);
+    CHECK(file_exists(compact_path));
+    CHECK(ticks_compact(path, compact_path, &policy) == TICKS_ERROR_CHECKSUM_MISMATCH);
+    CHECK(!file_exists(compact_path));
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
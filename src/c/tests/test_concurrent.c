@@ -0,0 +1,118 @@
+#include "test_util.h"
+#include "ticksio/ticksio_platform.h"
+
+#define NUM_ROWS 200000
+#define CHUNK_ROWS 1000
+#define NUM_THREADS 8
+#define ITERATIONS 50
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+
+typedef struct {
+    ticks_file_t* handle;
+    uint32_t seed;
+    uint32_t failures;
+} worker_t;
+
+// Rows are one millisecond apart from BASE_MS, so the count of any range of seconds is known
+static uint64_t expected_count(uint64_t from_s, uint64_t to_s) {
+    const uint64_t base_s = BASE_MS / 1000;
+    const uint64_t from_row = (from_s - base_s) * 1000 < NUM_ROWS ? (from_s - base_s) * 1000 : NUM_ROWS;
+    const uint64_t to_row = (to_s - base_s) * 1000 < NUM_ROWS ? (to_s - base_s) * 1000 : NUM_ROWS;
+    return to_row - from_row;
+}
+
+// Helper function to run iterators over random ranges of the shared handle, counting wrong results
+static void* iterate_worker(void* arg) {
+    worker_t* worker = arg;
+    const uint64_t base_s = BASE_MS / 1000;
+    const uint64_t span_s = NUM_ROWS / 1000 + 10;
+    uint64_t buffer[512 * 3];
+    for (int i = 0; i < ITERATIONS; i++) {
+        worker->seed = worker->seed * 1103515245u + 12345u;
+        const uint64_t from_s = base_s + (worker->seed >> 8) % span_s;
+        worker->seed = worker->seed * 1103515245u + 12345u;
+        const uint64_t to_s = from_s + 1 + (worker->seed >> 8) % 40;
+
+        ticks_iterator_t* iterator = NULL;
+        if (ticks_iterator_create(worker->handle, (time_t)from_s, (time_t)to_s, &iterator) != TICKS_OK) {
+            worker->failures++;
+            continue;
+        }
+        uint64_t total = 0;
+        uint64_t previous = 0;
+        uint32_t num_records = 0;
+        ticks_status_e status;
+        while ((status = ticks_iterator_next_records(iterator, buffer, 512, &num_records)) == TICKS_OK) {
+            for (uint32_t r = 0; r < num_records; r++) {
+                if (buffer[r * 3] < previous || buffer[r * 3 + 2] != (buffer[r * 3] - BASE_MS) % 13)
+                    worker->failures++;
+                previous = buffer[r * 3];
+            }
+            total += num_records;
+        }
+        ticks_iterator_destroy(iterator);
+        if (status != TICKS_EOF || total != expected_count(from_s, to_s))
+            worker->failures++;
+    }
+    return NULL;
+}
+
+// Helper function to run NUM_THREADS workers on one handle and check every iteration was right
+static void run_workers(ticks_file_t* handle) {
+    thread_portable threads[NUM_THREADS];
+    worker_t workers[NUM_THREADS];
+    for (uint32_t t = 0; t < NUM_THREADS; t++) {
+        workers[t].handle = handle;
+        workers[t].seed = t + 1;
+        workers[t].failures = 0;
+        CHECK(thread_create_portable(&threads[t], iterate_worker, &workers[t]) == 0);
+    }
+    for (uint32_t t = 0; t < NUM_THREADS; t++) {
+        CHECK(thread_join_portable(threads[t]) == 0);
+        CHECK(workers[t].failures == 0);
+    }
+}
+
+int main(void) {
+    const char* path = "test_concurrent.ticks";
+
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i;
+        rows[i * 3 + 1] = 10000 + i % 977;
+        rows[i * 3 + 2] = i % 13;
+    }
+    test_write_file(path, rows, NUM_ROWS, CHUNK_ROWS);
+
+    static const ticks_index_mode_e index_modes[] = {TICKS_INDEX_LOAD, TICKS_INDEX_MMAP};
+    static const char* index_names[] = {"loaded", "mapped"};
+    static const uint64_t cache_budgets[] = {0, 256u << 10};
+    for (size_t i = 0; i < sizeof(index_modes) / sizeof(index_modes[0]); i++) {
+        for (size_t c = 0; c < sizeof(cache_budgets) / sizeof(cache_budgets[0]); c++) {
+            printf("--- Iterators on %d threads share one handle: %s index, cache %s ---\n", NUM_THREADS, index_names[i],
+                   cache_budgets[c] != 0 ? "on" : "off");
+            // The budget holds far fewer chunks than the threads touch, so chunks are evicted while others still use them
+            CHECK_OK(ticks_cache_set_budget(cache_budgets[c]));
+            ticks_open_options_t options;
+            memset(&options, 0, sizeof(options));
+            options.index_mode = index_modes[i];
+            ticks_file_t* handle = NULL;
+            CHECK_OK(ticks_open_read_ex(path, &options, &handle));
+            run_workers(handle);
+
+            ticks_metrics_t metrics;
+            CHECK_OK(ticks_get_metrics(handle, &metrics));
+            if (cache_budgets[c] != 0)
+                CHECK(metrics.cache_hits > 0 && metrics.cache_misses > 0);
+            else
+                CHECK(metrics.cache_hits == 0 && metrics.cache_misses == 0);
+            CHECK_OK(ticks_close(handle));
+        }
+    }
+    CHECK_OK(ticks_cache_set_budget(0));
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
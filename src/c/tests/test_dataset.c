@@ -0,0 +1,305 @@
+#include "test_util.h"
+#include "ticksio/ticksio_platform.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+    #include <direct.h>
+    #include <sys/utime.h>
+    #define make_dir(path) _mkdir(path)
+    #define remove_dir(path) _rmdir(path)
+    #define utime _utime
+    #define utimbuf _utimbuf
+#else
+    #include <unistd.h>
+    #include <utime.h>
+    #define make_dir(path) mkdir(path, 0755)
+    #define remove_dir(path) rmdir(path)
+#endif
+
+#define NUM_SYMBOLS 3
+#define NUM_DAYS 4
+#define ROWS 5000
+#define CHUNK_ROWS 700
+#define DAY_MS 86400000ULL
+#define BASE_MS 1600000000000ULL
+#define DIR "test_dataset_dir"
+
+static const char* symbols[NUM_SYMBOLS] = {"AAA", "BBBB", "LONGSYM8"};
+static uint64_t volume_sums[NUM_SYMBOLS][NUM_DAYS];
+static trade_data_t trades[ROWS];
+
+static mutex_portable scan_mutex = MUTEX_INIT_PORTABLE;
+static uint64_t scanned_rows;
+static uint64_t scanned_volume;
+
+static ticks_status_e sum_volumes(uint32_t partition, const uint64_t* rows, uint32_t num_rows, void* user) {
+    (void)partition;
+    (void)user;
+    mutex_lock_portable(&scan_mutex);
+    scanned_rows += num_rows;
+    for (uint32_t i = 0; i < num_rows; i++)
+        scanned_volume += rows[i * 3 + 2];
+    mutex_unlock_portable(&scan_mutex);
+    return TICKS_OK;
+}
+
+static ticks_status_e stop_scan(uint32_t partition, const uint64_t* rows, uint32_t num_rows, void* user) {
+    (void)partition;
+    (void)rows;
+    (void)num_rows;
+    (void)user;
+    return TICKS_EOF;
+}
+
+static void day_path(char* path, size_t size, int symbol, int day) {
+    snprintf(path, size, DIR "/%s/day%d.ticks", symbols[symbol], day);
+}
+
+static void write_day(int symbol, int day) {
+    char path[256];
+    snprintf(path, sizeof(path), DIR "/%s", symbols[symbol]);
+    make_dir(path);
+    day_path(path, sizeof(path), symbol, day);
+    ticks_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.ticker, symbols[symbol], strlen(symbols[symbol]));
+    header.chunk_policy.max_chunk_rows = CHUNK_ROWS;
+    volume_sums[symbol][day] = 0;
+    for (uint64_t i = 0; i < ROWS; i++) {
+        trades[i].ms_since_epoch = BASE_MS + day * DAY_MS + 3600000 + i * 10000;
+        trades[i].price = 100 + i;
+        trades[i].volume = (uint64_t)(symbol * 7 + day) + i % 13;
+        volume_sums[symbol][day] += trades[i].volume;
+    }
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    CHECK_OK(ticks_add_data(handle, trades, ROWS));
+    CHECK_OK(ticks_close(handle));
+}
+
+static uint64_t file_size(const char* path) {
+    FILE* file = fopen(path, "rb");
+    CHECK(file != NULL);
+    CHECK(fseek(file, 0, SEEK_END) == 0);
+    const long size = ftell(file);
+    fclose(file);
+    return (uint64_t)size;
+}
+
+static void copy_file(const char* from, const char* to) {
+    FILE* in = fopen(from, "rb");
+    FILE* out = fopen(to, "wb");
+    CHECK(in != NULL && out != NULL);
+    static uint8_t buffer[65536];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        CHECK(fwrite(buffer, 1, size, out) == size);
+    fclose(in);
+    fclose(out);
+}
+
+// Helper function to find a partition by its path, returns the number of partitions when there is none
+static uint32_t find_partition(ticks_dataset_t* dataset, const char* path, ticks_partition_t* out_partition) {
+    uint32_t num_partitions = 0;
+    CHECK_OK(ticks_dataset_get_num_partitions(dataset, &num_partitions));
+    for (uint32_t i = 0; i < num_partitions; i++) {
+        CHECK_OK(ticks_dataset_get_partition(dataset, i, out_partition));
+        if (strcmp(out_partition->path, path) == 0)
+            return i;
+    }
+    return num_partitions;
+}
+
+int main(void) {
+    const char* incomplete_path = DIR "/incomplete.ticks";
+    const char* copy_path = DIR "/AAA/copy.ticks";
+
+    // Leftovers of an earlier failed run
+    remove(copy_path);
+    remove(DIR "/" TICKS_CATALOG_NAME);
+    make_dir(DIR);
+    make_dir(DIR "/.hidden");
+    for (int symbol = 0; symbol < NUM_SYMBOLS; symbol++)
+        for (int day = 0; day < NUM_DAYS; day++)
+            write_day(symbol, day);
+    // Neither hidden files nor files of other types are partitions
+    FILE* file = fopen(DIR "/.hidden/hidden.ticks", "wb");
+    CHECK(file != NULL);
+    fclose(file);
+    file = fopen(DIR "/notes.txt", "wb");
+    CHECK(file != NULL);
+    fclose(file);
+    // A file that is not a complete ticks file yet, as large as a complete one. Its modification time is set to a
+    // whole second so it can be set back exactly.
+    char day0_path[256];
+    day_path(day0_path, sizeof(day0_path), 0, 0);
+    const uint64_t day_size = file_size(day0_path);
+    file = fopen(incomplete_path, "wb");
+    CHECK(file != NULL);
+    for (uint64_t i = 0; i < day_size; i++)
+        fputc('x', file);
+    fclose(file);
+    struct utimbuf incomplete_times;
+    incomplete_times.actime = 1600000000;
+    incomplete_times.modtime = 1600000000;
+    CHECK(utime(incomplete_path, &incomplete_times) == 0);
+
+    printf("--- Catalog ---\n");
+    ticks_dataset_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.num_threads = 4;
+    ticks_dataset_t* dataset = NULL;
+    CHECK_OK(ticks_dataset_open_ex(DIR, &options, &dataset));
+    uint32_t num_partitions = 0;
+    CHECK_OK(ticks_dataset_get_num_partitions(dataset, &num_partitions));
+    CHECK(num_partitions == NUM_SYMBOLS * NUM_DAYS + 1);
+    ticks_partition_t partition;
+    CHECK(find_partition(dataset, "incomplete.ticks", &partition) < num_partitions);
+    CHECK(partition.num_chunks == 0 && partition.num_records == 0);
+    for (int symbol = 0; symbol < NUM_SYMBOLS; symbol++) {
+        for (int day = 0; day < NUM_DAYS; day++) {
+            char path[64];
+            snprintf(path, sizeof(path), "%s/day%d.ticks", symbols[symbol], day);
+            CHECK(find_partition(dataset, path, &partition) < num_partitions);
+            CHECK(strncmp(partition.symbol, symbols[symbol], TICKS_TICKER_SIZE) == 0);
+            CHECK(partition.min_time == BASE_MS + day * DAY_MS + 3600000);
+            CHECK(partition.max_time == partition.min_time + (ROWS - 1) * 10000ULL);
+            CHECK(partition.num_records == ROWS && partition.num_chunks == (ROWS + CHUNK_ROWS - 1) / CHUNK_ROWS);
+        }
+    }
+    CHECK(ticks_dataset_get_partition(dataset, num_partitions, &partition) == TICKS_ERROR_INVALID_ARGUMENTS);
+
+    printf("--- Planning ---\n");
+    const time_t day1 = (time_t)((BASE_MS + DAY_MS) / 1000);
+    const time_t day3 = (time_t)((BASE_MS + 3 * DAY_MS) / 1000);
+    uint32_t selected[64];
+    uint32_t num_selected = 0;
+    CHECK_OK(ticks_dataset_plan(dataset, "AAA", day1, day3, selected, 64, &num_selected));
+    CHECK(num_selected == 2);
+    CHECK_OK(ticks_dataset_get_partition(dataset, selected[0], &partition));
+    CHECK(strcmp(partition.path, "AAA/day1.ticks") == 0);
+    CHECK_OK(ticks_dataset_get_partition(dataset, selected[1], &partition));
+    CHECK(strcmp(partition.path, "AAA/day2.ticks") == 0);
+    CHECK_OK(ticks_dataset_plan(dataset, NULL, day1, day3, selected, 64, &num_selected));
+    CHECK(num_selected == 2 * NUM_SYMBOLS);
+    CHECK_OK(ticks_dataset_plan(dataset, "LONGSYM8", day1, day3, NULL, 0, &num_selected));
+    CHECK(num_selected == 2);
+    CHECK_OK(ticks_dataset_plan(dataset, "BBBB", day1, day3, selected, 1, &num_selected));
+    CHECK(num_selected == 2);
+    CHECK_OK(ticks_dataset_plan(dataset, "LONGSYM89", day1, day3, selected, 64, &num_selected));
+    CHECK(num_selected == 0);
+    CHECK_OK(ticks_dataset_plan(dataset, "AA", day1, day3, selected, 64, &num_selected));
+    CHECK(num_selected == 0);
+    CHECK(ticks_dataset_plan(dataset, "AAA", day3, day1, selected, 64, &num_selected) == TICKS_ERROR_INVALID_ARGUMENTS);
+
+    printf("--- Queries ---\n");
+    uint64_t expected_volume = 0;
+    for (int symbol = 0; symbol < NUM_SYMBOLS; symbol++)
+        expected_volume += volume_sums[symbol][1] + volume_sums[symbol][2];
+    CHECK_OK(ticks_dataset_scan(dataset, NULL, day1, day3, NULL, sum_volumes, NULL));
+    CHECK(scanned_rows == 2 * NUM_SYMBOLS * ROWS && scanned_volume == expected_volume);
+    CHECK(ticks_dataset_scan(dataset, NULL, day1, day3, NULL, stop_scan, NULL) == TICKS_EOF);
+    ticks_aggregate_t aggregate;
+    CHECK_OK(ticks_dataset_aggregate(dataset, NULL, day1, day3, 2, &aggregate));
+    CHECK(aggregate.count == 2 * NUM_SYMBOLS * ROWS && aggregate.sum == expected_volume);
+    CHECK_OK(ticks_dataset_aggregate(dataset, "BBBB", 0, day3, 2, &aggregate));
+    CHECK(aggregate.count == 3 * ROWS && aggregate.sum == volume_sums[1][0] + volume_sums[1][1] + volume_sums[1][2]);
+    CHECK(ticks_dataset_aggregate(dataset, NULL, day1, day3, 9, &aggregate) == TICKS_ERROR_INVALID_ARGUMENTS);
+    uint32_t changed = 99;
+    CHECK_OK(ticks_dataset_refresh(dataset, &changed));
+    CHECK(changed == 0);
+    CHECK_OK(ticks_dataset_close(dataset));
+
+    printf("--- Refreshing a stored catalog ---\n");
+    sleep_ms_portable(20);
+    ticks_file_t* handle = NULL;
+    char day3_path[256];
+    day_path(day3_path, sizeof(day3_path), 0, 3);
+    CHECK_OK(ticks_open_write(day3_path, &handle));
+    trade_data_t late = {BASE_MS + 3 * DAY_MS + 60000000, 1, 1};
+    CHECK_OK(ticks_add_data(handle, &late, 1));
+    CHECK_OK(ticks_close(handle));
+    char removed_path[256];
+    day_path(removed_path, sizeof(removed_path), 1, 0);
+    CHECK(remove(removed_path) == 0);
+    copy_file(day0_path, copy_path);
+
+    options.refresh = TICKS_CATALOG_TRUST;
+    CHECK_OK(ticks_dataset_open_ex(DIR, &options, &dataset));
+    CHECK_OK(ticks_dataset_get_num_partitions(dataset, &num_partitions));
+    CHECK(num_partitions == NUM_SYMBOLS * NUM_DAYS + 1);
+    // A trusted catalog is used as stored, so the query reaches the removed file and fails
+    CHECK(ticks_dataset_aggregate(dataset, "BBBB", 0, day3, 2, &aggregate) != TICKS_OK);
+    CHECK_OK(ticks_dataset_refresh(dataset, &changed));
+    CHECK(changed == 3);
+    CHECK(find_partition(dataset, "AAA/day3.ticks", &partition) < num_partitions);
+    CHECK(partition.num_records == ROWS + 1 && partition.max_time == late.ms_since_epoch);
+    CHECK(find_partition(dataset, "AAA/copy.ticks", &partition) < num_partitions);
+    CHECK(partition.num_records == ROWS);
+    CHECK(find_partition(dataset, "BBBB/day0.ticks", &partition) == num_partitions);
+    CHECK_OK(ticks_dataset_close(dataset));
+    CHECK_OK(ticks_dataset_open(DIR, &dataset));
+    CHECK_OK(ticks_dataset_refresh(dataset, &changed));
+    CHECK(changed == 0);
+    CHECK_OK(ticks_dataset_close(dataset));
+
+    printf("--- Incomplete files are read again ---\n");
+    // Once complete, the file is read on the next refresh even with the size and modification time it was listed with
+    copy_file(day0_path, incomplete_path);
+    CHECK(file_size(incomplete_path) == day_size);
+    CHECK(utime(incomplete_path, &incomplete_times) == 0);
+    options.refresh = TICKS_CATALOG_REFRESH;
+    CHECK_OK(ticks_dataset_open_ex(DIR, &options, &dataset));
+    CHECK(find_partition(dataset, "incomplete.ticks", &partition) < num_partitions);
+    CHECK(partition.num_records == ROWS && strncmp(partition.symbol, "AAA", TICKS_TICKER_SIZE) == 0);
+    CHECK_OK(ticks_dataset_refresh(dataset, &changed));
+    CHECK(changed == 0);
+    CHECK_OK(ticks_dataset_close(dataset));
+
+    printf("--- Damaged and read-only catalogs ---\n");
+    file = fopen(DIR "/" TICKS_CATALOG_NAME, "r+b");
+    CHECK(file != NULL);
+    CHECK(fseek(file, 30, SEEK_SET) == 0);
+    fputc('X', file);
+    fclose(file);
+    options.refresh = TICKS_CATALOG_TRUST;
+    CHECK_OK(ticks_dataset_open_ex(DIR, &options, &dataset));
+    CHECK_OK(ticks_dataset_get_num_partitions(dataset, &num_partitions));
+    CHECK(num_partitions == NUM_SYMBOLS * NUM_DAYS + 1);
+    CHECK_OK(ticks_dataset_close(dataset));
+    CHECK_OK(ticks_dataset_open(DIR, &dataset));
+    CHECK_OK(ticks_dataset_refresh(dataset, &changed));
+    CHECK(changed == 0);
+    CHECK_OK(ticks_dataset_close(dataset));
+
+    CHECK(remove(DIR "/" TICKS_CATALOG_NAME) == 0);
+    options.read_only = 1;
+    options.num_threads = 1;
+    CHECK_OK(ticks_dataset_open_ex(DIR, &options, &dataset));
+    CHECK_OK(ticks_dataset_aggregate(dataset, "AAA", 0, day3, 2, &aggregate));
+    CHECK(aggregate.count == 5 * ROWS);
+    CHECK_OK(ticks_dataset_close(dataset));
+    file = fopen(DIR "/" TICKS_CATALOG_NAME, "rb");
+    CHECK(file == NULL);
+    CHECK(ticks_dataset_open(DIR "/missing", &dataset) == TICKS_ERROR_FILE_IO);
+
+    for (int symbol = 0; symbol < NUM_SYMBOLS; symbol++) {
+        char path[256];
+        for (int day = 0; day < NUM_DAYS; day++) {
+            day_path(path, sizeof(path), symbol, day);
+            remove(path);
+        }
+        snprintf(path, sizeof(path), DIR "/%s", symbols[symbol]);
+        if (symbol == 0)
+            remove(copy_path);
+        remove_dir(path);
+    }
+    remove(incomplete_path);
+    remove(DIR "/notes.txt");
+    remove(DIR "/.hidden/hidden.ticks");
+    remove_dir(DIR "/.hidden");
+    remove_dir(DIR);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
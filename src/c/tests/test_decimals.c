@@ -0,0 +1,173 @@
+#include "test_util.h"
+#include "ticksio/ticksio_csv.h"
+#include "ticksio/ticksio_helpers.h"
+#include "ticksio/ticksio_internal.h"
+
+#define NUM_ROWS 200000
+#define CHUNK_ROWS 50000
+#define NUM_COLUMNS 4
+#define BASE_MS 1600000000000ULL
+#define FROM 1600000000
+#define TO 1600000400
+
+static uint64_t rows[NUM_ROWS * NUM_COLUMNS];
+static uint64_t expected[NUM_ROWS * NUM_COLUMNS];
+static uint64_t actual[NUM_ROWS * NUM_COLUMNS];
+static ticks_schema_t schema;
+
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Helper function to parse a decimal, UINT64_MAX when it is rejected
+static uint64_t parse(const char* str, uint8_t scale) {
+    uint64_t value = 0;
+    return parse_scaled_decimal(str, scale, &value) != NULL ? value : UINT64_MAX;
+}
+
+// Helper function to write the rows with the given schema columns and reopen the file for reading
+static ticks_file_t* write_rows(const char* path, uint8_t num_columns) {
+    ticks_header_t header;
+    test_header(&header, CHUNK_ROWS);
+    header.schema = schema;
+    header.schema.num_columns = num_columns;
+    // Records are packed rows of the schema's columns
+    for (uint64_t i = 0; i < NUM_ROWS; i++)
+        memcpy(&expected[i * num_columns], &rows[i * NUM_COLUMNS], num_columns * sizeof(uint64_t));
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    CHECK_OK(ticks_add_records(handle, expected, NUM_ROWS));
+    CHECK_OK(ticks_close(handle));
+    CHECK_OK(ticks_open_read(path, &handle));
+    return handle;
+}
+
+// Helper function to check a file returns every row and sums every column over a few ranges as stored
+static void check_round_trip(ticks_file_t* handle, uint8_t num_columns) {
+    ticks_iterator_t* iterator = NULL;
+    CHECK_OK(ticks_iterator_create(handle, FROM, TO, &iterator));
+    uint64_t total = 0;
+    uint32_t num_records = 0;
+    while (ticks_iterator_next_records(iterator, &actual[total * num_columns], 7000, &num_records) == TICKS_OK)
+        total += num_records;
+    ticks_iterator_destroy(iterator);
+    CHECK(total == NUM_ROWS);
+    for (uint64_t i = 0; i < NUM_ROWS; i++)
+        CHECK(memcmp(&actual[i * num_columns], &rows[i * NUM_COLUMNS], num_columns * sizeof(uint64_t)) == 0);
+
+    for (time_t from = FROM; from < FROM + 200; from += 37) {
+        const time_t to = from + 1 + (from - FROM) / 2;
+        for (uint32_t column = 0; column < num_columns; column++) {
+            ticks_aggregate_t aggregate;
+            CHECK_OK(ticks_aggregate(handle, from, to, column, &aggregate));
+            uint64_t count = 0;
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < NUM_ROWS; i++) {
+                if (rows[i * NUM_COLUMNS] >= (uint64_t)from * 1000 && rows[i * NUM_COLUMNS] < (uint64_t)to * 1000) {
+                    count++;
+                    sum += rows[i * NUM_COLUMNS + column];
+                }
+            }
+            CHECK(aggregate.count == count && aggregate.sum == sum);
+        }
+    }
+}
+
+int main(void) {
+    const char* path = "test_decimals.ticks";
+    const char* csv_path = "test_decimals.csv";
+
+    memset(&schema, 0, sizeof(schema));
+    schema.num_columns = NUM_COLUMNS;
+    strcpy(schema.columns[0].name, "ts");
+    schema.columns[0].type = TICKS_COLUMN_TIMESTAMP;
+    strcpy(schema.columns[1].name, "price");
+    schema.columns[1].type = TICKS_COLUMN_DECIMAL;
+    schema.columns[1].scale = 4;
+    strcpy(schema.columns[2].name, "volume");
+    schema.columns[2].type = TICKS_COLUMN_UINT;
+    strcpy(schema.columns[3].name, "delta");
+    schema.columns[3].type = TICKS_COLUMN_INT;
+
+    printf("--- Exact decimal parsing ---\n");
+    CHECK(parse("0.29", 2) == 29);
+    CHECK(parse("12", 2) == 1200);
+    CHECK(parse("1.5", 4) == 15000);
+    CHECK(parse("1.230", 2) == 123);
+    CHECK(parse(".5", 1) == 5);
+    CHECK(parse("1.234", 2) == UINT64_MAX);
+    CHECK(parse("abc", 2) == UINT64_MAX);
+    CHECK(parse("18446744073709551614", 0) == 18446744073709551614ULL);
+    CHECK(parse("18446744073709551616", 0) == UINT64_MAX);
+    CHECK(parse("184467440737095516.16", 2) == UINT64_MAX);
+    CHECK(parse("1", TICKS_MAX_DECIMAL_SCALE) == 1000000000000000000ULL);
+    CHECK(parse("1", TICKS_MAX_DECIMAL_SCALE + 1) == UINT64_MAX);
+
+    printf("--- CSV prices at the schema's scale ---\n");
+    FILE* file = fopen(csv_path, "w");
+    CHECK(file != NULL);
+    fprintf(file, "timestamp,price,volume\n"
+                  "2020-09-13 12:26:40.123,0.29,100\n"
+                  "2020-09-13 12:26:41,101.1,5\n"
+                  "2020-09-13 12:26:42,1.234,5\n"
+                  "not a trade at all\n"
+                  "2020-09-13 12:26:43,7,18446744073709551615\r\n");
+    fclose(file);
+    csv_read_result_t reader;
+    memset(&reader, 0, sizeof(reader));
+    CHECK_OK(read_csv(csv_path, &reader));
+    CHECK(reader.price_scale == TICKS_DEFAULT_PRICE_SCALE);
+    CHECK(reader.records_in_buffer == 3 && reader.rejected_lines == 2);
+    CHECK(reader.buffer[0].price == 29 && reader.buffer[0].volume == 100);
+    CHECK(reader.buffer[1].price == 10110);
+    CHECK(reader.buffer[2].price == 700 && reader.buffer[2].volume == 18446744073709551615ULL);
+    csv_reader_cleanup(&reader);
+    ticks_schema_t trades;
+    CHECK_OK(ticks_schema_builtin(TICKS_SCHEMA_TRADES, &trades));
+    trades.columns[1].scale = 3;
+    reader.schema = &trades;
+    CHECK_OK(read_csv(csv_path, &reader));
+    CHECK(reader.records_in_buffer == 4 && reader.rejected_lines == 1 && reader.buffer[2].price == 1234);
+    csv_reader_cleanup(&reader);
+    trades.columns[1].scale = TICKS_MAX_DECIMAL_SCALE + 1;
+    reader.schema = &trades;
+    CHECK(read_csv(csv_path, &reader) == TICKS_ERROR_INVALID_ARGUMENTS);
+    reader.schema = &schema;
+    CHECK(read_csv(csv_path, &reader) == TICKS_ERROR_INVALID_ARGUMENTS);
+
+    printf("--- Decimal scale shifts ---\n");
+    uint64_t state = 99;
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        const uint64_t random = next_random(&state);
+        rows[i * NUM_COLUMNS] = BASE_MS + i;
+        rows[i * NUM_COLUMNS + 2] = random % 100000;
+        // Prices of the first chunks are whole cents at scale 4, so two trailing zeros are divided out
+        rows[i * NUM_COLUMNS + 1] = i < 2 * CHUNK_ROWS ? (1000000 + random % 5000) * 100 : 10000000 + random % 5000;
+    }
+    ticks_file_t* handle = write_rows(path, 3);
+    CHECK(handle->header.schema.columns[1].scale == 4);
+    CHECK(handle->index.entries[0].columns[1].scale_shift == 2 && handle->index.entries[3].columns[1].scale_shift == 0);
+    CHECK(handle->index.entries[0].columns[0].scale_shift == 0 && handle->index.entries[0].columns[2].scale_shift == 0);
+    check_round_trip(handle, 3);
+    CHECK_OK(ticks_close(handle));
+    static double prices[NUM_ROWS];
+    CHECK_OK(ticks_decimal_to_double(&rows[1], NUM_COLUMNS, NUM_ROWS, 4, prices));
+    for (uint64_t i = 0; i < NUM_ROWS; i++)
+        CHECK(prices[i] == (double)rows[i * NUM_COLUMNS + 1] / 10000.0);
+    const uint64_t cents = 29;
+    CHECK_OK(ticks_decimal_to_double(&cents, 1, 1, 2, prices));
+    CHECK(prices[0] == 0.29);
+    CHECK(ticks_decimal_to_double(&cents, 1, 1, TICKS_MAX_DECIMAL_SCALE + 1, prices) == TICKS_ERROR_INVALID_ARGUMENTS);
+    ticks_header_t header;
+    test_header(&header, CHUNK_ROWS);
+    header.schema.columns[1].scale = TICKS_MAX_DECIMAL_SCALE + 1;
+    CHECK(ticks_new_file(path, &header, &handle) == TICKS_ERROR_INVALID_ARGUMENTS);
+
+    remove(path);
+    remove(csv_path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
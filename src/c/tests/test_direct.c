@@ -0,0 +1,169 @@
+#include "test_util.h"
+#include "ticksio/ticksio_alloc.h"
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_platform.h"
+
+#define NUM_ROWS 100000
+#define CHUNK_ROWS 2000
+#define STAGING_BYTES 4096
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+static uint64_t read_rows[NUM_ROWS * 3];
+
+// Helper function to read every row of a file in order and check them against the rows written
+static void check_rows(const char* path, uint64_t num_rows) {
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    ticks_iterator_t* iterator = NULL;
+    CHECK_OK(ticks_iterator_create(handle, 1600000000, 1600001000, &iterator));
+    uint64_t total = 0;
+    uint32_t num_records = 0;
+    ticks_status_e status;
+    while ((status = ticks_iterator_next_records(iterator, read_rows + total * 3, 1024, &num_records)) == TICKS_OK)
+        total += num_records;
+    CHECK(status == TICKS_EOF);
+    ticks_iterator_destroy(iterator);
+    CHECK_OK(ticks_close(handle));
+    CHECK(total == num_rows);
+    CHECK(memcmp(read_rows, rows, num_rows * 3 * sizeof(uint64_t)) == 0);
+}
+
+// Helper function to check every chunk starts on the alignment and its padding reaches the next one, returning how
+// many chunks were padded
+static uint32_t check_alignment(const char* path) {
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    uint32_t padded = 0;
+    for (uint32_t i = 0; i < handle->index.num_entries; i++) {
+        const ticks_index_entry_t* entry = &handle->index.entries[i];
+        CHECK(entry->chunk_offset % TICKS_DIRECT_ALIGNMENT == 0);
+        CHECK((entry->chunk_size + entry->padding) % TICKS_DIRECT_ALIGNMENT == 0);
+        CHECK(entry->padding < TICKS_DIRECT_ALIGNMENT);
+        // Checkpoints write their index between chunks, anywhere else the next chunk follows the padding
+        if (i + 1 < handle->index.num_entries)
+            CHECK(handle->index.entries[i + 1].chunk_offset >= entry->chunk_offset + entry->chunk_size + entry->padding);
+        padded += entry->padding != 0;
+    }
+    CHECK_OK(ticks_close(handle));
+    return padded;
+}
+
+// Helper function to create a file whose chunks are written direct with small staging buffers
+static ticks_file_t* new_direct_file(const char* path, ticks_durability_e durability) {
+    ticks_header_t header;
+    test_header(&header, CHUNK_ROWS);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    ticks_write_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.io_mode = TICKS_WRITE_DIRECT;
+    options.staging_bytes = STAGING_BYTES;
+    options.durability = durability;
+    options.group_commit_chunks = 4;
+    options.group_commit_ms = 5;
+    CHECK_OK(ticks_set_write_options(handle, &options));
+    return handle;
+}
+
+int main(void) {
+    const char* path = "test_direct.ticks";
+
+    // Volumes are spread wide, so each chunk encodes to more than one staging buffer
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i;
+        rows[i * 3 + 1] = 10000 + i % 977;
+        rows[i * 3 + 2] = i * 2654435761u % 1000003;
+    }
+
+    printf("--- Chunks larger than the staging buffers grow them ---\n");
+    ticks_file_t* handle = new_direct_file(path, TICKS_DURABILITY_NONE);
+    // Where the platform or filesystem refuses O_DIRECT on open the handle writes buffered, as documented
+    const int direct = direct_writer_active(&handle->direct);
+    printf("direct writes %s\n", direct ? "on" : "refused, buffered");
+    CHECK_OK(ticks_add_records(handle, rows, NUM_ROWS / 2));
+    if (direct)
+        CHECK(handle->direct.capacities[0] > STAGING_BYTES || handle->direct.capacities[1] > STAGING_BYTES);
+    CHECK_OK(ticks_add_records(handle, &rows[NUM_ROWS / 2 * 3], NUM_ROWS / 2));
+    CHECK_OK(ticks_close(handle));
+    check_rows(path, NUM_ROWS);
+
+    printf("--- Padding is recorded in the index ---\n");
+    if (direct)
+        CHECK(check_alignment(path) > 0);
+
+    printf("--- Reopened files continue direct after the footer ---\n");
+    CHECK_OK(ticks_open_write(path, &handle));
+    ticks_write_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.io_mode = TICKS_WRITE_DIRECT;
+    options.staging_bytes = STAGING_BYTES;
+    CHECK_OK(ticks_set_write_options(handle, &options));
+    CHECK(direct_writer_active(&handle->direct) == direct);
+    CHECK_OK(ticks_close(handle));
+    check_rows(path, NUM_ROWS);
+    if (direct)
+        check_alignment(path);
+
+    printf("--- Direct writes with group checkpoints ---\n");
+    handle = new_direct_file(path, TICKS_DURABILITY_GROUP);
+    for (uint64_t i = 0; i < NUM_ROWS; i += CHUNK_ROWS) {
+        CHECK_OK(ticks_add_records(handle, &rows[i * 3], CHUNK_ROWS));
+        // Pauses give the background thread time to checkpoint between staged chunks
+        if (i / CHUNK_ROWS % 8 == 7)
+            sleep_ms_portable(10);
+    }
+    // Wait for the background thread to checkpoint every chunk, a reader then sees all of them before close
+    ticks_file_t* reader = NULL;
+    for (int attempt = 0; attempt < 500; attempt++) {
+        // Before the first checkpoint there is no index to open
+        const ticks_status_e status = ticks_open_read(path, &reader);
+        CHECK(status == TICKS_OK || status == TICKS_ERROR_INVALID_FORMAT);
+        if (status != TICKS_OK) {
+            sleep_ms_portable(10);
+            continue;
+        }
+        const uint32_t num_entries = reader->index.num_entries;
+        CHECK(test_count_range(reader, 1600000000, 1600001000) == (uint64_t)num_entries * CHUNK_ROWS);
+        CHECK_OK(ticks_close(reader));
+        if (num_entries == NUM_ROWS / CHUNK_ROWS)
+            break;
+        sleep_ms_portable(10);
+    }
+    check_rows(path, NUM_ROWS);
+    CHECK_OK(ticks_close(handle));
+    check_rows(path, NUM_ROWS);
+    if (direct)
+        CHECK(check_alignment(path) > 0);
+
+    printf("--- Writes refused with EINVAL continue buffered ---\n");
+    FILE* file = fopen(path, "w+b");
+    CHECK(file != NULL);
+    direct_writer_t writer;
+    writer.fd = -1;
+    if (direct_writer_open(&writer, file, 0, STAGING_BYTES, mem_global_allocator()) == TICKS_OK) {
+        // O_DIRECT refuses offsets off the device's block size, like filesystems that refuse it altogether
+        writer.offset = 100;
+        static const uint8_t data[1000] = {1, 2, 3};
+        uint64_t offset = 0;
+        uint32_t padding = 0;
+        CHECK_OK(direct_writer_stage(&writer, data, sizeof(data), &offset, &padding));
+        CHECK(offset == 100 && padding == TICKS_DIRECT_ALIGNMENT - sizeof(data));
+        CHECK_OK(direct_writer_flush(&writer));
+        CHECK(writer.buffered);
+        // The descriptor stays buffered, later writes succeed without O_DIRECT
+        CHECK_OK(direct_writer_stage(&writer, data, sizeof(data), &offset, &padding));
+        CHECK(offset == 100 + TICKS_DIRECT_ALIGNMENT);
+        CHECK_OK(direct_writer_close(&writer));
+
+        uint8_t read_back[sizeof(data)];
+        CHECK(fseek(file, (long)offset, SEEK_SET) == 0);
+        CHECK(fread(read_back, 1, sizeof(read_back), file) == sizeof(read_back));
+        CHECK(memcmp(read_back, data, sizeof(data)) == 0);
+    }
+    fclose(file);
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
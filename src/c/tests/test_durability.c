@@ -0,0 +1,207 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_platform.h"
+
+#define NUM_ROWS 100000
+#define CHUNK_ROWS 100
+#define NUM_CHUNKS 200
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+static uint64_t checkpoint_sizes[NUM_CHUNKS];
+
+static uint64_t file_size(const char* path) {
+    FILE* file = fopen(path, "rb");
+    CHECK(file != NULL);
+    CHECK(fseek(file, 0, SEEK_END) == 0);
+    const long size = ftell(file);
+    fclose(file);
+    return (uint64_t)size;
+}
+
+// Helper function to copy the first length bytes of a file, standing in for what a crash left on disk
+static void copy_prefix(const char* from, const char* to, uint64_t length) {
+    FILE* in = fopen(from, "rb");
+    FILE* out = fopen(to, "wb");
+    CHECK(in != NULL && out != NULL);
+    static uint8_t buffer[65536];
+    while (length > 0) {
+        const size_t size = length < sizeof(buffer) ? (size_t)length : sizeof(buffer);
+        CHECK(fread(buffer, 1, size, in) == size);
+        CHECK(fwrite(buffer, 1, size, out) == size);
+        length -= size;
+    }
+    fclose(in);
+    fclose(out);
+}
+
+// Helper function to open a crashed copy and return how many whole chunks it recovered, -1 if it does not open.
+// Whatever is recovered must be the rows written first, in full chunks.
+static int recovered_chunks(const char* path) {
+    ticks_file_t* handle = NULL;
+    const ticks_status_e status = ticks_open_read(path, &handle);
+    if (status != TICKS_OK) {
+        CHECK(status == TICKS_ERROR_INVALID_FORMAT);
+        return -1;
+    }
+    const uint32_t num_entries = handle->index.num_entries;
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == (uint64_t)num_entries * CHUNK_ROWS);
+    if (num_entries > 0)
+        CHECK(handle->index.entries[num_entries - 1].chunk_max_time == BASE_MS + (uint64_t)num_entries * CHUNK_ROWS - 1);
+    CHECK_OK(ticks_close(handle));
+    return (int)num_entries;
+}
+
+// Helper function to create a file whose writer checkpoints in the given mode
+static ticks_file_t* new_durable_file(const char* path, ticks_durability_e durability) {
+    ticks_header_t header;
+    test_header(&header, CHUNK_ROWS);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    ticks_write_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.durability = durability;
+    options.group_commit_chunks = 4;
+    options.group_commit_ms = 5;
+    CHECK_OK(ticks_set_write_options(handle, &options));
+    return handle;
+}
+
+int main(void) {
+    const char* path = "test_durability.ticks";
+    const char* crashed_path = "test_durability_crashed.ticks";
+    const char* snapshot_path = "test_durability_snapshot.ticks";
+
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i;
+        rows[i * 3 + 1] = 10000 + i % 977;
+        rows[i * 3 + 2] = i % 13;
+    }
+
+    printf("--- Strict checkpoints, followed while written ---\n");
+    ticks_file_t* writer = new_durable_file(path, TICKS_DURABILITY_STRICT);
+    CHECK_OK(ticks_add_records(writer, rows, CHUNK_ROWS));
+    checkpoint_sizes[0] = file_size(path);
+    ticks_open_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.follow = 1;
+    ticks_file_t* follower = NULL;
+    CHECK_OK(ticks_open_read_ex(path, &options, &follower));
+    options.index_mode = TICKS_INDEX_MMAP;
+    ticks_file_t* mapped = NULL;
+    CHECK_OK(ticks_open_read_ex(path, &options, &mapped));
+    CHECK(follower->index.num_entries == 1 && mapped->index.num_entries == 1);
+    for (uint32_t chunk = 1; chunk < NUM_CHUNKS; chunk++) {
+        CHECK_OK(ticks_add_records(writer, &rows[(uint64_t)chunk * CHUNK_ROWS * 3], CHUNK_ROWS));
+        checkpoint_sizes[chunk] = file_size(path);
+        uint32_t new_chunks = 0;
+        CHECK_OK(ticks_refresh(follower, &new_chunks));
+        CHECK(new_chunks == 1 && follower->index.num_entries == chunk + 1);
+        if (chunk % 50 == 0) {
+            CHECK_OK(ticks_refresh(mapped, &new_chunks));
+            CHECK(mapped->index.num_entries == chunk + 1);
+            CHECK(test_count_range(mapped, 1600000000, 1600001000) == (uint64_t)(chunk + 1) * CHUNK_ROWS);
+        }
+    }
+    CHECK(test_count_range(follower, 1600000000, 1600001000) == (uint64_t)NUM_CHUNKS * CHUNK_ROWS);
+    CHECK_OK(ticks_close(mapped));
+    CHECK_OK(ticks_close(follower));
+
+    printf("--- Strict crash recovery ---\n");
+    ticks_header_t header;
+    CHECK_OK(ticks_get_header(writer, &header));
+    CHECK(header.flags & TICKS_HEADER_CHECKPOINTS);
+    for (uint32_t chunk = 0; chunk < NUM_CHUNKS; chunk++) {
+        copy_prefix(path, crashed_path, checkpoint_sizes[chunk]);
+        CHECK(recovered_chunks(crashed_path) == (int)chunk + 1);
+        copy_prefix(path, crashed_path, checkpoint_sizes[chunk] - 1);
+        CHECK(recovered_chunks(crashed_path) == (chunk > 0 ? (int)chunk : -1));
+    }
+
+    CHECK_OK(ticks_close(writer));
+    CHECK(recovered_chunks(path) == NUM_CHUNKS);
+
+    // Appending after a crash continues from the recovered prefix
+    copy_prefix(path, crashed_path, checkpoint_sizes[50] - 1);
+    CHECK_OK(ticks_open_write(crashed_path, &writer));
+    CHECK_OK(ticks_add_records(writer, &rows[50 * CHUNK_ROWS * 3], 10 * CHUNK_ROWS));
+    CHECK_OK(ticks_close(writer));
+    CHECK(recovered_chunks(crashed_path) == 60);
+
+    // Checkpoints of a reopened file chain back to the footer written on close
+    CHECK_OK(ticks_open_write(crashed_path, &writer));
+    ticks_write_options_t write_options;
+    memset(&write_options, 0, sizeof(write_options));
+    write_options.durability = TICKS_DURABILITY_STRICT;
+    CHECK_OK(ticks_set_write_options(writer, &write_options));
+    for (uint32_t chunk = 60; chunk < 63; chunk++) {
+        CHECK_OK(ticks_add_records(writer, &rows[(uint64_t)chunk * CHUNK_ROWS * 3], CHUNK_ROWS));
+        checkpoint_sizes[chunk - 60] = file_size(crashed_path);
+    }
+    for (uint32_t chunk = 0; chunk < 3; chunk++) {
+        copy_prefix(crashed_path, snapshot_path, checkpoint_sizes[chunk] - 1);
+        CHECK(recovered_chunks(snapshot_path) == 60 + (int)chunk);
+    }
+    CHECK_OK(ticks_close(writer));
+    CHECK(recovered_chunks(crashed_path) == 63);
+
+    printf("--- Group commit crash recovery ---\n");
+    writer = new_durable_file(path, TICKS_DURABILITY_GROUP);
+    for (uint32_t chunk = 0; chunk < NUM_CHUNKS; chunk++) {
+        CHECK_OK(ticks_add_records(writer, &rows[(uint64_t)chunk * CHUNK_ROWS * 3], CHUNK_ROWS));
+        // Pauses give the background thread time to checkpoint along the way
+        if (chunk % 8 == 7)
+            sleep_ms_portable(10);
+    }
+    // Wait for the background thread to checkpoint the last chunks
+    for (int attempt = 0; attempt < 500; attempt++) {
+        copy_prefix(path, snapshot_path, file_size(path));
+        if (recovered_chunks(snapshot_path) == NUM_CHUNKS)
+            break;
+        sleep_ms_portable(10);
+    }
+    const uint64_t group_size = file_size(snapshot_path);
+    CHECK(recovered_chunks(snapshot_path) == NUM_CHUNKS);
+    int previous = -1;
+    int partial = 0;
+    for (uint64_t length = 0; length <= group_size; length += group_size / 97 + 1) {
+        copy_prefix(snapshot_path, crashed_path, length);
+        const int chunks = recovered_chunks(crashed_path);
+        CHECK(chunks >= previous);
+        partial += chunks > 0 && chunks < NUM_CHUNKS;
+        previous = chunks;
+    }
+    CHECK(partial > 0);
+    CHECK_OK(ticks_close(writer));
+
+    printf("--- Checkpoints grow the file linearly ---\n");
+    test_write_file(path, rows, NUM_ROWS, CHUNK_ROWS);
+    const uint64_t none_size = file_size(path);
+    writer = new_durable_file(path, TICKS_DURABILITY_STRICT);
+    for (uint64_t i = 0; i < NUM_ROWS; i += CHUNK_ROWS)
+        CHECK_OK(ticks_add_records(writer, &rows[i * 3], CHUNK_ROWS));
+    const uint64_t strict_size = file_size(path);
+    CHECK_OK(ticks_close(writer));
+    printf("none: %llu bytes, strict before close: %llu bytes\n", (unsigned long long)none_size, (unsigned long long)strict_size);
+    CHECK(strict_size < 2 * none_size);
+
+    printf("--- Files never checkpointed are not searched ---\n");
+    test_write_file(path, rows, NUM_ROWS, CHUNK_ROWS);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK_OK(ticks_get_header(handle, &header));
+    CHECK((header.flags & TICKS_HEADER_CHECKPOINTS) == 0);
+    CHECK_OK(ticks_close(handle));
+    FILE* file = fopen(path, "ab");
+    CHECK(file != NULL);
+    static const uint8_t garbage[4096] = {1};
+    CHECK(fwrite(garbage, 1, sizeof(garbage), file) == sizeof(garbage));
+    fclose(file);
+    CHECK(ticks_open_read(path, &handle) == TICKS_ERROR_INVALID_FORMAT);
+
+    remove(path);
+    remove(crashed_path);
+    remove(snapshot_path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+
+#define NUM_CHUNKS 20
+#define CHUNK_ROWS 100
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_CHUNKS * CHUNK_ROWS * 3];
+static uint64_t checkpoint_sizes[NUM_CHUNKS];
+
+static uint64_t file_size(const char* path) {
+    FILE* file = fopen(path, "rb");
+    CHECK(file != NULL);
+    CHECK(fseek(file, 0, SEEK_END) == 0);
+    const long size = ftell(file);
+    fclose(file);
+    return (uint64_t)size;
+}
+
+// Helper function to append bytes [from, to) of one file to another, as a writer would have written them
+static void append_bytes(const char* source, const char* path, uint64_t from, uint64_t to) {
+    FILE* in = fopen(source, "rb");
+    FILE* out = fopen(path, "ab");
+    CHECK(in != NULL && out != NULL);
+    CHECK(fseek(in, (long)from, SEEK_SET) == 0);
+    static uint8_t buffer[65536];
+    while (from < to) {
+        const size_t size = to - from < sizeof(buffer) ? (size_t)(to - from) : sizeof(buffer);
+        CHECK(fread(buffer, 1, size, in) == size);
+        CHECK(fwrite(buffer, 1, size, out) == size);
+        from += size;
+    }
+    fclose(in);
+    fclose(out);
+}
+
+// Helper function to read everything a follower returns without waiting, checking the rows arrive in order
+static uint64_t follow_rows(ticks_follower_t* follower, uint64_t expected_first) {
+    uint64_t buffer[256 * 3];
+    uint64_t total = 0;
+    uint32_t num_rows = 0;
+    ticks_status_e status;
+    while ((status = ticks_follow_next(follower, buffer, 256, &num_rows, 0)) == TICKS_OK) {
+        for (uint32_t i = 0; i < num_rows; i++)
+            CHECK(buffer[i * 3] == BASE_MS + expected_first + total + i);
+        total += num_rows;
+    }
+    CHECK(status == TICKS_EOF);
+    return total;
+}
+
+int main(void) {
+    const char* path = "test_follow.ticks";
+    const char* source_path = "test_follow_source.ticks";
+
+    for (uint64_t i = 0; i < NUM_CHUNKS * CHUNK_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i;
+        rows[i * 3 + 1] = 10000 + i % 977;
+        rows[i * 3 + 2] = i % 13;
+    }
+
+    printf("--- Following from before the first commit ---\n");
+    ticks_header_t header;
+    test_header(&header, CHUNK_ROWS);
+    ticks_file_t* writer = NULL;
+    CHECK_OK(ticks_new_file(source_path, &header, &writer));
+    ticks_follower_t* follower = NULL;
+    CHECK_OK(ticks_follow_open(source_path, NULL, &follower));
+    ticks_header_t followed_header;
+    CHECK_OK(ticks_get_header(ticks_follow_handle(follower), &followed_header));
+    CHECK(followed_header.schema.num_columns == 3 && followed_header.chunk_policy.max_chunk_rows == CHUNK_ROWS);
+    CHECK(follow_rows(follower, 0) == 0);
+    ticks_write_options_t write_options;
+    memset(&write_options, 0, sizeof(write_options));
+    write_options.durability = TICKS_DURABILITY_STRICT;
+    CHECK_OK(ticks_set_write_options(writer, &write_options));
+    for (uint32_t chunk = 0; chunk < NUM_CHUNKS; chunk++) {
+        CHECK_OK(ticks_add_records(writer, &rows[(uint64_t)chunk * CHUNK_ROWS * 3], CHUNK_ROWS));
+        checkpoint_sizes[chunk] = file_size(source_path);
+        CHECK(follow_rows(follower, (uint64_t)chunk * CHUNK_ROWS) == CHUNK_ROWS);
+    }
+    CHECK_OK(ticks_close(writer));
+    CHECK(follow_rows(follower, NUM_CHUNKS * CHUNK_ROWS) == 0);
+    CHECK_OK(ticks_follow_close(follower));
+
+    printf("--- Following from before the header is complete ---\n");
+    FILE* file = fopen(path, "wb");
+    CHECK(file != NULL);
+    fclose(file);
+    CHECK_OK(ticks_follow_open(path, NULL, &follower));
+    ticks_file_t* handle = ticks_follow_handle(follower);
+    CHECK(follow_rows(follower, 0) == 0);
+    append_bytes(source_path, path, 0, 100);
+    CHECK(follow_rows(follower, 0) == 0);
+    append_bytes(source_path, path, 100, checkpoint_sizes[0] - 1);
+    CHECK(follow_rows(follower, 0) == 0);
+    CHECK_OK(ticks_get_header(handle, &followed_header));
+    CHECK(followed_header.schema.num_columns == 3);
+    append_bytes(source_path, path, checkpoint_sizes[0] - 1, checkpoint_sizes[5]);
+    CHECK(follow_rows(follower, 0) == 6 * CHUNK_ROWS);
+    append_bytes(source_path, path, checkpoint_sizes[5], file_size(source_path));
+    CHECK(follow_rows(follower, 6 * CHUNK_ROWS) == (NUM_CHUNKS - 6) * CHUNK_ROWS);
+    CHECK_OK(ticks_follow_close(follower));
+
+    printf("--- A short file that is not a ticks file ---\n");
+    file = fopen(path, "wb");
+    CHECK(file != NULL);
+    CHECK(fwrite("TIC", 1, 3, file) == 3);
+    fclose(file);
+    CHECK_OK(ticks_follow_open(path, NULL, &follower));
+    CHECK_OK(ticks_follow_close(follower));
+    CHECK(ticks_open_read(path, &handle) == TICKS_ERROR_INVALID_FORMAT);
+    file = fopen(path, "wb");
+    CHECK(file != NULL);
+    CHECK(fwrite("TOCK", 1, 4, file) == 4);
+    fclose(file);
+    CHECK(ticks_follow_open(path, NULL, &follower) == TICKS_ERROR_INVALID_FORMAT);
+
+    remove(path);
+    remove(source_path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
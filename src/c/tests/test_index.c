@@ -0,0 +1,99 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_index.h"
+
+#define NUM_ROWS 300000
+#define CHUNK_ROWS 100
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+
+static int same_entry(const ticks_index_entry_t* a, const ticks_index_entry_t* b, uint32_t num_columns) {
+    if (a->chunk_time_base != b->chunk_time_base || a->chunk_max_time != b->chunk_max_time ||
+        a->chunk_offset != b->chunk_offset || a->chunk_size != b->chunk_size || a->checksum != b->checksum ||
+        a->num_records != b->num_records || a->padding != b->padding)
+        return 0;
+    for (uint32_t c = 0; c < num_columns; c++) {
+        const ticks_column_chunk_t* x = &a->columns[c];
+        const ticks_column_chunk_t* y = &b->columns[c];
+        if (x->base != y->base || x->max != y->max || x->offset != y->offset || x->size != y->size ||
+            x->checksum != y->checksum || x->width != y->width || x->codec != y->codec || x->scale_shift != y->scale_shift)
+            return 0;
+    }
+    return 1;
+}
+
+int main(void) {
+    const char* path = "test_index.ticks";
+
+    uint64_t state = 7;
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        rows[i * 3] = BASE_MS + i;
+        // Alternate between whole prices, which get a scale shift, and prices using every decimal place
+        rows[i * 3 + 1] = (i / 5000) % 2 ? (100000 + state % 5000) * 100 : 10000000 + state % 500000;
+        rows[i * 3 + 2] = state % (1ULL << ((i / 300) % 40));
+    }
+    test_write_file(path, rows, NUM_ROWS, CHUNK_ROWS);
+
+    printf("--- Packed index round trip ---\n");
+    ticks_file_t* loaded = NULL;
+    CHECK_OK(ticks_open_read(path, &loaded));
+    CHECK(loaded->index.num_entries == NUM_ROWS / CHUNK_ROWS);
+    uint64_t index_size = 0;
+    CHECK_OK(ticks_get_index_size(loaded, &index_size));
+    CHECK(index_size % 8 == 0);
+    CHECK(index_size < (uint64_t)loaded->index.num_entries * sizeof(ticks_index_entry_t) / 2);
+    printf("%u entries in %llu bytes\n", loaded->index.num_entries, (unsigned long long)index_size);
+
+    uint32_t shifted = 0;
+    for (uint32_t i = 0; i < loaded->index.num_entries; i++) {
+        const ticks_index_entry_t* entry = &loaded->index.entries[i];
+        CHECK(entry->num_records == CHUNK_ROWS);
+        CHECK(entry->chunk_time_base == BASE_MS + (uint64_t)i * CHUNK_ROWS);
+        CHECK(entry->chunk_max_time == entry->chunk_time_base + CHUNK_ROWS - 1);
+        shifted += entry->columns[1].scale_shift != 0;
+    }
+    CHECK(shifted > 0);
+
+    printf("--- Lazy mmap block decode ---\n");
+    ticks_open_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.index_mode = TICKS_INDEX_MMAP;
+    ticks_file_t* mapped = NULL;
+    CHECK_OK(ticks_open_read_ex(path, &options, &mapped));
+    CHECK(mapped->decoded_blocks != NULL);
+    CHECK(mapped->index.num_entries == loaded->index.num_entries);
+    for (uint32_t b = 0; b < mapped->index.num_sparse; b++)
+        CHECK(mapped->decoded_blocks[b] == 0);
+
+    // One second in the middle of the file decodes only the block holding it
+    CHECK(test_count_range(mapped, 1600000250, 1600000251) == 1000);
+    uint32_t decoded = 0;
+    for (uint32_t b = 0; b < mapped->index.num_sparse; b++)
+        decoded += mapped->decoded_blocks[b];
+    CHECK(decoded == 1);
+
+    for (uint32_t i = 0; i < mapped->index.num_entries; i++)
+        CHECK(same_entry(index_entry(mapped, i), &loaded->index.entries[i], 3));
+    CHECK(test_count_range(mapped, 1600000000, 1600000300) == NUM_ROWS);
+    CHECK_OK(ticks_close(mapped));
+
+    printf("--- Corrupt index is rejected ---\n");
+    const uint64_t index_offset = loaded->index_offset;
+    CHECK_OK(ticks_close(loaded));
+    FILE* file = fopen(path, "rb+");
+    CHECK(file != NULL);
+    CHECK(fseek(file, (long)(index_offset + index_size / 2), SEEK_SET) == 0);
+    int byte = fgetc(file);
+    CHECK(fseek(file, (long)(index_offset + index_size / 2), SEEK_SET) == 0);
+    fputc(byte ^ 0x5A, file);
+    fclose(file);
+    CHECK(ticks_open_read(path, &loaded) != TICKS_OK);
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
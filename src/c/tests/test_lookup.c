@@ -0,0 +1,89 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_index.h"
+
+#define NUM_ROWS 20000
+
+static uint64_t rows[NUM_ROWS * 3];
+
+static ticks_status_e count_batch(const uint64_t* batch, uint32_t num_rows, void* user) {
+    (void)batch;
+    *(uint64_t*)user += num_rows;
+    return TICKS_OK;
+}
+
+// Helper function to check the iterator, scan and aggregate all see the records of [from, to) seconds
+static void check_range(ticks_file_t* handle, const uint64_t* data, uint64_t num_rows, time_t from, time_t to) {
+    uint64_t expected = 0;
+    for (uint64_t i = 0; i < num_rows; i++)
+        expected += data[i * 3] >= (uint64_t)from * 1000 && data[i * 3] < (uint64_t)to * 1000;
+
+    CHECK(test_count_range(handle, from, to) == expected);
+    uint64_t scanned = 0;
+    CHECK_OK(ticks_scan(handle, from, to, count_batch, &scanned));
+    CHECK(scanned == expected);
+    ticks_aggregate_t aggregate;
+    CHECK_OK(ticks_aggregate(handle, from, to, 2, &aggregate));
+    CHECK(aggregate.count == expected);
+}
+
+int main(void) {
+    const char* path = "test_lookup.ticks";
+    ticks_open_options_t options;
+    memset(&options, 0, sizeof(options));
+
+    printf("--- Timestamp shared by two chunks ---\n");
+    const uint64_t boundary[] = {500, 600, 700, 1000, 1000, 1000, 1500, 2000};
+    for (uint32_t i = 0; i < 8; i++) {
+        rows[i * 3] = boundary[i];
+        rows[i * 3 + 1] = 10000;
+        rows[i * 3 + 2] = 1;
+    }
+    test_write_file(path, rows, 8, 4);
+    for (int mode = TICKS_INDEX_LOAD; mode <= TICKS_INDEX_MMAP; mode++) {
+        options.index_mode = mode;
+        ticks_file_t* handle = NULL;
+        CHECK_OK(ticks_open_read_ex(path, &options, &handle));
+        CHECK(handle->index.num_entries == 2);
+        CHECK(find_chunk_for_time(handle, 1000) == 0);
+        CHECK(find_chunk_for_time(handle, 1001) == 1);
+        CHECK(find_chunk_for_time(handle, 0) == 0);
+        check_range(handle, rows, 8, 1, 3);
+        check_range(handle, rows, 8, 0, 1);
+        check_range(handle, rows, 8, 2, 3);
+        CHECK_OK(ticks_close(handle));
+    }
+
+    printf("--- Runs of equal timestamps across many chunks ---\n");
+    // Every timestamp repeats between 1 and 40 times so runs span chunk and sparse block boundaries
+    uint64_t state = 11;
+    uint64_t ms_since_epoch = 1000;
+    for (uint64_t i = 0; i < NUM_ROWS;) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        const uint64_t run = 1 + state % 40;
+        for (uint64_t r = 0; r < run && i < NUM_ROWS; r++, i++) {
+            rows[i * 3] = ms_since_epoch;
+            rows[i * 3 + 1] = 10000 + i;
+            rows[i * 3 + 2] = 1;
+        }
+        // Land on whole seconds often, where range queries start
+        ms_since_epoch += state % 3 == 0 ? 1000 - ms_since_epoch % 1000 : 1 + state % 250;
+    }
+    test_write_file(path, rows, NUM_ROWS, 7);
+    const time_t last_second = (time_t)(rows[(NUM_ROWS - 1) * 3] / 1000) + 1;
+    for (int mode = TICKS_INDEX_LOAD; mode <= TICKS_INDEX_MMAP; mode++) {
+        options.index_mode = mode;
+        ticks_file_t* handle = NULL;
+        CHECK_OK(ticks_open_read_ex(path, &options, &handle));
+        CHECK(handle->index.num_entries > 2 * TICKS_SPARSE_INDEX_STRIDE);
+        for (time_t from = 0; from <= last_second; from++)
+            check_range(handle, rows, NUM_ROWS, from, from + 1 + from % 3);
+        CHECK_OK(ticks_close(handle));
+    }
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
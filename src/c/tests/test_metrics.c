@@ -0,0 +1,103 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+
+#define NUM_ROWS 20000
+#define CHUNK_ROWS 1000
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+
+// Helper function to read every row through an iterator with the given options
+static uint64_t count_with_options(ticks_file_t* handle, const ticks_iterator_options_t* options) {
+    ticks_iterator_t* iterator = NULL;
+    CHECK_OK(ticks_iterator_create_ex(handle, 1600000000, 1600001000, options, &iterator));
+    uint64_t buffer[1024 * 3];
+    uint64_t total = 0;
+    uint32_t num_records = 0;
+    ticks_status_e status;
+    while ((status = ticks_iterator_next_records(iterator, buffer, 1024, &num_records)) == TICKS_OK)
+        total += num_records;
+    CHECK(status == TICKS_EOF);
+    ticks_iterator_destroy(iterator);
+    return total;
+}
+
+int main(void) {
+    const char* path = "test_metrics.ticks";
+
+    // Prices repeat in runs and volumes take few distinct wide values, so both value codecs are used
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i;
+        rows[i * 3 + 1] = 10000 + (i / 50) % 7 * 1000;
+        rows[i * 3 + 2] = 1000000 + i % 13 * 100000;
+    }
+
+    printf("--- Writing moves the write counters ---\n");
+    ticks_header_t header;
+    test_header(&header, CHUNK_ROWS);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    ticks_reorder_options_t reorder;
+    memset(&reorder, 0, sizeof(reorder));
+    reorder.window_rows = 100;
+    CHECK_OK(ticks_set_reorder_window(handle, &reorder));
+    CHECK_OK(ticks_add_records(handle, rows, NUM_ROWS));
+    // Older than everything the window already let through
+    CHECK_OK(ticks_add_records(handle, rows, 1));
+    ticks_metrics_t metrics;
+    CHECK_OK(ticks_get_metrics(handle, &metrics));
+    CHECK(metrics.bytes_written > 0);
+    CHECK(metrics.chunks_written > 0);
+    CHECK(metrics.rows_encoded > 0);
+    CHECK(metrics.encode_ns > 0);
+    CHECK(metrics.io_ns > 0);
+    CHECK(metrics.compression_ns > 0);
+    CHECK(metrics.compression_ns <= metrics.encode_ns);
+    CHECK(metrics.late_ticks == 1);
+    CHECK_OK(ticks_close(handle));
+
+    printf("--- Reading moves the read counters ---\n");
+    CHECK_OK(ticks_cache_set_budget(64u << 20));
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(handle->index.entries[0].columns[1].codec == TICKS_CODEC_RLE);
+    CHECK(handle->index.entries[0].columns[2].codec == TICKS_CODEC_DICT);
+    // The reorder window hands rows on in batches, which may end chunks early
+    const uint64_t num_chunks = handle->index.num_entries;
+    CHECK(count_with_options(handle, NULL) == NUM_ROWS);
+    CHECK_OK(ticks_get_metrics(handle, &metrics));
+    CHECK(metrics.bytes_read > 0);
+    CHECK(metrics.chunks_read == num_chunks);
+    CHECK(metrics.rows_decoded == NUM_ROWS);
+    CHECK(metrics.decode_ns > 0);
+    CHECK(metrics.io_ns > 0);
+    CHECK(metrics.checksum_ns > 0);
+    CHECK(metrics.compression_ns > 0);
+    CHECK(metrics.compression_ns <= metrics.decode_ns);
+    CHECK(metrics.index_lookups > 0);
+    CHECK(metrics.cache_misses == num_chunks);
+    CHECK(metrics.cache_hits == 0);
+    CHECK(metrics.chunks_skipped == 0);
+    CHECK(metrics.bytes_written == 0);
+
+    // The second pass is served from the cache
+    CHECK(count_with_options(handle, NULL) == NUM_ROWS);
+    CHECK_OK(ticks_get_metrics(handle, &metrics));
+    CHECK(metrics.cache_hits == num_chunks);
+    CHECK(metrics.chunks_read == num_chunks);
+    CHECK_OK(ticks_cache_set_budget(0));
+
+    printf("--- Predicates ruling out chunks move the skip counter ---\n");
+    ticks_predicate_t predicate = {.column = 1, .min = 100000, .max = 200000};
+    ticks_iterator_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.predicates = &predicate;
+    options.num_predicates = 1;
+    CHECK(count_with_options(handle, &options) == 0);
+    CHECK_OK(ticks_get_metrics(handle, &metrics));
+    CHECK(metrics.chunks_skipped == num_chunks);
+    CHECK_OK(ticks_close(handle));
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
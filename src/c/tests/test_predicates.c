@@ -0,0 +1,182 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+
+#define NUM_ROWS 200000
+#define CHUNK_ROWS 50000
+#define NUM_COLUMNS 4
+#define BASE_MS 1600000000000ULL
+#define FROM 1600000000
+#define TO 1600000400
+
+static uint64_t rows[NUM_ROWS * NUM_COLUMNS];
+static uint64_t expected[NUM_ROWS * NUM_COLUMNS];
+static uint64_t actual[NUM_ROWS * NUM_COLUMNS];
+static ticks_schema_t schema;
+
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Helper function to write the rows with the given schema columns and reopen the file for reading
+static ticks_file_t* write_rows(const char* path, uint8_t num_columns) {
+    ticks_header_t header;
+    test_header(&header, CHUNK_ROWS);
+    header.schema = schema;
+    header.schema.num_columns = num_columns;
+    // Records are packed rows of the schema's columns
+    for (uint64_t i = 0; i < NUM_ROWS; i++)
+        memcpy(&expected[i * num_columns], &rows[i * NUM_COLUMNS], num_columns * sizeof(uint64_t));
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    CHECK_OK(ticks_add_records(handle, expected, NUM_ROWS));
+    CHECK_OK(ticks_close(handle));
+    CHECK_OK(ticks_open_read(path, &handle));
+    return handle;
+}
+
+static int matches(const uint64_t* row, const ticks_predicate_t* predicates, uint32_t num_predicates) {
+    for (uint32_t i = 0; i < num_predicates; i++) {
+        const uint64_t value = row[predicates[i].column];
+        if (schema.columns[predicates[i].column].type == TICKS_COLUMN_INT) {
+            if ((int64_t)value < (int64_t)predicates[i].min || (int64_t)value > (int64_t)predicates[i].max)
+                return 0;
+        } else if (value < predicates[i].min || value > predicates[i].max) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+typedef struct {
+    uint64_t* out;
+    uint64_t num_values;
+    uint32_t stride;
+} scan_context_t;
+
+static ticks_status_e collect(const uint64_t* records, uint32_t num_records, void* user) {
+    scan_context_t* context = user;
+    memcpy(&context->out[context->num_values], records, (size_t)num_records * context->stride * sizeof(uint64_t));
+    context->num_values += (uint64_t)num_records * context->stride;
+    return TICKS_OK;
+}
+
+// Helper function to check a scan and an iterator with predicates and a column mask return what filtering the rows
+// by hand does
+static void check_predicates(ticks_file_t* handle, time_t from, time_t to, uint32_t column_mask,
+                             const ticks_predicate_t* predicates, uint32_t num_predicates) {
+    const uint32_t columns = column_mask != 0 ? column_mask | 1 : (1u << NUM_COLUMNS) - 1;
+    uint32_t stride = 0;
+    for (uint32_t c = 0; c < NUM_COLUMNS; c++)
+        stride += (columns >> c) & 1;
+    uint64_t num_values = 0;
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        const uint64_t* row = &rows[i * NUM_COLUMNS];
+        if (row[0] < (uint64_t)from * 1000 || row[0] >= (uint64_t)to * 1000 || !matches(row, predicates, num_predicates))
+            continue;
+        for (uint32_t c = 0; c < NUM_COLUMNS; c++)
+            if (columns & (1u << c))
+                expected[num_values++] = row[c];
+    }
+
+    ticks_iterator_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.column_mask = column_mask;
+    options.predicates = predicates;
+    options.num_predicates = num_predicates;
+    scan_context_t context = {actual, 0, stride};
+    CHECK_OK(ticks_scan_ex(handle, from, to, &options, collect, &context));
+    CHECK(context.num_values == num_values);
+    CHECK(memcmp(actual, expected, num_values * sizeof(uint64_t)) == 0);
+
+    ticks_iterator_t* iterator = NULL;
+    CHECK_OK(ticks_iterator_create_ex(handle, from, to, &options, &iterator));
+    uint64_t total = 0;
+    uint32_t num_records = 0;
+    ticks_status_e status;
+    while ((status = ticks_iterator_next_records(iterator, &actual[total * stride], 3000, &num_records)) == TICKS_OK)
+        total += num_records;
+    CHECK(status == TICKS_EOF);
+    ticks_iterator_destroy(iterator);
+    CHECK(total * stride == num_values);
+    CHECK(memcmp(actual, expected, num_values * sizeof(uint64_t)) == 0);
+}
+
+int main(void) {
+    const char* path = "test_predicates.ticks";
+
+    memset(&schema, 0, sizeof(schema));
+    schema.num_columns = NUM_COLUMNS;
+    strcpy(schema.columns[0].name, "ts");
+    schema.columns[0].type = TICKS_COLUMN_TIMESTAMP;
+    strcpy(schema.columns[1].name, "price");
+    schema.columns[1].type = TICKS_COLUMN_DECIMAL;
+    schema.columns[1].scale = 4;
+    strcpy(schema.columns[2].name, "volume");
+    schema.columns[2].type = TICKS_COLUMN_UINT;
+    strcpy(schema.columns[3].name, "delta");
+    schema.columns[3].type = TICKS_COLUMN_INT;
+
+    printf("--- Predicates and column masks ---\n");
+    uint64_t state = 99;
+    static const uint64_t lots[] = {100, 200, 500, 1000};
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        const uint64_t random = next_random(&state);
+        uint64_t* row = &rows[i * NUM_COLUMNS];
+        row[0] = BASE_MS + i;
+        const uint64_t segment = i / CHUNK_ROWS;
+        row[1] = segment % 2 ? (100000 + random % 5000) * 100 : 10000000 + random % 500000;
+        row[2] = segment == 0 ? lots[(random >> 9) % 4] : segment == 1 ? 100 + i / 4000 : random % 3000;
+        row[3] = (uint64_t)((int64_t)(random % 2001) - 1000);
+    }
+    // A few out-of-order timestamps within chunks
+    for (uint64_t i = 1000; i < NUM_ROWS; i += 997) {
+        const uint64_t ts = rows[i * NUM_COLUMNS];
+        rows[i * NUM_COLUMNS] = rows[(i - 3) * NUM_COLUMNS];
+        rows[(i - 3) * NUM_COLUMNS] = ts;
+    }
+    ticks_file_t* handle = write_rows(path, NUM_COLUMNS);
+    const ticks_predicate_t predicates[][2] = {
+        {{2, 10000, UINT64_MAX}},
+        {{2, 200, 500}},
+        {{1, 10100000, 10200000}},
+        {{1, 10100050, 10100099}}, // Within a chunk of whole cents, so no stored value matches
+        {{1, 10000000, 10300000}, {2, 150, 1000}},
+        {{3, (uint64_t)-50, 50}},
+        {{3, (uint64_t)-2000, (uint64_t)-1001}},
+        {{0, BASE_MS + 100000, BASE_MS + 150000}, {2, 0, 150}},
+        {{2, 107, 107}},
+    };
+    const uint32_t num_predicates[] = {1, 1, 1, 1, 2, 1, 1, 2, 1};
+    const uint32_t column_masks[] = {0, 0x3, 0x1, 0x9};
+    for (uint32_t p = 0; p < sizeof(num_predicates) / sizeof(num_predicates[0]); p++) {
+        for (uint32_t m = 0; m < sizeof(column_masks) / sizeof(column_masks[0]); m++) {
+            check_predicates(handle, FROM, TO, column_masks[m], predicates[p], num_predicates[p]);
+            check_predicates(handle, FROM + 37, FROM + 191, column_masks[m], predicates[p], num_predicates[p]);
+        }
+    }
+    ticks_metrics_t metrics;
+    CHECK_OK(ticks_get_metrics(handle, &metrics));
+    CHECK(metrics.chunks_skipped > 0);
+
+    ticks_iterator_options_t options;
+    memset(&options, 0, sizeof(options));
+    ticks_predicate_t invalid = {9, 0, 1};
+    options.predicates = &invalid;
+    options.num_predicates = 1;
+    scan_context_t context = {actual, 0, NUM_COLUMNS};
+    CHECK(ticks_scan_ex(handle, FROM, TO, &options, collect, &context) == TICKS_ERROR_INVALID_ARGUMENTS);
+    invalid.column = 2;
+    invalid.min = 5;
+    invalid.max = 4;
+    CHECK(ticks_scan_ex(handle, FROM, TO, &options, collect, &context) == TICKS_ERROR_INVALID_ARGUMENTS);
+    options.num_predicates = TICKS_MAX_PREDICATES + 1;
+    CHECK(ticks_scan_ex(handle, FROM, TO, &options, collect, &context) == TICKS_ERROR_INVALID_ARGUMENTS);
+    CHECK_OK(ticks_close(handle));
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
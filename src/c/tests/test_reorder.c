@@ -0,0 +1,119 @@
+#include "test_util.h"
+#include "ticksio/ticksio_internal.h"
+#include "ticksio/ticksio_index.h"
+
+#define NUM_ROWS 50000
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+
+// Helper function to check every chunk starts at or after the end of the chunk before it
+static void check_chunks_ordered(const char* path) {
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    for (uint32_t i = 1; i < handle->index.num_entries; i++)
+        CHECK(handle->index.entries[i].chunk_time_base >= handle->index.entries[i - 1].chunk_max_time);
+    CHECK_OK(ticks_close(handle));
+}
+
+// Helper function to write rows through a reorder window, returning the number of late ticks
+static uint64_t write_reordered(const char* path, const uint64_t* data, uint64_t num_rows, uint32_t max_chunk_rows,
+                                const ticks_reorder_options_t* options) {
+    ticks_header_t header;
+    test_header(&header, max_chunk_rows);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    CHECK_OK(ticks_set_reorder_window(handle, options));
+    for (uint64_t i = 0; i < num_rows; i += 1000)
+        CHECK_OK(ticks_add_records(handle, &data[i * 3], num_rows - i < 1000 ? num_rows - i : 1000));
+    ticks_metrics_t metrics;
+    CHECK_OK(ticks_get_metrics(handle, &metrics));
+    CHECK_OK(ticks_close(handle));
+    return metrics.late_ticks;
+}
+
+int main(void) {
+    const char* path = "test_reorder.ticks";
+    ticks_reorder_options_t options;
+    memset(&options, 0, sizeof(options));
+
+    printf("--- Late tick beyond the window ---\n");
+    for (uint64_t i = 0; i < 8; i++) {
+        rows[i * 3] = (i + 1) * 1000;
+        rows[i * 3 + 1] = 10000;
+        rows[i * 3 + 2] = 1;
+    }
+    rows[8 * 3] = 500;
+    rows[8 * 3 + 1] = 10000;
+    rows[8 * 3 + 2] = 1;
+    options.window_rows = 2;
+    CHECK(write_reordered(path, rows, 9, 4, &options) == 1);
+    check_chunks_ordered(path);
+
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(test_count_range(handle, 0, 1) == 0);
+    CHECK(test_count_range(handle, 1, 2) == 1);
+    CHECK(test_count_range(handle, 0, 100) == 8);
+    trade_data_t record;
+    uint8_t found = 0;
+    const uint64_t query = 600;
+    CHECK_OK(ticks_asof(handle, &query, 1, &record, &found));
+    CHECK(found == 0);
+    const uint64_t later_query = 4500;
+    CHECK_OK(ticks_asof(handle, &later_query, 1, &record, &found));
+    CHECK(found == 1 && record.ms_since_epoch == 4000);
+    CHECK_OK(ticks_close(handle));
+
+    printf("--- Jitter within the window ---\n");
+    uint64_t state = 12345;
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        rows[i * 3] = BASE_MS + i * 10 + state % 50;
+        rows[i * 3 + 1] = 10000 + i;
+        rows[i * 3 + 2] = 1;
+    }
+    memset(&options, 0, sizeof(options));
+    options.window_ms = 100;
+    CHECK(write_reordered(path, rows, NUM_ROWS, 1000, &options) == 0);
+    check_chunks_ordered(path);
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS);
+    uint64_t expected = 0;
+    for (uint64_t i = 0; i < NUM_ROWS; i++)
+        expected += rows[i * 3] >= 1600000200000ULL && rows[i * 3] < 1600000201000ULL;
+    CHECK(test_count_range(handle, 1600000200, 1600000201) == expected);
+    CHECK_OK(ticks_close(handle));
+
+    printf("--- Window too small for the jitter ---\n");
+    memset(&options, 0, sizeof(options));
+    options.window_rows = 1;
+    const uint64_t late = write_reordered(path, rows, NUM_ROWS, 1000, &options);
+    CHECK(late > 0);
+    check_chunks_ordered(path);
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS - late);
+    CHECK_OK(ticks_close(handle));
+
+    printf("--- Append behind the end of the file ---\n");
+    ticks_file_t* writer = NULL;
+    CHECK_OK(ticks_open_write(path, &writer));
+    options.window_rows = 16;
+    CHECK_OK(ticks_set_reorder_window(writer, &options));
+    uint64_t old_tick[3] = {BASE_MS, 10000, 1};
+    CHECK_OK(ticks_add_records(writer, old_tick, 1));
+    ticks_metrics_t metrics;
+    CHECK_OK(ticks_get_metrics(writer, &metrics));
+    CHECK(metrics.late_ticks == 1);
+    CHECK_OK(ticks_close(writer));
+    check_chunks_ordered(path);
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS - late);
+    CHECK_OK(ticks_close(handle));
+
+    remove(path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+#include "test_util.h"
+#include "ticksio/ticksio_platform.h"
+
+// Only built with the TICKSIO_TRACE option, which records the library's trace scopes
+
+#define NUM_ROWS 20000
+#define BASE_MS 1600000000000ULL
+
+static uint64_t rows[NUM_ROWS * 3];
+static const char* path = "test_trace.ticks";
+
+// Helper function to skip whitespace in a JSON document
+static const char* json_skip(const char* p) {
+    while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+        p++;
+    return p;
+}
+
+// Helper function to parse one JSON value, returning the position after it or NULL when it is not valid JSON
+static const char* json_value(const char* p) {
+    p = json_skip(p);
+    if (*p == '{' || *p == '[') {
+        const char close = *p == '{' ? '}' : ']';
+        const int object = *p == '{';
+        p = json_skip(p + 1);
+        if (*p == close)
+            return p + 1;
+        for (;;) {
+            if (object) {
+                if (*p != '"' || (p = json_value(p)) == NULL)
+                    return NULL;
+                p = json_skip(p);
+                if (*p++ != ':')
+                    return NULL;
+            }
+            if ((p = json_value(p)) == NULL)
+                return NULL;
+            p = json_skip(p);
+            if (*p == close)
+                return p + 1;
+            if (*p++ != ',')
+                return NULL;
+            p = json_skip(p);
+        }
+    }
+    if (*p == '"') {
+        for (p++; *p != '"'; p++) {
+            if (*p == '\0' || (unsigned char)*p < 0x20)
+                return NULL;
+            if (*p == '\\' && *++p == '\0')
+                return NULL;
+        }
+        return p + 1;
+    }
+    if (*p == '-' || (*p >= '0' && *p <= '9')) {
+        char* end = NULL;
+        strtod(p, &end);
+        return end;
+    }
+    return NULL;
+}
+
+// Helper function to dump the trace and return it, checking it is a single valid JSON value
+static char* dump_trace(const char* trace_path) {
+    CHECK_OK(ticks_trace_dump(trace_path));
+    FILE* file = fopen(trace_path, "rb");
+    CHECK(file != NULL);
+    CHECK(fseek(file, 0, SEEK_END) == 0);
+    const long size = ftell(file);
+    CHECK(size > 0);
+    CHECK(fseek(file, 0, SEEK_SET) == 0);
+    char* json = malloc((size_t)size + 1);
+    CHECK(json != NULL);
+    CHECK(fread(json, 1, (size_t)size, file) == (size_t)size);
+    json[size] = '\0';
+    fclose(file);
+
+    const char* end = json_value(json);
+    CHECK(end != NULL);
+    CHECK(*json_skip(end) == '\0');
+    return json;
+}
+
+static uint32_t count_occurrences(const char* text, const char* pattern) {
+    uint32_t count = 0;
+    for (const char* p = strstr(text, pattern); p != NULL; p = strstr(p + 1, pattern))
+        count++;
+    return count;
+}
+
+// Helper function to read the test file on a thread of its own, recording trace events there
+static void* read_worker(void* arg) {
+    (void)arg;
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_open_read(path, &handle));
+    CHECK(test_count_range(handle, 1600000000, 1600001000) == NUM_ROWS);
+    CHECK_OK(ticks_close(handle));
+    return NULL;
+}
+
+int main(void) {
+    const char* trace_path = "test_trace.json";
+
+    for (uint64_t i = 0; i < NUM_ROWS; i++) {
+        rows[i * 3] = BASE_MS + i;
+        rows[i * 3 + 1] = 10000 + i % 977;
+        rows[i * 3 + 2] = i % 13;
+    }
+
+    printf("--- The dump is Chrome trace JSON ---\n");
+    test_write_file(path, rows, NUM_ROWS, 1000);
+    char* json = dump_trace(trace_path);
+    CHECK(strstr(json, "\"traceEvents\":[") != NULL);
+    CHECK(strstr(json, "\"name\":\"create_chunk\",\"cat\":\"ticksio\",\"ph\":\"X\"") != NULL);
+    CHECK(count_occurrences(json, "\"ph\":\"M\"") == 1);
+    free(json);
+
+    printf("--- A thread's ring is reused once it exited ---\n");
+    for (int i = 0; i < 3; i++) {
+        thread_portable thread;
+        CHECK(thread_create_portable(&thread, read_worker, NULL) == 0);
+        CHECK(thread_join_portable(thread) == 0);
+    }
+    json = dump_trace(trace_path);
+    // The main thread's ring and one ring shared by the workers, holding the last worker's events
+    CHECK(count_occurrences(json, "\"ph\":\"M\"") == 2);
+    CHECK(strstr(json, "\"args\":{\"name\":\"ticksio-4\"}") != NULL);
+    CHECK(strstr(json, "\"args\":{\"name\":\"ticksio-2\"}") == NULL);
+    CHECK(strstr(json, "\"name\":\"decode_chunk\"") != NULL || strstr(json, "\"name\":\"read_index_table\"") != NULL);
+    free(json);
+
+    remove(path);
+    remove(trace_path);
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+#ifndef TICKSIO_TEST_UTIL_H
+#define TICKSIO_TEST_UTIL_H
+
+#include "ticksio/ticksio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Checks stay active in release builds, unlike assert, and report the failing expression and line
+#define CHECK(expr)                                                                  \
+    do {                                                                             \
+        if (!(expr)) {                                                               \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+            exit(EXIT_FAILURE);                                                      \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_OK(expr) CHECK((expr) == TICKS_OK)
+
+// Helper function to fill in a header with a timestamp, price (DECIMAL, scale 4) and volume schema
+static inline void test_header(ticks_header_t* header, uint32_t max_chunk_rows) {
+    memset(header, 0, sizeof(ticks_header_t));
+    strcpy(header->ticker, "TEST");
+    header->schema.num_columns = 3;
+    strcpy(header->schema.columns[0].name, "ts");
+    header->schema.columns[0].type = TICKS_COLUMN_TIMESTAMP;
+    strcpy(header->schema.columns[1].name, "price");
+    header->schema.columns[1].type = TICKS_COLUMN_DECIMAL;
+    header->schema.columns[1].scale = 4;
+    strcpy(header->schema.columns[2].name, "volume");
+    header->schema.columns[2].type = TICKS_COLUMN_UINT;
+    header->chunk_policy.max_chunk_rows = max_chunk_rows;
+}
+
+// Helper function to write three-column rows into a new file with one chunk per max_chunk_rows
+static inline void test_write_file(const char* path, const uint64_t* rows, uint64_t num_rows, uint32_t max_chunk_rows) {
+    ticks_header_t header;
+    test_header(&header, max_chunk_rows);
+    ticks_file_t* handle = NULL;
+    CHECK_OK(ticks_new_file(path, &header, &handle));
+    CHECK_OK(ticks_add_records(handle, rows, num_rows));
+    CHECK_OK(ticks_close(handle));
+}
+
+// Helper function to count the records an iterator returns for [from, to)
+static inline uint64_t test_count_range(ticks_file_t* handle, time_t from, time_t to) {
+    ticks_iterator_t* iterator = NULL;
+    CHECK_OK(ticks_iterator_create(handle, from, to, &iterator));
+    uint64_t buffer[1024 * TICKS_MAX_COLUMNS];
+    uint64_t total = 0;
+    uint32_t num_records = 0;
+    ticks_status_e status;
+    while ((status = ticks_iterator_next_records(iterator, buffer, 1024, &num_records)) == TICKS_OK)
+        total += num_records;
+    CHECK(status == TICKS_EOF);
+    ticks_iterator_destroy(iterator);
+    return total;
+}
+
+#endif // TICKSIO_TEST_UTIL_H
@@ -0,0 +1,76 @@
+#include "ticksio/ticksio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Re-chunks a ticks file, e.g. one recorded live from many small ticks_add_data calls.
+// Usage: ticksio_compact <src> <dst> [--chunk-bytes <n>] [--chunk-rows <n>] [--bucket-ms <n>] [--bucket-origin-ms <n>]
+//                        [--range-rows <n>] [--threads <n>] [--verify always|off]
+// Without chunk options the source file's chunk policy is kept.
+
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s <src> <dst> [--chunk-bytes <n>] [--chunk-rows <n>] [--bucket-ms <n>] [--bucket-origin-ms <n>]\n"
+                    "       [--range-rows <n>] [--threads <n>] [--verify always|off]\n", program);
+}
+
+int main(int argc, char** argv) {
+    const char* src = NULL;
+    const char* dst = NULL;
+    ticks_compact_policy_t policy;
+    memset(&policy, 0, sizeof(policy));
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--chunk-bytes") == 0 && i + 1 < argc) {
+            policy.chunk_policy.max_chunk_bytes = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--chunk-rows") == 0 && i + 1 < argc) {
+            policy.chunk_policy.max_chunk_rows = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--bucket-ms") == 0 && i + 1 < argc) {
+            policy.chunk_policy.bucket_ms = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--bucket-origin-ms") == 0 && i + 1 < argc) {
+            policy.chunk_policy.bucket_origin_ms = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--range-rows") == 0 && i + 1 < argc) {
+            policy.range_rows = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            policy.num_threads = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--verify") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "always") == 0) {
+                policy.verify_mode = TICKS_VERIFY_ALWAYS;
+            } else if (strcmp(mode, "off") == 0) {
+                policy.verify_mode = TICKS_VERIFY_OFF;
+            } else {
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        } else if (src == NULL) {
+            src = argv[i];
+        } else if (dst == NULL) {
+            dst = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (src == NULL || dst == NULL) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ticks_status_e status = ticks_compact(src, dst, &policy);
+    if (status != TICKS_OK) {
+        fprintf(stderr, "Compaction of %s failed: %s\n", src, ticks_status_to_string(status));
+        return EXIT_FAILURE;
+    }
+
+    ticks_file_t* handle = NULL;
+    if (ticks_open_read(dst, &handle) == TICKS_OK) {
+        uint64_t index_size = 0;
+        ticks_get_index_size(handle, &index_size);
+        printf("Compacted %s into %s (%llu index bytes)\n", src, dst, (unsigned long long)index_size);
+        ticks_close(handle);
+    }
+
+    return EXIT_SUCCESS;
+}